@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2025 Tools for Humanity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef H_BACKUP_REGS_
+#define H_BACKUP_REGS_
+
+#include <soc.h>
+#include <stdint.h>
+#include <stm32_ll_bus.h>
+#include <stm32_ll_pwr.h>
+#include <zephyr/devicetree.h>
+
+/*
+ * Backup registers, shared with the application which accesses them through
+ * the bbram driver, see main_board/src/system/backup_regs.h for the layout.
+ * The bbram driver isn't used here to keep the RTC off in the bootloader.
+ */
+
+#define BACKUP_REGS_COUNT DT_PROP(DT_NODELABEL(bbram), st_backup_regs)
+#define BACKUP_REGS_SIZE  (BACKUP_REGS_COUNT * sizeof(uint32_t))
+
+/*
+ * Gives access to the backup registers, which are in the TAMP peripheral,
+ * in the backup domain.
+ *
+ * @retval	pointer to the first backup register
+ */
+static inline volatile uint32_t *
+backup_regs_get(void)
+{
+    LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_PWR);
+    LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_RTCAPB);
+    LL_PWR_EnableBkUpAccess();
+
+    return &TAMP->BKP0R;
+}
+
+#endif /* H_BACKUP_REGS_ */
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2025 Tools for Humanity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef H_STAGES_
+#define H_STAGES_
+
+#ifdef CONFIG_ORB_BOOT_STAGES_TIMING
+
+#include <boot_stages.h>
+
+/*
+ * Timestamps the beginning of a boot stage with the cycle counter.
+ */
+void
+stages_stamp(enum boot_stage_e stage);
+
+/*
+ * Stores the timestamps into the backup registers, to be read by the
+ * application. Must be called before the system timer is disabled.
+ */
+void
+stages_save(void);
+
+#else
+
+#define stages_stamp(stage)                                                    \
+    do {                                                                       \
+    } while (false)
+#define stages_save()                                                          \
+    do {                                                                       \
+    } while (false)
+
+#endif /* CONFIG_ORB_BOOT_STAGES_TIMING */
+
+#endif /* H_STAGES_ */
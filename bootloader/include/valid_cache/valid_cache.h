@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2025 Tools for Humanity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef H_VALID_CACHE_
+#define H_VALID_CACHE_
+
+#include "bootutil/bootutil.h"
+#include "bootutil/fault_injection_hardening.h"
+
+/*
+ * Validated-image cache: once the image in the primary slot has been fully
+ * validated (hash and signature), a SHA-256 of the whole image (header, image
+ * and TLV areas) is kept in a CCM SRAM page that the application can't write.
+ * On the next boots, the image is hashed again but its signature isn't
+ * verified as long as the digest matches the record.
+ *
+ * The record is invalidated whenever the bootloader writes the primary slot,
+ * and lost on power loss, in which case the image is fully validated again.
+ */
+
+#ifdef CONFIG_ORB_BOOT_VALID_CACHE
+
+/*
+ * Checks the primary slot image against the record.
+ *
+ * @retval	FIH_SUCCESS if the image has already been validated and the full
+ *		validation can be skipped
+ */
+fih_ret
+valid_cache_check(int img_index);
+
+/*
+ * Invalidates the record, when the primary slot is modified.
+ */
+void
+valid_cache_invalidate(void);
+
+/*
+ * Records the image about to be booted, if it has been fully validated
+ * during this boot, then write-protects the record until the next reset.
+ */
+void
+valid_cache_update(const struct boot_rsp *rsp);
+
+#else
+
+#define valid_cache_invalidate()                                               \
+    do {                                                                       \
+    } while (false)
+#define valid_cache_update(rsp)                                                \
+    do {                                                                       \
+    } while (false)
+
+#endif /* CONFIG_ORB_BOOT_VALID_CACHE */
+
+#endif /* H_VALID_CACHE_ */
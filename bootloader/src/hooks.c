@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2025 Tools for Humanity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+
+#include "bootutil/boot_hooks.h"
+#include "bootutil/bootutil_public.h"
+#include "bootutil/fault_injection_hardening.h"
+#include "bootutil/image.h"
+#include "flash_map_backend/flash_map_backend.h"
+#include "stages/stages.h"
+#include "valid_cache/valid_cache.h"
+#include <sysflash/sysflash.h>
+
+/*
+ * MCUboot image access hooks, used to timestamp the stages happening in
+ * `boot_go()` and to skip the validation of an already validated primary
+ * image. Other hooks keep the regular MCUboot behavior.
+ */
+
+int
+boot_read_image_header_hook(int img_index, int slot,
+                            struct image_header *img_head)
+{
+    ARG_UNUSED(img_index);
+    ARG_UNUSED(slot);
+    ARG_UNUSED(img_head);
+
+    return BOOT_HOOK_REGULAR;
+}
+
+fih_ret
+boot_image_check_hook(int img_index, int slot)
+{
+    if (slot != 0) {
+        stages_stamp(BOOT_STAGE_SECONDARY_CHECK);
+        FIH_RET(FIH_BOOT_HOOK_REGULAR);
+    }
+
+    stages_stamp(BOOT_STAGE_PRIMARY_CHECK);
+
+#ifdef CONFIG_ORB_BOOT_VALID_CACHE
+    FIH_DECLARE(fih_rc, FIH_FAILURE);
+    FIH_CALL(valid_cache_check, fih_rc, img_index);
+    if (FIH_EQ(fih_rc, FIH_SUCCESS)) {
+        /* image validated on a previous boot: skip the validation */
+        FIH_RET(fih_rc);
+    }
+#else
+    ARG_UNUSED(img_index);
+#endif
+
+    FIH_RET(FIH_BOOT_HOOK_REGULAR);
+}
+
+int
+boot_perform_update_hook(int img_index, struct image_header *img_head,
+                         const struct flash_area *area)
+{
+    ARG_UNUSED(img_index);
+    ARG_UNUSED(img_head);
+    ARG_UNUSED(area);
+
+    stages_stamp(BOOT_STAGE_UPDATE);
+    valid_cache_invalidate();
+
+    return BOOT_HOOK_REGULAR;
+}
+
+int
+boot_read_swap_state_primary_slot_hook(int image_index,
+                                       struct boot_swap_state *state)
+{
+    ARG_UNUSED(image_index);
+    ARG_UNUSED(state);
+
+    return BOOT_HOOK_REGULAR;
+}
+
+int
+boot_copy_region_post_hook(int img_index, const struct flash_area *area,
+                           size_t size)
+{
+    ARG_UNUSED(size);
+
+    /* primary slot written: image must be fully validated again */
+    if (flash_area_get_id(area) == FLASH_AREA_IMAGE_PRIMARY(img_index)) {
+        valid_cache_invalidate();
+    }
+
+    return 0;
+}
+
+int
+boot_serial_uploaded_hook(int img_index, const struct flash_area *area,
+                          size_t size)
+{
+    ARG_UNUSED(size);
+
+    /* image uploaded into the primary slot, not validated yet */
+    if (flash_area_get_id(area) == FLASH_AREA_IMAGE_PRIMARY(img_index)) {
+        valid_cache_invalidate();
+    }
+
+    return 0;
+}
+
+int
+boot_img_install_stat_hook(int image_index, int slot, int *img_install_stat)
+{
+    ARG_UNUSED(image_index);
+    ARG_UNUSED(slot);
+    ARG_UNUSED(img_install_stat);
+
+    return BOOT_HOOK_REGULAR;
+}
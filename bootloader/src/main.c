@@ -38,7 +38,9 @@
 #include <sysflash/sysflash.h>
 
 #include "io/io.h"
+#include "stages/stages.h"
 #include "target.h"
+#include "valid_cache/valid_cache.h"
 
 #include "bootutil/bootutil.h"
 #include "bootutil/bootutil_log.h"
@@ -484,6 +486,8 @@ main(void)
     int rc;
     FIH_DECLARE(fih_rc, FIH_FAILURE);
 
+    stages_stamp(BOOT_STAGE_MAIN);
+
     MCUBOOT_WATCHDOG_SETUP();
     MCUBOOT_WATCHDOG_FEED();
 
@@ -566,7 +570,9 @@ main(void)
 #endif
 #endif
 
+    stages_stamp(BOOT_STAGE_BOOT_GO);
     FIH_CALL(boot_go, fih_rc, &rsp);
+    stages_stamp(BOOT_STAGE_BOOT_GO_DONE);
 
 #ifdef CONFIG_BOOT_SERIAL_BOOT_MODE
     if (io_detect_boot_mode()) {
@@ -636,7 +642,11 @@ main(void)
 
     mcuboot_status_change(MCUBOOT_STATUS_BOOTABLE_IMAGE_FOUND);
 
+    valid_cache_update(&rsp);
+
     ZEPHYR_BOOT_LOG_STOP();
+    stages_stamp(BOOT_STAGE_JUMP);
+    stages_save();
     do_boot(&rsp);
 
     mcuboot_status_change(MCUBOOT_STATUS_BOOT_FAILED);
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2025 Tools for Humanity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+
+#include "backup_regs/backup_regs.h"
+#include "stages/stages.h"
+
+BUILD_ASSERT(BOOT_STAGES_BACKUP_REGS_OFFSET % sizeof(uint32_t) == 0,
+             "Boot stages must be aligned on a backup register");
+BUILD_ASSERT(BOOT_STAGES_BACKUP_REGS_OFFSET + sizeof(struct boot_stages_t) <=
+                 BACKUP_REGS_SIZE,
+             "Not enough backup registers for the boot stages");
+
+static struct boot_stages_t stages;
+
+void
+stages_stamp(enum boot_stage_e stage)
+{
+    if (stage < BOOT_STAGE_COUNT) {
+        /* 0 means the stage didn't happen */
+        stages.timestamp_us[stage] =
+            MAX(k_cyc_to_us_floor32(k_cycle_get_32()), 1);
+    }
+}
+
+void
+stages_save(void)
+{
+    volatile uint32_t *regs = backup_regs_get();
+
+    stages.magic = BOOT_STAGES_MAGIC;
+
+    const uint32_t *words = (const uint32_t *)&stages;
+    for (size_t i = 0; i < sizeof(stages) / sizeof(uint32_t); ++i) {
+        regs[BOOT_STAGES_BACKUP_REGS_OFFSET / sizeof(uint32_t) + i] = words[i];
+    }
+}
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2025 Tools for Humanity
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soc.h>
+#include <stm32_ll_bus.h>
+#include <string.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
+
+#include "bootutil/bootutil_log.h"
+#include "bootutil/crypto/sha.h"
+#include "bootutil/fault_injection_hardening.h"
+#include "bootutil/image.h"
+#include "flash_map_backend/flash_map_backend.h"
+#include "valid_cache/valid_cache.h"
+#include <sysflash/sysflash.h>
+
+BOOT_LOG_MODULE_DECLARE(mcuboot);
+
+/*
+ * The record lives in the last CCM SRAM page, which is left out of sram0 in
+ * the board DTS. SRAM content is kept across system resets, and the page is
+ * write-protected (SYSCFG_SWPR) before jumping into the application: only
+ * the bootloader can write the record, until the next system reset.
+ */
+#define VALID_CACHE_CCM_PAGE_SIZE  1024
+#define VALID_CACHE_CCM_PAGE       31
+#define VALID_CACHE_CCM_ALIAS_BASE 0x20018000
+#define VALID_CACHE_RECORD                                                     \
+    ((volatile struct valid_cache_record *)(CCMSRAM_BASE +                     \
+                                            VALID_CACHE_CCM_PAGE *             \
+                                                VALID_CACHE_CCM_PAGE_SIZE))
+
+#define VALID_CACHE_MAGIC       0x56434143 /* "CACV" */
+#define VALID_CACHE_DIGEST_SIZE 32
+#define VALID_CACHE_READ_SIZE   256
+
+struct valid_cache_record {
+    uint32_t magic;
+    uint8_t digest[VALID_CACHE_DIGEST_SIZE];
+};
+
+BUILD_ASSERT(DT_REG_ADDR(DT_NODELABEL(sram0)) +
+                     DT_REG_SIZE(DT_NODELABEL(sram0)) <=
+                 VALID_CACHE_CCM_ALIAS_BASE +
+                     VALID_CACHE_CCM_PAGE * VALID_CACHE_CCM_PAGE_SIZE,
+             "Validated-image cache page must be left out of sram0");
+BUILD_ASSERT(sizeof(struct valid_cache_record) <= VALID_CACHE_CCM_PAGE_SIZE,
+             "Record must fit in the write-protected page");
+BUILD_ASSERT(IS_ENABLED(CONFIG_BOOT_IMG_HASH_ALG_SHA256),
+             "Digest size is the one of SHA-256");
+
+/* primary slot fully validated during this boot */
+static bool primary_validated;
+
+/*
+ * Record of the primary slot, computed when checking it: written as is once
+ * validated, the primary slot being hashed only once per boot
+ */
+static struct valid_cache_record primary_record;
+
+/*
+ * Digest of the whole image as validated by MCUboot: header, image, protected
+ * TLV area and TLV area, which contains the image hash and its signature.
+ * Any modification of the primary slot content changes the digest.
+ */
+static int
+image_digest(const struct flash_area *fap, uint8_t *digest)
+{
+    struct image_header hdr;
+    struct image_tlv_info info;
+    uint8_t buf[VALID_CACHE_READ_SIZE];
+    bootutil_sha_context sha;
+    uint32_t end;
+    int rc;
+
+    rc = flash_area_read(fap, 0, &hdr, sizeof(hdr));
+    if (rc != 0 || hdr.ih_magic != IMAGE_MAGIC) {
+        return -1;
+    }
+
+    /* protected TLV area is accounted for in the header */
+    end = (uint32_t)hdr.ih_hdr_size + hdr.ih_img_size +
+          hdr.ih_protect_tlv_size;
+    if (end + sizeof(info) > flash_area_get_size(fap) ||
+        flash_area_read(fap, end, &info, sizeof(info)) != 0 ||
+        info.it_magic != IMAGE_TLV_INFO_MAGIC) {
+        return -1;
+    }
+    end += info.it_tlv_tot;
+    if (end > flash_area_get_size(fap)) {
+        return -1;
+    }
+
+    bootutil_sha_init(&sha);
+    for (uint32_t off = 0; off < end; off += sizeof(buf)) {
+        const uint32_t len = MIN(sizeof(buf), end - off);
+        rc = flash_area_read(fap, off, buf, len);
+        if (rc != 0) {
+            bootutil_sha_drop(&sha);
+            return -1;
+        }
+        bootutil_sha_update(&sha, buf, len);
+    }
+    bootutil_sha_finish(&sha, digest);
+    bootutil_sha_drop(&sha);
+
+    return 0;
+}
+
+static int
+primary_digest(struct valid_cache_record *record)
+{
+    const struct flash_area *fap;
+    int rc;
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_PRIMARY(0), &fap);
+    if (rc != 0) {
+        return rc;
+    }
+
+    record->magic = VALID_CACHE_MAGIC;
+    rc = image_digest(fap, record->digest);
+    flash_area_close(fap);
+
+    return rc;
+}
+
+/*
+ * Constant-time comparison, the loop counter is checked so that a glitch
+ * skipping the loop doesn't report a match.
+ */
+static fih_ret
+record_matches(const struct valid_cache_record *expected)
+{
+    FIH_DECLARE(fih_rc, FIH_FAILURE);
+    const volatile uint8_t *record =
+        (const volatile uint8_t *)VALID_CACHE_RECORD;
+    const uint8_t *bytes = (const uint8_t *)expected;
+    uint8_t diff = 0;
+    size_t i;
+
+    for (i = 0; i < sizeof(*expected); ++i) {
+        diff |= record[i] ^ bytes[i];
+    }
+    if (diff == 0 && i == sizeof(*expected)) {
+        fih_rc = FIH_SUCCESS;
+    }
+
+    FIH_RET(fih_rc);
+}
+
+fih_ret
+valid_cache_check(int img_index)
+{
+    FIH_DECLARE(fih_rc, FIH_FAILURE);
+
+    if (img_index != 0) {
+        FIH_RET(FIH_FAILURE);
+    }
+
+    /* full validation fails if the image can't be hashed */
+    primary_validated = false;
+    if (primary_digest(&primary_record) != 0) {
+        FIH_RET(FIH_FAILURE);
+    }
+
+    /* validation is performed in full unless the cache matches */
+    primary_validated = true;
+
+    /* magic is part of the comparison, hardened against glitches */
+    FIH_CALL(record_matches, fih_rc, &primary_record);
+    if (FIH_EQ(fih_rc, FIH_SUCCESS)) {
+        BOOT_LOG_INF("Primary image already validated");
+        primary_validated = false;
+    }
+
+    FIH_RET(fih_rc);
+}
+
+void
+valid_cache_invalidate(void)
+{
+    primary_validated = false;
+    memset((void *)VALID_CACHE_RECORD, 0, sizeof(struct valid_cache_record));
+}
+
+void
+valid_cache_update(const struct boot_rsp *rsp)
+{
+    const struct flash_area *fap;
+
+    if (primary_validated &&
+        flash_area_open(FLASH_AREA_IMAGE_PRIMARY(0), &fap) == 0) {
+        const bool primary_booted =
+            rsp->br_image_off == flash_area_get_off(fap);
+        flash_area_close(fap);
+
+        /* primary slot not written since checked, see invalidate */
+        if (primary_booted) {
+            memcpy((void *)VALID_CACHE_RECORD, &primary_record,
+                   sizeof(primary_record));
+        }
+    }
+
+    /* in any case, the application must not be able to forge a record */
+    LL_APB2_GRP1_EnableClock(LL_APB2_GRP1_PERIPH_SYSCFG);
+    SYSCFG->SWPR = BIT(VALID_CACHE_CCM_PAGE);
+}
@@ -0,0 +1,279 @@
+#include "orb_crc.h"
+#include "compilers.h"
+#include "orb_logs.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/crc.h>
+
+LOG_MODULE_REGISTER(orb_crc, CONFIG_ORB_CRC_LOG_LEVEL);
+
+#if defined(CONFIG_ORB_LIB_CRC_HW)
+
+#include <stm32g4xx_ll_crc.h>
+#include <zephyr/drivers/clock_control.h>
+#include <zephyr/drivers/clock_control/stm32_clock_control.h>
+
+#if defined(CONFIG_ORB_LIB_CRC_HW_DMA)
+#include <zephyr/drivers/dma.h>
+
+static const struct device *const crc_dma_dev =
+    DEVICE_DT_GET(DT_NODELABEL(dma2));
+BUILD_ASSERT(CONFIG_ORB_LIB_CRC_HW_DMA_CHANNEL <=
+                 DT_PROP(DT_NODELABEL(dma2), dma_requests),
+             "DMA2 channel used by the CRC unit doesn't exist");
+
+// DMA transfers are limited to 65535 data items
+#define CRC_DMA_MAX_WORDS 0xFFFF
+// the CRC unit needs 4 AHB cycles per word, even the largest transfer is
+// done in less than a few milliseconds
+#define CRC_DMA_TIMEOUT_MS 50
+
+static K_SEM_DEFINE(crc_dma_done_sem, 0, 1);
+static volatile int crc_dma_status;
+#endif
+
+static struct stm32_pclken crc_pclken = {.bus = STM32_CLOCK_BUS_AHB1,
+                                         .enr = RCC_AHB1ENR_CRCEN};
+
+static K_MUTEX_DEFINE(crc_hw_mutex);
+static bool crc_hw_ready = false;
+
+static int
+crc_hw_init(void)
+{
+    const struct device *clk = DEVICE_DT_GET(STM32_CLOCK_CONTROL_NODE);
+    int err_code = clock_control_on(clk, &crc_pclken);
+    if (err_code) {
+        LOG_ERR("Unable to enable CRC unit clock: %d", err_code);
+        return err_code;
+    }
+
+#if defined(CONFIG_ORB_LIB_CRC_HW_DMA)
+    if (!device_is_ready(crc_dma_dev)) {
+        // CPU will feed the CRC unit
+        LOG_WRN("DMA not ready");
+    }
+#endif
+
+    crc_hw_ready = true;
+    return 0;
+}
+
+#if defined(CONFIG_ORB_LIB_CRC_HW_DMA)
+static void
+crc_dma_callback(const struct device *dev, void *user_data, uint32_t channel,
+                 int status)
+{
+    UNUSED_PARAMETER(dev);
+    UNUSED_PARAMETER(user_data);
+    UNUSED_PARAMETER(channel);
+
+    crc_dma_status = status;
+    k_sem_give(&crc_dma_done_sem);
+}
+
+/**
+ * Feed the CRC data register with `count` words using a memory-to-memory
+ * transfer, the calling thread sleeps until the transfer is done.
+ *
+ * @param words word-aligned input data
+ * @param count number of words
+ * @retval 0 on success
+ * @retval negative error code: the CRC unit state is undefined
+ */
+static int
+crc_hw_feed_dma(const uint32_t *words, size_t count)
+{
+    while (count > 0) {
+        size_t chunk = MIN(count, CRC_DMA_MAX_WORDS);
+
+        struct dma_block_config block = {
+            .source_address = (uint32_t)words,
+            .dest_address = (uint32_t)&CRC->DR,
+            .block_size = chunk * sizeof(uint32_t),
+            .source_addr_adj = DMA_ADDR_ADJ_INCREMENT,
+            .dest_addr_adj = DMA_ADDR_ADJ_NO_CHANGE,
+        };
+        struct dma_config config = {
+            .dma_slot = 0, // DMAMUX request: memory-to-memory
+            .channel_direction = MEMORY_TO_MEMORY,
+            .channel_priority = 0,
+            .source_data_size = sizeof(uint32_t),
+            .dest_data_size = sizeof(uint32_t),
+            .source_burst_length = 1,
+            .dest_burst_length = 1,
+            .block_count = 1,
+            .head_block = &block,
+            .dma_callback = crc_dma_callback,
+        };
+
+        k_sem_reset(&crc_dma_done_sem);
+        int err_code =
+            dma_config(crc_dma_dev, CONFIG_ORB_LIB_CRC_HW_DMA_CHANNEL, &config);
+        if (err_code == 0) {
+            err_code =
+                dma_start(crc_dma_dev, CONFIG_ORB_LIB_CRC_HW_DMA_CHANNEL);
+        }
+        if (err_code) {
+            LOG_ERR("Unable to start DMA transfer: %d", err_code);
+            return err_code;
+        }
+
+        if (k_sem_take(&crc_dma_done_sem, K_MSEC(CRC_DMA_TIMEOUT_MS))) {
+            dma_stop(crc_dma_dev, CONFIG_ORB_LIB_CRC_HW_DMA_CHANNEL);
+            LOG_ERR("DMA transfer timed out");
+            return -ETIMEDOUT;
+        }
+        if (crc_dma_status < 0) {
+            LOG_ERR("DMA transfer error: %d", crc_dma_status);
+            return crc_dma_status;
+        }
+
+        words += chunk;
+        count -= chunk;
+    }
+
+    return 0;
+}
+#endif
+
+/**
+ * Feed the CRC unit with any buffer.
+ * Bytes are processed LSB first (reflected input):
+ * - unaligned head and tail bytes are written one by one with
+ *   bit-reversal by byte
+ * - words are loaded in little-endian so the first byte is in the least
+ *   significant byte: reversing the bit order of the entire word keeps the
+ *   byte ordering and allows 32-bit writes to the data register, from the CPU
+ *   or DMA
+ *
+ * @retval 0 on success
+ * @retval negative error code: the CRC unit state is undefined
+ */
+static int
+crc_hw_feed(const uint8_t *data, size_t len)
+{
+    int err_code = 0;
+
+    LL_CRC_SetInputDataReverseMode(CRC, LL_CRC_INDATA_REVERSE_BYTE);
+    while (len > 0 && ((uintptr_t)data & 0x3) != 0) {
+        LL_CRC_FeedData8(CRC, *data++);
+        len--;
+    }
+
+    size_t words = len / sizeof(uint32_t);
+    if (words > 0) {
+        // reading the data register stalls until the ongoing computation
+        // is over, do it before changing the input configuration
+        (void)LL_CRC_ReadData32(CRC);
+        LL_CRC_SetInputDataReverseMode(CRC, LL_CRC_INDATA_REVERSE_WORD);
+
+        const uint32_t *src = (const uint32_t *)data;
+#if defined(CONFIG_ORB_LIB_CRC_HW_DMA)
+        if (len >= CONFIG_ORB_LIB_CRC_HW_DMA_THRESHOLD &&
+            device_is_ready(crc_dma_dev)) {
+            err_code = crc_hw_feed_dma(src, words);
+        } else
+#endif
+        {
+            for (size_t i = 0; i < words; i++) {
+                LL_CRC_FeedData32(CRC, src[i]);
+            }
+        }
+
+        data += words * sizeof(uint32_t);
+        len -= words * sizeof(uint32_t);
+
+        (void)LL_CRC_ReadData32(CRC);
+        LL_CRC_SetInputDataReverseMode(CRC, LL_CRC_INDATA_REVERSE_BYTE);
+    }
+
+    while (len > 0) {
+        LL_CRC_FeedData8(CRC, *data++);
+        len--;
+    }
+
+    return err_code;
+}
+
+/**
+ * Take exclusive access to the CRC unit
+ * @retval true if the CRC unit can be used
+ * @retval false to use the software implementation: called from an ISR or the
+ * CRC unit couldn't be initialized
+ */
+static bool
+crc_hw_lock(void)
+{
+    if (k_is_in_isr() || k_is_pre_kernel()) {
+        return false;
+    }
+
+    k_mutex_lock(&crc_hw_mutex, K_FOREVER);
+    if (!crc_hw_ready && crc_hw_init() != 0) {
+        k_mutex_unlock(&crc_hw_mutex);
+        return false;
+    }
+
+    return true;
+}
+
+static void
+crc_hw_unlock(void)
+{
+    k_mutex_unlock(&crc_hw_mutex);
+}
+
+#endif // CONFIG_ORB_LIB_CRC_HW
+
+uint16_t
+orb_crc16_ccitt(uint16_t seed, const uint8_t *src, size_t len)
+{
+#if defined(CONFIG_ORB_LIB_CRC_HW)
+    if (len > 0 && crc_hw_lock()) {
+        // `crc16_ccitt` is reflected: the CRC unit computes the
+        // non-reflected CRC over bit-reversed input so the internal state
+        // starts with the bit-reversed seed and the output is bit-reversed
+        LL_CRC_SetPolynomialSize(CRC, LL_CRC_POLYLENGTH_16B);
+        LL_CRC_SetPolynomialCoef(CRC, 0x1021);
+        LL_CRC_SetOutputDataReverseMode(CRC, LL_CRC_OUTDATA_REVERSE_BIT);
+        LL_CRC_SetInitialData(CRC, __RBIT(seed) >> 16);
+        LL_CRC_ResetCRCCalculationUnit(CRC);
+
+        int err_code = crc_hw_feed(src, len);
+        uint16_t crc = LL_CRC_ReadData16(CRC);
+        crc_hw_unlock();
+
+        if (err_code == 0) {
+            return crc;
+        }
+    }
+#endif
+
+    return crc16_ccitt(seed, src, len);
+}
+
+uint32_t
+orb_crc32_ieee_update(uint32_t crc, const uint8_t *data, size_t len)
+{
+#if defined(CONFIG_ORB_LIB_CRC_HW)
+    if (len > 0 && crc_hw_lock()) {
+        // `crc32_ieee_update` inverts the CRC before and after processing
+        // the data, on top of being reflected (see `orb_crc16_ccitt`)
+        LL_CRC_SetPolynomialSize(CRC, LL_CRC_POLYLENGTH_32B);
+        LL_CRC_SetPolynomialCoef(CRC, LL_CRC_DEFAULT_CRC32_POLY);
+        LL_CRC_SetOutputDataReverseMode(CRC, LL_CRC_OUTDATA_REVERSE_BIT);
+        LL_CRC_SetInitialData(CRC, __RBIT(~crc));
+        LL_CRC_ResetCRCCalculationUnit(CRC);
+
+        int err_code = crc_hw_feed(data, len);
+        uint32_t hw_crc = ~LL_CRC_ReadData32(CRC);
+        crc_hw_unlock();
+
+        if (err_code == 0) {
+            return hw_crc;
+        }
+    }
+#endif
+
+    return crc32_ieee_update(crc, data, len);
+}
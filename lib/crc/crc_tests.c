@@ -0,0 +1,43 @@
+#include "orb_crc.h"
+#include <stdlib.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/ztest.h>
+
+// large enough to go through DMA, with unaligned head & tail bytes
+#define CRC_TEST_BUFFER_SIZE (2048 + 8)
+
+static uint8_t crc_test_buffer[CRC_TEST_BUFFER_SIZE];
+
+ZTEST(hardware, test_crc_matches_software)
+{
+    for (size_t i = 0; i < sizeof(crc_test_buffer); i++) {
+        crc_test_buffer[i] = rand() % (UINT8_MAX + 1);
+    }
+
+    const size_t lengths[] = {0, 1, 3, 4, 7, 64, 255, 256, 257, 2048};
+    for (size_t offset = 0; offset < 4; offset++) {
+        for (size_t i = 0; i < ARRAY_SIZE(lengths); i++) {
+            const uint8_t *data = &crc_test_buffer[offset];
+            size_t len = lengths[i];
+
+            zassert_equal(orb_crc16_ccitt(0xffff, data, len),
+                          crc16_ccitt(0xffff, data, len),
+                          "crc16 mismatch, offset %u, len %u", offset, len);
+            zassert_equal(orb_crc32_ieee_update(0x12345678, data, len),
+                          crc32_ieee_update(0x12345678, data, len),
+                          "crc32 mismatch, offset %u, len %u", offset, len);
+        }
+    }
+
+    // chained computation, as done when reading records or images by chunks
+    uint16_t crc16 = 0xffff;
+    uint32_t crc32 = 0;
+    for (size_t off = 0; off < CRC_TEST_BUFFER_SIZE; off += 333) {
+        size_t len = MIN(333, CRC_TEST_BUFFER_SIZE - off);
+        crc16 = orb_crc16_ccitt(crc16, &crc_test_buffer[off], len);
+        crc32 = orb_crc32_ieee_update(crc32, &crc_test_buffer[off], len);
+    }
+    zassert_equal(crc16,
+                  crc16_ccitt(0xffff, crc_test_buffer, CRC_TEST_BUFFER_SIZE));
+    zassert_equal(crc32, crc32_ieee(crc_test_buffer, CRC_TEST_BUFFER_SIZE));
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * CRC computation offloaded to the STM32 CRC unit when available
+ * (`CONFIG_ORB_LIB_CRC_HW`), large buffers being fed by DMA
+ * (`CONFIG_ORB_LIB_CRC_HW_DMA`).
+ * Fall back to the software implementation from `zephyr/sys/crc.h`
+ * otherwise (native_sim, unit tests).
+ *
+ * Results are bit-identical to their Zephyr counterparts so the functions
+ * can be used as drop-in replacements, and values stored in Flash or sent by
+ * the Jetson remain compatible.
+ */
+
+/**
+ * @brief Compute CRC16-CCITT, same as `crc16_ccitt()`
+ *
+ * Reflected 0x1021 polynomial, no final XOR.
+ *
+ * @param seed initial value, or value returned by the previous call
+ * @param src input data
+ * @param len number of bytes in `src`
+ * @return CRC16 value
+ */
+uint16_t
+orb_crc16_ccitt(uint16_t seed, const uint8_t *src, size_t len);
+
+/**
+ * @brief Update CRC32-IEEE, same as `crc32_ieee_update()`
+ *
+ * @param crc 0 for the first call, or value returned by the previous call
+ * @param data input data
+ * @param len number of bytes in `data`
+ * @return CRC32 value
+ */
+uint32_t
+orb_crc32_ieee_update(uint32_t crc, const uint8_t *data, size_t len);
+
+/**
+ * @brief Compute CRC32-IEEE over a buffer, same as `crc32_ieee()`
+ */
+static inline uint32_t
+orb_crc32_ieee(const uint8_t *data, size_t len)
+{
+    return orb_crc32_ieee_update(0x0, data, len);
+}
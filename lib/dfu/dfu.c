@@ -2,6 +2,7 @@
 #include "bootutil/bootutil_public.h"
 #include "compilers.h"
 #include "errno.h"
+#include "orb_crc.h"
 #include "orb_logs.h"
 #include <app_assert.h>
 #include <errors.h>
@@ -11,7 +12,18 @@
 #include <zephyr/drivers/flash/stm32_flash_api_extensions.h>
 #include <zephyr/kernel.h>
 #include <zephyr/storage/flash_map.h>
-#include <zephyr/sys/crc.h>
+
+#ifdef CONFIG_ORB_LIB_DFU_RESUME
+#include <storage.h>
+#endif
+
+#ifdef CONFIG_ORB_LIB_DFU_LZ
+#include "dfu_lz.h"
+#endif
+
+#ifdef CONFIG_ORB_LIB_DFU_DELTA
+#include "dfu_delta.h"
+#endif
 
 #ifdef CONFIG_MEMFAULT
 #include <memfault/core/reboot_tracking.h>
@@ -28,6 +40,10 @@ static int
 dfu_secondary_check(uint32_t crc32);
 #endif
 
+static int
+dfu_secondary_image_size(const struct flash_area *flash_area_p,
+                         size_t *img_size);
+
 K_THREAD_STACK_DEFINE(dfu_thread_stack, CONFIG_ORB_LIB_THREAD_STACK_SIZE_DFU);
 static struct k_thread dfu_thread_data = {0};
 static k_tid_t tid_dfu = NULL;
@@ -52,215 +68,907 @@ BUILD_ASSERT(DFU_BLOCKS_WRITE_SIZE % 8 == 0,
 
 STATIC_OR_EXTERN struct dfu_state_t dfu_state __ALIGN(8) = {0};
 
-// 1 producer and 1 consumer sharing dfu_state
-// we need two semaphores
-STATIC_OR_EXTERN K_SEM_DEFINE(sem_dfu_free_space, 1, 1);
-STATIC_OR_EXTERN K_SEM_DEFINE(sem_dfu_full, 0, 1);
+#ifdef CONFIG_ORB_LIB_DFU_LZ
+// decompression context of compressed images, used by the processing thread
+static struct dfu_lz_t dfu_lz;
+#endif
+
+#ifdef CONFIG_ORB_LIB_DFU_DELTA
+// patch context, used by the processing thread, reading the primary slot
+static struct dfu_delta_t dfu_delta;
+#endif
+
+#ifdef CONFIG_ORB_LIB_DFU_RESUME
+BUILD_ASSERT(CONFIG_ORB_LIB_DFU_RESUME_BACKUP_REGS_OFFSET % 4 == 0,
+             "DFU checkpoint must be aligned on a backup register");
+BUILD_ASSERT(CONFIG_ORB_LIB_DFU_RESUME_BACKUP_REGS_OFFSET +
+                     sizeof(struct dfu_checkpoint_t) <=
+                 DT_PROP(DT_NODELABEL(bbram), st_backup_regs) * 4,
+             "Not enough backup registers for the DFU checkpoint");
+#endif
+
+// 1 producer and 1 consumer sharing `dfu_state.slots`
+// we need two semaphores, counting free and queued slots
+STATIC_OR_EXTERN K_SEM_DEFINE(sem_dfu_free_space, DFU_WINDOW_SIZE,
+                              DFU_WINDOW_SIZE);
+STATIC_OR_EXTERN K_SEM_DEFINE(sem_dfu_full, 0, DFU_WINDOW_SIZE);
+
+static void
+dfu_thread_create(void)
+{
+    // create processing task now if it doesn't exist
+    // priority set by Kconfig: CONFIG_ORB_LIB_DFU_THREAD_PRIORITY
+    if (tid_dfu == NULL) {
+        tid_dfu = k_thread_create(&dfu_thread_data, dfu_thread_stack,
+                                  K_THREAD_STACK_SIZEOF(dfu_thread_stack),
+                                  (k_thread_entry_t)process_dfu_blocks_thread,
+                                  NULL, NULL, NULL,
+                                  CONFIG_ORB_LIB_THREAD_PRIORITY_DFU, 0,
+                                  K_NO_WAIT);
+        k_thread_name_set(tid_dfu, "dfu");
+    }
+}
+
+/// Get a free slot, to be queued with `dfu_slot_queue`
+/// @return NULL if window is full
+static struct dfu_slot_t *
+dfu_slot_get(void)
+{
+    if (k_sem_take(&sem_dfu_free_space, K_NO_WAIT) != 0) {
+        return NULL;
+    }
+
+    return &dfu_state.slots[dfu_state.slot_wr_idx % DFU_WINDOW_SIZE];
+}
+
+static void
+dfu_slot_queue(void)
+{
+    dfu_state.slot_wr_idx++;
+
+    // wake up processing task
+    k_sem_give(&sem_dfu_full);
+}
+
+/// Persist the checkpoint so that it survives an MCU reset, the checkpoint is
+/// kept in RAM otherwise, which allows resuming after a link loss only
+static void
+dfu_checkpoint_save(void)
+{
+#ifdef CONFIG_ORB_LIB_DFU_RESUME
+    struct dfu_checkpoint_t *checkpoint = &dfu_state.checkpoint;
+    checkpoint->crc16 =
+        orb_crc16_ccitt(0xffff, (const uint8_t *)checkpoint,
+                        offsetof(struct dfu_checkpoint_t, crc16));
+
+    int err_code =
+        backup_regs_write(CONFIG_ORB_LIB_DFU_RESUME_BACKUP_REGS_OFFSET,
+                          checkpoint, sizeof(*checkpoint));
+    if (err_code) {
+        // transfer can still be resumed if the link is lost
+        LOG_WRN("Unable to save DFU checkpoint: %d", err_code);
+    }
+#endif
+}
+
+static void
+dfu_checkpoint_clear(void)
+{
+    memset(&dfu_state.checkpoint, 0, sizeof(dfu_state.checkpoint));
+    dfu_checkpoint_save();
+}
+
+/// Load the checkpoint saved before the MCU reset, if any
+static void
+dfu_checkpoint_load(void)
+{
+#ifdef CONFIG_ORB_LIB_DFU_RESUME
+    struct dfu_checkpoint_t *checkpoint = &dfu_state.checkpoint;
+    int err_code =
+        backup_regs_read(CONFIG_ORB_LIB_DFU_RESUME_BACKUP_REGS_OFFSET,
+                         checkpoint, sizeof(*checkpoint));
+    if (err_code ||
+        checkpoint->crc16 !=
+            orb_crc16_ccitt(0xffff, (const uint8_t *)checkpoint,
+                            offsetof(struct dfu_checkpoint_t, crc16))) {
+        // backup registers lost (power cycle) or never written
+        memset(checkpoint, 0, sizeof(*checkpoint));
+        return;
+    }
+
+    if (checkpoint->block_count != 0) {
+        LOG_INF("DFU checkpoint: image 0x%08x, %u bytes written",
+                checkpoint->image_id, checkpoint->offset);
+    }
+#endif
+}
+
+/// Check whether block 0 belongs to the image being written and whether some
+/// of its blocks have already been written
+static bool
+dfu_checkpoint_matches(uint32_t block_count, const uint8_t *data, size_t size)
+{
+    const struct dfu_checkpoint_t *checkpoint = &dfu_state.checkpoint;
+    return checkpoint->block_count == block_count &&
+           checkpoint->block_size == size && checkpoint->offset >= size &&
+           checkpoint->image_id == orb_crc32_ieee(data, size);
+}
+
+int
+dfu_resume_point_get(uint32_t *image_id, uint32_t *block_number,
+                     uint32_t *block_count)
+{
+    const struct dfu_checkpoint_t checkpoint = dfu_state.checkpoint;
+    if (checkpoint.block_count == 0 ||
+        checkpoint.offset < checkpoint.block_size) {
+        return RET_ERROR_NOT_FOUND;
+    }
+
+    if (image_id != NULL) {
+        *image_id = checkpoint.image_id;
+    }
+    if (block_number != NULL) {
+        *block_number = checkpoint.offset / checkpoint.block_size;
+    }
+    if (block_count != NULL) {
+        *block_count = checkpoint.block_count;
+    }
+
+    return RET_SUCCESS;
+}
 
 int
 dfu_load(uint32_t current_block_number, uint32_t block_count,
          const uint8_t *data, size_t size, void *ctx,
          void (*process_cb)(void *ctx, int err))
 {
+    // after block 0, the remote can jump to the resume point
+    const bool resume_jump =
+        (current_block_number != 0 &&
+         current_block_number == dfu_state.resume_block &&
+         current_block_number > dfu_state.block_number + 1);
+
     // check params first
     if ((current_block_number != 0 &&
-         current_block_number != dfu_state.block_number + 1) ||
-        (current_block_number > block_count) || size > DFU_BLOCK_SIZE_MAX ||
-        size > sizeof(dfu_state.bytes) ||
-        (dfu_state.block_count == 0 && current_block_number != 0)) {
+         current_block_number != dfu_state.block_number + 1 && !resume_jump) ||
+        (current_block_number >= block_count) || size > DFU_BLOCK_SIZE_MAX ||
+        (dfu_state.block_count == 0 && current_block_number != 0) ||
+        (current_block_number != 0 && block_count != dfu_state.block_count)) {
         return RET_ERROR_INVALID_PARAM;
     }
 
-    // if last block has been processed (consumed)
-    // semaphore must be free
-    if (k_sem_take(&sem_dfu_free_space, K_NO_WAIT) != 0) {
-        LOG_ERR("Semaphore already taken");
+    if (current_block_number == 0) {
+        // blocks from a previous image must be processed before starting
+        // over
+        if (k_sem_count_get(&sem_dfu_free_space) != DFU_WINDOW_SIZE) {
+            return RET_ERROR_BUSY;
+        }
+
+        // check image size to see if it fits
+        const size_t slot_size = DT_REG_SIZE(DT_ALIAS(secondary_slot));
+        if (block_count > slot_size / DFU_BLOCK_SIZE_MAX) {
+            LOG_ERR("Not enough size in Flash: %u blocks, slot size %u",
+                    block_count, slot_size);
+            // a new image needs to be sent again from scratch
+            dfu_state.block_count = 0;
+            return RET_ERROR_INVALID_PARAM;
+        }
+    } else if (dfu_state.err_code != RET_SUCCESS) {
+        // an error occurred while writing a previous block
+        return RET_ERROR_INVALID_STATE;
+    }
+
+    struct dfu_slot_t *slot = dfu_slot_get();
+    if (slot == NULL) {
+        LOG_DBG("DFU window full");
         return RET_ERROR_BUSY;
     }
 
-    // ready to update the image block
+    slot->resume = false;
     if (current_block_number == 0) {
-        LOG_INF("New firmware image");
+        // queue is empty, checkpoint can safely be read
+        slot->resume = dfu_checkpoint_matches(block_count, data, size);
+        dfu_state.resume_block = 0;
+        if (slot->resume) {
+            dfu_state.resume_block =
+                MIN(dfu_state.checkpoint.offset / size, block_count - 1);
+            LOG_INF("Resuming firmware image from block #%u",
+                    dfu_state.resume_block);
+        } else {
+            LOG_INF("New firmware image");
+        }
         dfu_state.block_count = block_count;
-        dfu_state.flash_offset = 0;
-        dfu_state.wr_idx = 0;
-        dfu_state.expected_crc32 = 0;
+        dfu_state.block_size = size;
+        dfu_state.block_offset = 0;
         dfu_state.state = DFU_IN_PROGRESS;
+        dfu_state.err_code = RET_SUCCESS;
 
-        // create processing task now if it doesn't exist
-        // priority set by Kconfig: CONFIG_ORB_LIB_DFU_THREAD_PRIORITY
-        if (tid_dfu == NULL) {
-            tid_dfu = k_thread_create(
-                &dfu_thread_data, dfu_thread_stack,
-                K_THREAD_STACK_SIZEOF(dfu_thread_stack),
-                (k_thread_entry_t)process_dfu_blocks_thread, NULL, NULL, NULL,
-                CONFIG_ORB_LIB_THREAD_PRIORITY_DFU, 0, K_NO_WAIT);
-            k_thread_name_set(tid_dfu, "dfu");
-        }
+        dfu_thread_create();
+    } else if (resume_jump) {
+        dfu_state.block_offset = current_block_number * dfu_state.block_size;
     }
 
     dfu_state.block_number = current_block_number;
 
-    // copy new block for processing while making sure we don't overflow the
-    // buffer
-    if (dfu_state.wr_idx + size > sizeof(dfu_state.bytes)) {
-        k_sem_give(&sem_dfu_free_space);
+    slot->type = DFU_SLOT_BLOCK;
+    slot->block_number = current_block_number;
+    slot->block_count = block_count;
+    slot->last_block = (current_block_number == (block_count - 1));
+    slot->ctx = ctx;
+    slot->dfu_cb = process_cb;
+    slot->size = size;
+    slot->offset = dfu_state.block_offset;
+    memcpy(slot->bytes, data, size);
+    dfu_state.block_offset += size;
+
+    if (slot->last_block) {
+        dfu_state.state = DFU_FINISHED_VERIFY;
+    }
+
+    LOG_DBG("Queuing DFU data #%u", current_block_number);
+    dfu_slot_queue();
+
+    return -EINPROGRESS;
+}
+
+/// Erase sectors until `offset`
+static int
+dfu_erase_until(const struct flash_area *flash_area_p, size_t offset)
+{
+    while (dfu_state.erased_offset < offset) {
+        LOG_INF("Erasing Flash, offset 0x%08x", dfu_state.erased_offset);
+
+        int err_code =
+            flash_area_erase(flash_area_p, (off_t)dfu_state.erased_offset,
+                             DFU_FLASH_SECTOR_SIZE);
+        if (err_code != 0) {
+            LOG_ERR("Unable to erase sector @0x%x, err %i",
+                    dfu_state.erased_offset, err_code);
+            return RET_ERROR_INTERNAL;
+        }
+
+        dfu_state.erased_offset += DFU_FLASH_SECTOR_SIZE;
+    }
+
+    return RET_SUCCESS;
+}
+
+/// Erase the sector following the write pointer, if not already done
+/// Called when no block is waiting to be processed so that sector erasing
+/// doesn't delay the next writes.
+/// @retval true a sector has been erased
+/// @retval false nothing to be done
+static bool
+dfu_erase_ahead(void)
+{
+    if (dfu_state.err_code != RET_SUCCESS ||
+        dfu_state.erased_offset >= dfu_state.image_end ||
+        dfu_state.erased_offset >=
+            dfu_state.flash_offset + DFU_FLASH_SECTOR_SIZE) {
+        return false;
+    }
+
+    const struct flash_area *flash_area_p = NULL;
+    int err_code = flash_area_open(
+        DT_FIXED_PARTITION_ID(DT_ALIAS(secondary_slot)), &flash_area_p);
+    if (err_code == 0) {
+        err_code = dfu_erase_until(flash_area_p, dfu_state.erased_offset + 1);
+        flash_area_close(flash_area_p);
+    }
+    if (err_code) {
+        // don't retry, the sector will be erased again before being written
+        LOG_WRN("Unable to erase ahead: %d", err_code);
+        return false;
+    }
+
+    return true;
+}
+
+/// Read back `len` bytes written at `offset` and compare them against `src`.
+/// The image CRC32 is updated with the first `crc_len` bytes read back, so
+/// that the final image check doesn't need another pass over the slot.
+static int
+dfu_readback_verify(const struct flash_area *flash_area_p, size_t offset,
+                    const uint8_t *src, size_t len, size_t crc_len)
+{
+    uint8_t buf[DFU_BLOCKS_WRITE_SIZE];
+
+    for (size_t off = 0; off < len; off += sizeof(buf)) {
+        size_t chunk = MIN(sizeof(buf), len - off);
+        int err_code =
+            flash_area_read(flash_area_p, (off_t)(offset + off), buf, chunk);
+        if (err_code) {
+            LOG_ERR("Unable to read back Flash, err %i", err_code);
+            return RET_ERROR_INTERNAL;
+        }
+
+        if (memcmp(buf, &src[off], chunk) != 0) {
+            LOG_ERR("Read-back mismatch @0x%x", offset + off);
+            return RET_ERROR_INTERNAL;
+        }
 
-        return RET_ERROR_NO_MEM;
+        if (off < crc_len) {
+            dfu_state.image_crc32 = orb_crc32_ieee_update(
+                dfu_state.image_crc32, buf, MIN(chunk, crc_len - off));
+        }
     }
-    memcpy(&dfu_state.bytes[dfu_state.wr_idx], data, size);
-    dfu_state.wr_idx += size;
 
-    dfu_state.ctx = ctx;
-    dfu_state.dfu_cb = process_cb;
+    return RET_SUCCESS;
+}
 
-    // write if enough bytes ready: DFU_BLOCKS_WRITE_SIZE
-    // or last block
-    if (dfu_state.wr_idx >= DFU_BLOCKS_WRITE_SIZE ||
-        dfu_state.block_number == (dfu_state.block_count - 1)) {
-        LOG_DBG("Queuing DFU data #%u", current_block_number);
+/// Write staged bytes: as many DFU_BLOCKS_WRITE_SIZE chunks as possible, or
+/// the entire buffer, padded to a double-word, if `last_block`
+/// Written bytes are verified and accounted in the image CRC32.
+static int
+dfu_write_staged(const struct flash_area *flash_area_p, bool last_block)
+{
+    // check how many bytes to write
+    // last block might be more or less than DFU_BLOCKS_WRITE_SIZE
+    size_t bytes_to_write =
+        dfu_state.wr_idx - (dfu_state.wr_idx % DFU_BLOCKS_WRITE_SIZE);
+    // image bytes, without padding
+    const size_t image_bytes = last_block ? dfu_state.wr_idx : bytes_to_write;
+    if (last_block) {
+        bytes_to_write = dfu_state.wr_idx;
+
+        // if byte count to write is not multiple of double-word
+        // fill remaining bytes with 0xff
+        if (dfu_state.wr_idx % 8) {
+            memset(&dfu_state.bytes[dfu_state.wr_idx], 0xff,
+                   8 - (dfu_state.wr_idx % 8));
+            bytes_to_write += (8 - dfu_state.wr_idx % 8);
+        }
+    }
+
+    if (bytes_to_write == 0) {
+        return RET_SUCCESS;
+    }
+
+    // sectors are usually erased ahead, this is a no-op in that case
+    int err_code =
+        dfu_erase_until(flash_area_p, dfu_state.flash_offset + bytes_to_write);
+    if (err_code) {
+        return err_code;
+    }
 
-        // wake up processing task
-        k_sem_give(&sem_dfu_full);
+    err_code = flash_area_write(flash_area_p, (off_t)dfu_state.flash_offset,
+                                dfu_state.bytes, bytes_to_write);
+    if (err_code) {
+        LOG_ERR("Unable to write into Flash, err %i", err_code);
+        return RET_ERROR_INTERNAL;
+    }
+
+    err_code = dfu_readback_verify(flash_area_p, dfu_state.flash_offset,
+                                   dfu_state.bytes, bytes_to_write,
+                                   image_bytes);
+    if (err_code) {
+        return err_code;
+    }
+    dfu_state.image_size += image_bytes;
 
-        return -EINPROGRESS;
+    if (dfu_state.wr_idx >= bytes_to_write) {
+        // copy remaining bytes at the beginning of the buffer
+        memmove(dfu_state.bytes, &dfu_state.bytes[bytes_to_write],
+                dfu_state.wr_idx - bytes_to_write);
+        dfu_state.wr_idx = dfu_state.wr_idx - bytes_to_write;
     } else {
-        // we still have room for at least another DFU block
-        // give back semaphore as it won't be processed by consumer
-        k_sem_give(&sem_dfu_free_space);
+        dfu_state.wr_idx = 0;
+    }
+
+    dfu_state.flash_offset += bytes_to_write;
+
+    if (last_block) {
+        // image complete, nothing left to resume
+        dfu_checkpoint_clear();
+    } else if (!dfu_state.compressed && !dfu_state.delta) {
+        // compressed images and patches can't be resumed: the decoding
+        // context isn't part of the checkpoint
+        dfu_state.checkpoint.offset = dfu_state.image_size;
+        dfu_state.checkpoint.image_crc32 = dfu_state.image_crc32;
+        dfu_checkpoint_save();
     }
 
     return RET_SUCCESS;
 }
 
-_Noreturn static void
-process_dfu_blocks_thread()
+/// Restore the write pointer and image CRC32 from the checkpoint.
+/// A write might have happened after the checkpoint was saved, so the rest of
+/// the sector must still be erased to use it.
+static int
+dfu_resume(const struct flash_area *flash_area_p)
 {
-    const struct flash_area *flash_area_p = NULL;
-    int err_code = RET_SUCCESS;
+    const struct dfu_checkpoint_t *checkpoint = &dfu_state.checkpoint;
+    const size_t sector_end =
+        MIN(ROUND_UP(checkpoint->offset, DFU_FLASH_SECTOR_SIZE),
+            flash_area_get_size(flash_area_p));
+    uint8_t buf[DFU_BLOCKS_WRITE_SIZE];
+
+    for (size_t off = checkpoint->offset; off < sector_end;
+         off += sizeof(buf)) {
+        size_t chunk = MIN(sizeof(buf), sector_end - off);
+        int err_code = flash_area_read(flash_area_p, (off_t)off, buf, chunk);
+        if (err_code) {
+            LOG_ERR("Unable to read Flash, err %i", err_code);
+            return RET_ERROR_INTERNAL;
+        }
+
+        for (size_t i = 0; i < chunk; ++i) {
+            if (buf[i] != 0xff) {
+                LOG_WRN("Cannot resume, Flash written @0x%x", off + i);
+                return RET_ERROR_INVALID_STATE;
+            }
+        }
+    }
+
+    dfu_state.flash_offset = checkpoint->offset;
+    dfu_state.erased_offset = sector_end;
+    dfu_state.image_size = checkpoint->offset;
+    dfu_state.image_crc32 = checkpoint->image_crc32;
+
+    LOG_INF("Firmware image resumed, %u bytes already written",
+            checkpoint->offset);
+
+    return RET_SUCCESS;
+}
+
+/// Copy the block into the staging buffer, skipping bytes already written
+/// when resuming the transfer
+static int
+dfu_stage_block(const struct dfu_slot_t *slot)
+{
+    const size_t next_offset = dfu_state.image_size + dfu_state.wr_idx;
+    if (slot->offset > next_offset) {
+        LOG_ERR("Missing image bytes: block #%u @%u, expected @%u",
+                slot->block_number, slot->offset, next_offset);
+        return RET_ERROR_INVALID_STATE;
+    }
+    const size_t skip = MIN(next_offset - slot->offset, slot->size);
+
+    // staging buffer always has room for one more block, see
+    // DFU_BLOCKS_BUFFER_MIN_SIZE
+    memcpy(&dfu_state.bytes[dfu_state.wr_idx], &slot->bytes[skip],
+           slot->size - skip);
+    dfu_state.wr_idx += slot->size - skip;
+
+    return RET_SUCCESS;
+}
+
+#ifdef CONFIG_ORB_LIB_DFU_DELTA
+static int
+dfu_patch_source_read(void *context, size_t offset, uint8_t *data,
+                      size_t size)
+{
+    const struct flash_area *flash_area_p = context;
+    if (flash_area_p == NULL) {
+        return RET_ERROR_INVALID_STATE;
+    }
+
+    int err_code = flash_area_read(flash_area_p, (off_t)offset, data, size);
+    if (err_code) {
+        LOG_ERR("Unable to read primary slot @0x%x, err %i", offset,
+                err_code);
+        return RET_ERROR_INTERNAL;
+    }
+
+    return RET_SUCCESS;
+}
+
+/// Patch header parsed: make sure the patch applies to the image in the
+/// primary slot, and that the target image fits into the secondary slot
+static int
+dfu_patch_source_check(const struct flash_area *flash_area_p)
+{
+    const struct flash_area *primary_p = dfu_delta.context;
+    uint8_t buf[DFU_BLOCKS_WRITE_SIZE];
+    uint32_t crc32 = 0;
+
+    if (primary_p == NULL ||
+        dfu_delta.source_size > flash_area_get_size(primary_p) ||
+        dfu_delta.target_size > flash_area_get_size(flash_area_p) ||
+        dfu_delta.target_size == 0) {
+        LOG_ERR("Invalid patch: source %u bytes, target %u bytes",
+                dfu_delta.source_size, dfu_delta.target_size);
+        return RET_ERROR_INVALID_PARAM;
+    }
+
+    for (size_t off = 0; off < dfu_delta.source_size; off += sizeof(buf)) {
+        size_t chunk = MIN(sizeof(buf), dfu_delta.source_size - off);
+        int err_code = dfu_patch_source_read(dfu_delta.context, off, buf,
+                                             chunk);
+        if (err_code) {
+            return err_code;
+        }
+        crc32 = orb_crc32_ieee_update(crc32, buf, chunk);
+    }
+
+    if (crc32 != dfu_delta.source_crc32) {
+        LOG_ERR("Patch doesn't apply to the primary slot: CRC32 0x%08x, "
+                "expected 0x%08x",
+                crc32, dfu_delta.source_crc32);
+        return RET_ERROR_INVALID_STATE;
+    }
+
+    dfu_state.image_end =
+        ROUND_UP(dfu_delta.target_size, DFU_FLASH_SECTOR_SIZE);
+
+    return RET_SUCCESS;
+}
+#endif
+
+/// Release the primary slot read by the patch, once the patched image is
+/// entirely written or on error
+static void
+dfu_patch_end(void)
+{
+#ifdef CONFIG_ORB_LIB_DFU_DELTA
+    if (dfu_delta.context != NULL) {
+        flash_area_close(dfu_delta.context);
+        dfu_delta.context = NULL;
+    }
+#endif
+}
+
+/// Check whether the decoded stream starting with `data` is a patch and, if
+/// so, prepare its application against the primary slot
+static bool
+dfu_patch_start(const uint8_t *data, size_t size)
+{
+#ifdef CONFIG_ORB_LIB_DFU_DELTA
+    // previous patch interrupted before its last block
+    dfu_patch_end();
+
+    if (dfu_delta_is_patch(data, size)) {
+        const struct flash_area *flash_area_p = NULL;
+        int err_code = flash_area_open(
+            DT_FIXED_PARTITION_ID(DT_NODELABEL(slot0_partition)),
+            &flash_area_p);
+        ASSERT_SOFT(err_code);
+
+        LOG_INF("Firmware image patch");
+        // an error to open the primary slot is reported when reading
+        dfu_delta_init(&dfu_delta, dfu_patch_source_read,
+                       (void *)flash_area_p);
+        return true;
+    }
+#else
+    UNUSED_PARAMETER(data);
+    UNUSED_PARAMETER(size);
+#endif
+
+    return false;
+}
+
+/// Reconstruct the image from patch bytes into the staging buffer, writing
+/// each DFU_BLOCKS_WRITE_SIZE chunk as soon as it is complete
+static int
+dfu_patch_apply(const struct flash_area *flash_area_p, const uint8_t *in,
+                size_t in_len)
+{
+#ifndef CONFIG_ORB_LIB_DFU_DELTA
+    UNUSED_PARAMETER(flash_area_p);
+    UNUSED_PARAMETER(in);
+    UNUSED_PARAMETER(in_len);
+    return RET_ERROR_NOT_SUPPORTED;
+#else
+    int err_code;
 
     while (true) {
-        // setting thread as blocked while waiting for new block or event to
-        // be received
-        k_sem_take(&sem_dfu_full, K_FOREVER);
-
-        switch (dfu_state.state) {
-        case DFU_IN_PROGRESS: {
-            do {
-                err_code = flash_area_open(
-                    DT_FIXED_PARTITION_ID(DT_ALIAS(secondary_slot)),
-                    &flash_area_p);
-                if (err_code) {
-                    LOG_ERR("Err flash_area_open %i", err_code);
-                    err_code = RET_ERROR_INVALID_STATE;
-                    break;
-                }
+        size_t out_len = 0;
+        err_code = dfu_delta_apply(
+            &dfu_delta, &in, &in_len, &dfu_state.bytes[dfu_state.wr_idx],
+            DFU_BLOCKS_WRITE_SIZE - dfu_state.wr_idx, &out_len);
+        if (err_code) {
+            LOG_ERR("Invalid patch @%u: %d", dfu_delta.out_count, err_code);
+            return err_code;
+        }
+        dfu_state.wr_idx += out_len;
 
-                // if new image, check that area is large enough
-                if (dfu_state.flash_offset == 0) {
-                    uint32_t image_slot_size =
-                        flash_area_get_size(flash_area_p);
-
-                    // check image size to see if it fits
-                    if (dfu_state.block_count * DFU_BLOCK_SIZE_MAX >
-                        image_slot_size) {
-                        LOG_ERR("Not enough size in Flash %u > %u",
-                                dfu_state.block_count * DFU_BLOCK_SIZE_MAX,
-                                image_slot_size);
-                        // reset internal state, a new image needs to be sent
-                        // again from scratch
-                        memset(&dfu_state, 0, sizeof(dfu_state));
-                        err_code = RET_ERROR_INVALID_PARAM;
-                        break;
-                    }
-                }
+        if (dfu_state.image_end == 0 && dfu_delta_header_parsed(&dfu_delta)) {
+            err_code = dfu_patch_source_check(flash_area_p);
+            if (err_code) {
+                return err_code;
+            }
+        }
 
-                // check how many bytes to write
-                // last block might be more or less than DFU_BLOCKS_WRITE_SIZE
-                size_t bytes_to_write = DFU_BLOCKS_WRITE_SIZE;
-                if (dfu_state.block_number == dfu_state.block_count - 1) {
-                    bytes_to_write = dfu_state.wr_idx;
-
-                    // if byte count to write is not multiple of double-word
-                    // fill remaining bytes with 0xff
-                    if (dfu_state.wr_idx % 8) {
-                        memset(&dfu_state.bytes[dfu_state.wr_idx], 0xff,
-                               8 - (dfu_state.wr_idx % 8));
-                        bytes_to_write += (8 - dfu_state.wr_idx % 8);
-                    }
-                    dfu_state.state = DFU_FINISHED_VERIFY;
-                }
+        if (dfu_state.wr_idx == DFU_BLOCKS_WRITE_SIZE) {
+            err_code = dfu_write_staged(flash_area_p, false);
+            if (err_code) {
+                return err_code;
+            }
+        } else if (in_len == 0) {
+            // input fully applied
+            break;
+        }
+    }
 
-                // check whether on a sector boundary or
-                // bytes to write will use the next sector
-                if (dfu_state.flash_offset % DFU_FLASH_SECTOR_SIZE == 0 ||
-                    ((bytes_to_write > DFU_BLOCKS_WRITE_SIZE) &&
-                     (dfu_state.flash_offset % DFU_FLASH_SECTOR_SIZE +
-                          bytes_to_write >
-                      DFU_FLASH_SECTOR_SIZE))) {
-
-                    size_t offset = dfu_state.flash_offset;
-                    // erase next sector if not on sector boundary
-                    if (dfu_state.flash_offset % DFU_FLASH_SECTOR_SIZE) {
-                        offset = NEXT_SECTOR_BOUNDARY(offset);
-                    }
-                    // erase secondary slot
-                    LOG_INF("Erasing Flash, offset 0x%08x", offset);
-
-                    err_code = flash_area_erase(flash_area_p, (off_t)offset,
-                                                DFU_FLASH_SECTOR_SIZE);
-                    if (err_code != 0) {
-                        LOG_ERR("Unable to erase sector @0x%x, err %i", offset,
-                                err_code);
-                        err_code = RET_ERROR_INTERNAL;
-                        break;
-                    }
-                }
+    return RET_SUCCESS;
+#endif
+}
 
-                // ready to write block
-                LOG_INF("Writing firmware image %d%%",
-                        (dfu_state.block_number + 1) * 100 /
-                            dfu_state.block_count);
-                err_code =
-                    flash_area_write(flash_area_p, dfu_state.flash_offset,
-                                     dfu_state.bytes, bytes_to_write);
-                if (err_code) {
-                    LOG_ERR("Unable to write into Flash, err %i", err_code);
-                    err_code = RET_ERROR_INTERNAL;
-                    break;
-                }
+#ifdef CONFIG_ORB_LIB_DFU_LZ
+/// Stage decompressed bytes: either image bytes or patch bytes to be applied
+static int
+dfu_stage_decoded(const struct flash_area *flash_area_p, const uint8_t *data,
+                  size_t len)
+{
+    if (dfu_state.delta) {
+        return dfu_patch_apply(flash_area_p, data, len);
+    }
+
+    while (len) {
+        const size_t chunk = MIN(len, DFU_BLOCKS_WRITE_SIZE - dfu_state.wr_idx);
+        memcpy(&dfu_state.bytes[dfu_state.wr_idx], data, chunk);
+        dfu_state.wr_idx += chunk;
+        data += chunk;
+        len -= chunk;
+
+        if (dfu_state.wr_idx == DFU_BLOCKS_WRITE_SIZE) {
+            int err_code = dfu_write_staged(flash_area_p, false);
+            if (err_code) {
+                return err_code;
+            }
+        }
+    }
+
+    return RET_SUCCESS;
+}
+#endif
+
+/// Check whether the image is compressed, from its first block, and prepare
+/// its decompression
+static bool
+dfu_decompress_start(const struct dfu_slot_t *slot)
+{
+#ifdef CONFIG_ORB_LIB_DFU_LZ
+    if (dfu_lz_is_compressed(slot->bytes, slot->size)) {
+        LOG_INF("Compressed firmware image");
+        dfu_lz_init(&dfu_lz);
+        return true;
+    }
+#else
+    UNUSED_PARAMETER(slot);
+#endif
+
+    return false;
+}
+
+/// Decompress the block and stage the decompressed bytes, which can be a
+/// patch
+static int
+dfu_decompress_block(const struct flash_area *flash_area_p,
+                     const struct dfu_slot_t *slot)
+{
+#ifndef CONFIG_ORB_LIB_DFU_LZ
+    UNUSED_PARAMETER(flash_area_p);
+    UNUSED_PARAMETER(slot);
+    return RET_ERROR_NOT_SUPPORTED;
+#else
+    const uint8_t *in = slot->bytes;
+    size_t in_len = slot->size;
+    uint8_t chunk[DFU_BLOCKS_WRITE_SIZE];
+    size_t out_len;
+    int err_code;
+
+    do {
+        out_len = 0;
+        err_code = dfu_lz_decompress(&dfu_lz, &in, &in_len, chunk,
+                                     sizeof(chunk), &out_len);
+        if (err_code) {
+            LOG_ERR("Invalid compressed image, block #%u: %d",
+                    slot->block_number, err_code);
+            return err_code;
+        }
 
-                if (dfu_state.wr_idx >= bytes_to_write) {
-                    // copy remaining bytes at the beginning of the buffer
-                    memcpy(dfu_state.bytes, &dfu_state.bytes[bytes_to_write],
-                           dfu_state.wr_idx - bytes_to_write);
-                    dfu_state.wr_idx = dfu_state.wr_idx - bytes_to_write;
-                } else {
-                    dfu_state.wr_idx = 0;
+        if (out_len != 0 && dfu_lz.out_count == out_len) {
+            // first decompressed bytes
+            dfu_state.delta = dfu_patch_start(chunk, out_len);
+            if (!dfu_state.delta) {
+                // sectors to be erased depend on the decompressed size
+                if (dfu_lz.raw_size > flash_area_get_size(flash_area_p)) {
+                    LOG_ERR("Decompressed image too large: %u bytes",
+                            dfu_lz.raw_size);
+                    return RET_ERROR_INVALID_PARAM;
                 }
+                dfu_state.image_end =
+                    ROUND_UP(dfu_lz.raw_size, DFU_FLASH_SECTOR_SIZE);
+            }
+        }
+
+        err_code = dfu_stage_decoded(flash_area_p, chunk, out_len);
+        if (err_code) {
+            return err_code;
+        }
+    } while (out_len == sizeof(chunk));
+
+    if (slot->last_block && !dfu_lz_done(&dfu_lz)) {
+        LOG_ERR("Compressed image truncated, %u/%u bytes", dfu_lz.out_count,
+                dfu_lz.raw_size);
+        return RET_ERROR_INVALID_STATE;
+    }
+
+    return RET_SUCCESS;
+#endif
+}
+
+static int
+dfu_process_block(const struct dfu_slot_t *slot)
+{
+    const uint32_t block_count = slot->block_count;
+    const struct flash_area *flash_area_p = NULL;
+    int err_code = flash_area_open(
+        DT_FIXED_PARTITION_ID(DT_ALIAS(secondary_slot)), &flash_area_p);
+    if (err_code) {
+        LOG_ERR("Err flash_area_open %i", err_code);
+        return RET_ERROR_INVALID_STATE;
+    }
+
+    if (slot->block_number == 0) {
+        dfu_state.flash_offset = 0;
+        dfu_state.erased_offset = 0;
+        dfu_state.wr_idx = 0;
+        dfu_state.image_size = 0;
+        dfu_state.image_crc32 = 0;
+        dfu_state.image_crc32_valid = false;
+        dfu_state.image_end =
+            MIN(ROUND_UP(block_count * DFU_BLOCK_SIZE_MAX,
+                         DFU_FLASH_SECTOR_SIZE),
+                flash_area_get_size(flash_area_p));
+
+        dfu_state.compressed = dfu_decompress_start(slot);
+        dfu_state.delta = !dfu_state.compressed &&
+                          dfu_patch_start(slot->bytes, slot->size);
+        if (dfu_state.compressed || dfu_state.delta) {
+            // known once the header is decoded
+            dfu_state.image_end = 0;
+            dfu_checkpoint_clear();
+        } else if (!slot->resume ||
+                   dfu_resume(flash_area_p) != RET_SUCCESS) {
+            // if the transfer cannot be resumed, the image is written from
+            // scratch: blocks sent in sequence are processed as usual,
+            // while a jump to the resume point is rejected below.
+            // Identify the new image before anything gets erased.
+            dfu_state.checkpoint.image_id =
+                orb_crc32_ieee(slot->bytes, slot->size);
+            dfu_state.checkpoint.block_count = block_count;
+            dfu_state.checkpoint.block_size = slot->size;
+            dfu_state.checkpoint.offset = 0;
+            dfu_state.checkpoint.image_crc32 = 0;
+            dfu_checkpoint_save();
+        }
+    }
+
+    if (dfu_state.compressed) {
+        err_code = dfu_decompress_block(flash_area_p, slot);
+    } else if (dfu_state.delta) {
+        err_code = dfu_patch_apply(flash_area_p, slot->bytes, slot->size);
+    } else {
+        err_code = dfu_stage_block(slot);
+    }
+
+#ifdef CONFIG_ORB_LIB_DFU_DELTA
+    if (err_code == RET_SUCCESS && slot->last_block && dfu_state.delta &&
+        !dfu_delta_done(&dfu_delta)) {
+        LOG_ERR("Patch truncated, %u/%u bytes", dfu_delta.out_count,
+                dfu_delta.target_size);
+        err_code = RET_ERROR_INVALID_STATE;
+    }
+#endif
+
+    if (err_code == RET_SUCCESS) {
+        err_code = dfu_write_staged(flash_area_p, slot->last_block);
+    }
+
+    if (dfu_state.delta && (err_code != RET_SUCCESS || slot->last_block)) {
+        // following blocks are rejected until the image is sent again
+        dfu_patch_end();
+    }
+
+    if (err_code == RET_SUCCESS && slot->last_block) {
+        // whole image written and verified
+        dfu_state.image_crc32_valid = true;
+        LOG_INF("Firmware image written, %u bytes, CRC32 0x%08x",
+                dfu_state.image_size, dfu_state.image_crc32);
+    } else if (err_code == RET_SUCCESS &&
+               (slot->block_number % (block_count / 10 + 1)) == 0) {
+        LOG_INF("Writing firmware image %d%%",
+                (slot->block_number + 1) * 100 / block_count);
+    }
+
+    flash_area_close(flash_area_p);
+
+    return err_code;
+}
+
+/// The CRC32 computed while writing covers every received byte, which is
+/// only usable if the received bytes are exactly the image range covered by
+/// the full check (no padding after the TLVs, no truncated image)
+static bool
+dfu_streamed_crc_covers_image(void)
+{
+    const struct flash_area *flash_area_p = NULL;
+    size_t img_size = 0;
 
-                dfu_state.flash_offset += bytes_to_write;
-            } while (0);
+    if (flash_area_open(DT_FIXED_PARTITION_ID(DT_ALIAS(secondary_slot)),
+                        &flash_area_p)) {
+        return false;
+    }
+    int ret = dfu_secondary_image_size(flash_area_p, &img_size);
+    flash_area_close(flash_area_p);
 
-            // close Flash area
-            if (flash_area_p) {
-                flash_area_close(flash_area_p);
+    if (ret == RET_SUCCESS && img_size != dfu_state.image_size) {
+        LOG_WRN("Received %uB for a %uB image, reading back the slot",
+                dfu_state.image_size, img_size);
+        return false;
+    }
+
+    return ret == RET_SUCCESS;
+}
+
+_Noreturn static void
+process_dfu_blocks_thread()
+{
+    int err_code;
+
+    while (true) {
+        if (k_sem_take(&sem_dfu_full, K_NO_WAIT) != 0) {
+            // nothing to process: use idle time to prepare the next sector
+            // ahead of the write pointer
+            if (dfu_erase_ahead()) {
+                continue;
             }
 
-            // dfu_state has been consumed, semaphore can be freed
-            k_sem_give(&sem_dfu_free_space);
+            // setting thread as blocked while waiting for new block or event
+            // to be received
+            k_sem_take(&sem_dfu_full, K_FOREVER);
+        }
 
-            if (dfu_state.dfu_cb != NULL) {
-                dfu_state.dfu_cb(dfu_state.ctx, err_code);
+        struct dfu_slot_t *slot =
+            &dfu_state.slots[dfu_state.slot_rd_idx % DFU_WINDOW_SIZE];
+
+        switch (slot->type) {
+        case DFU_SLOT_BLOCK: {
+            // once an error occurred, all following blocks are rejected
+            // until the image is sent again from block 0
+            err_code = dfu_state.err_code;
+            if (err_code == RET_SUCCESS) {
+                err_code = dfu_process_block(slot);
+                dfu_state.err_code = err_code;
             }
         } break;
-        case DFU_FINISHED_VERIFY: {
-            err_code = dfu_secondary_check(dfu_state.expected_crc32);
-            k_sem_give(&sem_dfu_free_space);
-            if (dfu_state.dfu_cb != NULL) {
-                dfu_state.dfu_cb(dfu_state.ctx, err_code);
+        case DFU_SLOT_CHECK: {
+            err_code = dfu_state.err_code;
+            if (err_code != RET_SUCCESS) {
+                break;
+            }
+
+            if (!slot->full_readback && dfu_state.image_crc32_valid &&
+                dfu_streamed_crc_covers_image()) {
+                // CRC32 computed over read-back bytes while writing
+                LOG_INF("Secondary slot CRC32 (streamed, %uB): computed "
+                        "0x%x, expected 0x%x",
+                        dfu_state.image_size, dfu_state.image_crc32,
+                        slot->crc32);
+                err_code = (dfu_state.image_crc32 == slot->crc32)
+                               ? RET_SUCCESS
+                               : RET_ERROR_INVALID_STATE;
+            } else {
+                err_code = dfu_secondary_check(slot->crc32);
             }
         } break;
+        default:
+            err_code = RET_ERROR_INTERNAL;
+            break;
+        }
+
+        void *ctx = slot->ctx;
+        void (*dfu_cb)(void *ctx, int err) = slot->dfu_cb;
+
+        // slot has been consumed, semaphore can be freed
+        dfu_state.slot_rd_idx++;
+        k_sem_give(&sem_dfu_free_space);
+
+        if (dfu_cb != NULL) {
+            dfu_cb(ctx, err_code);
         }
     }
 }
@@ -303,7 +1011,11 @@ dfu_secondary_activate(bool permanent)
         return RET_ERROR_INTERNAL;
     }
 
-    memset(&dfu_state, 0, sizeof(dfu_state));
+    // a new image must be sent from scratch
+    dfu_state.block_count = 0;
+    dfu_state.resume_block = 0;
+    dfu_state.state = DFU_IN_PROGRESS;
+    dfu_checkpoint_clear();
 
     LOG_INF("The second image will be loaded after reset");
 
@@ -327,43 +1039,44 @@ dfu_secondary_activate_temporarily(void)
 }
 
 int
-dfu_secondary_check_async(uint32_t crc32, void *context,
+dfu_secondary_check_async(uint32_t crc32, bool full_readback, void *context,
                           void (*process_cb)(void *ctx, int err))
 {
-    // ensure block processing is over by taking `sem_dfu_free_space`
-    // also, make sure state is DFU_FINISHED_VERIFY, meaning that the
-    // last block has been processed
-    int ret = k_sem_take(&sem_dfu_free_space, K_MSEC(10));
-    if (ret == 0) {
-        if (dfu_state.state == DFU_FINISHED_VERIFY) {
-            dfu_state.ctx = context;
-            dfu_state.dfu_cb = process_cb;
-            dfu_state.expected_crc32 = crc32;
-            k_sem_give(&sem_dfu_full);
-            ret = -EINPROGRESS;
-        } else {
-            k_sem_give(&sem_dfu_free_space);
-        }
-    } else {
-        ret = RET_ERROR_INVALID_STATE;
+    // make sure state is DFU_FINISHED_VERIFY, meaning that the last block
+    // has been received. The check is queued after the last block so that
+    // all the blocks are written before reading back the slot.
+    if (dfu_state.state != DFU_FINISHED_VERIFY) {
+        return RET_ERROR_INVALID_STATE;
     }
 
-    return ret;
+    struct dfu_slot_t *slot = dfu_slot_get();
+    if (slot == NULL) {
+        return RET_ERROR_BUSY;
+    }
+
+    slot->type = DFU_SLOT_CHECK;
+    slot->crc32 = crc32;
+    slot->full_readback = full_readback;
+    slot->ctx = context;
+    slot->dfu_cb = process_cb;
+    dfu_slot_queue();
+
+    return -EINPROGRESS;
 }
 
-STATIC_OR_EXTERN int
-dfu_secondary_check(uint32_t crc32)
+/// Size of the image in the secondary slot, as covered by the CRC32 checks:
+/// header, image, protected TLV area and TLV area.
+/// Both the CRC32 computed while writing and the one computed by reading back
+/// the slot must cover exactly this range.
+static int
+dfu_secondary_image_size(const struct flash_area *flash_area_p,
+                         size_t *img_size)
 {
-    // buffer needed to read external Flash (diamond) and compute CRC32
-    uint8_t buf[DFU_FLASH_PAGE_SIZE];
-    uint32_t computed_crc = 0;
-    int ret;
-
     // update header before checking
     struct image_version dummy;
     dfu_version_secondary_get(&dummy);
 
-    ret = k_sem_take(&sem_headers, K_NO_WAIT);
+    int ret = k_sem_take(&sem_headers, K_NO_WAIT);
     if (ret) {
         return RET_ERROR_BUSY;
     }
@@ -373,13 +1086,41 @@ dfu_secondary_check(uint32_t crc32)
         return RET_ERROR_INVALID_STATE;
     }
 
-    // find full image size by reading image header
-    // then add TLV size using the offset provided in the image header
-    size_t img_size =
-        secondary_slot_header.ih_hdr_size + secondary_slot_header.ih_img_size;
+    // protected TLVs are located right after the image, their size is
+    // provided in the image header
+    size_t size = secondary_slot_header.ih_hdr_size +
+                  secondary_slot_header.ih_img_size +
+                  secondary_slot_header.ih_protect_tlv_size;
 
     k_sem_give(&sem_headers);
 
+    // then add the size of the (unprotected) TLV area
+    struct image_tlv_info tlv_info = {0};
+    ret = flash_area_read(flash_area_p, (off_t)size, &tlv_info,
+                          sizeof(tlv_info));
+    if (ret == 0 && tlv_info.it_magic == IMAGE_TLV_INFO_MAGIC) {
+        size += tlv_info.it_tlv_tot;
+    }
+
+    if (size > flash_area_p->fa_size) {
+        LOG_ERR("Invalid image size: %uB", size);
+        return RET_ERROR_INVALID_STATE;
+    }
+
+    *img_size = size;
+
+    return RET_SUCCESS;
+}
+
+STATIC_OR_EXTERN int
+dfu_secondary_check(uint32_t crc32)
+{
+    // buffer needed to read external Flash (diamond) and compute CRC32
+    uint8_t buf[DFU_FLASH_PAGE_SIZE];
+    uint32_t computed_crc = 0;
+    size_t img_size = 0;
+    int ret;
+
     const struct flash_area *flash_area_p = NULL;
     ret = flash_area_open(DT_FIXED_PARTITION_ID(DT_ALIAS(secondary_slot)),
                           &flash_area_p);
@@ -388,12 +1129,10 @@ dfu_secondary_check(uint32_t crc32)
         return RET_ERROR_INTERNAL;
     }
 
-    struct image_tlv_info tlv_magic = {0};
-    flash_area_read(flash_area_p, (off_t)img_size, &tlv_magic,
-                    sizeof(tlv_magic));
-    if (tlv_magic.it_magic == IMAGE_TLV_INFO_MAGIC ||
-        tlv_magic.it_magic == IMAGE_TLV_PROT_INFO_MAGIC) {
-        img_size += tlv_magic.it_tlv_tot;
+    ret = dfu_secondary_image_size(flash_area_p, &img_size);
+    if (ret) {
+        flash_area_close(flash_area_p);
+        return ret;
     }
 
     // read entire flash area content to calculate CRC32
@@ -408,7 +1147,7 @@ dfu_secondary_check(uint32_t crc32)
             flash_area_close(flash_area_p);
             return RET_ERROR_INTERNAL;
         }
-        computed_crc = crc32_ieee_update(computed_crc, buf, len);
+        computed_crc = orb_crc32_ieee_update(computed_crc, buf, len);
 
         // every 200ms, allow other lower priority threads to be executed
         // at least to avoid starving the watchdog
@@ -607,6 +1346,7 @@ dfu_readback_protection(void)
             ret = flash_area_erase(flash_area_p, (off_t)0,
                                    DFU_FLASH_SECTOR_SIZE * 2);
             ASSERT_SOFT(ret);
+            dfu_checkpoint_clear();
         }
         if (flash_area_p) {
             flash_area_close(flash_area_p);
@@ -653,6 +1393,8 @@ dfu_init(void)
     // don't care if no image in secondary slot
     (void)dfu_version_secondary_get(&ih_version_dummy);
 
+    dfu_checkpoint_load();
+
     ret = k_sem_take(&sem_headers, K_FOREVER);
     if (ret != 0) {
         return RET_ERROR_INTERNAL;
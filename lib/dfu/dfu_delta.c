@@ -0,0 +1,230 @@
+#include "dfu_delta.h"
+#include <errors.h>
+#include <string.h>
+#include <zephyr/sys/util.h>
+
+// a u32 fits in 5 LEB128 bytes
+#define VARINT_SHIFT_MAX 28
+
+static uint32_t
+read_u32_le(const uint8_t *bytes)
+{
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) |
+           ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+bool
+dfu_delta_is_patch(const uint8_t *data, size_t size)
+{
+    return size >= sizeof(uint32_t) && read_u32_le(data) == DFU_DELTA_MAGIC;
+}
+
+void
+dfu_delta_init(struct dfu_delta_t *delta, dfu_delta_read_t read,
+               void *context)
+{
+    delta->read = read;
+    delta->context = context;
+    delta->state = DFU_DELTA_HEADER;
+    delta->op = 0;
+    delta->source_size = 0;
+    delta->source_crc32 = 0;
+    delta->target_size = 0;
+    delta->out_count = 0;
+    delta->count = 0;
+    delta->varint = 0;
+    delta->shift = 0;
+    delta->source_offset = 0;
+}
+
+static int
+dfu_delta_parse_header(struct dfu_delta_t *delta)
+{
+    const uint8_t *header = delta->header;
+    if (read_u32_le(&header[0]) != DFU_DELTA_MAGIC ||
+        header[4] != DFU_DELTA_VERSION) {
+        return RET_ERROR_INVALID_PARAM;
+    }
+
+    delta->source_size = read_u32_le(&header[8]);
+    delta->source_crc32 = read_u32_le(&header[12]);
+    delta->target_size = read_u32_le(&header[16]);
+    delta->state =
+        (delta->target_size == 0) ? DFU_DELTA_DONE : DFU_DELTA_OP;
+
+    return RET_SUCCESS;
+}
+
+/// Accumulate a varint byte
+/// @retval true varint complete, value in `delta->varint`
+static bool
+dfu_delta_varint(struct dfu_delta_t *delta, uint8_t byte, int *err_code)
+{
+    if (delta->shift > VARINT_SHIFT_MAX) {
+        *err_code = RET_ERROR_INVALID_STATE;
+        return false;
+    }
+    delta->varint |= (uint32_t)(byte & 0x7f) << delta->shift;
+    delta->shift += 7;
+
+    return (byte & 0x80) == 0;
+}
+
+/// Operation length decoded, check it against the target and source sizes
+static int
+dfu_delta_op_start(struct dfu_delta_t *delta)
+{
+    if (delta->count == 0 ||
+        delta->count > delta->target_size - delta->out_count) {
+        return RET_ERROR_INVALID_STATE;
+    }
+    if (delta->op != DFU_DELTA_INSERT &&
+        (delta->source_offset > delta->source_size ||
+         delta->count > delta->source_size - delta->source_offset)) {
+        return RET_ERROR_INVALID_STATE;
+    }
+    delta->state = DFU_DELTA_DATA;
+
+    return RET_SUCCESS;
+}
+
+int
+dfu_delta_apply(struct dfu_delta_t *delta, const uint8_t **in, size_t *in_len,
+                uint8_t *out, size_t out_size, size_t *out_len)
+{
+    int err_code = RET_SUCCESS;
+    size_t produced = 0;
+
+    while (err_code == RET_SUCCESS) {
+        if (delta->state == DFU_DELTA_DATA) {
+            if (delta->count == 0) {
+                delta->state = (delta->out_count == delta->target_size)
+                                   ? DFU_DELTA_DONE
+                                   : DFU_DELTA_OP;
+                continue;
+            }
+            if (produced == out_size) {
+                break;
+            }
+
+            // operation bytes by chunks, as large as possible
+            size_t len = MIN(delta->count, out_size - produced);
+            uint8_t *dst = &out[produced];
+            if (delta->op != DFU_DELTA_COPY) {
+                // need input
+                if (*in_len == 0) {
+                    break;
+                }
+                len = MIN(len, *in_len);
+            }
+
+            if (delta->op == DFU_DELTA_INSERT) {
+                memcpy(dst, *in, len);
+            } else {
+                err_code = delta->read(delta->context, delta->source_offset,
+                                       dst, len);
+                if (err_code) {
+                    break;
+                }
+                delta->source_offset += len;
+            }
+            if (delta->op == DFU_DELTA_ADD) {
+                for (size_t i = 0; i < len; ++i) {
+                    dst[i] += (*in)[i];
+                }
+            }
+            if (delta->op != DFU_DELTA_COPY) {
+                *in += len;
+                *in_len -= len;
+            }
+
+            produced += len;
+            delta->out_count += len;
+            delta->count -= len;
+            continue;
+        }
+
+        if (*in_len == 0) {
+            break;
+        }
+
+        if (delta->state == DFU_DELTA_DONE) {
+            // bytes past the end of the image
+            err_code = RET_ERROR_INVALID_STATE;
+            break;
+        }
+
+        const uint8_t byte = **in;
+        (*in)++;
+        (*in_len)--;
+
+        switch (delta->state) {
+        case DFU_DELTA_HEADER:
+            delta->header[delta->count++] = byte;
+            if (delta->count == DFU_DELTA_HEADER_SIZE) {
+                delta->count = 0;
+                err_code = dfu_delta_parse_header(delta);
+                if (err_code == RET_SUCCESS) {
+                    // let the caller check the source
+                    *out_len = produced;
+                    return RET_SUCCESS;
+                }
+            }
+            break;
+        case DFU_DELTA_OP:
+            if (byte > DFU_DELTA_INSERT) {
+                err_code = RET_ERROR_INVALID_STATE;
+                break;
+            }
+            delta->op = byte;
+            delta->varint = 0;
+            delta->shift = 0;
+            delta->state = DFU_DELTA_LENGTH;
+            break;
+        case DFU_DELTA_LENGTH:
+            if (!dfu_delta_varint(delta, byte, &err_code)) {
+                break;
+            }
+            delta->count = delta->varint;
+            if (delta->op == DFU_DELTA_INSERT) {
+                err_code = dfu_delta_op_start(delta);
+            } else {
+                delta->varint = 0;
+                delta->shift = 0;
+                delta->state = DFU_DELTA_SEEK;
+            }
+            break;
+        case DFU_DELTA_SEEK:
+            if (!dfu_delta_varint(delta, byte, &err_code)) {
+                break;
+            }
+            // zigzag: even values are positive, odd values negative
+            // source offset wraps around when seeking before 0, caught below
+            if (delta->varint & 1) {
+                delta->source_offset -= (delta->varint >> 1) + 1;
+            } else {
+                delta->source_offset += delta->varint >> 1;
+            }
+            err_code = dfu_delta_op_start(delta);
+            break;
+        default:
+            err_code = RET_ERROR_INVALID_STATE;
+            break;
+        }
+    }
+
+    *out_len = produced;
+    return err_code;
+}
+
+bool
+dfu_delta_header_parsed(const struct dfu_delta_t *delta)
+{
+    return delta->state != DFU_DELTA_HEADER;
+}
+
+bool
+dfu_delta_done(const struct dfu_delta_t *delta)
+{
+    return delta->state == DFU_DELTA_DONE;
+}
@@ -0,0 +1,182 @@
+#include "dfu_lz.h"
+#include <errors.h>
+
+static uint32_t
+read_u32_le(const uint8_t *bytes)
+{
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) |
+           ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+bool
+dfu_lz_is_compressed(const uint8_t *data, size_t size)
+{
+    return size >= sizeof(uint32_t) && read_u32_le(data) == DFU_LZ_MAGIC;
+}
+
+void
+dfu_lz_init(struct dfu_lz_t *lz)
+{
+    lz->state = DFU_LZ_HEADER;
+    lz->window_size = 0;
+    lz->raw_size = 0;
+    lz->out_count = 0;
+    lz->count = 0;
+    lz->match_length = 0;
+    lz->match_offset = 0;
+}
+
+static int
+dfu_lz_parse_header(struct dfu_lz_t *lz)
+{
+    const uint8_t *header = lz->header;
+    if (read_u32_le(&header[0]) != DFU_LZ_MAGIC ||
+        header[4] != DFU_LZ_VERSION) {
+        return RET_ERROR_INVALID_PARAM;
+    }
+
+    // matches must not reach past our window
+    if (header[5] > CONFIG_ORB_LIB_DFU_LZ_WINDOW_LOG2) {
+        return RET_ERROR_INVALID_PARAM;
+    }
+
+    lz->window_size = 1UL << header[5];
+    lz->raw_size = read_u32_le(&header[8]);
+    lz->state = (lz->raw_size == 0) ? DFU_LZ_DONE : DFU_LZ_TOKEN;
+
+    return RET_SUCCESS;
+}
+
+/// Value of a 4-bit length, continued with the following bytes when 15
+static enum dfu_lz_state_e
+dfu_lz_length(uint32_t nibble, uint32_t *length, enum dfu_lz_state_e extended,
+              enum dfu_lz_state_e next)
+{
+    *length = nibble;
+    return (nibble == 15) ? extended : next;
+}
+
+int
+dfu_lz_decompress(struct dfu_lz_t *lz, const uint8_t **in, size_t *in_len,
+                  uint8_t *out, size_t out_size, size_t *out_len)
+{
+    const uint32_t window_mask = DFU_LZ_WINDOW_SIZE - 1;
+    int err_code = RET_SUCCESS;
+    size_t produced = 0;
+
+    while (err_code == RET_SUCCESS) {
+        // states producing bytes from the window don't need input
+        if (lz->state == DFU_LZ_MATCH) {
+            if (lz->count == 0) {
+                lz->state = DFU_LZ_TOKEN;
+                continue;
+            }
+            if (produced == out_size) {
+                break;
+            }
+            if (lz->out_count == lz->raw_size) {
+                err_code = RET_ERROR_INVALID_STATE;
+                break;
+            }
+
+            const uint8_t byte =
+                lz->window[(lz->out_count - lz->match_offset) & window_mask];
+            lz->window[lz->out_count & window_mask] = byte;
+            out[produced++] = byte;
+            lz->out_count++;
+            lz->count--;
+            continue;
+        }
+
+        if (lz->state == DFU_LZ_LITERALS) {
+            if (lz->count == 0) {
+                // the last sequence has no match
+                lz->state = (lz->out_count == lz->raw_size)
+                                ? DFU_LZ_DONE
+                                : DFU_LZ_OFFSET_LOW;
+                continue;
+            }
+            if (produced == out_size) {
+                break;
+            }
+        }
+
+        if (*in_len == 0) {
+            break;
+        }
+
+        if (lz->state == DFU_LZ_DONE) {
+            // bytes past the end of the image
+            err_code = RET_ERROR_INVALID_STATE;
+            break;
+        }
+
+        const uint8_t byte = **in;
+        (*in)++;
+        (*in_len)--;
+
+        switch (lz->state) {
+        case DFU_LZ_HEADER:
+            lz->header[lz->count++] = byte;
+            if (lz->count == DFU_LZ_HEADER_SIZE) {
+                lz->count = 0;
+                err_code = dfu_lz_parse_header(lz);
+            }
+            break;
+        case DFU_LZ_TOKEN:
+            lz->state = dfu_lz_length(byte >> 4, &lz->count,
+                                      DFU_LZ_LITERALS_LENGTH, DFU_LZ_LITERALS);
+            lz->match_length = byte & 0x0f;
+            break;
+        case DFU_LZ_LITERALS_LENGTH:
+            lz->count += byte;
+            if (byte != 255) {
+                lz->state = DFU_LZ_LITERALS;
+            }
+            break;
+        case DFU_LZ_LITERALS:
+            if (lz->out_count == lz->raw_size) {
+                err_code = RET_ERROR_INVALID_STATE;
+                break;
+            }
+            lz->window[lz->out_count & window_mask] = byte;
+            out[produced++] = byte;
+            lz->out_count++;
+            lz->count--;
+            break;
+        case DFU_LZ_OFFSET_LOW:
+            lz->match_offset = byte;
+            lz->state = DFU_LZ_OFFSET_HIGH;
+            break;
+        case DFU_LZ_OFFSET_HIGH:
+            lz->match_offset |= (uint32_t)byte << 8;
+            if (lz->match_offset == 0 || lz->match_offset > lz->window_size ||
+                lz->match_offset > lz->out_count) {
+                err_code = RET_ERROR_INVALID_STATE;
+                break;
+            }
+            lz->state = dfu_lz_length(lz->match_length, &lz->count,
+                                      DFU_LZ_MATCH_LENGTH, DFU_LZ_MATCH);
+            lz->count += DFU_LZ_MIN_MATCH;
+            break;
+        case DFU_LZ_MATCH_LENGTH:
+            lz->count += byte;
+            if (byte != 255) {
+                lz->state = DFU_LZ_MATCH;
+            }
+            break;
+        default:
+            err_code = RET_ERROR_INVALID_STATE;
+            break;
+        }
+    }
+
+    *out_len = produced;
+    return err_code;
+}
+
+bool
+dfu_lz_done(const struct dfu_lz_t *lz)
+{
+    return lz->state == DFU_LZ_DONE;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "bootutil/image.h"
+#include "compilers.h"
 #include "utils.h"
 #include <mcu.pb.h>
 #include <stdbool.h>
@@ -42,31 +43,101 @@
 #define DFU_BLOCKS_BUFFER_SIZE                                                 \
     (DFU_BLOCKS_BUFFER_MIN_SIZE + 8 - (DFU_BLOCKS_BUFFER_MIN_SIZE % 8))
 
+// Number of image blocks that can be queued before being written into Flash.
+// The remote can send that many blocks without waiting for the corresponding
+// acks, which are sent once the block has been written (or staged into the
+// blocks buffer, see above). Reception thus overlaps with Flash operations.
+#define DFU_WINDOW_SIZE CONFIG_ORB_LIB_DFU_WINDOW_SIZE
+
+/// Progress of the image being written, retained across MCU resets to resume
+/// the transfer, see CONFIG_ORB_LIB_DFU_RESUME
+struct dfu_checkpoint_t {
+    uint32_t image_id;    // CRC32 of block 0, containing the image header
+    uint32_t block_count; // 0 if no image being written
+    uint32_t offset;      // image bytes written and verified into Flash
+    uint32_t image_crc32; // CRC32 over the first `offset` bytes
+    uint16_t block_size;
+    uint16_t crc16; // over the fields above
+} __PACKED;
+
 enum dfu_state_e {
     DFU_IN_PROGRESS,
     DFU_FINISHED_VERIFY,
 };
 
+enum dfu_slot_type_e {
+    DFU_SLOT_BLOCK,
+    DFU_SLOT_CHECK, // verify secondary slot once preceding blocks are written
+};
+
+/// Image block (or request) queued for the processing thread
+struct dfu_slot_t {
+    enum dfu_slot_type_e type;
+    uint32_t block_number;
+    uint32_t block_count;
+    bool last_block;
+    uint32_t crc32;     // expected CRC32 when `type` is DFU_SLOT_CHECK
+    bool full_readback; // read the entire slot to compute the CRC32
+    bool resume;        // block 0 matches the checkpoint, keep written bytes
+    size_t offset;      // offset of the block into the image
+    void *ctx;          // pointer to the caller context, to be used with the
+                        // `dfu_cb`
+    void (*dfu_cb)(void *ctx, int err);
+    size_t size;
+    uint8_t bytes[DFU_BLOCK_SIZE_MAX];
+};
+
 struct dfu_state_t {
     // make sure `bytes` is the first field to ensure alignment
     uint8_t bytes[DFU_BLOCKS_BUFFER_SIZE];
     uint32_t wr_idx;
+    size_t flash_offset;
+    size_t erased_offset; // sectors below this offset are erased
+    size_t image_end;     // upper bound of the image, sector-aligned
+    // first error during image processing, the image must be sent again from
+    // scratch
+    int err_code;
+    // CRC32 over the image bytes, computed from read-back data while writing
+    uint32_t image_crc32;
+    size_t image_size;
+    bool image_crc32_valid; // entire image written and verified
+    bool compressed;        // image decompressed while written, see dfu_lz.h
+    bool delta;             // image rebuilt from a patch, see dfu_delta.h
+    // progress of the image being written, only modified by the processing
+    // thread, or by the producer when no block is queued
+    struct dfu_checkpoint_t checkpoint;
+
+    // queued blocks, produced by `dfu_load` and consumed by the processing
+    // thread
+    struct dfu_slot_t slots[DFU_WINDOW_SIZE];
+    uint32_t slot_wr_idx;
+    uint32_t slot_rd_idx;
+
+    // last queued block and state, only accessed by the producer
     uint32_t block_number;
     uint32_t block_count;
-    size_t flash_offset;
-    uint32_t expected_crc32;
-    void *ctx; // pointer to the caller context, to be used with the
-               // `dfu_block_process_cb`
-    void (*dfu_cb)(void *ctx, int err);
+    uint32_t block_size;
+    size_t block_offset; // offset of the next block into the image
+    // block the remote can jump to after block 0 when resuming, 0 otherwise
+    uint32_t resume_block;
     enum dfu_state_e state;
 };
 
 /**
  * Queue one firmware image block.
- * An internal buffer is used to queue blocks before writing to flash a larger,
- * memory-aligned chunk.
+ * Up to DFU_WINDOW_SIZE blocks can be queued while previous ones are being
+ * written. An internal buffer is used to stage blocks before writing to flash
+ * a larger, memory-aligned chunk. Flash sectors are erased ahead of the write
+ * pointer when no block is waiting to be processed.
+ * Blocks must all have the same size, except the last one.
+ * When the transfer of an image has been interrupted (link loss, MCU reset),
+ * sending block 0 of the same image again keeps the bytes already written:
+ * the next block can then be the resume point given by
+ * @c dfu_resume_point_get, or block 1, in which case blocks already written
+ * are acked without being written again.
  * @param current_block_number Must increment for each new
- * block. 0 will erase the flash area to receive a new image
+ * block, or jump to the resume point after block 0. 0 will erase the flash
+ * area to receive a new image, unless the transfer can be resumed
  * @param block_count
  * Number of image blocks to be processed
  * @param data Firmware image block
@@ -75,11 +146,14 @@ struct dfu_state_t {
  * process_cb
  * @param process_cb Callback when block is processed asynchronously, with
  * error code
- * @retval RET_ERROR_INVALID_PARAM @c current_block_number or size invalid
- * @retval RET_ERROR_BUSY last block not processed
+ * @retval RET_ERROR_INVALID_PARAM @c current_block_number, @c block_count or
+ * size invalid
+ * @retval RET_ERROR_BUSY window full: DFU_WINDOW_SIZE blocks are already
+ * queued, or previous image still being processed when receiving block 0
+ * @retval RET_ERROR_INVALID_STATE a previous block couldn't be written, the
+ * image must be sent again from block 0
  * @retval -EINPROGRESS block queued for further processing, @c process_cb will
  * be called to provide the actual status
- * @retval RET_SUCCESS block processed
  */
 int
 dfu_load(uint32_t current_block_number, uint32_t block_count,
@@ -117,16 +191,22 @@ dfu_secondary_activate_temporarily(void);
 /**
  * Check image in secondary slot against a CRC32.
  * Use it to validate a new image has correctly been written on Flash.
- * CRC processing is done in the dfu thread and thus the status of the check
- * is returned with the `process_cb`.
+ * CRC processing is done in the dfu thread, once all the queued blocks are
+ * written, and thus the status of the check is returned with the
+ * `process_cb`.
+ * Each chunk is read back and accounted in the image CRC32 when written, so
+ * the check of an image received since boot is a simple comparison. The
+ * entire slot is read back otherwise, or if requested with @c full_readback.
  *
  * @param crc32 expected CRC32 to be computed from read back content
+ * @param full_readback read the entire slot to compute the CRC32
  * @retval -EINPROGRESS task successfully queued
  * @retval RET_ERROR_INVALID_STATE current state doesn't allow checking CRC32
- * over secondary slot: is the new image fully received and processed?
+ * over secondary slot: is the new image fully received?
+ * @retval RET_ERROR_BUSY window full, try again later
  */
 int
-dfu_secondary_check_async(uint32_t crc32, void *context,
+dfu_secondary_check_async(uint32_t crc32, bool full_readback, void *context,
                           void (*process_cb)(void *ctx, int err));
 
 #ifdef CONFIG_ZTEST
@@ -134,6 +214,19 @@ int
 dfu_secondary_check(uint32_t crc32);
 #endif
 
+/**
+ * Get the point from which the transfer of the image being written can be
+ * resumed, after sending block 0 again.
+ * @param image_id CRC32 of block 0 of the image being written
+ * @param block_number First block not entirely written into Flash
+ * @param block_count Number of blocks of the image being written
+ * @retval RET_SUCCESS transfer can be resumed
+ * @retval RET_ERROR_NOT_FOUND no image transfer to be resumed
+ */
+int
+dfu_resume_point_get(uint32_t *image_id, uint32_t *block_number,
+                     uint32_t *block_count);
+
 /**
  * Confirm image in primary slot: will set the image as working accross reboot
  * when image is being tested.
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Streaming reconstruction of firmware images from a patch generated with
+ * `utils/ota/dfu_delta.py`, against the image in the primary slot (source).
+ *
+ * Patch format, little-endian:
+ *  - header:
+ *    - magic `DFU_DELTA_MAGIC` (u32)
+ *    - version `DFU_DELTA_VERSION` (u8)
+ *    - reserved (3 bytes)
+ *    - source size (u32): number of bytes of the primary slot used as source
+ *    - source CRC32 (u32): over those bytes, to check the patch applies
+ *    - target image size (u32)
+ *  - operations, until the target image size is reached:
+ *    - operation (u8), one of `dfu_delta_op_e`
+ *    - length (varint)
+ *    - for DFU_DELTA_COPY and DFU_DELTA_ADD: signed seek (zigzag varint),
+ *      added to the source offset before the operation. The source offset
+ *      starts at 0 and is incremented by the length after the operation.
+ *    - for DFU_DELTA_ADD: `length` bytes added (modulo 256) to the source
+ *      bytes, bsdiff-style
+ *    - for DFU_DELTA_INSERT: `length` bytes of the target image
+ *  Varints are LEB128-encoded, 7 bits per byte, least significant first.
+ *
+ * The patch can itself be packed into the compressed container of dfu_lz.h,
+ * which is how `dfu_delta.py` emits it by default: add bytes are mostly
+ * zeros.
+ */
+
+#define DFU_DELTA_MAGIC       0x50444644 // "DFDP"
+#define DFU_DELTA_VERSION     1
+#define DFU_DELTA_HEADER_SIZE 20
+
+enum dfu_delta_op_e {
+    DFU_DELTA_COPY = 0,
+    DFU_DELTA_ADD = 1,
+    DFU_DELTA_INSERT = 2,
+};
+
+enum dfu_delta_state_e {
+    DFU_DELTA_HEADER,
+    DFU_DELTA_OP,
+    DFU_DELTA_LENGTH,
+    DFU_DELTA_SEEK,
+    DFU_DELTA_DATA,
+    DFU_DELTA_DONE,
+};
+
+/**
+ * Read source bytes
+ * @retval RET_SUCCESS bytes read into @c data
+ * @retval other error code, returned by @c dfu_delta_apply
+ */
+typedef int (*dfu_delta_read_t)(void *context, size_t offset, uint8_t *data,
+                                size_t size);
+
+struct dfu_delta_t {
+    dfu_delta_read_t read;
+    void *context; // passed to `read`
+    uint8_t header[DFU_DELTA_HEADER_SIZE];
+    enum dfu_delta_state_e state;
+    uint8_t op;
+    uint32_t source_size;  // from header
+    uint32_t source_crc32; // from header
+    uint32_t target_size;  // from header
+    uint32_t out_count;    // target bytes so far
+    uint32_t count;        // header bytes, or remaining operation bytes
+    uint32_t varint;       // value being decoded
+    uint32_t shift;        // of the next varint byte
+    uint32_t source_offset;
+};
+
+/**
+ * Check whether a stream starts with the patch header
+ * @param data First bytes of the stream
+ * @param size Number of bytes at @c data
+ * @retval true stream is a patch and must be applied with @c dfu_delta_apply
+ */
+bool
+dfu_delta_is_patch(const uint8_t *data, size_t size);
+
+/**
+ * Reset the patch context, to reconstruct a new image
+ * @param delta Patch context
+ * @param read Function reading the source bytes
+ * @param context Passed to @c read
+ */
+void
+dfu_delta_init(struct dfu_delta_t *delta, dfu_delta_read_t read,
+               void *context);
+
+/**
+ * Apply patch bytes until either all the input is consumed or the output
+ * buffer is full. Input not producing any output is consumed even if the
+ * output buffer is full.
+ * Returns right after the header is parsed, without producing any output, so
+ * that the source can be checked with the header fields before going on.
+ * @param delta Patch context
+ * @param in Pointer to patch bytes, incremented by the consumed count
+ * @param in_len Number of bytes at @c in, decremented by the consumed count
+ * @param out Output buffer
+ * @param out_size Size of the output buffer
+ * @param out_len Set to the number of target bytes written into @c out
+ * @retval RET_SUCCESS call again with more input if @c in_len is 0, or with
+ * more output space if @c out_len is @c out_size
+ * @retval RET_ERROR_INVALID_PARAM invalid header
+ * @retval RET_ERROR_INVALID_STATE corrupted patch: unknown operation, source
+ * out of range, target larger than announced or input past the end of the
+ * image
+ * @retval other error returned by the read function
+ */
+int
+dfu_delta_apply(struct dfu_delta_t *delta, const uint8_t **in, size_t *in_len,
+                uint8_t *out, size_t out_size, size_t *out_len);
+
+/**
+ * @retval true header has been parsed, source can be checked
+ */
+bool
+dfu_delta_header_parsed(const struct dfu_delta_t *delta);
+
+/**
+ * @retval true all the target image bytes have been produced
+ */
+bool
+dfu_delta_done(const struct dfu_delta_t *delta);
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Streaming decompression of firmware images packed with
+ * `utils/ota/dfu_compress.py`.
+ *
+ * Container format, little-endian:
+ *  - header:
+ *    - magic `DFU_LZ_MAGIC` (u32)
+ *    - version `DFU_LZ_VERSION` (u8)
+ *    - log2 of the window size (u8), at most
+ *      CONFIG_ORB_LIB_DFU_LZ_WINDOW_LOG2
+ *    - reserved (u16)
+ *    - decompressed image size (u32)
+ *  - sequences of literals followed by a match, LZ4-style:
+ *    - token (u8): high nibble is the literal count, low nibble is the
+ *      match length minus DFU_LZ_MIN_MATCH. 15 means the value continues
+ *      with the following bytes, added until one is lower than 255
+ *    - literal bytes
+ *    - match offset (u16), back into the decompressed bytes, 1 to window size
+ *    The last sequence ends after its literals, once the decompressed image
+ *    size is reached.
+ *
+ * Input and output are consumed / produced in chunks of any size so that
+ * image blocks can be decompressed on the fly into Flash write chunks.
+ */
+
+#define DFU_LZ_MAGIC       0x5a4c4644 // "DFLZ"
+#define DFU_LZ_VERSION     1
+#define DFU_LZ_HEADER_SIZE 12
+#define DFU_LZ_MIN_MATCH   4
+#define DFU_LZ_WINDOW_SIZE (1UL << CONFIG_ORB_LIB_DFU_LZ_WINDOW_LOG2)
+
+enum dfu_lz_state_e {
+    DFU_LZ_HEADER,
+    DFU_LZ_TOKEN,
+    DFU_LZ_LITERALS_LENGTH,
+    DFU_LZ_LITERALS,
+    DFU_LZ_OFFSET_LOW,
+    DFU_LZ_OFFSET_HIGH,
+    DFU_LZ_MATCH_LENGTH,
+    DFU_LZ_MATCH,
+    DFU_LZ_DONE,
+};
+
+struct dfu_lz_t {
+    // decompressed bytes, used as dictionary by the matches
+    uint8_t window[DFU_LZ_WINDOW_SIZE];
+    uint8_t header[DFU_LZ_HEADER_SIZE];
+    enum dfu_lz_state_e state;
+    uint32_t window_size; // from header, lower than or equal to buffer size
+    uint32_t raw_size;    // decompressed image size, from header
+    uint32_t out_count;   // decompressed bytes so far
+    uint32_t count;       // header bytes, or remaining literals / match bytes
+    uint32_t match_length;
+    uint32_t match_offset;
+};
+
+/**
+ * Check whether an image starts with the compressed container header
+ * @param data First image block
+ * @param size Size of the image block
+ * @retval true image is compressed and must be decompressed with
+ * @c dfu_lz_decompress
+ */
+bool
+dfu_lz_is_compressed(const uint8_t *data, size_t size);
+
+/**
+ * Reset the decompression context, to decompress a new image
+ */
+void
+dfu_lz_init(struct dfu_lz_t *lz);
+
+/**
+ * Decompress bytes until either all the input is consumed or the output
+ * buffer is full. Input not producing any output (headers, lengths, offsets)
+ * is consumed even if the output buffer is full.
+ * @param lz Decompression context
+ * @param in Pointer to compressed bytes, incremented by the consumed count
+ * @param in_len Number of bytes at @c in, decremented by the consumed count
+ * @param out Output buffer
+ * @param out_size Size of the output buffer
+ * @param out_len Set to the number of decompressed bytes written into @c out
+ * @retval RET_SUCCESS call again with more input if @c in_len is 0, or with
+ * more output space if @c out_len is @c out_size
+ * @retval RET_ERROR_INVALID_PARAM invalid header or window size not supported
+ * @retval RET_ERROR_INVALID_STATE corrupted compressed data, or input past the
+ * end of the image
+ */
+int
+dfu_lz_decompress(struct dfu_lz_t *lz, const uint8_t **in, size_t *in_len,
+                  uint8_t *out, size_t out_size, size_t *out_len);
+
+/**
+ * @retval true all the decompressed image bytes have been produced
+ */
+bool
+dfu_lz_done(const struct dfu_lz_t *lz);
@@ -0,0 +1,413 @@
+#include "dfu.h"
+#include <errno.h>
+#include <errors.h>
+#include <orb_crc.h>
+#include <storage.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/ztest.h>
+
+/**
+ * DFU end-to-end throughput benchmark, running against the flash simulator
+ * configured like the STM32G4 internal flash (see boards/native_sim.overlay).
+ *
+ * Blocks of DFU_BLOCK_SIZE_MAX bytes are sent with `dfu_load()` the way the
+ * runner does it: up to DFU_WINDOW_SIZE blocks are queued without waiting for
+ * their ack. The image is then checked with `dfu_secondary_check_async()`.
+ * A transfer resumed after a link loss is measured as well.
+ *
+ * Flash accesses and CRC computations from `dfu.c` go through the `bench_*`
+ * functions below (see CMakeLists.txt): they are counted, and the time they
+ * take on target is spent busy-waiting so that the simulated time reflects
+ * the processing thread being busy. The measured times thus include the
+ * overlap between block reception and Flash operations.
+ *
+ * Each benchmark emits one line per measurement:
+ *   DFU_BENCH {"bench":"...", ...}
+ * Twister records them into `recording.csv`, otherwise grep `handler.log`.
+ */
+
+#define SECONDARY_SLOT_ID   FIXED_PARTITION_ID(slot1_partition)
+#define SECONDARY_SLOT_SIZE DT_REG_SIZE(DT_NODELABEL(slot1_partition))
+#define FLASH_ERASE_BLOCK_SIZE                                                 \
+    DT_PROP(DT_GPARENT(DT_NODELABEL(slot1_partition)), erase_block_size)
+
+BUILD_ASSERT(FLASH_ERASE_BLOCK_SIZE == DFU_FLASH_SECTOR_SIZE,
+             "DFU sector size must match the simulated flash");
+
+// STM32G4 datasheet typical timings, used to model time spent on target
+#define STM32G4_FLASH_PROGRAM_DWORD_NS 81700
+#define STM32G4_FLASH_ERASE_PAGE_NS    22020000
+#define STM32G4_FLASH_READ_DWORD_NS    50
+// CRC unit: one 32-bit word every 4 AHB clock cycles at 170MHz
+#define STM32G4_CRC_WORD_NS 24
+
+// 64-byte CAN-FD frames, 500kbit/s arbitration & 2Mbit/s data phases,
+// carrying the block and its protobuf / ISO-TP framing
+#define CANFD_FRAME_US        330
+#define CANFD_FRAME_PAYLOAD   62
+#define DFU_MESSAGE_OVERHEAD  16
+#define CANFD_BLOCK_TRANSFER_US                                                \
+    (DIV_ROUND_UP(DFU_BLOCK_SIZE_MAX + DFU_MESSAGE_OVERHEAD,                   \
+                  CANFD_FRAME_PAYLOAD) *                                       \
+     CANFD_FRAME_US)
+
+// typical main MCU image
+#define IMAGE_SIZE (200 * 1024)
+BUILD_ASSERT(IMAGE_SIZE <= SECONDARY_SLOT_SIZE, "image doesn't fit in slot");
+
+#define BENCH_REPORT(fmt, ...) printk("DFU_BENCH {" fmt "}\n", __VA_ARGS__)
+
+struct bench_counters {
+    uint32_t read_calls;
+    uint32_t bytes_read;
+    uint32_t write_calls;
+    uint32_t bytes_written;
+    uint32_t sectors_erased;
+    uint32_t crc_calls;
+    uint32_t crc_bytes;
+    // modeled time on target
+    uint64_t read_ns;
+    uint64_t program_ns;
+    uint64_t erase_ns;
+    uint64_t crc_ns;
+};
+
+#define BACKUP_REGS_SIZE (DT_PROP(DT_NODELABEL(bbram), st_backup_regs) * 4)
+
+static struct bench_counters counters;
+// retained across MCU resets on target, the DFU checkpoint is saved there
+static uint8_t backup_regs[BACKUP_REGS_SIZE];
+// modeled time not busy-waited yet, below 1us
+static uint32_t pending_ns;
+
+static K_SEM_DEFINE(sem_ack, 0, DFU_WINDOW_SIZE + 1);
+static K_SEM_DEFINE(sem_check, 0, 1);
+static atomic_t ack_errors;
+static int check_err_code;
+
+/// Let the time modeled for an operation elapse in the calling thread
+static void
+model_time_spend(uint64_t time_ns)
+{
+    time_ns += pending_ns;
+    pending_ns = (uint32_t)(time_ns % 1000);
+    if (time_ns >= 1000) {
+        k_busy_wait((uint32_t)(time_ns / 1000));
+    }
+}
+
+int
+bench_flash_area_read(const struct flash_area *fa, off_t off, void *dst,
+                      size_t len)
+{
+    const uint64_t time_ns =
+        (uint64_t)DIV_ROUND_UP(len, 8) * STM32G4_FLASH_READ_DWORD_NS;
+
+    counters.read_calls++;
+    counters.bytes_read += len;
+    counters.read_ns += time_ns;
+    model_time_spend(time_ns);
+
+    return flash_area_read(fa, off, dst, len);
+}
+
+int
+bench_flash_area_write(const struct flash_area *fa, off_t off,
+                       const void *src, size_t len)
+{
+    const uint64_t time_ns =
+        (uint64_t)DIV_ROUND_UP(len, 8) * STM32G4_FLASH_PROGRAM_DWORD_NS;
+
+    counters.write_calls++;
+    counters.bytes_written += len;
+    counters.program_ns += time_ns;
+    model_time_spend(time_ns);
+
+    return flash_area_write(fa, off, src, len);
+}
+
+int
+bench_flash_area_erase(const struct flash_area *fa, off_t off, size_t len)
+{
+    const uint32_t sectors = DIV_ROUND_UP(len, FLASH_ERASE_BLOCK_SIZE);
+    const uint64_t time_ns = (uint64_t)sectors * STM32G4_FLASH_ERASE_PAGE_NS;
+
+    counters.sectors_erased += sectors;
+    counters.erase_ns += time_ns;
+    model_time_spend(time_ns);
+
+    return flash_area_erase(fa, off, len);
+}
+
+uint32_t
+bench_crc32_ieee_update(uint32_t crc, const uint8_t *data, size_t len)
+{
+    const uint64_t time_ns =
+        (uint64_t)DIV_ROUND_UP(len, 4) * STM32G4_CRC_WORD_NS;
+
+    counters.crc_calls++;
+    counters.crc_bytes += len;
+    counters.crc_ns += time_ns;
+    model_time_spend(time_ns);
+
+    return orb_crc32_ieee_update(crc, data, len);
+}
+
+int
+backup_regs_read(const size_t offset, void *data, const size_t size)
+{
+    if (offset + size > sizeof(backup_regs)) {
+        return -EINVAL;
+    }
+    memcpy(data, &backup_regs[offset], size);
+
+    return 0;
+}
+
+int
+backup_regs_write(const size_t offset, const void *data, const size_t size)
+{
+    if (offset + size > sizeof(backup_regs)) {
+        return -EINVAL;
+    }
+    memcpy(&backup_regs[offset], data, size);
+
+    return 0;
+}
+
+static void
+counters_reset(void)
+{
+    memset(&counters, 0, sizeof(counters));
+}
+
+static uint32_t
+ticks_to_us(int64_t ticks)
+{
+    return (uint32_t)k_ticks_to_us_floor64((uint64_t)ticks);
+}
+
+/// Deterministic image content, starting with an MCUboot header so that the
+/// full read-back check finds the image size
+static void
+block_fill(uint32_t block_number, uint8_t *buf, size_t size)
+{
+    const size_t offset = (size_t)block_number * DFU_BLOCK_SIZE_MAX;
+
+    for (size_t i = 0; i < size; ++i) {
+        buf[i] = (uint8_t)((offset + i) * 7 + (offset + i) / 251);
+    }
+
+    if (block_number == 0) {
+        struct image_header header = {
+            .ih_magic = IMAGE_MAGIC,
+            .ih_hdr_size = sizeof(struct image_header),
+            .ih_img_size = IMAGE_SIZE - sizeof(struct image_header),
+        };
+        memcpy(buf, &header, MIN(sizeof(header), size));
+    }
+}
+
+/// Same as the runner: blocks are acked once processed
+static void
+block_ack(void *ctx, int err)
+{
+    ARG_UNUSED(ctx);
+
+    if (err != RET_SUCCESS) {
+        atomic_inc(&ack_errors);
+    }
+    k_sem_give(&sem_ack);
+}
+
+static void
+check_done(void *ctx, int err)
+{
+    ARG_UNUSED(ctx);
+
+    check_err_code = err;
+    k_sem_give(&sem_check);
+}
+
+static void
+bench_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    // let the processing thread finish erasing ahead from a previous run
+    k_msleep(500);
+
+    const struct flash_area *fa;
+    zassert_ok(flash_area_open(SECONDARY_SLOT_ID, &fa));
+    zassert_ok(flash_area_erase(fa, 0, fa->fa_size));
+    flash_area_close(fa);
+    memset(backup_regs, 0, sizeof(backup_regs));
+
+    k_sem_reset(&sem_ack);
+    k_sem_reset(&sem_check);
+    atomic_clear(&ack_errors);
+    counters_reset();
+    pending_ns = 0;
+}
+
+/// Check the secondary slot, returns the elapsed time in microseconds
+static uint32_t
+image_check(uint32_t crc32, bool full_readback)
+{
+    const int64_t start = k_uptime_ticks();
+
+    int ret =
+        dfu_secondary_check_async(crc32, full_readback, NULL, check_done);
+    zassert_equal(ret, -EINPROGRESS, "check not queued: %d", ret);
+    zassert_ok(k_sem_take(&sem_check, K_SECONDS(60)));
+    zassert_equal(check_err_code, RET_SUCCESS, "check failed: %d",
+                  check_err_code);
+
+    return ticks_to_us(k_uptime_ticks() - start);
+}
+
+/// Send blocks [`first`, `last`), each block taking `link_us` to be received,
+/// and wait for all of them to be acked
+/// @return time elapsed in microseconds
+static uint32_t
+send_blocks(uint32_t first, uint32_t last, uint32_t link_us)
+{
+    const uint32_t block_count = DIV_ROUND_UP(IMAGE_SIZE, DFU_BLOCK_SIZE_MAX);
+    uint8_t block[DFU_BLOCK_SIZE_MAX];
+    uint32_t outstanding = 0;
+
+    const int64_t start = k_uptime_ticks();
+    for (uint32_t b = first; b < last; ++b) {
+        const size_t size =
+            MIN(DFU_BLOCK_SIZE_MAX, IMAGE_SIZE - b * DFU_BLOCK_SIZE_MAX);
+
+        // the remote waits for an ack once the window is full
+        if (outstanding == DFU_WINDOW_SIZE) {
+            zassert_ok(k_sem_take(&sem_ack, K_SECONDS(10)));
+            outstanding--;
+        }
+        if (link_us) {
+            k_usleep(link_us);
+        }
+
+        block_fill(b, block, size);
+        int ret = dfu_load(b, block_count, block, size, NULL, block_ack);
+        zassert_equal(ret, -EINPROGRESS, "block #%u not queued: %d", b, ret);
+        outstanding++;
+    }
+    while (outstanding) {
+        zassert_ok(k_sem_take(&sem_ack, K_SECONDS(10)));
+        outstanding--;
+    }
+    zassert_equal(atomic_get(&ack_errors), 0, "%u blocks failed",
+                  (uint32_t)atomic_get(&ack_errors));
+
+    return ticks_to_us(k_uptime_ticks() - start);
+}
+
+/// CRC32 of the whole image, as computed by the remote
+static uint32_t
+image_crc32(void)
+{
+    uint8_t block[DFU_BLOCK_SIZE_MAX];
+    uint32_t crc32 = 0;
+
+    for (size_t off = 0; off < IMAGE_SIZE; off += DFU_BLOCK_SIZE_MAX) {
+        const size_t size = MIN(DFU_BLOCK_SIZE_MAX, IMAGE_SIZE - off);
+        block_fill(off / DFU_BLOCK_SIZE_MAX, block, size);
+        crc32 = orb_crc32_ieee_update(crc32, block, size);
+    }
+
+    return crc32;
+}
+
+/// Send the whole image, each block taking `link_us` to be received, then
+/// check it
+static void
+bench_image(const char *link, uint32_t link_us)
+{
+    const uint32_t block_count = DIV_ROUND_UP(IMAGE_SIZE, DFU_BLOCK_SIZE_MAX);
+    const uint32_t crc32 = image_crc32();
+
+    const int64_t start = k_uptime_ticks();
+    const uint32_t blocks_us = send_blocks(0, block_count, link_us);
+
+    // streamed CRC32, computed while writing
+    const uint32_t check_us = image_check(crc32, false);
+    const uint32_t end_to_end_us = ticks_to_us(k_uptime_ticks() - start);
+
+    BENCH_REPORT(
+        "\"bench\":\"throughput\",\"link\":\"%s\",\"link_us_per_block\":%u,"
+        "\"window\":%u,\"block_size\":%u,\"blocks\":%u,\"image_bytes\":%u,"
+        "\"blocks_us\":%u,\"blocks_per_s\":%u,\"bytes_per_s\":%u,"
+        "\"check_us\":%u,\"end_to_end_us\":%u,"
+        "\"sectors_erased\":%u,\"erase_us\":%u,"
+        "\"write_calls\":%u,\"bytes_written\":%u,\"program_us\":%u,"
+        "\"read_calls\":%u,\"bytes_read\":%u,\"read_us\":%u,"
+        "\"crc_calls\":%u,\"crc_bytes\":%u,\"crc_us\":%u",
+        link, link_us, DFU_WINDOW_SIZE, (uint32_t)DFU_BLOCK_SIZE_MAX,
+        block_count, IMAGE_SIZE, blocks_us,
+        (uint32_t)((uint64_t)block_count * 1000000 / MAX(blocks_us, 1)),
+        (uint32_t)((uint64_t)IMAGE_SIZE * 1000000 / MAX(blocks_us, 1)),
+        check_us, end_to_end_us, counters.sectors_erased,
+        (uint32_t)(counters.erase_ns / 1000), counters.write_calls,
+        counters.bytes_written, (uint32_t)(counters.program_ns / 1000),
+        counters.read_calls, counters.bytes_read,
+        (uint32_t)(counters.read_ns / 1000), counters.crc_calls,
+        counters.crc_bytes, (uint32_t)(counters.crc_ns / 1000));
+
+    // compare with a check reading the entire image back
+    counters_reset();
+    const uint32_t full_check_us = image_check(crc32, true);
+
+    BENCH_REPORT("\"bench\":\"full_check\",\"link\":\"%s\",\"check_us\":%u,"
+                 "\"bytes_read\":%u,\"read_us\":%u,\"crc_bytes\":%u,"
+                 "\"crc_us\":%u",
+                 link, full_check_us, counters.bytes_read,
+                 (uint32_t)(counters.read_ns / 1000), counters.crc_bytes,
+                 (uint32_t)(counters.crc_ns / 1000));
+}
+
+/// Link lost halfway through the image: block 0 is sent again, then the
+/// remaining blocks from the resume point
+ZTEST(dfu_bench, test_resume_canfd)
+{
+    const uint32_t block_count = DIV_ROUND_UP(IMAGE_SIZE, DFU_BLOCK_SIZE_MAX);
+    const uint32_t crc32 = image_crc32();
+    uint32_t resume_block;
+
+    send_blocks(0, block_count / 2, CANFD_BLOCK_TRANSFER_US);
+    counters_reset();
+
+    const int64_t start = k_uptime_ticks();
+    const uint32_t block0_us = send_blocks(0, 1, CANFD_BLOCK_TRANSFER_US);
+    zassert_ok(dfu_resume_point_get(NULL, &resume_block, NULL));
+    zassert_true(resume_block > 0 && resume_block <= block_count / 2,
+                 "resume point #%u", resume_block);
+    send_blocks(resume_block, block_count, CANFD_BLOCK_TRANSFER_US);
+    image_check(crc32, false);
+    const uint32_t end_to_end_us = ticks_to_us(k_uptime_ticks() - start);
+
+    BENCH_REPORT("\"bench\":\"resume\",\"link\":\"canfd\",\"blocks\":%u,"
+                 "\"resume_block\":%u,\"block0_us\":%u,"
+                 "\"end_to_end_us\":%u,\"bytes_written\":%u,"
+                 "\"sectors_erased\":%u",
+                 block_count, resume_block, block0_us, end_to_end_us,
+                 counters.bytes_written, counters.sectors_erased);
+}
+
+/// Blocks sent as fast as they are acked: Flash operations are the limit
+ZTEST(dfu_bench, test_throughput_mcu_bound)
+{
+    bench_image("none", 0);
+}
+
+/// Blocks received over CAN-FD from the Jetson
+ZTEST(dfu_bench, test_throughput_canfd)
+{
+    bench_image("canfd", CANFD_BLOCK_TRANSFER_US);
+}
+
+ZTEST_SUITE(dfu_bench, NULL, NULL, bench_before, NULL, NULL);
@@ -0,0 +1,3 @@
+// CMSIS isn't available on native_sim, `compilers.h` only needs the include
+// to resolve
+#pragma once
@@ -0,0 +1,3 @@
+// STM32 LL drivers aren't available on native_sim, `dfu.c` only needs the
+// include to resolve
+#pragma once
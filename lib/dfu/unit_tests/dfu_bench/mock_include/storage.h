@@ -0,0 +1,9 @@
+// Backup registers holding the DFU checkpoint, emulated in RAM by `main.c`
+#pragma once
+
+#include <stddef.h>
+
+int
+backup_regs_read(const size_t offset, void *data, const size_t size);
+int
+backup_regs_write(const size_t offset, const void *data, const size_t size);
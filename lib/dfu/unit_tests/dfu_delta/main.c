@@ -0,0 +1,227 @@
+#include <dfu_delta.h>
+#include <errors.h>
+#include <string.h>
+#include <zephyr/ztest.h>
+
+ZTEST_SUITE(dfu_delta, NULL, NULL, NULL, NULL, NULL);
+
+static struct dfu_delta_t delta;
+
+#define SOURCE_SIZE 256
+#define TARGET_SIZE 323
+
+static uint8_t source[SOURCE_SIZE];
+static int source_read_err = RET_SUCCESS;
+
+#define HEADER(target_size)                                                    \
+    0x44, 0x46, 0x44, 0x50, DFU_DELTA_VERSION, 0x00, 0x00, 0x00, 0x00, 0x01,   \
+        0x00, 0x00, 0x78, 0x56, 0x34, 0x12, (target_size) & 0xff,              \
+        (target_size) >> 8, 0x00, 0x00
+
+// operations covering all the types, with forward and backward seeks
+static const uint8_t patch[] = {
+    HEADER(TARGET_SIZE),
+    // insert "abc"
+    DFU_DELTA_INSERT, 0x03, 'a', 'b', 'c',
+    // copy source [10, 110)
+    DFU_DELTA_COPY, 0x64, 0x14,
+    // add 1 to source [60, 80)
+    DFU_DELTA_ADD, 0x14, 0x63, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1,
+    // copy source [50, 250)
+    DFU_DELTA_COPY, 0xc8, 0x01, 0x3b};
+
+/// Offsets into `patch` of the seeks of the first and last copies
+#define PATCH_FIRST_SEEK (DFU_DELTA_HEADER_SIZE + 7)
+#define PATCH_LAST_SEEK  (sizeof(patch) - 1)
+
+static uint8_t
+source_byte(size_t i)
+{
+    return (uint8_t)(i * 7 + 3);
+}
+
+static uint8_t
+target_byte(size_t i)
+{
+    if (i < 3) {
+        return "abc"[i];
+    }
+    if (i < 103) {
+        return source_byte(10 + i - 3);
+    }
+    if (i < 123) {
+        return source_byte(60 + i - 103) + 1;
+    }
+    return source_byte(50 + i - 123);
+}
+
+static int
+source_read(void *context, size_t offset, uint8_t *data, size_t size)
+{
+    zassert_equal(context, source);
+    zassert_true(offset + size <= SOURCE_SIZE);
+    if (source_read_err) {
+        return source_read_err;
+    }
+    memcpy(data, &source[offset], size);
+    return RET_SUCCESS;
+}
+
+static void
+source_init(void)
+{
+    for (size_t i = 0; i < SOURCE_SIZE; ++i) {
+        source[i] = source_byte(i);
+    }
+}
+
+/// Apply `in` by chunks of `in_chunk` bytes into an output buffer of
+/// `out_chunk` bytes, appended to `out`
+static int
+apply(const uint8_t *in, size_t in_size, size_t in_chunk, uint8_t *out,
+      size_t out_max, size_t out_chunk, size_t *out_size)
+{
+    source_init();
+    dfu_delta_init(&delta, source_read, source);
+    *out_size = 0;
+
+    for (size_t off = 0; off < in_size; off += in_chunk) {
+        const uint8_t *in_p = &in[off];
+        size_t in_len = MIN(in_chunk, in_size - off);
+        size_t out_len;
+        size_t space;
+
+        // call again as long as input remains or the output buffer gets full
+        do {
+            space = MIN(out_chunk, out_max - *out_size);
+            int ret = dfu_delta_apply(&delta, &in_p, &in_len,
+                                      &out[*out_size], space, &out_len);
+            *out_size += out_len;
+            if (ret != RET_SUCCESS) {
+                return ret;
+            }
+            if (space == 0 && in_len != 0) {
+                return RET_ERROR_NO_MEM;
+            }
+        } while ((out_len == space && space != 0) || in_len != 0);
+    }
+
+    return RET_SUCCESS;
+}
+
+ZTEST(dfu_delta, test_dfu_delta_is_patch)
+{
+    const uint8_t mcuboot_header[] = {0x3d, 0xb8, 0xf3, 0x96};
+
+    zassert_true(dfu_delta_is_patch(patch, sizeof(patch)));
+    zassert_false(dfu_delta_is_patch(patch, 3));
+    zassert_false(dfu_delta_is_patch(mcuboot_header, sizeof(mcuboot_header)));
+}
+
+ZTEST(dfu_delta, test_dfu_delta_header)
+{
+    const uint8_t *in = patch;
+    size_t in_len = sizeof(patch);
+    uint8_t out[TARGET_SIZE];
+    size_t out_len;
+
+    // stops right after the header so that the source can be checked
+    dfu_delta_init(&delta, source_read, source);
+    int ret = dfu_delta_apply(&delta, &in, &in_len, out, sizeof(out),
+                              &out_len);
+    zassert_equal(ret, RET_SUCCESS);
+    zassert_true(dfu_delta_header_parsed(&delta));
+    zassert_equal(out_len, 0);
+    zassert_equal(in_len, sizeof(patch) - DFU_DELTA_HEADER_SIZE);
+    zassert_equal(delta.source_size, SOURCE_SIZE);
+    zassert_equal(delta.source_crc32, 0x12345678);
+    zassert_equal(delta.target_size, TARGET_SIZE);
+}
+
+ZTEST(dfu_delta, test_dfu_delta_apply)
+{
+    uint8_t out[TARGET_SIZE + 16];
+    size_t out_size;
+    // output chunks similar to Flash write chunks, then byte per byte
+    const size_t chunks[][2] = {
+        {sizeof(patch), 64}, {7, 64}, {1, 1}, {5, 3}, {sizeof(patch), 1000}};
+
+    for (size_t c = 0; c < ARRAY_SIZE(chunks); ++c) {
+        int ret = apply(patch, sizeof(patch), chunks[c][0], out, sizeof(out),
+                        chunks[c][1], &out_size);
+        zassert_equal(ret, RET_SUCCESS, "chunks #%u: %d", c, ret);
+        zassert_true(dfu_delta_done(&delta), "chunks #%u", c);
+        zassert_equal(out_size, TARGET_SIZE, "chunks #%u: %u", c, out_size);
+        for (size_t i = 0; i < out_size; ++i) {
+            zassert_equal(out[i], target_byte(i), "chunks #%u @%u", c, i);
+        }
+    }
+}
+
+ZTEST(dfu_delta, test_dfu_delta_invalid)
+{
+    uint8_t in[sizeof(patch) + 1];
+    uint8_t out[TARGET_SIZE];
+    size_t out_size;
+    int ret;
+
+    // unknown version
+    memcpy(in, patch, sizeof(patch));
+    in[4] = DFU_DELTA_VERSION + 1;
+    ret = apply(in, sizeof(patch), sizeof(patch), out, sizeof(out), 64,
+                &out_size);
+    zassert_equal(ret, RET_ERROR_INVALID_PARAM);
+
+    // unknown operation
+    memcpy(in, patch, sizeof(patch));
+    in[DFU_DELTA_HEADER_SIZE] = DFU_DELTA_INSERT + 1;
+    ret = apply(in, sizeof(patch), sizeof(patch), out, sizeof(out), 64,
+                &out_size);
+    zassert_equal(ret, RET_ERROR_INVALID_STATE);
+
+    // copy past the end of the source: [56, 256) is valid, [57, 257) isn't
+    memcpy(in, patch, sizeof(patch));
+    in[PATCH_LAST_SEEK] = 0x2f;
+    ret = apply(in, sizeof(patch), sizeof(patch), out, sizeof(out), 64,
+                &out_size);
+    zassert_equal(ret, RET_SUCCESS);
+    in[PATCH_LAST_SEEK] = 0x2d;
+    ret = apply(in, sizeof(patch), sizeof(patch), out, sizeof(out), 64,
+                &out_size);
+    zassert_equal(ret, RET_ERROR_INVALID_STATE);
+
+    // seek before the beginning of the source
+    memcpy(in, patch, sizeof(patch));
+    in[PATCH_FIRST_SEEK] = 0x01;
+    ret = apply(in, sizeof(patch), sizeof(patch), out, sizeof(out), 64,
+                &out_size);
+    zassert_equal(ret, RET_ERROR_INVALID_STATE);
+
+    // target larger than announced in the header
+    memcpy(in, patch, sizeof(patch));
+    in[16] = (TARGET_SIZE - 1) & 0xff;
+    ret = apply(in, sizeof(patch), sizeof(patch), out, sizeof(out), 64,
+                &out_size);
+    zassert_equal(ret, RET_ERROR_INVALID_STATE);
+
+    // bytes past the end of the image
+    memcpy(in, patch, sizeof(patch));
+    in[sizeof(patch)] = DFU_DELTA_COPY;
+    ret = apply(in, sizeof(in), sizeof(in), out, sizeof(out), 64, &out_size);
+    zassert_equal(ret, RET_ERROR_INVALID_STATE);
+
+    // source read error is returned
+    source_read_err = RET_ERROR_INTERNAL;
+    ret = apply(patch, sizeof(patch), sizeof(patch), out, sizeof(out), 64,
+                &out_size);
+    source_read_err = RET_SUCCESS;
+    zassert_equal(ret, RET_ERROR_INTERNAL);
+
+    // truncated patch
+    ret = apply(patch, sizeof(patch) - 10, 7, out, sizeof(out), 64,
+                &out_size);
+    zassert_equal(ret, RET_SUCCESS);
+    zassert_false(dfu_delta_done(&delta));
+    zassert_true(out_size < TARGET_SIZE);
+}
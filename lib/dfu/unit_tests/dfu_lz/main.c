@@ -0,0 +1,169 @@
+#include <dfu_lz.h>
+#include <errors.h>
+#include <string.h>
+#include <zephyr/ztest.h>
+
+ZTEST_SUITE(dfu_lz, NULL, NULL, NULL, NULL, NULL);
+
+static struct dfu_lz_t lz;
+
+#define PACKED_RAW_SIZE 400
+
+// `test_raw_byte()` packed with `utils/ota/dfu_compress.py -w 8`
+static const uint8_t packed[] = {
+    0x44, 0x46, 0x4c, 0x5a, 0x01, 0x08, 0x00, 0x00, 0x90, 0x01, 0x00, 0x00,
+    0xff, 0x16, 0x77, 0x6f, 0x72, 0x6c, 0x64, 0x63, 0x6f, 0x69, 0x6e, 0x20,
+    0x6f, 0x72, 0x62, 0x20, 0x64, 0x66, 0x75, 0x20, 0x77, 0x6f, 0x04, 0x11,
+    0x1e, 0x2b, 0x38, 0x45, 0x52, 0x5f, 0x6c, 0x79, 0x86, 0x93, 0xa0, 0xad,
+    0xba, 0xc7, 0xd4, 0x24, 0x00, 0x00, 0xff, 0x03, 0x72, 0xe5, 0xf2, 0xff,
+    0x0c, 0x19, 0x26, 0x33, 0x40, 0x4d, 0x5a, 0x67, 0x74, 0x81, 0x8e, 0x9b,
+    0xa8, 0xb5, 0x24, 0x00, 0x00, 0xff, 0x03, 0x6c, 0xc6, 0xd3, 0xe0, 0xed,
+    0xfa, 0x07, 0x14, 0x21, 0x2e, 0x3b, 0x48, 0x55, 0x62, 0x6f, 0x7c, 0x89,
+    0x96, 0x24, 0x00, 0x00, 0xff, 0x03, 0x64, 0xa7, 0xb4, 0xc1, 0xce, 0xdb,
+    0xe8, 0xf5, 0x02, 0x0f, 0x1c, 0x29, 0x36, 0x43, 0x50, 0x5d, 0x6a, 0x77,
+    0x24, 0x00, 0x00, 0xff, 0x03, 0x63, 0x88, 0x95, 0xa2, 0xaf, 0xbc, 0xc9,
+    0xd6, 0xe3, 0xf0, 0xfd, 0x0a, 0x17, 0x24, 0x31, 0x3e, 0x4b, 0x58, 0x24,
+    0x00, 0x00, 0xff, 0x03, 0x6f, 0x69, 0x76, 0x83, 0x90, 0x9d, 0xaa, 0xb7,
+    0xc4, 0xd1, 0xde, 0xeb, 0xf8, 0x05, 0x12, 0x1f, 0x2c, 0x39, 0x24, 0x00,
+    0x01, 0xff, 0x02, 0x4a, 0x57, 0x64, 0x71, 0x7e, 0x8b, 0x98, 0xa5, 0xb2,
+    0xbf, 0xcc, 0xd9, 0xe6, 0xf3, 0x00, 0x0d, 0x1a, 0x24, 0x00, 0x00, 0x1a,
+    0x6e, 0x00, 0x01, 0x3f, 0xe1, 0xee, 0xfb, 0x24, 0x00, 0x00, 0x1a, 0x20,
+    0x00, 0x01, 0x3f, 0xc2, 0xcf, 0xdc, 0x24, 0x00, 0x00, 0x1a, 0x6f, 0x00,
+    0x01, 0x3f, 0xa3, 0xb0, 0xbd, 0x24, 0x00, 0x00, 0x16, 0x72, 0x00, 0x01,
+    0x00,
+};
+
+static uint8_t
+test_raw_byte(size_t i)
+{
+    static const char text[] = "worldcoin orb dfu ";
+    return (i % 37) < 20 ? (uint8_t)text[i % 18] : (uint8_t)(i * 13);
+}
+
+/// Decompress `in` by chunks of `in_chunk` bytes into an output buffer of
+/// `out_chunk` bytes, appended to `out`
+static int
+decompress(const uint8_t *in, size_t in_size, size_t in_chunk, uint8_t *out,
+           size_t out_max, size_t out_chunk, size_t *out_size)
+{
+    dfu_lz_init(&lz);
+    *out_size = 0;
+
+    for (size_t off = 0; off < in_size; off += in_chunk) {
+        const uint8_t *in_p = &in[off];
+        size_t in_len = MIN(in_chunk, in_size - off);
+        size_t out_len;
+        size_t space;
+
+        // call again as long as the output buffer gets full
+        do {
+            space = MIN(out_chunk, out_max - *out_size);
+            int ret = dfu_lz_decompress(&lz, &in_p, &in_len, &out[*out_size],
+                                        space, &out_len);
+            *out_size += out_len;
+            if (ret != RET_SUCCESS) {
+                return ret;
+            }
+            if (space == 0 && in_len != 0) {
+                return RET_ERROR_NO_MEM;
+            }
+        } while (out_len == space && space != 0);
+    }
+
+    return RET_SUCCESS;
+}
+
+ZTEST(dfu_lz, test_dfu_lz_is_compressed)
+{
+    const uint8_t mcuboot_header[] = {0x3d, 0xb8, 0xf3, 0x96};
+
+    zassert_true(dfu_lz_is_compressed(packed, sizeof(packed)));
+    zassert_false(dfu_lz_is_compressed(packed, 3));
+    zassert_false(
+        dfu_lz_is_compressed(mcuboot_header, sizeof(mcuboot_header)));
+}
+
+ZTEST(dfu_lz, test_dfu_lz_packer_output)
+{
+    uint8_t out[PACKED_RAW_SIZE + 16];
+    size_t out_size;
+    // output chunks similar to Flash write chunks, then byte per byte
+    const size_t chunks[][2] = {{sizeof(packed), 64}, {39, 64}, {1, 1},
+                                {7, 3}};
+
+    for (size_t c = 0; c < ARRAY_SIZE(chunks); ++c) {
+        int ret = decompress(packed, sizeof(packed), chunks[c][0], out,
+                             sizeof(out), chunks[c][1], &out_size);
+        zassert_equal(ret, RET_SUCCESS, "chunks #%u: %d", c, ret);
+        zassert_true(dfu_lz_done(&lz), "chunks #%u", c);
+        zassert_equal(out_size, PACKED_RAW_SIZE, "chunks #%u: %u", c,
+                      out_size);
+        for (size_t i = 0; i < out_size; ++i) {
+            zassert_equal(out[i], test_raw_byte(i), "chunks #%u @%u", c, i);
+        }
+    }
+}
+
+ZTEST(dfu_lz, test_dfu_lz_long_overlapping_match)
+{
+    // 1 literal followed by a 1000-byte match overlapping its own output
+    const uint8_t in[] = {
+        0x44, 0x46, 0x4c, 0x5a, 0x01, 0x0a, 0x00, 0x00, 0xe9, 0x03, 0x00, 0x00,
+        0x1f, 'x',  0x01, 0x00, 0xff, 0xff, 0xff, 0xd8, 0x00,
+    };
+    uint8_t out[1001];
+    size_t out_size;
+
+    int ret = decompress(in, sizeof(in), sizeof(in), out, sizeof(out), 64,
+                         &out_size);
+    zassert_equal(ret, RET_SUCCESS);
+    zassert_true(dfu_lz_done(&lz));
+    zassert_equal(out_size, sizeof(out));
+    for (size_t i = 0; i < out_size; ++i) {
+        zassert_equal(out[i], 'x', "@%u", i);
+    }
+}
+
+ZTEST(dfu_lz, test_dfu_lz_invalid)
+{
+    uint8_t in[sizeof(packed) + 1];
+    uint8_t out[PACKED_RAW_SIZE];
+    size_t out_size;
+    int ret;
+
+    // unknown version
+    memcpy(in, packed, sizeof(packed));
+    in[4] = DFU_LZ_VERSION + 1;
+    ret = decompress(in, sizeof(packed), sizeof(packed), out, sizeof(out), 64,
+                     &out_size);
+    zassert_equal(ret, RET_ERROR_INVALID_PARAM);
+
+    // window larger than ours
+    memcpy(in, packed, sizeof(packed));
+    in[5] = CONFIG_ORB_LIB_DFU_LZ_WINDOW_LOG2 + 1;
+    ret = decompress(in, sizeof(packed), sizeof(packed), out, sizeof(out), 64,
+                     &out_size);
+    zassert_equal(ret, RET_ERROR_INVALID_PARAM);
+
+    // match before the beginning of the image: first match of the packed
+    // data, right after the 37 first literals
+    memcpy(in, packed, sizeof(packed));
+    in[DFU_LZ_HEADER_SIZE + 2 + 37] = 0xff;
+    ret = decompress(in, sizeof(packed), sizeof(packed), out, sizeof(out), 64,
+                     &out_size);
+    zassert_equal(ret, RET_ERROR_INVALID_STATE);
+
+    // bytes past the end of the image
+    memcpy(in, packed, sizeof(packed));
+    in[sizeof(packed)] = 0;
+    ret = decompress(in, sizeof(in), sizeof(in), out, sizeof(out), 64,
+                     &out_size);
+    zassert_equal(ret, RET_ERROR_INVALID_STATE);
+
+    // truncated image
+    ret = decompress(packed, sizeof(packed) - 10, 39, out, sizeof(out), 64,
+                     &out_size);
+    zassert_equal(ret, RET_SUCCESS);
+    zassert_false(dfu_lz_done(&lz));
+    zassert_true(out_size < PACKED_RAW_SIZE);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Bootloader stages timing, written by the bootloader into the backup
+ * registers right before jumping into the application, which reads it to
+ * report where cold-boot time is spent before the application starts.
+ *
+ * Timestamps are in microseconds, taken from the cycle counter of the
+ * bootloader (started with the system timer, so right before the bootloader
+ * drivers are initialized). A timestamp of 0 means the stage didn't happen.
+ * Stages entered several times keep the last timestamp.
+ */
+
+// after the DFU checkpoint, see main_board/src/system/backup_regs.h
+#define BOOT_STAGES_BACKUP_REGS_OFFSET 32
+#define BOOT_STAGES_MAGIC              0x42535447 // "GTSB"
+
+enum boot_stage_e {
+    BOOT_STAGE_MAIN,            // bootloader `main()` entered
+    BOOT_STAGE_BOOT_GO,         // images inspection starts
+    BOOT_STAGE_SECONDARY_CHECK, // secondary slot image validation starts
+    BOOT_STAGE_UPDATE,          // swap of the images starts
+    BOOT_STAGE_PRIMARY_CHECK,   // primary slot image validation starts
+    BOOT_STAGE_BOOT_GO_DONE,    // image to boot selected
+    BOOT_STAGE_JUMP,            // jumping into the application
+    BOOT_STAGE_COUNT
+};
+
+struct boot_stages_t {
+    uint32_t magic; // BOOT_STAGES_MAGIC, cleared once read by the application
+    uint32_t timestamp_us[BOOT_STAGE_COUNT];
+};
@@ -9,27 +9,39 @@ static const struct device *const backup_regs_dev =
 LOG_MODULE_DECLARE(storage, CONFIG_STORAGE_LOG_LEVEL);
 
 int
-backup_regs_read_byte(const size_t offset, uint8_t *data)
+backup_regs_read(const size_t offset, void *data, const size_t size)
 {
-    size_t size;
-    int ret = bbram_get_size(backup_regs_dev, &size);
-    if (ret == 0 && offset >= size) {
+    size_t regs_size;
+    int ret = bbram_get_size(backup_regs_dev, &regs_size);
+    if (ret == 0 && offset + size > regs_size) {
         return -EINVAL;
     }
 
-    ret = bbram_read(backup_regs_dev, offset, sizeof(data), data);
+    ret = bbram_read(backup_regs_dev, offset, size, data);
     return ret;
 }
 
 int
-backup_regs_write_byte(const size_t offset, const uint8_t data)
+backup_regs_write(const size_t offset, const void *data, const size_t size)
 {
-    size_t size;
-    int ret = bbram_get_size(backup_regs_dev, &size);
-    if (ret == 0 && offset >= size) {
+    size_t regs_size;
+    int ret = bbram_get_size(backup_regs_dev, &regs_size);
+    if (ret == 0 && offset + size > regs_size) {
         return -EINVAL;
     }
 
-    ret = bbram_write(backup_regs_dev, offset, sizeof(data), &data);
+    ret = bbram_write(backup_regs_dev, offset, size, data);
     return ret;
 }
+
+int
+backup_regs_read_byte(const size_t offset, uint8_t *data)
+{
+    return backup_regs_read(offset, data, sizeof(*data));
+}
+
+int
+backup_regs_write_byte(const size_t offset, const uint8_t data)
+{
+    return backup_regs_write(offset, &data, sizeof(data));
+}
@@ -142,6 +142,17 @@ int
 storage_init(struct storage_area_s *area, uint8_t partition_id);
 
 #ifdef CONFIG_BBRAM
+/**
+ * Read / write backup registers, which are retained across MCU resets
+ * @param offset Offset in bytes into the backup registers
+ * @retval -EINVAL out of the backup registers
+ * @retval 0 on success, error code from the bbram driver otherwise
+ */
+int
+backup_regs_read(const size_t offset, void *data, const size_t size);
+int
+backup_regs_write(const size_t offset, const void *data, const size_t size);
+
 int
 backup_regs_read_byte(const size_t offset, uint8_t *data);
 int
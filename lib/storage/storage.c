@@ -1,10 +1,10 @@
 #include "storage.h"
+#include "orb_crc.h"
 #include "orb_logs.h"
 #include <errors.h>
 #include <zephyr/device.h>
 #include <zephyr/kernel.h>
 #include <zephyr/storage/flash_map.h>
-#include <zephyr/sys/crc.h>
 
 LOG_MODULE_REGISTER(storage, CONFIG_STORAGE_LOG_LEVEL);
 
@@ -68,7 +68,7 @@ init_area(struct storage_area_s *area)
                     fa, (off_t)(index + sizeof(storage_header_t) + i),
                     (void *)read_buffer, size_to_read);
                 if (ret == 0) {
-                    crc16 = crc16_ccitt(crc16, read_buffer, size_to_read);
+                    crc16 = orb_crc16_ccitt(crc16, read_buffer, size_to_read);
                 }
             }
             if (header.crc16 == crc16) {
@@ -169,8 +169,9 @@ storage_peek(struct storage_area_s *area, char *buffer, size_t *size)
     if (flash_read_ret) {
         goto exit;
     } else if (header.magic_state != RECORD_VALID ||
-               (header.crc16 != crc16_ccitt(0xffff, (const uint8_t *)buffer,
-                                            header.record_size))) {
+               (header.crc16 != orb_crc16_ccitt(0xffff,
+                                                (const uint8_t *)buffer,
+                                                header.record_size))) {
         err_code = RET_ERROR_INVALID_STATE;
         goto exit;
     }
@@ -288,7 +289,7 @@ storage_push(struct storage_area_s *area, char *record, size_t size)
     memset(padding, 0xff, sizeof(padding));
 
     // compute CRC16 over the record
-    uint16_t crc = crc16_ccitt(0xffff, record, size);
+    uint16_t crc = orb_crc16_ccitt(0xffff, record, size);
 
     // size must be a multiple of FLASH_WRITE_BLOCK_SIZE
     // record will be padded with 0xff in case not
@@ -357,7 +358,7 @@ storage_push(struct storage_area_s *area, char *record, size_t size)
             size % FLASH_WRITE_BLOCK_SIZE);
     }
 
-    uint16_t rb_crc = crc16_ccitt(0xffff, record, size);
+    uint16_t rb_crc = orb_crc16_ccitt(0xffff, record, size);
     if (header.crc16 != rb_crc) {
         reset_area(area);
         LOG_ERR("Invalid CRC16 read after record has been written "
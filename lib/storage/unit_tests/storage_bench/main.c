@@ -0,0 +1,583 @@
+#include "storage.h"
+#include <errors.h>
+#include <string.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/ztest.h>
+
+/**
+ * Storage benchmark & power-loss suite, running against the flash simulator
+ * configured like the STM32G4 internal flash (see boards/native_sim.overlay).
+ *
+ * Flash accesses from `storage.c` go through the `bench_flash_area_*`
+ * functions below (see CMakeLists.txt) so that we can count operations,
+ * track erases per sector and cut power at any flash write.
+ *
+ * Each benchmark emits one line per measurement:
+ *   STORAGE_BENCH {"bench":"...", ...}
+ * Twister records them into `recording.csv`, otherwise grep `handler.log`.
+ */
+
+#define STORAGE_PARTITION_ID   FIXED_PARTITION_ID(storage_partition)
+#define STORAGE_PARTITION_SIZE DT_REG_SIZE(DT_NODELABEL(storage_partition))
+#define FLASH_ERASE_BLOCK_SIZE                                                 \
+    DT_PROP(DT_GPARENT(DT_NODELABEL(storage_partition)), erase_block_size)
+#define STORAGE_SECTOR_COUNT (STORAGE_PARTITION_SIZE / FLASH_ERASE_BLOCK_SIZE)
+
+BUILD_ASSERT(STORAGE_PARTITION_SIZE % FLASH_ERASE_BLOCK_SIZE == 0,
+             "storage partition must be made of entire sectors");
+
+// STM32G4 datasheet typical timings, used to model time spent on target
+#define STM32G4_FLASH_PROGRAM_DWORD_NS 81700
+#define STM32G4_FLASH_ERASE_PAGE_NS    22020000
+#define STM32G4_FLASH_READ_DWORD_NS    50
+
+#define BENCH_REPORT(fmt, ...) printk("STORAGE_BENCH {" fmt "}\n", __VA_ARGS__)
+
+#define RECORD_SIZE_MAX 256
+
+struct flash_counters {
+    uint32_t read_calls;
+    uint32_t bytes_read;
+    uint32_t write_calls;
+    uint32_t bytes_written;
+    uint32_t sectors_erased;
+    uint32_t sector_erases[STORAGE_SECTOR_COUNT];
+};
+
+static struct flash_counters counters;
+
+/// Number of flash program units (write blocks or erased sectors) allowed
+/// before power is cut, -1 to disable power-loss injection
+static int32_t power_budget = -1;
+static bool power_lost = false;
+
+static struct storage_area_s area;
+static uint8_t flash_snapshot[STORAGE_PARTITION_SIZE];
+
+int
+bench_flash_area_read(const struct flash_area *fa, off_t off, void *dst,
+                      size_t len)
+{
+    counters.read_calls++;
+    counters.bytes_read += len;
+
+    return flash_area_read(fa, off, dst, len);
+}
+
+int
+bench_flash_area_write(const struct flash_area *fa, off_t off,
+                       const void *src, size_t len)
+{
+    if (power_lost) {
+        return -EIO;
+    }
+
+    counters.write_calls++;
+
+    size_t blocks = DIV_ROUND_UP(len, FLASH_WRITE_BLOCK_SIZE);
+    if (power_budget >= 0 && blocks > (size_t)power_budget) {
+        // power is cut in the middle of the write: program units are
+        // considered atomic so only the units before the cut are written
+        size_t len_before_cut = (size_t)power_budget * FLASH_WRITE_BLOCK_SIZE;
+        power_budget = 0;
+        power_lost = true;
+        if (len_before_cut) {
+            counters.bytes_written += len_before_cut;
+            flash_area_write(fa, off, src, len_before_cut);
+        }
+        return -EIO;
+    }
+    if (power_budget >= 0) {
+        power_budget -= (int32_t)blocks;
+    }
+
+    counters.bytes_written += len;
+
+    return flash_area_write(fa, off, src, len);
+}
+
+int
+bench_flash_area_erase(const struct flash_area *fa, off_t off, size_t len)
+{
+    int ret = 0;
+
+    for (size_t sector_off = (size_t)off; sector_off < (size_t)off + len;
+         sector_off += FLASH_ERASE_BLOCK_SIZE) {
+        if (power_lost) {
+            return -EIO;
+        }
+        if (power_budget == 0) {
+            power_lost = true;
+            return -EIO;
+        }
+        if (power_budget > 0) {
+            power_budget--;
+        }
+
+        counters.sectors_erased++;
+        counters.sector_erases[sector_off / FLASH_ERASE_BLOCK_SIZE]++;
+        ret = flash_area_erase(fa, (off_t)sector_off, FLASH_ERASE_BLOCK_SIZE);
+        if (ret) {
+            break;
+        }
+    }
+
+    return ret;
+}
+
+static void
+counters_reset(void)
+{
+    memset(&counters, 0, sizeof(counters));
+}
+
+/// Time the flash operations would take on target, in microseconds
+static uint32_t
+counters_modeled_time_us(const struct flash_counters *c)
+{
+    uint64_t time_ns =
+        (uint64_t)(c->bytes_written / 8) * STM32G4_FLASH_PROGRAM_DWORD_NS +
+        (uint64_t)c->sectors_erased * STM32G4_FLASH_ERASE_PAGE_NS +
+        (uint64_t)(c->bytes_read / 8) * STM32G4_FLASH_READ_DWORD_NS;
+
+    return (uint32_t)(time_ns / 1000);
+}
+
+/// Deterministic record content so that any corruption can be detected and
+/// results are reproducible from one run to another
+static void
+record_fill(uint32_t seq, char *buf, size_t size)
+{
+    for (size_t i = 0; i < size; ++i) {
+        buf[i] = (char)(seq * 131 + i * 7 + 1);
+    }
+}
+
+static bool
+record_matches(uint32_t seq, const char *buf, size_t size)
+{
+    char expected[RECORD_SIZE_MAX];
+    record_fill(seq, expected, size);
+
+    return memcmp(expected, buf, size) == 0;
+}
+
+/// Push record #seq, `storage_push` overwrites the given buffer so a copy is
+/// made for each call
+static int
+record_push(uint32_t seq, size_t size)
+{
+    char record[RECORD_SIZE_MAX];
+    record_fill(seq, record, size);
+
+    return storage_push(&area, record, size);
+}
+
+static void
+partition_erase(void)
+{
+    const struct flash_area *fa;
+
+    int ret = flash_area_open(STORAGE_PARTITION_ID, &fa);
+    zassert_equal(ret, 0, "flash_area_open failed %d", ret);
+    ret = flash_area_erase(fa, 0, fa->fa_size);
+    zassert_equal(ret, 0, "flash_area_erase failed %d", ret);
+    flash_area_close(fa);
+}
+
+static void
+snapshot_save(void)
+{
+    const struct flash_area *fa;
+
+    zassert_ok(flash_area_open(STORAGE_PARTITION_ID, &fa));
+    zassert_ok(flash_area_read(fa, 0, flash_snapshot, sizeof(flash_snapshot)));
+    flash_area_close(fa);
+}
+
+static void
+snapshot_restore(void)
+{
+    const struct flash_area *fa;
+
+    zassert_ok(flash_area_open(STORAGE_PARTITION_ID, &fa));
+    zassert_ok(flash_area_erase(fa, 0, fa->fa_size));
+    zassert_ok(
+        flash_area_write(fa, 0, flash_snapshot, sizeof(flash_snapshot)));
+    flash_area_close(fa);
+}
+
+static void
+bench_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    power_budget = -1;
+    power_lost = false;
+    partition_erase();
+    counters_reset();
+
+    int ret = storage_init(&area, STORAGE_PARTITION_ID);
+    zassert_equal(ret, RET_SUCCESS, "storage_init failed %d", ret);
+}
+
+static void
+report_phase(const char *phase, size_t record_size, uint32_t ops)
+{
+    uint32_t modeled_us = counters_modeled_time_us(&counters);
+    uint32_t ops_per_s =
+        modeled_us ? (uint32_t)((uint64_t)ops * 1000000 / modeled_us) : 0;
+
+    BENCH_REPORT("\"bench\":\"throughput\",\"op\":\"%s\",\"record_size\":%u,"
+                 "\"ops\":%u,\"read_calls\":%u,\"bytes_read\":%u,"
+                 "\"write_calls\":%u,\"bytes_written\":%u,"
+                 "\"sectors_erased\":%u,\"modeled_us\":%u,"
+                 "\"modeled_ops_per_s\":%u",
+                 phase, (uint32_t)record_size, ops, counters.read_calls,
+                 counters.bytes_read, counters.write_calls,
+                 counters.bytes_written, counters.sectors_erased, modeled_us,
+                 ops_per_s);
+}
+
+ZTEST(storage_bench, test_throughput)
+{
+    const size_t record_sizes[] = {8, 24, 64, 200};
+
+    for (size_t s = 0; s < ARRAY_SIZE(record_sizes); ++s) {
+        const size_t size = record_sizes[s];
+        int ret;
+
+        partition_erase();
+        zassert_equal(storage_init(&area, STORAGE_PARTITION_ID),
+                      RET_SUCCESS);
+
+        // fill the area entirely
+        counters_reset();
+        uint32_t count = 0;
+        while ((ret = record_push(count, size)) == RET_SUCCESS) {
+            ++count;
+        }
+        zassert_equal(ret, RET_ERROR_NO_MEM, "push failed: %d", ret);
+        zassert_true(count > 0);
+        report_phase("push", size, count);
+
+        // read back every record, freeing them as we go without counting
+        // the free operations
+        struct flash_counters peek_counters = {0};
+        for (uint32_t i = 0; i < count; ++i) {
+            char buffer[RECORD_SIZE_MAX];
+            size_t buffer_size = sizeof(buffer);
+
+            counters_reset();
+            ret = storage_peek(&area, buffer, &buffer_size);
+            zassert_equal(ret, RET_SUCCESS, "peek #%u failed: %d", i, ret);
+            zassert_equal(buffer_size, size);
+            zassert_true(record_matches(i, buffer, size),
+                         "record #%u corrupted", i);
+            peek_counters.read_calls += counters.read_calls;
+            peek_counters.bytes_read += counters.bytes_read;
+
+            // last free resets the area, keep it out of the figures
+            if (i < count - 1) {
+                zassert_equal(storage_free(&area), RET_SUCCESS);
+            }
+        }
+        counters = peek_counters;
+        report_phase("peek", size, count);
+
+        // free on a full area again, timing only the free operations
+        partition_erase();
+        zassert_equal(storage_init(&area, STORAGE_PARTITION_ID),
+                      RET_SUCCESS);
+        for (uint32_t i = 0; i < count; ++i) {
+            zassert_equal(record_push(i, size), RET_SUCCESS);
+        }
+        counters_reset();
+        for (uint32_t i = 0; i < count; ++i) {
+            ret = storage_free(&area);
+            zassert_equal(ret, RET_SUCCESS, "free #%u failed: %d", i, ret);
+        }
+        report_phase("free", size, count);
+        zassert_false(storage_has_data(&area));
+    }
+}
+
+ZTEST(storage_bench, test_wear)
+{
+    const size_t size = 24;
+    const uint32_t cycles = 2000;
+    // records are pushed by bursts then all read, like when the Jetson
+    // is busy and then catches up
+    const uint32_t burst = 10;
+    uint32_t next_expected = 0;
+
+    counters_reset();
+    for (uint32_t seq = 0; seq < cycles; ++seq) {
+        zassert_equal(record_push(seq, size), RET_SUCCESS,
+                      "push failed at record #%u", seq);
+        if ((seq + 1) % burst) {
+            continue;
+        }
+
+        while (storage_has_data(&area)) {
+            char buffer[RECORD_SIZE_MAX];
+            size_t buffer_size = sizeof(buffer);
+
+            zassert_equal(storage_peek(&area, buffer, &buffer_size),
+                          RET_SUCCESS);
+            zassert_true(record_matches(next_expected, buffer, buffer_size),
+                         "record #%u corrupted", next_expected);
+            zassert_equal(storage_free(&area), RET_SUCCESS);
+            next_expected++;
+        }
+    }
+
+    uint32_t erases_min = UINT32_MAX;
+    uint32_t erases_max = 0;
+    char erases_json[STORAGE_SECTOR_COUNT * 11 + 1] = {0};
+    size_t json_len = 0;
+    for (size_t i = 0; i < STORAGE_SECTOR_COUNT; ++i) {
+        erases_min = MIN(erases_min, counters.sector_erases[i]);
+        erases_max = MAX(erases_max, counters.sector_erases[i]);
+        json_len += snprintk(&erases_json[json_len],
+                             sizeof(erases_json) - json_len, "%s%u",
+                             i ? "," : "", counters.sector_erases[i]);
+    }
+
+    BENCH_REPORT("\"bench\":\"wear\",\"record_size\":%u,\"records\":%u,"
+                 "\"sector_size\":%u,\"sector_erases\":[%s],"
+                 "\"erases_min\":%u,\"erases_max\":%u,"
+                 "\"bytes_written\":%u,\"records_per_sector_erase\":%u",
+                 (uint32_t)size, cycles, (uint32_t)FLASH_ERASE_BLOCK_SIZE,
+                 erases_json, erases_min, erases_max, counters.bytes_written,
+                 erases_max ? cycles / erases_max : 0);
+
+    // the whole area is erased at once when full: wear must be even
+    zassert_true(erases_max - erases_min <= 1, "uneven wear: %u..%u",
+                 erases_min, erases_max);
+}
+
+/// Fill `percent` of the area with records, freeing them if `freed`
+static uint32_t
+area_fill(uint32_t percent, size_t size, bool freed)
+{
+    const size_t target = STORAGE_PARTITION_SIZE * percent / 100;
+    uint32_t count = 0;
+
+    while ((size_t)area.wr_idx < target &&
+           record_push(count, size) == RET_SUCCESS) {
+        ++count;
+    }
+
+    // keep the last one valid so that the area isn't reset
+    for (uint32_t i = 0; freed && i + 1 < count; ++i) {
+        zassert_equal(storage_free(&area), RET_SUCCESS);
+    }
+
+    return count;
+}
+
+ZTEST(storage_bench, test_init_vs_fill_level)
+{
+    const uint32_t fill_levels[] = {0, 25, 50, 75, 100};
+    const size_t size = 24;
+
+    for (int freed = 0; freed <= 1; ++freed) {
+        for (size_t f = 0; f < ARRAY_SIZE(fill_levels); ++f) {
+            partition_erase();
+            zassert_equal(storage_init(&area, STORAGE_PARTITION_ID),
+                          RET_SUCCESS);
+            uint32_t count = area_fill(fill_levels[f], size, freed);
+
+            counters_reset();
+            int ret = storage_init(&area, STORAGE_PARTITION_ID);
+            zassert_equal(ret, RET_SUCCESS, "init failed: %d", ret);
+
+            BENCH_REPORT("\"bench\":\"init\",\"fill_percent\":%u,"
+                         "\"records\":%u,\"freed\":%s,\"read_calls\":%u,"
+                         "\"bytes_read\":%u,\"modeled_us\":%u",
+                         fill_levels[f], count, freed ? "true" : "false",
+                         counters.read_calls, counters.bytes_read,
+                         counters_modeled_time_us(&counters));
+        }
+    }
+}
+
+struct power_loss_stats {
+    uint32_t cut_points;
+    uint32_t corrupted;
+    uint32_t new_record_kept;
+    uint32_t new_record_dropped;
+    uint32_t old_records_lost;
+    uint32_t area_resets_on_next_push;
+};
+
+/// Records expected in storage after a power loss
+struct expected_records {
+    uint32_t first_seq;  //!< oldest record
+    uint32_t end_seq;    //!< one past the newest record
+    bool first_optional; //!< oldest record might have been freed
+    bool last_optional;  //!< newest record might not have been written
+};
+
+/// Reboot after a power loss: initialize the area from flash content, make
+/// sure no corrupted record is ever returned, then check that new records
+/// can be written
+static void
+power_loss_verify(struct power_loss_stats *stats,
+                  const struct expected_records *expected, size_t size)
+{
+    int ret = storage_init(&area, STORAGE_PARTITION_ID);
+    zassert_equal(ret, RET_SUCCESS, "init after power loss failed: %d", ret);
+
+    uint32_t seq = expected->first_seq;
+    while (storage_has_data(&area)) {
+        char buffer[RECORD_SIZE_MAX];
+        size_t buffer_size = sizeof(buffer);
+
+        ret = storage_peek(&area, buffer, &buffer_size);
+        if (ret == RET_SUCCESS && expected->first_optional &&
+            seq == expected->first_seq && seq + 1 < expected->end_seq &&
+            buffer_size == size && record_matches(seq + 1, buffer, size)) {
+            seq++;
+        }
+        if (ret != RET_SUCCESS || seq >= expected->end_seq ||
+            buffer_size != size || !record_matches(seq, buffer, size)) {
+            stats->corrupted++;
+            break;
+        }
+        seq++;
+        zassert_equal(storage_free(&area), RET_SUCCESS);
+    }
+
+    uint32_t mandatory_end = expected->end_seq;
+    if (expected->last_optional) {
+        mandatory_end--;
+        if (seq == expected->end_seq) {
+            stats->new_record_kept++;
+        } else {
+            stats->new_record_dropped++;
+        }
+    }
+    if (seq < mandatory_end) {
+        stats->old_records_lost += mandatory_end - seq;
+    }
+
+    // a power loss might leave programmed bytes after the write index, the
+    // storage must detect it and recover
+    ret = record_push(UINT16_MAX, size);
+    if (ret == RET_ERROR_INVALID_STATE) {
+        stats->area_resets_on_next_push++;
+        ret = record_push(UINT16_MAX, size);
+    }
+    zassert_equal(ret, RET_SUCCESS, "unable to push after power loss: %d",
+                  ret);
+}
+
+static void
+report_power_loss(const char *op, const struct power_loss_stats *stats)
+{
+    BENCH_REPORT("\"bench\":\"power_loss\",\"op\":\"%s\",\"cut_points\":%u,"
+                 "\"corrupted\":%u,\"new_record_kept\":%u,"
+                 "\"new_record_dropped\":%u,\"old_records_lost\":%u,"
+                 "\"area_resets_on_next_push\":%u",
+                 op, stats->cut_points, stats->corrupted,
+                 stats->new_record_kept, stats->new_record_dropped,
+                 stats->old_records_lost, stats->area_resets_on_next_push);
+}
+
+ZTEST(storage_bench, test_power_loss_push)
+{
+    const size_t sizes[] = {24, 29};
+    struct power_loss_stats stats = {0};
+
+    for (size_t s = 0; s < ARRAY_SIZE(sizes); ++s) {
+        const size_t size = sizes[s];
+        const uint32_t existing = 3;
+
+        // initial state: one freed record followed by valid ones
+        partition_erase();
+        zassert_equal(storage_init(&area, STORAGE_PARTITION_ID),
+                      RET_SUCCESS);
+        for (uint32_t i = 0; i <= existing; ++i) {
+            zassert_equal(record_push(i, size), RET_SUCCESS);
+        }
+        zassert_equal(storage_free(&area), RET_SUCCESS);
+        snapshot_save();
+
+        // count flash program units used by an uninterrupted push
+        power_budget = INT32_MAX;
+        zassert_equal(record_push(existing + 1, size), RET_SUCCESS);
+        const uint32_t units = (uint32_t)(INT32_MAX - power_budget);
+        power_budget = -1;
+
+        // cut power before each of them
+        for (uint32_t cut = 0; cut < units; ++cut) {
+            snapshot_restore();
+            zassert_equal(storage_init(&area, STORAGE_PARTITION_ID),
+                          RET_SUCCESS);
+
+            power_lost = false;
+            power_budget = (int32_t)cut;
+            (void)record_push(existing + 1, size);
+            power_budget = -1;
+            power_lost = false;
+
+            const struct expected_records expected = {
+                .first_seq = 1,
+                .end_seq = existing + 2,
+                .first_optional = false,
+                .last_optional = true,
+            };
+            stats.cut_points++;
+            power_loss_verify(&stats, &expected, size);
+        }
+    }
+
+    report_power_loss("push", &stats);
+    zassert_equal(stats.corrupted, 0, "corrupted records returned");
+    zassert_equal(stats.old_records_lost, 0, "previous records lost");
+}
+
+ZTEST(storage_bench, test_power_loss_free)
+{
+    const size_t size = 24;
+    const uint32_t existing = 3;
+    struct power_loss_stats stats = {0};
+
+    for (uint32_t i = 0; i < existing; ++i) {
+        zassert_equal(record_push(i, size), RET_SUCCESS);
+    }
+    snapshot_save();
+
+    power_budget = INT32_MAX;
+    zassert_equal(storage_free(&area), RET_SUCCESS);
+    const uint32_t units = (uint32_t)(INT32_MAX - power_budget);
+    power_budget = -1;
+
+    for (uint32_t cut = 0; cut < units; ++cut) {
+        snapshot_restore();
+        zassert_equal(storage_init(&area, STORAGE_PARTITION_ID), RET_SUCCESS);
+
+        power_lost = false;
+        power_budget = (int32_t)cut;
+        (void)storage_free(&area);
+        power_budget = -1;
+        power_lost = false;
+
+        // the record being freed might still be there
+        const struct expected_records expected = {
+            .first_seq = 0,
+            .end_seq = existing,
+            .first_optional = true,
+            .last_optional = false,
+        };
+        stats.cut_points++;
+        power_loss_verify(&stats, &expected, size);
+    }
+
+    report_power_loss("free", &stats);
+    zassert_equal(stats.corrupted, 0, "corrupted records returned");
+}
+
+ZTEST_SUITE(storage_bench, NULL, NULL, bench_before, NULL, NULL);
@@ -38,10 +38,6 @@
 #define THREAD_PRIORITY_CONE_RGB_LEDS   7
 #define THREAD_STACK_SIZE_CONE_RGB_LEDS 1024
 
-// Cone button
-#define THREAD_PRIORITY_CONE_BUTTON   8
-#define THREAD_STACK_SIZE_CONE_BUTTON 592
-
 // white LEDs
 #define THREAD_PRIORITY_WHITE_LEDS   9
 #define THREAD_STACK_SIZE_WHITE_LEDS 512
@@ -51,25 +47,23 @@
 #define THREAD_PRIORITY_LIQUID_LENS   7
 #define THREAD_STACK_SIZE_LIQUID_LENS 512
 
-// Temperature
-#define THREAD_PRIORITY_TEMPERATURE   8
-#define THREAD_STACK_SIZE_TEMPERATURE 2048
-
-// Fan Tachometer
-#define THREAD_PRIORITY_FAN_TACH   8
-#define THREAD_STACK_SIZE_FAN_TACH 1024
-
-// 1D ToF
-#define THREAD_PRIORITY_1DTOF   9
-#define THREAD_STACK_SIZE_1DTOF 1048
-
-// ALS
-#define THREAD_PRIORITY_ALS   11
-#define THREAD_STACK_SIZE_ALS 900
+// Sensor executor, periodic jobs of: fan tachometer, voltages publishing,
+// cone button
+// stack sized for the deepest job (voltages publishing)
+#define THREAD_PRIORITY_SENSOR_EXECUTOR   8
+#define THREAD_STACK_SIZE_SENSOR_EXECUTOR 2048
+// jobs accessing I2C buses: temperature, 1D ToF, ALS
+// stack sized for the deepest job (temperature)
+#define THREAD_PRIORITY_SENSOR_EXECUTOR_BUS   9
+#define THREAD_STACK_SIZE_SENSOR_EXECUTOR_BUS 2048
 
 #define THREAD_PRIORITY_MIRROR_INIT   12
 #define THREAD_STACK_SIZE_MIRROR_INIT 2048 // * 2 threads (pearl)
 
+// Mirror motion controller SPI transfers, ahead of the mirror work queue
+#define THREAD_PRIORITY_MOTOR_SPI   7
+#define THREAD_STACK_SIZE_MOTOR_SPI 1024
+
 // Polarizer Wheel Homing
 #define THREAD_PRIORITY_POLARIZER_WHEEL        5
 #define THREAD_STACK_SIZE_POLARIZER_WHEEL_HOME 2048
@@ -96,9 +90,6 @@
 #define THREAD_PRIORITY_VOLTAGE_MEASUREMENT_SELFTEST   12
 #define THREAD_STACK_SIZE_VOLTAGE_MEASUREMENT_SELFTEST 1300
 
-#define THREAD_PRIORITY_VOLTAGE_MEASUREMENT_PUBLISH   11
-#define THREAD_STACK_SIZE_VOLTAGE_MEASUREMENT_PUBLISH 2048
-
 // Testing threads
 // - CAN
 // - DFU
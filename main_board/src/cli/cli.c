@@ -9,16 +9,24 @@
 #include <bootutil/image.h>
 #include <compilers.h>
 #include <main.pb.h>
+#include <optics/ir_camera_system/ir_camera_system.h>
 #include <optics/ir_camera_system/ir_camera_timer_settings.h>
+#include <optics/mirror/mirror.h>
 #include <optics/polarizer_wheel/polarizer_wheel.h>
 #include <orb_state.h>
 #include <power/battery/battery.h>
 #include <runner/runner.h>
 #include <sec.pb.h>
 #include <stdlib.h>
+#include <system/boot_timeline.h>
+#include <system/cpu_usage.h>
+#include <system/isr_trace.h>
 #include <system/ping_sec.h>
+#include <system/sensor_executor.h>
 #include <system/version/version.h>
 #include <ui/rgb_leds/operator_leds/operator_leds.h>
+#include <voltage_measurement/ir_led_rail.h>
+#include <voltage_measurement/voltage_measurement.h>
 #include <zephyr/shell/shell.h>
 
 LOG_MODULE_REGISTER(cli, LOG_LEVEL_INF);
@@ -56,6 +64,17 @@ execute_version(const struct shell *sh, size_t argc, char **argv)
     return 0;
 }
 
+static int
+execute_boot_timeline(const struct shell *sh, size_t argc, char **argv)
+{
+    UNUSED_PARAMETER(argc);
+    UNUSED_PARAMETER(argv);
+
+    boot_timeline_print(sh);
+
+    return 0;
+}
+
 static int
 execute_state(const struct shell *sh, size_t argc, char **argv)
 {
@@ -764,6 +783,255 @@ execute_runner_stats(const struct shell *sh, size_t argc, char **argv)
     return 0;
 }
 
+static int
+execute_sensor_jobs(const struct shell *sh, size_t argc, char **argv)
+{
+    UNUSED_PARAMETER(argc);
+    UNUSED_PARAMETER(argv);
+
+    sensor_executor_print(sh);
+    return 0;
+}
+
+#if defined(CONFIG_CPU_USAGE_PROFILER)
+static int
+execute_cpu(const struct shell *sh, size_t argc, char **argv)
+{
+    UNUSED_PARAMETER(argc);
+    UNUSED_PARAMETER(argv);
+
+    cpu_usage_print((void *)sh);
+    return 0;
+}
+#endif
+
+#if defined(CONFIG_ISR_TRACE)
+static int
+execute_isr_trace(const struct shell *sh, size_t argc, char **argv)
+{
+    if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+        isr_trace_reset();
+        return 0;
+    }
+    if (argc != 1) {
+        shell_error(sh, "Usage: orb isr_trace [reset]");
+        return -EINVAL;
+    }
+
+    isr_trace_print((void *)sh);
+    return 0;
+}
+#endif
+
+#if defined(CONFIG_IR_LED_RAIL)
+static int32_t
+pvcc_raw_to_mv(uint32_t raw)
+{
+    int32_t mv = 0;
+    (void)voltage_measurement_raw_to_mv(CHANNEL_PVCC, (uint16_t)raw, &mv);
+    return mv;
+}
+
+static int
+execute_led_rail(const struct shell *sh, size_t argc, char **argv)
+{
+    UNUSED_PARAMETER(argc);
+    UNUSED_PARAMETER(argv);
+
+    static const char *const names[IR_LED_RAIL_COUNT] = {
+        [IR_LED_RAIL_850NM] = "850nm",
+        [IR_LED_RAIL_940NM] = "940nm",
+    };
+
+    for (size_t i = 0; i < IR_LED_RAIL_COUNT; ++i) {
+        struct ir_led_rail_stats stats;
+        ir_led_rail_get_stats(i, &stats);
+        const uint32_t n = MAX(stats.strobes, 1);
+
+        shell_print(sh, "%s: %u strobes, %u missed", names[i], stats.strobes,
+                    stats.missed);
+        shell_print(sh, "  start: %d mV [%d, %d]",
+                    pvcc_raw_to_mv(stats.start_sum / n),
+                    pvcc_raw_to_mv(stats.start_min),
+                    pvcc_raw_to_mv(stats.start_max));
+        shell_print(sh, "  end:   %d mV [%d, %d], droop max %d mV",
+                    pvcc_raw_to_mv(stats.end_sum / n),
+                    pvcc_raw_to_mv(stats.end_min),
+                    pvcc_raw_to_mv(stats.end_max),
+                    pvcc_raw_to_mv(stats.droop_max));
+    }
+
+    return 0;
+}
+#endif
+
+static const char *const sweep_actuator_names[IR_CAMERA_SWEEP_ACTUATOR_COUNT] =
+    {
+        [IR_CAMERA_SWEEP_LIQUID_LENS] = "lens",
+        [IR_CAMERA_SWEEP_MIRROR_PHI] = "phi",
+        [IR_CAMERA_SWEEP_MIRROR_THETA] = "theta",
+        [IR_CAMERA_SWEEP_POLARIZER] = "polarizer",
+        [IR_CAMERA_SWEEP_IR_LED_ON_TIME] = "on_time",
+};
+
+static int
+sweep_actuator_from_name(const char *name)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(sweep_actuator_names); ++i) {
+        if (strcmp(name, sweep_actuator_names[i]) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static int
+execute_sweep(const struct shell *sh, size_t argc, char **argv)
+{
+    if (argc >= 3 && strcmp(argv[1], "table") == 0) {
+        const int actuator = sweep_actuator_from_name(argv[2]);
+        if (actuator < 0) {
+            shell_error(sh, "Unknown actuator: %s", argv[2]);
+            return -EINVAL;
+        }
+
+        int16_t values[CONFIG_SHELL_ARGC_MAX];
+        const size_t num_frames = argc - 3;
+        for (size_t i = 0; i < num_frames; ++i) {
+            values[i] = (int16_t)strtol(argv[3 + i], NULL, 10);
+        }
+
+        const ret_code_t ret =
+            ir_camera_system_set_sweep_table(actuator, values, num_frames);
+        if (ret != RET_SUCCESS) {
+            shell_error(sh, "Unable to set table: %d", ret);
+            return -EINVAL;
+        }
+        shell_print(sh, "%s: %zu frames", argv[2], num_frames);
+        return 0;
+    }
+
+    if (argc >= 3 && strcmp(argv[1], "start") == 0) {
+        uint32_t actuators = 0;
+        for (size_t i = 2; i < argc; ++i) {
+            const int actuator = sweep_actuator_from_name(argv[i]);
+            if (actuator < 0) {
+                shell_error(sh, "Unknown actuator: %s", argv[i]);
+                return -EINVAL;
+            }
+            actuators |= BIT(actuator);
+        }
+
+        const ret_code_t ret = ir_camera_system_perform_sweep(actuators);
+        if (ret != RET_SUCCESS) {
+            shell_error(sh, "Unable to start sweep: %d", ret);
+            return -EINVAL;
+        }
+        return 0;
+    }
+
+    shell_error(sh, "Usage: orb sweep table <actuator> [setpoints...]");
+    shell_error(sh, "       orb sweep start <actuator> [actuator...]");
+    shell_print(sh, "Actuators: lens (mA), phi, theta (relative mdeg), "
+                    "polarizer (ddeg), on_time (us)");
+    return -EINVAL;
+}
+
+static int
+schedule_camera_from_name(const char *name)
+{
+    static const char *const names[IR_CAMERA_SCHEDULE_CAMERA_COUNT] = {
+        [IR_CAMERA_SCHEDULE_IR_EYE] = "eye",
+        [IR_CAMERA_SCHEDULE_IR_FACE] = "face",
+        [IR_CAMERA_SCHEDULE_TOF_2D] = "tof",
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(names); ++i) {
+        if (strcmp(name, names[i]) == 0) {
+            return (int)i;
+        }
+    }
+
+    return -1;
+}
+
+static int
+execute_schedule(const struct shell *sh, size_t argc, char **argv)
+{
+    ret_code_t ret;
+
+    if (argc == 2 && strcmp(argv[1], "clear") == 0) {
+        ret = ir_camera_system_set_schedule(NULL);
+    } else if (argc >= 4 && (argc - 1) % 3 == 0) {
+        struct ir_camera_schedule schedule = {0};
+        for (size_t i = 1; i < argc; i += 3) {
+            const int camera = schedule_camera_from_name(argv[i]);
+            if (camera < 0) {
+                shell_error(sh, "Unknown camera: %s", argv[i]);
+                return -EINVAL;
+            }
+            schedule.slots[camera].used = true;
+            schedule.slots[camera].phase_us = strtoul(argv[i + 1], NULL, 10);
+            schedule.slots[camera].window_us = strtoul(argv[i + 2], NULL, 10);
+        }
+        ret = ir_camera_system_set_schedule(&schedule);
+    } else {
+        shell_error(sh, "Usage: orb schedule <camera> <phase_us> <window_us> "
+                        "[<camera> <phase_us> <window_us>...]");
+        shell_error(sh, "       orb schedule clear");
+        shell_print(sh, "Cameras: eye, face, tof");
+        return -EINVAL;
+    }
+
+    if (ret != RET_SUCCESS) {
+        shell_error(sh, "Unable to set schedule: %d", ret);
+        return -EINVAL;
+    }
+    return 0;
+}
+
+#if defined(CONFIG_MIRROR_TRAJECTORY)
+static int
+execute_trajectory(const struct shell *sh, size_t argc, char **argv)
+{
+    ret_code_t ret;
+
+    if (argc == 3 && strcmp(argv[1], "start") == 0 &&
+        strcmp(argv[2], "ms") == 0) {
+        ret = mirror_trajectory_start(MIRROR_TRAJECTORY_TIMEBASE_MS);
+    } else if (argc == 3 && strcmp(argv[1], "start") == 0 &&
+               strcmp(argv[2], "frames") == 0) {
+        ret = mirror_trajectory_start(MIRROR_TRAJECTORY_TIMEBASE_FRAMES);
+    } else if (argc >= 5 && strcmp(argv[1], "add") == 0 &&
+               (argc - 2) % 3 == 0) {
+        struct mirror_waypoint waypoints[CONFIG_SHELL_ARGC_MAX / 3];
+        const size_t count = (argc - 2) / 3;
+        for (size_t i = 0; i < count; ++i) {
+            waypoints[i].at = strtoul(argv[2 + 3 * i], NULL, 10);
+            waypoints[i].phi_millidegrees = strtoul(argv[3 + 3 * i], NULL, 10);
+            waypoints[i].theta_millidegrees =
+                strtoul(argv[4 + 3 * i], NULL, 10);
+        }
+        ret = mirror_trajectory_add_waypoints(waypoints, count);
+    } else if (argc == 2 && strcmp(argv[1], "stop") == 0) {
+        mirror_trajectory_stop();
+        ret = RET_SUCCESS;
+    } else {
+        shell_error(sh, "Usage: orb trajectory start <ms|frames>");
+        shell_error(sh, "       orb trajectory add <at> <phi_millidegrees> "
+                        "<theta_millidegrees> [<at> <phi> <theta>...]");
+        shell_error(sh, "       orb trajectory stop");
+        return -EINVAL;
+    }
+
+    if (ret != RET_SUCCESS) {
+        shell_error(sh, "Trajectory error: %d", ret);
+        return -EINVAL;
+    }
+    return 0;
+}
+#endif
+
 static int
 execute_ping_sec(const struct shell *sh, size_t argc, char **argv)
 {
@@ -802,6 +1070,70 @@ execute_dfu_secondary_activate(const struct shell *sh, size_t argc, char **argv)
     return ret;
 }
 
+static K_SEM_DEFINE(dfu_check_sem, 0, 1);
+static int dfu_check_err_code;
+
+static void
+dfu_check_cb(void *ctx, int err)
+{
+    UNUSED_PARAMETER(ctx);
+
+    dfu_check_err_code = err;
+    k_sem_give(&dfu_check_sem);
+}
+
+static int
+execute_dfu_check(const struct shell *sh, size_t argc, char **argv)
+{
+    if (argc < 2 || argc > 3 || (argc == 3 && strcmp(argv[2], "full") != 0)) {
+        shell_error(sh, "Usage: orb dfu_check <crc32> [full]");
+        return -EINVAL;
+    }
+
+    uint32_t crc32 = strtoul(argv[1], NULL, 0);
+    bool full_readback = (argc == 3);
+
+    k_sem_reset(&dfu_check_sem);
+    int ret = dfu_secondary_check_async(crc32, full_readback, NULL,
+                                        dfu_check_cb);
+    if (ret != -EINPROGRESS) {
+        shell_error(sh, "Unable to check secondary slot: %d", ret);
+        return ret;
+    }
+
+    // full read-back of the external Flash takes more than a second
+    if (k_sem_take(&dfu_check_sem, K_SECONDS(5)) != 0) {
+        shell_error(sh, "Secondary slot check timed out");
+        return -ETIMEDOUT;
+    }
+
+    if (dfu_check_err_code == RET_SUCCESS) {
+        shell_print(sh, "Secondary slot CRC32 matches 0x%08x", crc32);
+    } else {
+        shell_error(sh, "Secondary slot check failed: %d", dfu_check_err_code);
+    }
+
+    return dfu_check_err_code;
+}
+
+static int
+execute_dfu_resume(const struct shell *sh, size_t argc, char **argv)
+{
+    UNUSED_PARAMETER(argc);
+    UNUSED_PARAMETER(argv);
+
+    uint32_t image_id, block_number, block_count;
+    int ret = dfu_resume_point_get(&image_id, &block_number, &block_count);
+    if (ret != RET_SUCCESS) {
+        shell_print(sh, "No firmware image transfer to resume");
+        return 0;
+    }
+
+    shell_print(sh, "Image 0x%08x: resume from block %u/%u", image_id,
+                block_number, block_count);
+    return 0;
+}
+
 static int
 execute_boot_config(const struct shell *sh, size_t argc, char **argv)
 {
@@ -843,6 +1175,8 @@ SHELL_STATIC_SUBCMD_SET_CREATE(
               execute_reboot),
     SHELL_CMD(version, NULL, "Show firmware and hardware versions",
               execute_version),
+    SHELL_CMD(boot_timeline, NULL, "Show duration of boot steps",
+              execute_boot_timeline),
     SHELL_CMD(state, NULL, "Show hardware states", execute_state),
     SHELL_CMD(battery, NULL, "Show battery information", execute_battery),
     SHELL_CMD(fan, NULL, "Control fan speed", execute_fan),
@@ -865,10 +1199,45 @@ SHELL_STATIC_SUBCMD_SET_CREATE(
     SHELL_CMD(boot_config, NULL, "Get/set boot behavior (button|always_on)",
               execute_boot_config),
     SHELL_CMD(stats, NULL, "Show runner statistics", execute_runner_stats),
+    SHELL_CMD(sensor_jobs, NULL, "Show sensor jobs runtime statistics",
+              execute_sensor_jobs),
+#if defined(CONFIG_CPU_USAGE_PROFILER)
+    SHELL_CMD(cpu, NULL,
+              "Show CPU usage of threads and ISRs since the previous report",
+              execute_cpu),
+#endif
+#if defined(CONFIG_ISR_TRACE)
+    SHELL_CMD(isr_trace, NULL,
+              "Show ISR latency and duration histograms ([reset] to clear)",
+              execute_isr_trace),
+#endif
+#if defined(CONFIG_IR_LED_RAIL)
+    SHELL_CMD(led_rail, NULL,
+              "Show the IR LED supply sampled during the strobes, since the "
+              "last report",
+              execute_led_rail),
+#endif
+    SHELL_CMD(sweep, NULL, "Set up and start IR eye camera sweeps",
+              execute_sweep),
+    SHELL_CMD(schedule, NULL, "Set the camera trigger phases (clear to reset)",
+              execute_schedule),
+#if defined(CONFIG_MIRROR_TRAJECTORY)
+    SHELL_CMD(trajectory, NULL,
+              "Execute timed mirror waypoints (start, add, stop)",
+              execute_trajectory),
+#endif
     SHELL_CMD(ping_sec, NULL, "Send ping to security MCU", execute_ping_sec),
     SHELL_CMD(dfu_secondary_activate, NULL,
               "Activate secondary image (permanent|temporary)",
               execute_dfu_secondary_activate),
+    SHELL_CMD(dfu_check, NULL,
+              "Check secondary image CRC32, optionally reading back the "
+              "entire slot (<crc32> [full])",
+              execute_dfu_check),
+    SHELL_CMD(dfu_resume, NULL,
+              "Print the block from which the firmware image transfer can be "
+              "resumed",
+              execute_dfu_resume),
     SHELL_SUBCMD_SET_END);
 
 SHELL_CMD_REGISTER(orb, &sub_orb, "Orb commands", NULL);
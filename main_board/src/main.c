@@ -10,6 +10,11 @@
 #include "power/boot/boot.h"
 #include "pubsub/pubsub.h"
 #include "runner/runner.h"
+#include "system/boot_sequence.h"
+#include "system/boot_timeline.h"
+#include "system/cpu_usage.h"
+#include "system/isr_trace.h"
+#include "system/sensor_executor.h"
 #include "system/version/version.h"
 #include "temperature/fan/fan.h"
 #include "temperature/fan/fan_tach.h"
@@ -271,6 +276,74 @@ send_mcu_ping(orb_mcu_Ping *ping)
                        CONFIG_CAN_ADDRESS_MCU_TO_MCU_TX);
 }
 
+/* steps of the boot sequence depending on other modules being ready */
+enum boot_step_e {
+    BOOT_STEP_SUPER_CAPS = 0,
+    BOOT_STEP_PVCC,
+    BOOT_STEP_OPTICS,
+    BOOT_STEP_OPTICS_PROGRESS,
+    BOOT_STEP_FAN_TACH,
+    BOOT_STEP_COUNT
+};
+
+#if !defined(CONFIG_NO_SUPER_CAPS) && !defined(CONFIG_CI_INTEGRATION_TESTS)
+/**
+ * Super-caps charging draws a lot of current, which is needed for
+ * proper Jetson boot: wait for the Jetson to talk to us
+ */
+static bool
+boot_jetson_alive(void)
+{
+    return runner_successful_jobs_count() > 0;
+}
+
+/**
+ * Super-caps must be charged enough so that turning on PVCC doesn't cause a
+ * brownout, which then disable PVCC (circuitry) back and forth until
+ * stabilized. VCaps voltage is thus kept stable.
+ */
+static bool
+boot_super_caps_charged(void)
+{
+    int32_t voltage_mv = 0;
+
+    return voltage_measurement_get(CHANNEL_12V_CAPS, &voltage_mv) ==
+               RET_SUCCESS &&
+           voltage_mv >= CONFIG_BOOT_SUPER_CAPS_CHARGED_MV;
+}
+#endif
+
+static int
+boot_optics_init(void)
+{
+    orb_mcu_Hardware hw = version_get();
+
+    BOOT_TIMELINE_RECORD("optics_init",
+                         optics_init(&hw, &analog_and_i2c_mutex));
+
+    return RET_SUCCESS;
+}
+
+static int
+boot_optics_progress(void)
+{
+    front_leds_boot_progress_set(BOOT_PROGRESS_STEP_OPTICS_INITIALIZED);
+
+    return RET_SUCCESS;
+}
+
+#if defined(CONFIG_BOARD_DIAMOND_MAIN)
+static int
+boot_fan_tach_init_if_no_polarizer(void)
+{
+    if (polarizer_wheel_homed()) {
+        return RET_SUCCESS;
+    }
+
+    return fan_tach_init();
+}
+#endif
+
 static void
 initialize(void)
 {
@@ -278,13 +351,28 @@ initialize(void)
 
     fatal_init();
 
-    err_code = pubsub_storage_init();
+    BOOT_TIMELINE_RECORD("pubsub_storage_init",
+                         err_code = pubsub_storage_init());
     ASSERT_SOFT(err_code);
 
     // initialize runner before communication modules
-    runner_init();
+    BOOT_TIMELINE_RECORD("runner_init", runner_init());
     ping_init(send_mcu_ping);
 
+    // periodic jobs of sensor modules, initialized below
+    err_code = sensor_executor_init();
+    ASSERT_SOFT(err_code);
+
+#if defined(CONFIG_CPU_USAGE_PROFILER)
+    err_code = cpu_usage_init();
+    ASSERT_SOFT(err_code);
+#endif
+
+#if defined(CONFIG_ISR_TRACE)
+    err_code = isr_trace_init();
+    ASSERT_SOFT(err_code);
+#endif
+
     app_assert_init(app_assert_cb);
 
 #if CONFIG_ORB_LIB_WATCHDOG && !(CONFIG_ORB_LIB_WATCHDOG_SYS_INIT)
@@ -293,7 +381,9 @@ initialize(void)
 #endif
 
 #if CONFIG_ORB_LIB_CAN_MESSAGING
-    err_code = can_messaging_init(runner_handle_new_can);
+    BOOT_TIMELINE_RECORD(
+        "can_messaging_init",
+        err_code = can_messaging_init(runner_handle_new_can));
     ASSERT_SOFT(err_code);
 #endif
 
@@ -309,7 +399,9 @@ initialize(void)
 
     // voltage_measurement module is used by battery and boot -> must be
     // initialized before
-    err_code = voltage_measurement_init(&hw, &analog_and_i2c_mutex);
+    BOOT_TIMELINE_RECORD(
+        "voltage_measurement_init",
+        err_code = voltage_measurement_init(&hw, &analog_and_i2c_mutex));
     ASSERT_SOFT(err_code);
 
     // logs over CAN must be initialized after CAN-messaging module
@@ -323,23 +415,25 @@ initialize(void)
 #endif
 
     // check battery state early on
-    err_code = battery_init();
+    BOOT_TIMELINE_RECORD("battery_init", err_code = battery_init());
     ASSERT_SOFT(err_code);
 
 #ifndef CONFIG_NO_JETSON_BOOT
-    err_code = boot_turn_on_jetson();
+    BOOT_TIMELINE_RECORD("boot_turn_on_jetson",
+                         err_code = boot_turn_on_jetson());
     ASSERT_SOFT(err_code);
 #endif // CONFIG_NO_JETSON_BOOT
 
     err_code = fan_init();
     ASSERT_SOFT(err_code);
 
-    temperature_init(&hw, &analog_and_i2c_mutex);
+    BOOT_TIMELINE_RECORD("temperature_init",
+                         temperature_init(&hw, &analog_and_i2c_mutex));
 
     err_code = sound_init(&hw);
     ASSERT_SOFT(err_code);
 
-    err_code = ui_init(&hw);
+    BOOT_TIMELINE_RECORD("ui_init", err_code = ui_init(&hw));
     ASSERT_SOFT(err_code);
 
     // first call to indicate boot progress
@@ -348,7 +442,7 @@ initialize(void)
     err_code = als_init(&hw, &analog_and_i2c_mutex);
     ASSERT_SOFT(err_code);
 
-    err_code = dfu_init();
+    BOOT_TIMELINE_RECORD("dfu_init", err_code = dfu_init());
     ASSERT_SOFT(err_code);
 
     err_code = button_init();
@@ -361,32 +455,30 @@ initialize(void)
     ASSERT_SOFT(err_code);
 #endif
 
-    // wait that jetson boots to enable super-caps as it's drawing a lot of
-    // current that is needed for proper jetson boot
+    boot_step_t boot_steps[BOOT_STEP_COUNT] = {
 #if !defined(CONFIG_NO_SUPER_CAPS) && !defined(CONFIG_CI_INTEGRATION_TESTS)
-    k_msleep(14000);
-    err_code = boot_turn_on_super_cap_charger();
-    if (err_code == RET_SUCCESS) {
-        // Delay is to wait for super-cap to charge enough so that turning on
-        // PVCC doesn't cause a brownout, which then disable PVCC (circuitry)
-        // back and forth until stabilized. VCaps voltage is thus kept stable.
-        // Ideally, we should measure the super-cap voltage but hardcoding a
-        // delay works for now.
-        k_msleep(6000);
-        err_code = boot_turn_on_pvcc();
-        if (err_code == RET_SUCCESS) {
-            optics_init(&hw, &analog_and_i2c_mutex);
-        } else {
-            ASSERT_SOFT(err_code);
-        }
-    } else {
-        ASSERT_SOFT(err_code);
-    }
+        // timeouts keep the delays previously used to sequence these steps
+        [BOOT_STEP_SUPER_CAPS] = {.name = "super-caps",
+                                  .ready = boot_jetson_alive,
+                                  .timeout_ms = 14000,
+                                  .run = boot_turn_on_super_cap_charger},
+        [BOOT_STEP_PVCC] = {.name = "pvcc",
+                            .depends_on = BIT(BOOT_STEP_SUPER_CAPS),
+                            .ready = boot_super_caps_charged,
+                            .timeout_ms = 6000,
+                            .run = boot_turn_on_pvcc},
 #else
-    optics_init(&hw, &analog_and_i2c_mutex);
+        [BOOT_STEP_SUPER_CAPS] = {.name = "super-caps"},
+        [BOOT_STEP_PVCC] = {.name = "pvcc"},
 #endif // CONFIG_NO_SUPER_CAPS
-
-    front_leds_boot_progress_set(BOOT_PROGRESS_STEP_OPTICS_INITIALIZED);
+        [BOOT_STEP_OPTICS] = {.name = "optics",
+                              .depends_on = BIT(BOOT_STEP_PVCC),
+                              .run = boot_optics_init},
+        [BOOT_STEP_OPTICS_PROGRESS] = {.name = "optics progress",
+                                       .after = BIT(BOOT_STEP_OPTICS),
+                                       .run = boot_optics_progress},
+        [BOOT_STEP_FAN_TACH] = {.name = "fan tach", .run = fan_tach_init},
+    };
 
 #if defined(CONFIG_BOARD_DIAMOND_MAIN)
     if (hw.version == orb_mcu_Hardware_OrbVersion_HW_VERSION_DIAMOND_V4_4 ||
@@ -394,22 +486,23 @@ initialize(void)
         // on diamond evt, timer2 is used by fan tach & stepper but
         // pwm cannot be used as output and input for same timer
         // so we default to polarizer if one is detected
-        // wait 15 seconds for polarizer homing to finish, if unsuccessful (no
+        // wait for polarizer homing to finish, if unsuccessful (no
         // polarizer dectected?): use fan tach
-        k_msleep(15000);
-        if (!polarizer_wheel_homed()) {
-            err_code = fan_tach_init();
-            ASSERT_SOFT(err_code);
-        }
-    } else {
-        err_code = fan_tach_init();
-        ASSERT_SOFT(err_code);
+        boot_steps[BOOT_STEP_FAN_TACH] = (boot_step_t){
+            .name = "fan tach",
+            .after = BIT(BOOT_STEP_OPTICS),
+            .ready = polarizer_wheel_homing_done,
+            .timeout_ms = 15000,
+            .run = boot_fan_tach_init_if_no_polarizer};
     }
-#else
-    err_code = fan_tach_init();
-    ASSERT_SOFT(err_code);
 #endif
 
+    err_code = boot_sequence_run(boot_steps, ARRAY_SIZE(boot_steps));
+    if (err_code != RET_ERROR_INTERNAL) {
+        // failed steps are already reported by the boot sequence
+        ASSERT_SOFT(err_code);
+    }
+
     // done booting
     LOG_INF("🚀");
 }
@@ -436,6 +529,8 @@ main_internal(void)
 #if !defined(CONFIG_NO_JETSON_BOOT) || !CONFIG_NO_JETSON_BOOT
     wait_jetson_up();
 #endif
+    // logs are sent to the Jetson once it's up
+    boot_timeline_print(NULL);
     backup_clear_reboot_flag();
 
     /*
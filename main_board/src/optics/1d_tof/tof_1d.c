@@ -3,6 +3,7 @@
 #include "mcu.pb.h"
 #include "orb_state.h"
 #include "pubsub/pubsub.h"
+#include "system/sensor_executor.h"
 #include <app_assert.h>
 #include <errors.h>
 #include <string.h>
@@ -34,8 +35,13 @@ const struct device *tof_1d_device_dvt =
 
 #else
 
-K_THREAD_STACK_DEFINE(stack_area_tof_1d, THREAD_STACK_SIZE_1DTOF);
-static struct k_thread tof_1d_thread_data;
+static void
+tof_1d_step(void);
+static sensor_job_t tof_1d_job =
+    SENSOR_JOB_BUS_INITIALIZER("tof_1d", tof_1d_step);
+
+// period of the attempts to configure the sensor after errors
+#define RECONFIGURE_RETRY_PERIOD_MS 5000
 #endif
 
 #if CONFIG_PROXIMITY_DETECTION_FOR_IR_SAFETY
@@ -83,6 +89,25 @@ distance_is_safe(void)
 
 #ifndef CONFIG_BOARD_DIAMOND_MAIN
 
+// bounded, so that a stuck bus doesn't stall the other sensor jobs: the step
+// is skipped and attempted again on the next period
+#define I2C1_LOCK_TIMEOUT_MS 100
+
+static bool
+i2c1_lock(void)
+{
+    return i2c1_mutex == NULL ||
+           k_mutex_lock(i2c1_mutex, K_MSEC(I2C1_LOCK_TIMEOUT_MS)) == 0;
+}
+
+static void
+i2c1_unlock(void)
+{
+    if (i2c1_mutex) {
+        k_mutex_unlock(i2c1_mutex);
+    }
+}
+
 static ret_code_t
 tof_init_config(void)
 {
@@ -92,14 +117,12 @@ tof_init_config(void)
     // stop first in case already started
     distance_config.val1 = 0; // stop
     distance_config.val2 = 0;
-    if (i2c1_mutex) {
-        k_mutex_lock(i2c1_mutex, K_FOREVER);
+    if (!i2c1_lock()) {
+        return RET_ERROR_BUSY;
     }
     ret = sensor_attr_set(tof_1d_device, SENSOR_CHAN_DISTANCE,
                           SENSOR_ATTR_SAMPLING_FREQUENCY, &distance_config);
-    if (i2c1_mutex) {
-        k_mutex_unlock(i2c1_mutex);
-    }
+    i2c1_unlock();
     if (ret != 0) {
         return RET_ERROR_INTERNAL;
     }
@@ -107,14 +130,12 @@ tof_init_config(void)
     // set short distance mode
     distance_config.val1 = 1;
     distance_config.val2 = 0;
-    if (i2c1_mutex) {
-        k_mutex_lock(i2c1_mutex, K_FOREVER);
+    if (!i2c1_lock()) {
+        return RET_ERROR_BUSY;
     }
     ret = sensor_attr_set(tof_1d_device, SENSOR_CHAN_DISTANCE,
                           SENSOR_ATTR_CONFIGURATION, &distance_config);
-    if (i2c1_mutex) {
-        k_mutex_unlock(i2c1_mutex);
-    }
+    i2c1_unlock();
     if (ret != 0) {
         return RET_ERROR_INTERNAL;
     }
@@ -124,14 +145,12 @@ tof_init_config(void)
     // the driver doesn't allow for sampling frequency below 1Hz
     distance_config.val1 = INTER_MEASUREMENT_FREQ_HZ;
     distance_config.val2 = 0; // fractional part, not used
-    if (i2c1_mutex) {
-        k_mutex_lock(i2c1_mutex, K_FOREVER);
+    if (!i2c1_lock()) {
+        return RET_ERROR_BUSY;
     }
     ret = sensor_attr_set(tof_1d_device, SENSOR_CHAN_DISTANCE,
                           SENSOR_ATTR_SAMPLING_FREQUENCY, &distance_config);
-    if (i2c1_mutex) {
-        k_mutex_unlock(i2c1_mutex);
-    }
+    i2c1_unlock();
     if (ret != 0) {
         return RET_ERROR_INTERNAL;
     }
@@ -150,150 +169,117 @@ set_states(bool tof_1d_is_error)
     }
 }
 
-_Noreturn void
-tof_1d_thread(void *a, void *b, void *c)
+static void
+tof_1d_step(void)
 {
-    UNUSED_PARAMETER(a);
-    UNUSED_PARAMETER(b);
-    UNUSED_PARAMETER(c);
-
     int ret;
     struct sensor_value distance_value;
     orb_mcu_main_ToF_1D tof;
-    uint32_t count = 0;
-    uint32_t tick = 0;
-    uint32_t err_count = 0;
-
-    /* initialize sensor config (short mode, sampling frequency) */
-    ret = tof_init_config();
-    /* initialize internal states */
-    set_states(ret != RET_SUCCESS);
-
-    while (1) {
-        uint32_t tock = k_uptime_get_32();
-        uint32_t task_duration = 0;
-        if (tick != 0) {
-            task_duration = tock - tick;
-        }
-        LOG_DBG("task duration: %u ms", task_duration);
-
-        // `ORB_STATE_1D_TOF_THRESHOLD_ERROR_COUNT` errors in a row for 1d-tof
-        // sensor means something is wrong
-        set_states(err_count >= ORB_STATE_1D_TOF_THRESHOLD_ERROR_COUNT);
-
-        /* wait until the sensor is back online */
-        if (err_count > ORB_STATE_1D_TOF_THRESHOLD_ERROR_COUNT) {
-            LOG_WRN("reconfiguring 1d-tof sensor after errors");
-            while (tof_init_config() != RET_SUCCESS) {
-                k_msleep(5000);
-            }
-            err_count = 0;
-        }
-
-        if (task_duration > FETCH_PERIOD_MS) {
-            LOG_WRN("Task took longer (%u ms) than fetch period (%u ms)",
-                    task_duration, FETCH_PERIOD_MS);
-        } else {
-            k_msleep(FETCH_PERIOD_MS - task_duration);
+    static uint32_t count = 0;
+    static uint32_t err_count = 0;
+
+    // `ORB_STATE_1D_TOF_THRESHOLD_ERROR_COUNT` errors in a row for 1d-tof
+    // sensor means something is wrong
+    set_states(err_count >= ORB_STATE_1D_TOF_THRESHOLD_ERROR_COUNT);
+
+    /* wait until the sensor is back online */
+    if (err_count > ORB_STATE_1D_TOF_THRESHOLD_ERROR_COUNT) {
+        LOG_WRN("reconfiguring 1d-tof sensor after errors");
+        if (tof_init_config() != RET_SUCCESS) {
+            sensor_executor_job_set_period(&tof_1d_job,
+                                           RECONFIGURE_RETRY_PERIOD_MS);
+            return;
         }
+        sensor_executor_job_set_period(&tof_1d_job, FETCH_PERIOD_MS);
+        err_count = 0;
+    }
 
-        tick = k_uptime_get_32();
-
-        if (i2c1_mutex) {
-            k_mutex_lock(i2c1_mutex, K_FOREVER);
-        }
-        // used this as a ping to 1d-tof sensor to ensure
-        // connection
-        ret = sensor_attr_get(tof_1d_device, SENSOR_CHAN_DISTANCE,
-                              SENSOR_ATTR_CONFIGURATION, &distance_value);
-        if (ret != 0) {
-            if (i2c1_mutex) {
-                k_mutex_unlock(i2c1_mutex);
-            }
-            LOG_WRN("Error fetching mode to check comms: %d", ret);
-            err_count++;
-            continue;
-        }
+    if (!i2c1_lock()) {
+        LOG_DBG("I2C bus busy");
+        return;
+    }
+    // used this as a ping to 1d-tof sensor to ensure
+    // connection
+    ret = sensor_attr_get(tof_1d_device, SENSOR_CHAN_DISTANCE,
+                          SENSOR_ATTR_CONFIGURATION, &distance_value);
+    if (ret != 0) {
+        i2c1_unlock();
+        LOG_WRN("Error fetching mode to check comms: %d", ret);
+        err_count++;
+        return;
+    }
 
-        ret = sensor_sample_fetch_chan(tof_1d_device, SENSOR_CHAN_ALL);
-        if (i2c1_mutex) {
-            k_mutex_unlock(i2c1_mutex);
-        }
-        if (ret != 0) {
-            LOG_WRN("Error fetching %d", ret);
-            continue;
-        }
+    ret = sensor_sample_fetch_chan(tof_1d_device, SENSOR_CHAN_ALL);
+    i2c1_unlock();
+    if (ret != 0) {
+        LOG_WRN("Error fetching %d", ret);
+        return;
+    }
 
-        if (i2c1_mutex) {
-            k_mutex_lock(i2c1_mutex, K_FOREVER);
-        }
-        ret = sensor_channel_get(tof_1d_device, SENSOR_CHAN_DISTANCE,
-                                 &distance_value);
-        if (i2c1_mutex) {
-            k_mutex_unlock(i2c1_mutex);
-        }
-        if (ret != 0) {
-            // print error with debug level because the range status
-            // can quickly throw an error when nothing in front of the sensor
-            LOG_DBG("Error getting distance data %d", ret);
-            continue;
-        }
+    if (!i2c1_lock()) {
+        return;
+    }
+    ret = sensor_channel_get(tof_1d_device, SENSOR_CHAN_DISTANCE,
+                             &distance_value);
+    i2c1_unlock();
+    if (ret != 0) {
+        // print error with debug level because the range status
+        // can quickly throw an error when nothing in front of the sensor
+        LOG_DBG("Error getting distance data %d", ret);
+        return;
+    }
 
-        tof.distance_mm = distance_value.val1;
+    tof.distance_mm = distance_value.val1;
 
-        // limit number of samples sent
-        ++count;
-        if (count % (DISTANCE_PUBLISH_PERIOD_MS / FETCH_PERIOD_MS) == 0) {
-            LOG_INF("Distance in front: %umm", tof.distance_mm);
+    // limit number of samples sent
+    ++count;
+    if (count % (DISTANCE_PUBLISH_PERIOD_MS / FETCH_PERIOD_MS) == 0) {
+        LOG_INF("Distance in front: %umm", tof.distance_mm);
 
-            publish_new(&tof, sizeof(tof), orb_mcu_main_McuToJetson_tof_1d_tag,
-                        CONFIG_CAN_ADDRESS_MCU_TO_JETSON_TX);
-        }
+        publish_new(&tof, sizeof(tof), orb_mcu_main_McuToJetson_tof_1d_tag,
+                    CONFIG_CAN_ADDRESS_MCU_TO_JETSON_TX);
+    }
 
-        // check proximity from sensor itself
-        memset(&distance_value, 0, sizeof(distance_value));
-        if (i2c1_mutex) {
-            k_mutex_lock(i2c1_mutex, K_FOREVER);
-        }
-        ret = sensor_channel_get(tof_1d_device, SENSOR_CHAN_PROX,
-                                 &distance_value);
-        if (i2c1_mutex) {
-            k_mutex_unlock(i2c1_mutex);
-        }
-        if (ret != 0) {
-            // print error with debug level because the range status
-            // can quickly throw an error when nothing in front of the sensor
-            LOG_DBG("Error getting prox data %d", ret);
-            continue;
-        }
+    // check proximity from sensor itself
+    memset(&distance_value, 0, sizeof(distance_value));
+    if (!i2c1_lock()) {
+        return;
+    }
+    ret = sensor_channel_get(tof_1d_device, SENSOR_CHAN_PROX, &distance_value);
+    i2c1_unlock();
+    if (ret != 0) {
+        // print error with debug level because the range status
+        // can quickly throw an error when nothing in front of the sensor
+        LOG_DBG("Error getting prox data %d", ret);
+        return;
+    }
 
 #if CONFIG_PROXIMITY_DETECTION_FOR_IR_SAFETY
-        const long counter_prev = atomic_get(&too_close_counter);
-        CRITICAL_SECTION_ENTER(k);
-        long counter = atomic_get(&too_close_counter);
-        // if val1 is 0, we are far away, so we can decrease the counter
-        // see SENSOR_CHAN_PROX documentation
-        if (distance_value.val1 == 0) {
-            if (counter > 0) {
-                counter--;
-            }
-        } else if (counter < TOO_CLOSE_THRESHOLD) {
-            counter++;
+    const long counter_prev = atomic_get(&too_close_counter);
+    CRITICAL_SECTION_ENTER(k);
+    long counter = atomic_get(&too_close_counter);
+    // if val1 is 0, we are far away, so we can decrease the counter
+    // see SENSOR_CHAN_PROX documentation
+    if (distance_value.val1 == 0) {
+        if (counter > 0) {
+            counter--;
         }
-        atomic_set(&too_close_counter, counter);
-        CRITICAL_SECTION_EXIT(k);
+    } else if (counter < TOO_CLOSE_THRESHOLD) {
+        counter++;
+    }
+    atomic_set(&too_close_counter, counter);
+    CRITICAL_SECTION_EXIT(k);
 
-        // only call unsafe_cb once on new event
-        if (unsafe_event_cb && counter_prev != atomic_get(&too_close_counter) &&
-            !distance_is_safe()) {
-            unsafe_event_cb();
-        }
+    // only call unsafe_cb once on new event
+    if (unsafe_event_cb && counter_prev != atomic_get(&too_close_counter) &&
+        !distance_is_safe()) {
+        unsafe_event_cb();
+    }
 #endif
 
-        // if reached here, we successfully fetched the data
-        set_states(false);
-        err_count = 0;
-    }
+    // if reached here, we successfully fetched the data
+    set_states(false);
+    err_count = 0;
 }
 
 #endif // !CONFIG_BOARD_DIAMOND_MAIN
@@ -340,11 +326,16 @@ tof_1d_init(void (*distance_unsafe_cb)(void), struct k_mutex *mutex,
     ORB_STATE_SET(tof_1d, RET_SUCCESS, "initialized but disabled");
 #else
 
-    k_thread_create(&tof_1d_thread_data, stack_area_tof_1d,
-                    K_THREAD_STACK_SIZEOF(stack_area_tof_1d),
-                    (k_thread_entry_t)tof_1d_thread, NULL, NULL, NULL,
-                    THREAD_PRIORITY_1DTOF, 0, K_NO_WAIT);
-    k_thread_name_set(&tof_1d_thread_data, "tof_1d");
+    /* initialize sensor config (short mode, sampling frequency) */
+    int ret = tof_init_config();
+    /* initialize internal states */
+    set_states(ret != RET_SUCCESS);
+
+    ret = sensor_executor_job_start(&tof_1d_job, FETCH_PERIOD_MS,
+                                    FETCH_PERIOD_MS);
+    if (ret != RET_SUCCESS) {
+        return ret;
+    }
 
 #if CONFIG_PROXIMITY_DETECTION_FOR_IR_SAFETY
     if (distance_unsafe_cb) {
@@ -0,0 +1,211 @@
+#include "ir_camera_frames.h"
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+#if !defined(IR_CAMERA_UNIT_TESTS)
+#include "mcu.pb.h"
+#include "pubsub/pubsub.h"
+#include <zephyr/kernel.h>
+#endif
+
+#define RING_SIZE CONFIG_IR_CAMERA_FRAMES_RING_SIZE
+#define RING_MASK (RING_SIZE - 1)
+
+BUILD_ASSERT(IS_POWER_OF_TWO(RING_SIZE),
+             "CONFIG_IR_CAMERA_FRAMES_RING_SIZE must be a power of two");
+BUILD_ASSERT(CONFIG_IR_CAMERA_FRAMES_BATCH <= RING_SIZE,
+             "Batches must fit in the ring");
+
+// one producer (the ISR of the source) writes `head`, one consumer writes
+// `tail`; indexes are free-running and wrap at 32 bits
+struct frame_ring {
+    struct ir_camera_frame entries[RING_SIZE];
+    atomic_t head;
+    atomic_t tail;
+    uint32_t next_frame;
+};
+
+static struct frame_ring rings[IR_CAMERA_FRAMES_SOURCE_COUNT];
+
+static const char *const source_names[IR_CAMERA_FRAMES_SOURCE_COUNT] = {
+    [IR_CAMERA_FRAMES_IR_TRIGGER] = "ir",
+    [IR_CAMERA_FRAMES_RGB_STROBE] = "rgb",
+};
+
+#if !defined(IR_CAMERA_UNIT_TESTS)
+static void
+drain_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    for (size_t i = 0; i < IR_CAMERA_FRAMES_SOURCE_COUNT; ++i) {
+        while (ir_camera_frames_pending(i) > 0) {
+            orb_mcu_Log log = {0};
+            if (ir_camera_frames_encode(i, log.log, sizeof(log.log)) == 0) {
+                break;
+            }
+            (void)publish_new(&log, sizeof(log),
+                              orb_mcu_main_McuToJetson_log_tag,
+                              CONFIG_CAN_ADDRESS_MCU_TO_JETSON_TX);
+        }
+    }
+}
+
+static K_WORK_DEFINE(drain_work, drain_work_handler);
+
+void
+ir_camera_frames_flush(void)
+{
+    k_work_submit(&drain_work);
+}
+
+uint32_t
+ir_camera_frames_timestamp_us(uint32_t us_ago)
+{
+    // the 32-bit hardware cycle counter wraps every few seconds, its upper
+    // bits are recovered from the kernel tick count: both count from boot
+    const uint32_t cycles = k_cycle_get_32();
+    const uint64_t approx = k_ticks_to_cyc_floor64(k_uptime_ticks());
+
+    uint64_t now = (approx & ~(uint64_t)UINT32_MAX) | cycles;
+    if (now + BIT64(31) < approx) {
+        now += BIT64(32);
+    } else if (now > approx + BIT64(31)) {
+        now -= BIT64(32);
+    }
+
+    return (uint32_t)k_cyc_to_us_floor64(now) - us_ago;
+}
+#endif
+
+void
+ir_camera_frames_record(ir_camera_frames_source_t source,
+                        const struct ir_camera_frame *frame)
+{
+    if (source >= IR_CAMERA_FRAMES_SOURCE_COUNT) {
+        return;
+    }
+
+    struct frame_ring *ring = &rings[source];
+    const uint32_t head = (uint32_t)atomic_get(&ring->head);
+    const uint32_t tail = (uint32_t)atomic_get(&ring->tail);
+    const uint32_t number = ring->next_frame++;
+
+    if (head - tail >= RING_SIZE) {
+        return;
+    }
+
+    struct ir_camera_frame *entry = &ring->entries[head & RING_MASK];
+    *entry = *frame;
+    entry->frame = number;
+    // publish the entry to the consumer
+    atomic_set(&ring->head, (atomic_val_t)(head + 1));
+
+#if !defined(IR_CAMERA_UNIT_TESTS)
+    if (head + 1 - tail >= CONFIG_IR_CAMERA_FRAMES_BATCH) {
+        k_work_submit(&drain_work);
+    }
+#endif
+}
+
+size_t
+ir_camera_frames_pending(ir_camera_frames_source_t source)
+{
+    if (source >= IR_CAMERA_FRAMES_SOURCE_COUNT) {
+        return 0;
+    }
+
+    return (uint32_t)atomic_get(&rings[source].head) -
+           (uint32_t)atomic_get(&rings[source].tail);
+}
+
+/**
+ * Encode one entry, with the fields that changed since `prev`, all of them if
+ * `prev` is NULL
+ *
+ * @return length of the token
+ */
+static size_t
+encode_token(char *buf, size_t size, const struct ir_camera_frame *prev,
+             const struct ir_camera_frame *entry, uint32_t batch_timestamp_us)
+{
+    const uint32_t dt_us = entry->timestamp_us -
+                           (prev ? prev->timestamp_us : batch_timestamp_us);
+    size_t len = snprintf(buf, size, " %u", dt_us);
+
+    if (prev != NULL && entry->frame != prev->frame + 1) {
+        len += snprintf(buf + len, size - len, "#%u", entry->frame);
+    }
+    if (prev == NULL || entry->exposure_us != prev->exposure_us) {
+        len += snprintf(buf + len, size - len, "e%u", entry->exposure_us);
+    }
+    if (prev == NULL || entry->wavelength != prev->wavelength) {
+        len += snprintf(buf + len, size - len, "w%u", entry->wavelength);
+    }
+    if (entry->sweep_frame != IR_CAMERA_FRAMES_NO_SWEEP) {
+        len += snprintf(buf + len, size - len, "s%u:%d", entry->sweep_frame,
+                        entry->setpoint);
+    }
+
+    return len;
+}
+
+size_t
+ir_camera_frames_encode(ir_camera_frames_source_t source, char *buf,
+                        size_t size)
+{
+    if (source >= IR_CAMERA_FRAMES_SOURCE_COUNT || buf == NULL || size == 0) {
+        return 0;
+    }
+    buf[0] = '\0';
+
+    struct frame_ring *ring = &rings[source];
+    const uint32_t head = (uint32_t)atomic_get(&ring->head);
+    uint32_t tail = (uint32_t)atomic_get(&ring->tail);
+    if (head == tail) {
+        return 0;
+    }
+
+    // the slots aren't reused by the producer until `tail` is published
+    const struct ir_camera_frame *first = &ring->entries[tail & RING_MASK];
+    const int header_len =
+        snprintf(buf, size, "frames %s #%u %u", source_names[source],
+                 first->frame, first->timestamp_us);
+    if (header_len < 0 || (size_t)header_len >= size) {
+        buf[0] = '\0';
+        return 0;
+    }
+
+    size_t len = header_len;
+    size_t count = 0;
+    const struct ir_camera_frame *prev = NULL;
+    // longest token: " 4294967295#4294967295e65535w255s65535:-32768"
+    char token[64];
+
+    while (tail != head) {
+        const struct ir_camera_frame *entry = &ring->entries[tail & RING_MASK];
+        const size_t token_len = encode_token(token, sizeof(token), prev,
+                                              entry, first->timestamp_us);
+        if (len + token_len >= size) {
+            break;
+        }
+        memcpy(&buf[len], token, token_len + 1);
+        len += token_len;
+
+        prev = entry;
+        tail++;
+        count++;
+    }
+
+    if (count == 0) {
+        buf[0] = '\0';
+        return 0;
+    }
+
+    // release the slots to the producer
+    atomic_set(&ring->tail, (atomic_val_t)tail);
+
+    return count;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Per-frame metadata stream of the camera triggers.
+ *
+ * The camera ISRs record one entry per exposure into a lock-free ring, one
+ * ring per trigger source with a single producer (the ISR) and a single
+ * consumer (the system workqueue). Once `CONFIG_IR_CAMERA_FRAMES_BATCH`
+ * entries are pending, the ring is drained into compact text batches sent to
+ * the Jetson as `McuToJetson` log messages:
+ *
+ *   `frames <source> #<first frame> <timestamp> <token> <token>...`
+ *
+ * Each entry is one token: the time since the previous entry (or since the
+ * batch timestamp for the first one), in µs, followed by the fields that
+ * changed since the previous entry of the batch:
+ * - `#<frame>` frame counter, when frames were dropped
+ * - `e<us>` exposure duration
+ * - `w<wavelength>` enabled IR LEDs, `orb_mcu_main_InfraredLEDs_Wavelength`
+ * - `s<sweep frame>:<setpoint>` sweep frame and setpoint, during sweeps
+ *
+ * The first entry of a batch carries all its fields.
+ */
+
+typedef enum {
+    IR_CAMERA_FRAMES_IR_TRIGGER, // IR eye, IR face and 2D ToF camera triggers
+    IR_CAMERA_FRAMES_RGB_STROBE, // RGB-IR face camera strobe, Diamond
+    IR_CAMERA_FRAMES_SOURCE_COUNT,
+} ir_camera_frames_source_t;
+
+/// `sweep_frame` of exposures taken outside sweeps
+#define IR_CAMERA_FRAMES_NO_SWEEP UINT16_MAX
+
+struct ir_camera_frame {
+    /// counter of the source, set when recorded
+    uint32_t frame;
+    /// start of the exposure, µs since boot
+    uint32_t timestamp_us;
+    uint16_t exposure_us;
+    /// orb_mcu_main_InfraredLEDs_Wavelength
+    uint8_t wavelength;
+    uint8_t reserved;
+    /// frame of the sweep in progress or IR_CAMERA_FRAMES_NO_SWEEP
+    uint16_t sweep_frame;
+    /// setpoint of the first swept actuator, in its table unit
+    int16_t setpoint;
+};
+
+/**
+ * Record an exposure, from the ISR of its source
+ *
+ * The frame counter of the source is incremented even if the ring is full,
+ * so that dropped frames show up as gaps on the Jetson.
+ *
+ * @param source Trigger source
+ * @param frame Exposure metadata, `frame` is overwritten
+ */
+void
+ir_camera_frames_record(ir_camera_frames_source_t source,
+                        const struct ir_camera_frame *frame);
+
+/**
+ * @param source Trigger source
+ * @return number of entries waiting to be sent
+ */
+size_t
+ir_camera_frames_pending(ir_camera_frames_source_t source);
+
+/**
+ * Remove entries from the ring and encode them into `buf` as one batch,
+ * as many as fit
+ *
+ * @param source Trigger source
+ * @param buf Destination, NUL-terminated
+ * @param size Size of `buf`
+ * @return number of entries encoded, 0 if none pending or `buf` is too small
+ */
+size_t
+ir_camera_frames_encode(ir_camera_frames_source_t source, char *buf,
+                        size_t size);
+
+#if !defined(IR_CAMERA_UNIT_TESTS)
+/**
+ * Send the pending entries of all sources, even if less than a batch, to be
+ * called when a camera stream stops
+ */
+void
+ir_camera_frames_flush(void);
+
+/**
+ * Convert a time in the past to a timestamp of the stream
+ *
+ * @param us_ago Time elapsed since the event, in µs
+ * @return time of the event, µs since boot, wrapping at 32 bits
+ */
+uint32_t
+ir_camera_frames_timestamp_us(uint32_t us_ago);
+#endif
@@ -0,0 +1,72 @@
+#include "ir_camera_schedule.h"
+#include <stddef.h>
+
+static bool
+lit_by_ir_leds(ir_camera_schedule_camera_t camera)
+{
+    return camera == IR_CAMERA_SCHEDULE_IR_EYE ||
+           camera == IR_CAMERA_SCHEDULE_IR_FACE;
+}
+
+static bool
+overlap(uint64_t start_a, uint64_t end_a, uint64_t start_b, uint64_t end_b)
+{
+    return start_a < end_b && start_b < end_a;
+}
+
+ret_code_t
+ir_camera_schedule_check(const struct ir_camera_schedule *schedule,
+                         uint32_t period_us, uint32_t led_start_us,
+                         uint32_t led_end_us,
+                         ir_camera_schedule_camera_t *conflict)
+{
+    const struct ir_camera_schedule_slot *slots = schedule->slots;
+
+    for (size_t i = 0; i < IR_CAMERA_SCHEDULE_CAMERA_COUNT; ++i) {
+        if (!slots[i].used) {
+            continue;
+        }
+        if (conflict != NULL) {
+            *conflict = i;
+        }
+
+        const uint64_t end_us =
+            (uint64_t)slots[i].phase_us + slots[i].window_us;
+        if (slots[i].window_us == 0 || end_us > period_us) {
+            return RET_ERROR_INVALID_PARAM;
+        }
+
+        // the IR LED pulse is foreign illumination for the others
+        if (!lit_by_ir_leds(i) &&
+            overlap(slots[i].phase_us, end_us, led_start_us, led_end_us)) {
+            return RET_ERROR_INVALID_PARAM;
+        }
+
+        for (size_t j = i + 1; j < IR_CAMERA_SCHEDULE_CAMERA_COUNT; ++j) {
+            if (!slots[j].used || (lit_by_ir_leds(i) && lit_by_ir_leds(j))) {
+                continue;
+            }
+            if (overlap(slots[i].phase_us, end_us, slots[j].phase_us,
+                        (uint64_t)slots[j].phase_us + slots[j].window_us)) {
+                return RET_ERROR_INVALID_PARAM;
+            }
+        }
+    }
+
+    return RET_SUCCESS;
+}
+
+uint32_t
+ir_camera_schedule_end_us(const struct ir_camera_schedule *schedule)
+{
+    uint32_t end = 0;
+
+    for (size_t i = 0; i < IR_CAMERA_SCHEDULE_CAMERA_COUNT; ++i) {
+        const struct ir_camera_schedule_slot *slot = &schedule->slots[i];
+        if (slot->used && slot->phase_us + slot->window_us > end) {
+            end = slot->phase_us + slot->window_us;
+        }
+    }
+
+    return end;
+}
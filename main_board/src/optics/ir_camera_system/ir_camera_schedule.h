@@ -0,0 +1,71 @@
+#pragma once
+
+#include <errors.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Trigger phase schedule of the cameras triggered by the MCU.
+ *
+ * All the camera triggers start from the master timer update event, once per
+ * frame period. By default they all rise together with the IR LED pulse. A
+ * schedule gives each camera a phase, the delay of its trigger from the update
+ * event, and a window, the duration of its exposure, so that cameras can be
+ * interleaved within the period instead of exposing at the same time.
+ *
+ * The IR eye and IR face cameras are lit by the IR LED pulse and may share it.
+ * The 2D ToF camera has its own emitter: its window must not overlap the IR
+ * LED pulse nor the window of another camera, otherwise each camera sees the
+ * illumination of the other.
+ *
+ * The RGB face camera isn't triggered by the MCU and isn't part of the
+ * schedule.
+ */
+
+typedef enum {
+    IR_CAMERA_SCHEDULE_IR_EYE,
+    IR_CAMERA_SCHEDULE_IR_FACE,
+    IR_CAMERA_SCHEDULE_TOF_2D,
+    IR_CAMERA_SCHEDULE_CAMERA_COUNT,
+} ir_camera_schedule_camera_t;
+
+struct ir_camera_schedule_slot {
+    /// slot checked and programmed
+    bool used;
+    /// trigger delay from the master timer update event, µs
+    uint32_t phase_us;
+    /// exposure duration from the trigger, µs
+    uint32_t window_us;
+};
+
+struct ir_camera_schedule {
+    struct ir_camera_schedule_slot slots[IR_CAMERA_SCHEDULE_CAMERA_COUNT];
+};
+
+/**
+ * Check that a schedule fits in the frame period without illumination
+ * crosstalk
+ *
+ * @param schedule Schedule to check
+ * @param period_us Frame period
+ * @param led_start_us Start of the IR LED pulse from the update event
+ * @param led_end_us End of the IR LED pulse, equal to `led_start_us` if the
+ *  LEDs are off
+ * @param conflict If not NULL, set to the camera at fault on error, or to the
+ *  first of the two cameras whose windows overlap
+ * @retval RET_SUCCESS the schedule can be programmed
+ * @retval RET_ERROR_INVALID_PARAM a window is empty, doesn't fit in the period
+ *  or overlaps with a foreign illumination
+ */
+ret_code_t
+ir_camera_schedule_check(const struct ir_camera_schedule *schedule,
+                         uint32_t period_us, uint32_t led_start_us,
+                         uint32_t led_end_us,
+                         ir_camera_schedule_camera_t *conflict);
+
+/**
+ * @param schedule Schedule, checked
+ * @return latest end of the windows of the used slots, 0 if none
+ */
+uint32_t
+ir_camera_schedule_end_us(const struct ir_camera_schedule *schedule);
@@ -0,0 +1,184 @@
+#include "ir_camera_sweep.h"
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+static struct {
+    const struct ir_camera_sweep_actuator_ops *ops;
+    const int16_t *table;
+    size_t num_frames;
+    // position when the sweep started, for relative tables
+    int32_t origin;
+} actuators[IR_CAMERA_SWEEP_ACTUATOR_COUNT];
+
+// actuators of the sweep in progress or of the last sweep
+static uint32_t sweep_actuators;
+static size_t sweep_num_frames;
+// next frame to apply, written from the ISR
+static volatile size_t sweep_frame;
+static atomic_t sweep_running;
+// latest frame to apply to the deferred actuators plus one, 0 if none
+static atomic_t deferred_frame;
+
+static void
+apply(ir_camera_sweep_actuator_t actuator, size_t frame)
+{
+    const int32_t setpoint =
+        actuators[actuator].origin + actuators[actuator].table[frame];
+    actuators[actuator].ops->set(setpoint);
+}
+
+void
+ir_camera_sweep_register(ir_camera_sweep_actuator_t actuator,
+                         const struct ir_camera_sweep_actuator_ops *ops)
+{
+    if (actuator < IR_CAMERA_SWEEP_ACTUATOR_COUNT) {
+        actuators[actuator].ops = ops;
+    }
+}
+
+ret_code_t
+ir_camera_sweep_load(ir_camera_sweep_actuator_t actuator, const int16_t *table,
+                     size_t num_frames)
+{
+    if (actuator >= IR_CAMERA_SWEEP_ACTUATOR_COUNT ||
+        (table == NULL && num_frames != 0)) {
+        return RET_ERROR_INVALID_PARAM;
+    }
+    if (ir_camera_sweep_in_progress()) {
+        return RET_ERROR_BUSY;
+    }
+
+    actuators[actuator].table = table;
+    actuators[actuator].num_frames = num_frames;
+
+    return RET_SUCCESS;
+}
+
+ret_code_t
+ir_camera_sweep_start(uint32_t mask)
+{
+    size_t num_frames = 0;
+
+    if (mask == 0 || mask >= BIT(IR_CAMERA_SWEEP_ACTUATOR_COUNT)) {
+        return RET_ERROR_INVALID_PARAM;
+    }
+    if (ir_camera_sweep_in_progress()) {
+        return RET_ERROR_BUSY;
+    }
+
+    for (size_t i = 0; i < IR_CAMERA_SWEEP_ACTUATOR_COUNT; ++i) {
+        if ((mask & BIT(i)) == 0) {
+            continue;
+        }
+        if (actuators[i].ops == NULL || actuators[i].num_frames == 0 ||
+            (num_frames != 0 && actuators[i].num_frames != num_frames)) {
+            return RET_ERROR_INVALID_PARAM;
+        }
+        num_frames = actuators[i].num_frames;
+    }
+
+    sweep_actuators = mask;
+    sweep_num_frames = num_frames;
+    atomic_clear(&deferred_frame);
+
+    for (size_t i = 0; i < IR_CAMERA_SWEEP_ACTUATOR_COUNT; ++i) {
+        if ((mask & BIT(i)) == 0) {
+            continue;
+        }
+        actuators[i].origin =
+            actuators[i].ops->get != NULL ? actuators[i].ops->get() : 0;
+        // thread context: deferred actuators are applied right away too
+        apply(i, 0);
+    }
+
+    sweep_frame = 1;
+    atomic_set(&sweep_running, 1);
+
+    return RET_SUCCESS;
+}
+
+bool
+ir_camera_sweep_next_frame(bool *deferred_pending)
+{
+    *deferred_pending = false;
+
+    if (!ir_camera_sweep_in_progress()) {
+        return false;
+    }
+
+    const size_t frame = sweep_frame;
+    if (frame >= sweep_num_frames) {
+        atomic_clear(&sweep_running);
+        return false;
+    }
+
+    for (size_t i = 0; i < IR_CAMERA_SWEEP_ACTUATOR_COUNT; ++i) {
+        if ((sweep_actuators & BIT(i)) == 0) {
+            continue;
+        }
+        if (actuators[i].ops->deferred) {
+            *deferred_pending = true;
+        } else {
+            apply(i, frame);
+        }
+    }
+    if (*deferred_pending) {
+        atomic_set(&deferred_frame, (atomic_val_t)(frame + 1));
+    }
+
+    sweep_frame = frame + 1;
+    return true;
+}
+
+bool
+ir_camera_sweep_current_frame(size_t *frame, int16_t *setpoint)
+{
+    if (!ir_camera_sweep_in_progress()) {
+        return false;
+    }
+
+    const size_t current = sweep_frame - 1;
+    for (size_t i = 0; i < IR_CAMERA_SWEEP_ACTUATOR_COUNT; ++i) {
+        if ((sweep_actuators & BIT(i)) != 0) {
+            *setpoint = actuators[i].table[current];
+            break;
+        }
+    }
+    *frame = current;
+
+    return true;
+}
+
+void
+ir_camera_sweep_apply_deferred(void)
+{
+    const atomic_val_t pending = atomic_clear(&deferred_frame);
+    if (pending == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < IR_CAMERA_SWEEP_ACTUATOR_COUNT; ++i) {
+        if ((sweep_actuators & BIT(i)) != 0 && actuators[i].ops->deferred) {
+            apply(i, (size_t)pending - 1);
+        }
+    }
+}
+
+void
+ir_camera_sweep_stop(void)
+{
+    atomic_clear(&sweep_running);
+    atomic_clear(&deferred_frame);
+}
+
+bool
+ir_camera_sweep_in_progress(void)
+{
+    return atomic_get(&sweep_running) != 0;
+}
+
+size_t
+ir_camera_sweep_num_frames(void)
+{
+    return sweep_num_frames;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <errors.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Per-frame sweep engine of the IR eye camera.
+ *
+ * Actuators are registered once with their operations. A sweep moves a set of
+ * actuators in lockstep: each actuator follows its own table, one setpoint per
+ * frame, and all the tables of a sweep have the same number of frames.
+ *
+ * The first setpoints are applied when the sweep starts, then the setpoints
+ * of the next frame are applied at the end of each exposure, from the camera
+ * exposure ISR. Actuators whose `set` operation can block are marked as
+ * `deferred`: the ISR only records the frame and their setpoint is applied
+ * from thread context by `ir_camera_sweep_apply_deferred`.
+ *
+ * Tables are compact: 16-bit setpoints in the unit of the actuator, optionally
+ * relative to the actuator position when the sweep starts. Tables aren't
+ * copied and must stay valid until the end of the sweep.
+ */
+
+typedef enum {
+    IR_CAMERA_SWEEP_LIQUID_LENS,    // target current, mA
+    IR_CAMERA_SWEEP_MIRROR_PHI,     // millidegrees, relative
+    IR_CAMERA_SWEEP_MIRROR_THETA,   // millidegrees, relative
+    IR_CAMERA_SWEEP_POLARIZER,      // decidegrees, [0, 3600]
+    IR_CAMERA_SWEEP_IR_LED_ON_TIME, // µs
+    IR_CAMERA_SWEEP_ACTUATOR_COUNT,
+} ir_camera_sweep_actuator_t;
+
+struct ir_camera_sweep_actuator_ops {
+    /// apply a setpoint
+    void (*set)(int32_t setpoint);
+    /// current position, origin of the relative tables, NULL for absolute
+    /// tables
+    int32_t (*get)(void);
+    /// `set` can block: called from thread context
+    bool deferred;
+};
+
+/**
+ * Register the operations of an actuator
+ *
+ * @param actuator Actuator
+ * @param ops Operations, must stay valid
+ */
+void
+ir_camera_sweep_register(ir_camera_sweep_actuator_t actuator,
+                         const struct ir_camera_sweep_actuator_ops *ops);
+
+/**
+ * Set the table of setpoints of an actuator for the next sweep
+ *
+ * @param actuator Actuator
+ * @param table Setpoint of each frame, not copied
+ * @param num_frames Number of frames in `table`, 0 to remove the table
+ * @retval RET_SUCCESS table set
+ * @retval RET_ERROR_INVALID_PARAM unknown actuator or NULL table
+ * @retval RET_ERROR_BUSY a sweep is in progress
+ */
+ret_code_t
+ir_camera_sweep_load(ir_camera_sweep_actuator_t actuator, const int16_t *table,
+                     size_t num_frames);
+
+/**
+ * Start a sweep and apply the setpoints of the first frame, from thread
+ * context
+ *
+ * @param mask Bitmask of the actuators moving during the sweep, bit `i` for
+ *  actuator `i`
+ * @retval RET_SUCCESS sweep started
+ * @retval RET_ERROR_INVALID_PARAM no actuator, actuator not registered,
+ *  without table, or tables of different lengths
+ * @retval RET_ERROR_BUSY a sweep is already in progress
+ */
+ret_code_t
+ir_camera_sweep_start(uint32_t mask);
+
+/**
+ * Apply the setpoints of the next frame, to be called at the end of each
+ * exposure
+ *
+ * @param deferred_pending set to true when setpoints of deferred actuators
+ *  must be applied with `ir_camera_sweep_apply_deferred`
+ * @retval true setpoints applied, the sweep goes on
+ * @retval false all frames have been taken, the sweep is over
+ */
+bool
+ir_camera_sweep_next_frame(bool *deferred_pending);
+
+/**
+ * Frame being exposed, to be called at the end of the exposure, before
+ * `ir_camera_sweep_next_frame`
+ *
+ * @param frame set to the index of the frame in the sweep
+ * @param setpoint set to the table value of the frame for the first actuator
+ *  of the sweep, in the order of `ir_camera_sweep_actuator_t`
+ * @retval true a sweep is in progress
+ * @retval false no sweep in progress, outputs untouched
+ */
+bool
+ir_camera_sweep_current_frame(size_t *frame, int16_t *setpoint);
+
+/**
+ * Apply the setpoints of the deferred actuators for the latest frame, from
+ * thread context. Setpoints of frames that were skipped because the thread
+ * ran late aren't applied.
+ */
+void
+ir_camera_sweep_apply_deferred(void);
+
+/**
+ * Abort the sweep in progress, if any
+ */
+void
+ir_camera_sweep_stop(void);
+
+/**
+ * @return true if a sweep is in progress
+ */
+bool
+ir_camera_sweep_in_progress(void);
+
+/**
+ * @return number of frames of the sweep in progress or of the last sweep
+ */
+size_t
+ir_camera_sweep_num_frames(void);
@@ -0,0 +1,108 @@
+#include "ir_camera_sweep_tables.h"
+#include <math.h>
+
+static int16_t
+saturate_int16(int32_t value)
+{
+    if (value > INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (value < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return (int16_t)value;
+}
+
+static int32_t
+evaluate_focus_sweep_polynomial(
+    const orb_mcu_main_IREyeCameraFocusSweepValuesPolynomial *poly,
+    uint32_t frame_no)
+{
+    // We are evaluating this formula:
+    // focus(n) = a + bn + cn^2 + dn^3 + en^4 + fn^5
+    //
+    // Transforming the formula using Horner's rule we get:
+    // f(x0) = a + x0(b + x0(c + x0(d + x0(e + fx0))))
+    //
+    // Using Horner's rule reduces the number of multiplications
+    float frame_no_float = (float)frame_no;
+    return lroundf(
+        poly->coef_a +
+        (frame_no_float *
+         (poly->coef_b +
+          frame_no_float *
+              (poly->coef_c +
+               frame_no_float *
+                   (poly->coef_d +
+                    frame_no_float *
+                        (poly->coef_e + (poly->coef_f * frame_no_float)))))));
+}
+
+ret_code_t
+ir_camera_sweep_focus_table(
+    const orb_mcu_main_IREyeCameraFocusSweepValuesPolynomial *poly,
+    int16_t *table, size_t table_size)
+{
+    if (poly->number_of_frames > table_size) {
+        return RET_ERROR_INVALID_PARAM;
+    }
+
+    for (uint32_t i = 0; i < poly->number_of_frames; ++i) {
+        table[i] = saturate_int16(evaluate_focus_sweep_polynomial(poly, i));
+    }
+
+    return RET_SUCCESS;
+}
+
+struct mirror_delta {
+    int32_t delta_phi_millidegrees;
+    int32_t delta_theta_millidegrees;
+};
+
+static struct mirror_delta
+evaluate_mirror_sweep_polynomials(
+    const orb_mcu_main_IREyeCameraMirrorSweepValuesPolynomial *poly,
+    uint32_t frame_no)
+{
+    struct mirror_delta md = {0};
+
+    float frame_no_float = (float)frame_no;
+    float radius =
+        poly->radius_coef_a +
+        (frame_no_float *
+         (poly->radius_coef_b + (frame_no_float * poly->radius_coef_c)));
+    float angle =
+        poly->angle_coef_a +
+        (frame_no_float *
+         (poly->angle_coef_b + (frame_no_float * poly->angle_coef_c)));
+
+    md.delta_phi_millidegrees = (int32_t)(radius * sinf(angle)) * 1000;
+    md.delta_theta_millidegrees = (int32_t)(radius * cosf(angle)) * 1000;
+
+    // because of the new angle definitions as phi/theta (previous
+    // horizontal/vertical) we need to divide these values by 2 and invert the
+    // x-value: todo: I'm not sure about the inversion -> double check this
+    md.delta_phi_millidegrees /= -2;
+    md.delta_theta_millidegrees /= 2;
+
+    return md;
+}
+
+ret_code_t
+ir_camera_sweep_mirror_table(
+    const orb_mcu_main_IREyeCameraMirrorSweepValuesPolynomial *poly,
+    int16_t *phi_table, int16_t *theta_table, size_t table_size)
+{
+    if (poly->number_of_frames > table_size) {
+        return RET_ERROR_INVALID_PARAM;
+    }
+
+    for (uint32_t i = 0; i < poly->number_of_frames; ++i) {
+        const struct mirror_delta md =
+            evaluate_mirror_sweep_polynomials(poly, i);
+        phi_table[i] = saturate_int16(md.delta_phi_millidegrees);
+        theta_table[i] = saturate_int16(md.delta_theta_millidegrees);
+    }
+
+    return RET_SUCCESS;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <errors.h>
+#include <mcu.pb.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Per-frame setpoints of the IR eye camera sweeps, computed from the
+ * polynomials sent by the Jetson when a sweep is armed, so that the camera
+ * exposure ISR only looks up the setpoint of the next frame instead of
+ * evaluating the polynomials in floating point.
+ *
+ * Setpoints are stored in the units of the sweep engine: mA for the liquid
+ * lens, millidegrees relative to the starting position for the mirror.
+ */
+
+/**
+ * Fill the table of liquid lens target currents from the focus sweep
+ * polynomial, one entry per frame
+ *
+ * @param poly Polynomial coefficients and number of frames
+ * @param table Target current of each frame, in mA
+ * @param table_size Number of entries in `table`
+ * @retval RET_SUCCESS table filled with `poly->number_of_frames` entries
+ * @retval RET_ERROR_INVALID_PARAM more frames than `table_size`
+ */
+ret_code_t
+ir_camera_sweep_focus_table(
+    const orb_mcu_main_IREyeCameraFocusSweepValuesPolynomial *poly,
+    int16_t *table, size_t table_size);
+
+/**
+ * Fill the tables of mirror angles from the mirror sweep polynomials, one
+ * entry per frame, relative to the mirror position when the sweep starts
+ *
+ * @param poly Polynomial coefficients and number of frames
+ * @param phi_table Delta of phi angle of each frame, in millidegrees
+ * @param theta_table Delta of theta angle of each frame, in millidegrees
+ * @param table_size Number of entries in each table
+ * @retval RET_SUCCESS tables filled with `poly->number_of_frames` entries
+ * @retval RET_ERROR_INVALID_PARAM more frames than `table_size`
+ */
+ret_code_t
+ir_camera_sweep_mirror_table(
+    const orb_mcu_main_IREyeCameraMirrorSweepValuesPolynomial *poly,
+    int16_t *phi_table, int16_t *theta_table, size_t table_size);
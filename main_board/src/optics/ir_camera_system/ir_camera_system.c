@@ -37,6 +37,7 @@ LOG_MODULE_REGISTER(ir_camera_system, CONFIG_IR_CAMERA_SYSTEM_LOG_LEVEL);
 
 STATIC_OR_EXTERN atomic_t focus_sweep_in_progress;
 STATIC_OR_EXTERN atomic_t mirror_sweep_in_progress;
+STATIC_OR_EXTERN atomic_t sweep_in_progress;
 STATIC_OR_EXTERN bool ir_camera_system_initialized;
 STATIC_OR_EXTERN orb_mcu_main_InfraredLEDs_Wavelength enabled_led_wavelength =
     orb_mcu_main_InfraredLEDs_Wavelength_WAVELENGTH_NONE;
@@ -48,7 +49,8 @@ STATIC_OR_EXTERN orb_mcu_main_InfraredLEDs_Wavelength enabled_led_wavelength =
                                                                                \
         if (!ir_camera_system_initialized) {                                   \
             ret = RET_ERROR_NOT_INITIALIZED;                                   \
-        } else if (get_focus_sweep_in_progress() == true) {                    \
+        } else if (get_focus_sweep_in_progress() == true ||                    \
+                   get_sweep_in_progress() == true) {                          \
             ret = RET_ERROR_BUSY;                                              \
         } else {                                                               \
             enabled_##camera_name##_camera = true;                             \
@@ -71,7 +73,8 @@ STATIC_OR_EXTERN orb_mcu_main_InfraredLEDs_Wavelength enabled_led_wavelength =
                                                                                \
         if (!ir_camera_system_initialized) {                                   \
             ret = RET_ERROR_NOT_INITIALIZED;                                   \
-        } else if (get_focus_sweep_in_progress() == true) {                    \
+        } else if (get_focus_sweep_in_progress() == true ||                    \
+                   get_sweep_in_progress() == true) {                          \
             ret = RET_ERROR_BUSY;                                              \
         } else {                                                               \
             enabled_##camera_name##_camera = false;                            \
@@ -156,6 +159,25 @@ clear_mirror_sweep_in_progress(void)
     atomic_set(&mirror_sweep_in_progress, 0);
 }
 
+// Generic sweep
+bool
+get_sweep_in_progress(void)
+{
+    return atomic_get(&sweep_in_progress);
+}
+
+void
+set_sweep_in_progress(void)
+{
+    atomic_set(&sweep_in_progress, 1);
+}
+
+void
+clear_sweep_in_progress(void)
+{
+    atomic_set(&sweep_in_progress, 0);
+}
+
 /* Public */
 
 ret_code_t
@@ -294,7 +316,10 @@ ir_camera_system_set_polynomial_coefficients_for_focus_sweep(
 {
     ret_code_t ret;
 
-    if (get_focus_sweep_in_progress() == true) {
+    if (poly.number_of_frames > MAX_NUMBER_OF_FOCUS_VALUES) {
+        LOG_ERR("Too many focus sweep frames!");
+        ret = RET_ERROR_INVALID_PARAM;
+    } else if (get_focus_sweep_in_progress() == true) {
         ret = RET_ERROR_BUSY;
     } else {
         ir_camera_system_set_polynomial_coefficients_for_focus_sweep_hw(poly);
@@ -355,7 +380,10 @@ ir_camera_system_set_polynomial_coefficients_for_mirror_sweep(
 {
     ret_code_t ret;
 
-    if (get_mirror_sweep_in_progress() == true) {
+    if (poly.number_of_frames > MAX_NUMBER_OF_FOCUS_VALUES) {
+        LOG_ERR("Too many mirror sweep frames!");
+        ret = RET_ERROR_INVALID_PARAM;
+    } else if (get_mirror_sweep_in_progress() == true) {
         ret = RET_ERROR_BUSY;
     } else {
         ir_camera_system_set_polynomial_coefficients_for_mirror_sweep_hw(poly);
@@ -388,6 +416,73 @@ ir_camera_system_perform_mirror_sweep(void)
     return ret;
 }
 
+ret_code_t
+ir_camera_system_set_sweep_table(ir_camera_sweep_actuator_t actuator,
+                                 const int16_t *values, size_t num_frames)
+{
+    ret_code_t ret;
+
+    if (actuator >= IR_CAMERA_SWEEP_ACTUATOR_COUNT ||
+        num_frames > MAX_NUMBER_OF_FOCUS_VALUES ||
+        (values == NULL && num_frames != 0)) {
+        LOG_ERR("Invalid sweep table!");
+        ret = RET_ERROR_INVALID_PARAM;
+    } else if (get_focus_sweep_in_progress() ||
+               get_mirror_sweep_in_progress() || get_sweep_in_progress()) {
+        ret = RET_ERROR_BUSY;
+    } else {
+        ir_camera_system_set_sweep_table_hw(actuator, values, num_frames);
+        ret = RET_SUCCESS;
+    }
+
+    return ret;
+}
+
+ret_code_t
+ir_camera_system_set_schedule(const struct ir_camera_schedule *schedule)
+{
+    ret_code_t ret;
+
+    ret = ir_camera_system_get_status();
+
+    // the schedule doesn't turn on the IR LEDs
+    if (ret == RET_ERROR_FORBIDDEN) {
+        ret = RET_SUCCESS;
+    }
+
+    if (ret == RET_SUCCESS) {
+        ret = ir_camera_system_set_schedule_hw(schedule);
+    } else {
+        LOG_ERR("Schedule not set, status: %d", ret);
+    }
+
+    return ret;
+}
+
+ret_code_t
+ir_camera_system_perform_sweep(uint32_t actuators)
+{
+    ret_code_t ret;
+
+    ret = ir_camera_system_get_status();
+
+    if (ret == RET_SUCCESS) {
+        if (ir_camera_system_get_fps_hw() == 0) {
+            LOG_ERR("FPS must be greater than 0!");
+            ret = RET_ERROR_INVALID_STATE;
+        } else if (ir_camera_system_ir_eye_camera_is_enabled()) {
+            LOG_ERR("IR eye camera must be disabled!");
+            ret = RET_ERROR_INVALID_STATE;
+        } else {
+            ret = ir_camera_system_perform_sweep_hw(actuators);
+        }
+    } else {
+        LOG_ERR("Sweep not performed, status: %d", ret);
+    }
+
+    return ret;
+}
+
 ret_code_t
 ir_camera_system_get_status(void)
 {
@@ -408,7 +503,7 @@ ir_camera_system_get_status(void)
     } else if (safety_triggered) {
         ret = RET_ERROR_FORBIDDEN;
     } else if (get_focus_sweep_in_progress() ||
-               get_mirror_sweep_in_progress()) {
+               get_mirror_sweep_in_progress() || get_sweep_in_progress()) {
         ret = RET_ERROR_BUSY;
     } else {
         ret = RET_SUCCESS;
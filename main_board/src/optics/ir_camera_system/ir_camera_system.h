@@ -1,5 +1,7 @@
 #pragma once
 
+#include "ir_camera_schedule.h"
+#include "ir_camera_sweep.h"
 #include <errors.h>
 #include <mcu.pb.h>
 #include <zephyr/sys/util.h>
@@ -281,6 +283,64 @@ ir_camera_system_set_polynomial_coefficients_for_mirror_sweep(
 ret_code_t
 ir_camera_system_perform_mirror_sweep(void);
 
+/**
+ * Set the table of setpoints of an actuator for the next generic sweep, one
+ * setpoint per frame. See `ir_camera_sweep_actuator_t` for the units.
+ *
+ * The focus and mirror sweeps use the tables of the actuators they drive, so
+ * these tables are overwritten when a focus or mirror sweep is set up.
+ *
+ * @param actuator Actuator following the table
+ * @param values Setpoints, copied
+ * @param num_frames Number of setpoints, 0 to remove the table
+ * @retval RET_SUCCESS table saved
+ * @retval RET_ERROR_INVALID_PARAM unknown actuator or more than
+ *  MAX_NUMBER_OF_FOCUS_VALUES setpoints
+ * @retval RET_ERROR_BUSY a sweep is in progress
+ */
+ret_code_t
+ir_camera_system_set_sweep_table(ir_camera_sweep_actuator_t actuator,
+                                 const int16_t *values, size_t num_frames);
+
+/**
+ * Perform a sweep with the IR eye camera, moving several actuators in
+ * lockstep: one frame is taken per setpoint, all the actuators of the sweep
+ * must have tables of the same length. Same requirements and restrictions as
+ * the focus sweep.
+ *
+ * This function is asynchronous and returns immediately.
+ *
+ * @param actuators Bitmask of the actuators to move, bit `i` for actuator `i`
+ * @retval RET_SUCCESS: All is good, sweep is initiated.
+ * @retval RET_ERROR_BUSY: A sweep is already in progress.
+ * @retval RET_ERROR_INVALID_STATE: Either the FPS is zero or the IR eye camera
+ * is enabled.
+ * @retval RET_ERROR_INVALID_PARAM: actuator without table or tables of
+ * different lengths
+ */
+ret_code_t
+ir_camera_system_perform_sweep(uint32_t actuators);
+
+/**
+ * Set the trigger phase and exposure window of the cameras triggered by the
+ * MCU, see `struct ir_camera_schedule`. Cameras without a slot in use keep
+ * the default trigger, together with the IR LED pulse.
+ *
+ * The schedule is checked against the current FPS and IR LED on-time; if a
+ * later change of these settings invalidates it, the schedule is cleared.
+ *
+ * @param schedule Schedule, copied, NULL to trigger all the cameras together
+ * @retval RET_SUCCESS schedule applied from the next frame
+ * @retval RET_ERROR_INVALID_PARAM a camera isn't triggered by the MCU, starts
+ *  before the IR LEDs, doesn't fit in the frame period or overlaps with a
+ *  foreign illumination
+ * @retval RET_ERROR_INVALID_STATE the FPS is zero
+ * @retval RET_ERROR_BUSY a sweep is in progress
+ * @retval RET_ERROR_NOT_INITIALIZED the IR camera system is not initialized
+ */
+ret_code_t
+ir_camera_system_set_schedule(const struct ir_camera_schedule *schedule);
+
 /**
  * Determine the state/status of the IR camera system.
  *
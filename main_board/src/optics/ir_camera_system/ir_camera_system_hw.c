@@ -4,16 +4,26 @@
 
 #include "ir_camera_system_hw.h"
 #include "ir_camera_system_internal.h"
+#include "ir_camera_frames.h"
+#include "ir_camera_schedule.h"
+#include "ir_camera_sweep.h"
+#include "ir_camera_sweep_tables.h"
 #include "ir_camera_timer_settings.h"
+#include "ir_camera_timers.h"
 #include "optics/1d_tof/tof_1d.h"
 #include "optics/liquid_lens/liquid_lens.h"
 #include "optics/mirror/mirror.h"
+#if defined(CONFIG_BOARD_DIAMOND_MAIN)
+#include "optics/polarizer_wheel/polarizer_wheel.h"
+#endif
+#include "system/cpu_usage.h"
+#include "system/isr_trace.h"
 #include "system/version/version.h"
 #include "ui/rgb_leds/front_leds/front_leds.h"
+#include "voltage_measurement/ir_led_rail.h"
 #include <app_assert.h>
 #include <app_config.h>
 #include <assert.h>
-#include <math.h>
 #include <soc.h>
 #include <stm32_ll_tim.h>
 #include <system/stm32_timer_utils/stm32_timer_utils.h>
@@ -210,8 +220,43 @@ static const uint32_t ch2ll[TIMER_MAX_CH] = {
     LL_TIM_CHANNEL_CH1, LL_TIM_CHANNEL_CH2, LL_TIM_CHANNEL_CH3,
     LL_TIM_CHANNEL_CH4};
 
+#if defined(CONFIG_IR_LED_RAIL)
+/** Channel to TRGO output compare reference mapping. */
+static const uint32_t ch2trgo[TIMER_MAX_CH] = {
+    LL_TIM_TRGO_OC1REF, LL_TIM_TRGO_OC2REF, LL_TIM_TRGO_OC3REF,
+    LL_TIM_TRGO_OC4REF};
+#endif
+
+// CAMERA_TRIGGER_TIMER update interrupt kept enabled outside sweeps, to follow
+// every exposure
+#define CAMERA_EXPOSURE_IT_ALWAYS_ON                                           \
+    (IS_ENABLED(CONFIG_IR_CAMERA_FRAMES) || IS_ENABLED(CONFIG_IR_LED_RAIL) ||  \
+     IS_ENABLED(CONFIG_MIRROR_TRAJECTORY))
+
 static struct ir_camera_timer_settings global_timer_settings = {0};
 
+// Camera trigger phases
+// CAMERA_TRIGGER_TIMER channel of each camera of the schedule, 0 if the camera
+// isn't triggered by the MCU on this board
+static const int schedule_channels[IR_CAMERA_SCHEDULE_CAMERA_COUNT] = {
+    [IR_CAMERA_SCHEDULE_IR_EYE] = IR_EYE_CAMERA_TRIGGER_TIMER_CHANNEL,
+#ifdef IR_FACE_CAMERA_TRIGGER_TIMER_CHANNEL
+    [IR_CAMERA_SCHEDULE_IR_FACE] = IR_FACE_CAMERA_TRIGGER_TIMER_CHANNEL,
+#endif
+    [IR_CAMERA_SCHEDULE_TOF_2D] = TOF_2D_CAMERA_TRIGGER_TIMER_CHANNEL,
+};
+static const char *const schedule_camera_names[] = {
+    [IR_CAMERA_SCHEDULE_IR_EYE] = "ir eye",
+    [IR_CAMERA_SCHEDULE_IR_FACE] = "ir face",
+    [IR_CAMERA_SCHEDULE_TOF_2D] = "2d tof",
+};
+static struct ir_camera_schedule trigger_schedule = {0};
+static bool trigger_schedule_active = false;
+// programmed trigger window of the IR eye camera, from the start of the
+// CAMERA_TRIGGER_TIMER period
+static uint32_t ir_eye_window_start_us = CAMERA_TRIGGER_TIMER_START_DELAY_US;
+static uint32_t ir_eye_window_end_us = CAMERA_TRIGGER_TIMER_START_DELAY_US;
+
 /// Drive PVCC converter PWM mode:
 ///    * physical low: usage of PWM which allows for fast response to massive
 ///    power draw by the IR LEDs, drawback is a passive draw of 2 by default
@@ -240,13 +285,13 @@ camera_enable_trigger(bool enabled, int channel);
 
 #endif
 
-// Focus sweep stuff
-static int16_t global_focus_values[MAX_NUMBER_OF_FOCUS_VALUES];
-static size_t global_num_focus_values;
-static volatile size_t sweep_index;
-static bool use_focus_sweep_polynomial;
-static orb_mcu_main_IREyeCameraFocusSweepValuesPolynomial
-    focus_sweep_polynomial;
+// Sweep stuff
+// setpoints of each actuator followed by the sweep engine; the mirror tables
+// have one more entry as the first frame of a mirror sweep is taken at the
+// starting position
+static int16_t sweep_tables[IR_CAMERA_SWEEP_ACTUATOR_COUNT]
+                           [MAX_NUMBER_OF_FOCUS_VALUES + 1];
+static size_t sweep_table_num_frames[IR_CAMERA_SWEEP_ACTUATOR_COUNT];
 
 static void
 set_pvcc_converter_into_low_power_mode(void)
@@ -276,76 +321,172 @@ set_pvcc_converter_into_high_demand_mode(void)
     }
 }
 
+// CC channels of the LED timers
+static uint32_t
+ir_leds_850nm_channels(void)
+{
+    return ch2ll[LED_850NM_TIMER_LEFT_CHANNEL - 1] |
+           ch2ll[LED_850NM_TIMER_RIGHT_CHANNEL - 1];
+}
+
+static uint32_t
+ir_leds_940nm_channels(void)
+{
+    uint32_t channels = ch2ll[LED_940NM_TIMER_LEFT_CHANNEL - 1] |
+                        ch2ll[LED_940NM_TIMER_RIGHT_CHANNEL - 1];
+#if defined(CONFIG_BOARD_DIAMOND_MAIN)
+    channels |= ch2ll[LED_940NM_TIMER_SINGLE_CHANNEL - 1];
+#endif
+    return channels;
+}
+
+/**
+ * Enable exactly `enabled` among the CC channels of the LED timers, see
+ * ir_camera_timers_leds_set_channels
+ */
+static void
+ir_leds_set_channels(uint32_t enabled_850nm, uint32_t enabled_940nm)
+{
+    ir_camera_timers_leds_set_channels(LED_850NM_TIMER,
+                                       ir_leds_850nm_channels(), enabled_850nm);
+    ir_camera_timers_leds_set_channels(LED_940NM_TIMER,
+                                       ir_leds_940nm_channels(), enabled_940nm);
+
+#if defined(CONFIG_IR_LED_RAIL)
+    // sample the rail on the strobes of the enabled LEDs
+    if (enabled_850nm != 0) {
+        ir_led_rail_set_source(IR_LED_RAIL_850NM);
+    } else if (enabled_940nm != 0) {
+        ir_led_rail_set_source(IR_LED_RAIL_940NM);
+    } else {
+        ir_led_rail_set_source(IR_LED_RAIL_NONE);
+    }
+#endif
+}
+
 static void
 ir_leds_disable_all(void)
 {
     // disable all CC channels of the LED timers
-    LL_TIM_CC_DisableChannel(LED_850NM_TIMER,
-                             ch2ll[LED_850NM_TIMER_LEFT_CHANNEL - 1]);
-    LL_TIM_CC_DisableChannel(LED_850NM_TIMER,
-                             ch2ll[LED_850NM_TIMER_RIGHT_CHANNEL - 1]);
-    LL_TIM_CC_DisableChannel(LED_940NM_TIMER,
-                             ch2ll[LED_940NM_TIMER_LEFT_CHANNEL - 1]);
-    LL_TIM_CC_DisableChannel(LED_940NM_TIMER,
-                             ch2ll[LED_940NM_TIMER_RIGHT_CHANNEL - 1]);
+    ir_leds_set_channels(0, 0);
+}
+
+static void
+sweep_set_liquid_lens(int32_t setpoint)
+{
+    liquid_set_target_current_ma(setpoint);
+}
+
+static void
+sweep_set_mirror_phi(int32_t setpoint)
+{
+    (void)mirror_set_angle_phi_async(setpoint, 0);
+}
+
+static int32_t
+sweep_get_mirror_phi(void)
+{
+    return (int32_t)mirror_get_phi_angle_millidegrees();
+}
+
+static void
+sweep_set_mirror_theta(int32_t setpoint)
+{
+    (void)mirror_set_angle_theta_async(setpoint, 0);
+}
+
+static int32_t
+sweep_get_mirror_theta(void)
+{
+    return (int32_t)mirror_get_theta_angle_millidegrees();
+}
+
+#if defined(CONFIG_BOARD_DIAMOND_MAIN)
+static void
+sweep_set_polarizer(int32_t setpoint)
+{
+    // always rotate forward, which is the most reliable; the wheel must have
+    // reached the previous angle, otherwise the setpoint is refused and the
+    // frame is taken at the previous angle
+    const ret_code_t err_code =
+        polarizer_wheel_set_angle(0, (uint32_t)setpoint, false);
+    if (err_code != RET_SUCCESS) {
+        LOG_WRN("Polarizer sweep setpoint %d not applied: %d", setpoint,
+                err_code);
+    }
+}
+#endif
+
+static void
+sweep_set_ir_led_on_time(int32_t setpoint)
+{
+    if (setpoint < 0 || setpoint > UINT16_MAX) {
+        LOG_WRN("Invalid on-time sweep setpoint: %d", setpoint);
+        return;
+    }
+    (void)ir_camera_system_set_on_time_us_hw((uint16_t)setpoint);
+}
+
+static const struct ir_camera_sweep_actuator_ops
+    sweep_actuator_ops[IR_CAMERA_SWEEP_ACTUATOR_COUNT] = {
+        [IR_CAMERA_SWEEP_LIQUID_LENS] = {.set = sweep_set_liquid_lens},
+        [IR_CAMERA_SWEEP_MIRROR_PHI] = {.set = sweep_set_mirror_phi,
+                                        .get = sweep_get_mirror_phi},
+        [IR_CAMERA_SWEEP_MIRROR_THETA] = {.set = sweep_set_mirror_theta,
+                                          .get = sweep_get_mirror_theta},
 #if defined(CONFIG_BOARD_DIAMOND_MAIN)
-    LL_TIM_CC_DisableChannel(LED_940NM_TIMER,
-                             ch2ll[LED_940NM_TIMER_SINGLE_CHANNEL - 1]);
+        [IR_CAMERA_SWEEP_POLARIZER] = {.set = sweep_set_polarizer,
+                                       .deferred = true},
 #endif
+        [IR_CAMERA_SWEEP_IR_LED_ON_TIME] = {.set = sweep_set_ir_led_on_time,
+                                            .deferred = true},
+};
+
+static void
+sweep_register_actuators(void)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(sweep_actuator_ops); ++i) {
+        if (sweep_actuator_ops[i].set != NULL) {
+            ir_camera_sweep_register(i, &sweep_actuator_ops[i]);
+        }
+    }
+}
+
+void
+ir_camera_system_set_sweep_table_hw(ir_camera_sweep_actuator_t actuator,
+                                    const int16_t *values, size_t num_frames)
+{
+    // actuator and number of frames checked by the caller
+    if (num_frames > 0) {
+        memcpy(sweep_tables[actuator], values, num_frames * sizeof(values[0]));
+    }
+    sweep_table_num_frames[actuator] = num_frames;
 }
 
 void
 ir_camera_system_set_polynomial_coefficients_for_focus_sweep_hw(
     orb_mcu_main_IREyeCameraFocusSweepValuesPolynomial poly)
 {
-    use_focus_sweep_polynomial = true;
-    global_num_focus_values = poly.number_of_frames;
-    focus_sweep_polynomial = poly;
+    // number of frames checked by the caller
+    const ret_code_t err_code = ir_camera_sweep_focus_table(
+        &poly, sweep_tables[IR_CAMERA_SWEEP_LIQUID_LENS],
+        MAX_NUMBER_OF_FOCUS_VALUES);
+    ASSERT_SOFT(err_code);
+    sweep_table_num_frames[IR_CAMERA_SWEEP_LIQUID_LENS] =
+        err_code == RET_SUCCESS ? poly.number_of_frames : 0;
 }
 
 void
 ir_camera_system_set_focus_values_for_focus_sweep_hw(int16_t *focus_values,
                                                      size_t num_focus_values)
 {
-    global_num_focus_values = num_focus_values;
-    memcpy(global_focus_values, focus_values, sizeof(global_focus_values));
-    use_focus_sweep_polynomial = false;
+    ir_camera_system_set_sweep_table_hw(IR_CAMERA_SWEEP_LIQUID_LENS,
+                                        focus_values, num_focus_values);
 }
 
-static int32_t
-evaluate_focus_sweep_polynomial(uint32_t frame_no)
-{
-    // We are evaluating this formula:
-    // focus(n) = a + bn + cn^2 + dn^3 + en^4 + fn^5
-    //
-    // Transforming the formula using Horner's rule we get:
-    // f(x0) = a + x0(b + x0(c + x0(d + x0(e + fx0))))
-    //
-    // Using Horner's rule reduces the number of multiplications
-    float frame_no_float = (float)frame_no;
-    return lroundf(
-        focus_sweep_polynomial.coef_a +
-        (frame_no_float *
-         (focus_sweep_polynomial.coef_b +
-          frame_no_float *
-              (focus_sweep_polynomial.coef_c +
-               frame_no_float *
-                   (focus_sweep_polynomial.coef_d +
-                    frame_no_float *
-                        (focus_sweep_polynomial.coef_e +
-                         (focus_sweep_polynomial.coef_f * frame_no_float)))))));
-}
-
-struct mirror_delta {
-    int32_t delta_phi_millidegrees;
-    int32_t delta_theta_millidegrees;
-};
-
 // Mirror sweep stuff
 static orb_mcu_main_IREyeCameraMirrorSweepValuesPolynomial
     mirror_sweep_polynomial;
-static uint32_t initial_mirror_angle_theta_millidegrees,
-    initial_mirror_angle_phi_millidegrees;
 
 void
 ir_camera_system_set_polynomial_coefficients_for_mirror_sweep_hw(
@@ -354,159 +495,318 @@ ir_camera_system_set_polynomial_coefficients_for_mirror_sweep_hw(
     mirror_sweep_polynomial = poly;
 }
 
-static struct mirror_delta
-evaluate_mirror_sweep_polynomials(uint32_t frame_no)
-{
-    struct mirror_delta md = {0};
+#if CONFIG_ZTEST
+// semaphore to signal end of sweep in tests
+// keep non-static for tests
+K_SEM_DEFINE(camera_sweep_test_sem, 0, 1);
+#endif
 
-    float frame_no_float = (float)frame_no;
-    float radius = mirror_sweep_polynomial.radius_coef_a +
-                   (frame_no_float *
-                    (mirror_sweep_polynomial.radius_coef_b +
-                     (frame_no_float * mirror_sweep_polynomial.radius_coef_c)));
-    float angle = mirror_sweep_polynomial.angle_coef_a +
-                  (frame_no_float *
-                   (mirror_sweep_polynomial.angle_coef_b +
-                    (frame_no_float * mirror_sweep_polynomial.angle_coef_c)));
+#if defined(CONFIG_ISR_TRACE)
+/**
+ * Time elapsed since the end of the camera trigger pulse: the trigger timer
+ * is started by the MASTER_TIMER update event and stops at the end of its
+ * pulse, while MASTER_TIMER keeps counting
+ */
+static uint32_t
+camera_exposure_end_elapsed_cycles(void)
+{
+    const uint32_t since_start =
+        isr_trace_timer_elapsed_cycles(MASTER_TIMER, 0);
+    const uint32_t pulse =
+        (LL_TIM_GetAutoReload(CAMERA_TRIGGER_TIMER) + 1) *
+        (LL_TIM_GetPrescaler(CAMERA_TRIGGER_TIMER) + 1);
 
-    md.delta_phi_millidegrees = (int32_t)(radius * sinf(angle)) * 1000;
-    md.delta_theta_millidegrees = (int32_t)(radius * cosf(angle)) * 1000;
+    return since_start > pulse ? since_start - pulse : 0;
+}
+#endif
 
-    // because of the new angle definitions as phi/theta (previous
-    // horizontal/vertical) we need to divide these values by 2 and invert the
-    // x-value: todo: I'm not sure about the inversion -> double check this
-    md.delta_phi_millidegrees /= -2;
-    md.delta_theta_millidegrees /= 2;
+#if defined(CONFIG_IR_CAMERA_FRAMES)
+static bool
+camera_any_trigger_enabled(void)
+{
+    bool enabled = LL_TIM_CC_IsEnabledChannel(
+                       CAMERA_TRIGGER_TIMER,
+                       ch2ll[IR_EYE_CAMERA_TRIGGER_TIMER_CHANNEL - 1]) ||
+                   LL_TIM_CC_IsEnabledChannel(
+                       CAMERA_TRIGGER_TIMER,
+                       ch2ll[TOF_2D_CAMERA_TRIGGER_TIMER_CHANNEL - 1]);
+#ifdef IR_FACE_CAMERA_TRIGGER_TIMER_CHANNEL
+    enabled = enabled ||
+              LL_TIM_CC_IsEnabledChannel(
+                  CAMERA_TRIGGER_TIMER,
+                  ch2ll[IR_FACE_CAMERA_TRIGGER_TIMER_CHANNEL - 1]);
+#endif
+    return enabled;
+}
 
-    return md;
+/// IR LEDs lit during the exposure
+static uint8_t
+frame_wavelength(void)
+{
+    if (global_timer_settings.on_time_in_us == 0) {
+        return orb_mcu_main_InfraredLEDs_Wavelength_WAVELENGTH_NONE;
+    }
+    return ir_camera_system_get_enabled_leds();
 }
 
-#if CONFIG_ZTEST
-// semaphore to signal end of sweep in tests
-// keep non-static for tests
-K_SEM_DEFINE(camera_sweep_test_sem, 0, 1);
+/**
+ * Record the exposure that just ended, from the camera exposure ISR.
+ * The eye camera is exposed during its programmed window of the trigger
+ * period, which starts with the MASTER_TIMER update event.
+ * Must be called before the sweep engine moves to the next frame.
+ */
+static void
+ir_trigger_frame_record(uint32_t since_master_update_us)
+{
+    if (!camera_any_trigger_enabled()) {
+        return;
+    }
+
+    struct ir_camera_frame frame = {
+        .timestamp_us = ir_camera_frames_timestamp_us(since_master_update_us -
+                                                      ir_eye_window_start_us),
+        .exposure_us = ir_eye_window_end_us - ir_eye_window_start_us,
+        .wavelength = frame_wavelength(),
+        .sweep_frame = IR_CAMERA_FRAMES_NO_SWEEP,
+    };
+
+    size_t sweep_frame;
+    if (ir_camera_sweep_current_frame(&sweep_frame, &frame.setpoint)) {
+        frame.sweep_frame = MIN(sweep_frame, IR_CAMERA_FRAMES_NO_SWEEP - 1);
+    }
+
+    ir_camera_frames_record(IR_CAMERA_FRAMES_IR_TRIGGER, &frame);
+}
 #endif
 
+/// a camera stream stopped: send the frames of the last, partial batch
 static void
-camera_exposure_completes_isr(void *arg)
+frames_flush(void)
 {
-    ARG_UNUSED(arg);
-    LL_TIM_ClearFlag_UPDATE(CAMERA_TRIGGER_TIMER);
-    // check if CAMERA_TRIGGER_TIMER is off to only catch the end of a pulse
-    if (!LL_TIM_IsEnabledCounter(CAMERA_TRIGGER_TIMER)) {
-        if (get_focus_sweep_in_progress() == true) {
-            if (sweep_index == global_num_focus_values) {
-                LL_TIM_DisableIT_UPDATE(CAMERA_TRIGGER_TIMER);
-                LOG_DBG("Focus sweep complete!");
-                ir_camera_system_disable_ir_eye_camera_force();
-                clear_focus_sweep_in_progress();
-#ifdef CONFIG_ZTEST
-                k_sem_give(&camera_sweep_test_sem);
+#if defined(CONFIG_IR_CAMERA_FRAMES)
+    ir_camera_frames_flush();
 #endif
-            } else {
-                if (use_focus_sweep_polynomial) {
-                    liquid_set_target_current_ma(
-                        evaluate_focus_sweep_polynomial(sweep_index));
-                } else {
-                    liquid_set_target_current_ma(
-                        global_focus_values[sweep_index]);
-                }
-            }
-        } else if (get_mirror_sweep_in_progress() == true) {
-            if (sweep_index == mirror_sweep_polynomial.number_of_frames) {
-                LL_TIM_DisableIT_UPDATE(CAMERA_TRIGGER_TIMER);
-                LOG_DBG("Mirror sweep complete!");
-                ir_camera_system_disable_ir_eye_camera_force();
-                clear_mirror_sweep_in_progress();
+}
+
+static void
+sweep_deferred_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+    ir_camera_sweep_apply_deferred();
+}
+
+static K_WORK_DEFINE(sweep_deferred_work, sweep_deferred_work_handler);
+
+// on-time of the IR LEDs before a sweep moving it, restored at the end
+static uint16_t sweep_saved_on_time_us;
+static bool sweep_restore_on_time = false;
+
+static void
+sweep_end_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    // queued after the deferred setpoints of the last frame
+    if (sweep_restore_on_time) {
+        sweep_restore_on_time = false;
+        (void)ir_camera_system_set_on_time_us_hw(sweep_saved_on_time_us);
+    }
+}
+
+static K_WORK_DEFINE(sweep_end_work, sweep_end_work_handler);
+
+/**
+ * Sweep stopped, all frames taken or aborted. Can be called from ISR
+ * context, the settings changed by the sweep are restored from thread
+ * context.
+ */
+static void
+sweep_ended(void)
+{
+    ir_camera_system_disable_ir_eye_camera_force();
+    clear_focus_sweep_in_progress();
+    clear_mirror_sweep_in_progress();
+    clear_sweep_in_progress();
+    k_work_submit(&sweep_end_work);
 #ifdef CONFIG_ZTEST
-                k_sem_give(&camera_sweep_test_sem);
+    k_sem_give(&camera_sweep_test_sem);
 #endif
-            } else {
-                struct mirror_delta md =
-                    evaluate_mirror_sweep_polynomials(sweep_index);
-                mirror_set_angle_phi_async(
-                    md.delta_phi_millidegrees +
-                        (int32_t)initial_mirror_angle_phi_millidegrees,
-                    0);
-                mirror_set_angle_theta_async(
-                    md.delta_theta_millidegrees +
-                        (int32_t)initial_mirror_angle_theta_millidegrees,
-                    0);
-            }
-        } else {
-            LOG_ERR("Nothing is in progress, this should not be possible!");
-        }
+}
+
+/// end the sweep in progress, from any context
+static void
+sweep_end(void)
+{
+    ir_camera_timers_sweep_stop(CAMERA_TRIGGER_TIMER,
+                                CAMERA_EXPOSURE_IT_ALWAYS_ON);
+    sweep_ended();
+}
+
+static void
+camera_exposure_ended(uint32_t since_master_update_us)
+{
+    ISR_TRACE_LATENCY(CPU_USAGE_ISR_CAMERA_EXPOSURE,
+                      camera_exposure_end_elapsed_cycles());
 
-        sweep_index++;
+#if defined(CONFIG_IR_CAMERA_FRAMES)
+    ir_trigger_frame_record(since_master_update_us);
+#else
+    ARG_UNUSED(since_master_update_us);
+#endif
+#if defined(CONFIG_IR_LED_RAIL)
+    ir_led_rail_strobe_end();
+#endif
+#if defined(CONFIG_MIRROR_TRAJECTORY)
+    if (global_timer_settings.fps != 0) {
+        mirror_trajectory_on_frame(USEC_PER_SEC / global_timer_settings.fps);
     }
+#endif
 }
 
 static void
-initialize_focus_sweep(void)
+camera_exposure_sweep_deferred(void)
 {
-    if (use_focus_sweep_polynomial) {
-        liquid_set_target_current_ma(evaluate_focus_sweep_polynomial(0));
-    } else {
-        liquid_set_target_current_ma(global_focus_values[0]);
+    k_work_submit(&sweep_deferred_work);
+}
+
+static const struct ir_camera_timers_exposure_ops camera_exposure_ops = {
+    .ended = camera_exposure_ended,
+    .deferred = camera_exposure_sweep_deferred,
+    .sweep_end = sweep_ended,
+};
+
+static void
+camera_exposure_completes_isr(void *arg)
+{
+    ARG_UNUSED(arg);
+    const uint32_t isr_start = cpu_usage_isr_enter();
+
+    ir_camera_timers_exposure_isr(MASTER_TIMER, CAMERA_TRIGGER_TIMER,
+                                  CAMERA_EXPOSURE_IT_ALWAYS_ON,
+                                  &camera_exposure_ops);
+
+    cpu_usage_isr_exit(CPU_USAGE_ISR_CAMERA_EXPOSURE, isr_start);
+}
+
+/**
+ * Apply the first setpoints of the actuators in `mask` then take one frame
+ * per setpoint, the next setpoints being applied at the end of each exposure
+ */
+static ret_code_t
+start_sweep(uint32_t mask)
+{
+    for (size_t i = 0; i < IR_CAMERA_SWEEP_ACTUATOR_COUNT; ++i) {
+        if ((mask & BIT(i)) != 0) {
+            ret_code_t err_code = ir_camera_sweep_load(
+                i, sweep_tables[i], sweep_table_num_frames[i]);
+            if (err_code != RET_SUCCESS) {
+                return err_code;
+            }
+        }
     }
 
-    sweep_index = 1;
+    // on-time setpoints change the global settings, which are restored at
+    // the end of the sweep
+    if ((mask & BIT(IR_CAMERA_SWEEP_IR_LED_ON_TIME)) != 0) {
+        sweep_saved_on_time_us = global_timer_settings.on_time_in_us;
+        sweep_restore_on_time = true;
+    }
+
+    ret_code_t err_code = ir_camera_sweep_start(mask);
+    if (err_code != RET_SUCCESS) {
+        sweep_restore_on_time = false;
+        return err_code;
+    }
 
     LL_TIM_ClearFlag_UPDATE(CAMERA_TRIGGER_TIMER);
     LL_TIM_EnableIT_UPDATE(CAMERA_TRIGGER_TIMER);
 
-    LOG_DBG("Starting focus sweep!");
+    LOG_DBG("Starting sweep of %zu frames", ir_camera_sweep_num_frames());
 
     ir_camera_system_enable_ir_eye_camera_force();
+
+    return RET_SUCCESS;
 }
 
 void
 ir_camera_system_perform_focus_sweep_hw(void)
 {
+    const size_t num_frames =
+        sweep_table_num_frames[IR_CAMERA_SWEEP_LIQUID_LENS];
+
     LOG_DBG("Initializing focus sweep.");
-    LOG_DBG("Taking %zu focus sweep frames", global_num_focus_values);
+    LOG_DBG("Taking %zu focus sweep frames", num_frames);
     // No focus values means we trivially succeed
-    if (global_num_focus_values > 0) {
+    if (num_frames > 0) {
         set_focus_sweep_in_progress();
-        initialize_focus_sweep();
+        const ret_code_t err_code =
+            start_sweep(BIT(IR_CAMERA_SWEEP_LIQUID_LENS));
+        if (err_code != RET_SUCCESS) {
+            ASSERT_SOFT(err_code);
+            clear_focus_sweep_in_progress();
+        }
     } else {
         LOG_WRN("Num focus values is 0!");
     }
 }
 
-static void
-initialize_mirror_sweep(void)
+void
+ir_camera_system_perform_mirror_sweep_hw(void)
 {
-    sweep_index = 0;
-    initial_mirror_angle_phi_millidegrees = mirror_get_phi_angle_millidegrees();
-    initial_mirror_angle_theta_millidegrees =
-        mirror_get_theta_angle_millidegrees();
+    const size_t num_frames = mirror_sweep_polynomial.number_of_frames;
+    int16_t *phi_table = sweep_tables[IR_CAMERA_SWEEP_MIRROR_PHI];
+    int16_t *theta_table = sweep_tables[IR_CAMERA_SWEEP_MIRROR_THETA];
 
-    LOG_DBG("Initial mirror angle phi: %d",
-            initial_mirror_angle_phi_millidegrees);
-    LOG_DBG("Initial mirror angle theta: %d",
-            initial_mirror_angle_theta_millidegrees);
+    LOG_DBG("Initializing mirror sweep.");
+    LOG_DBG("Taking %zu mirror sweep frames", num_frames);
+    // No mirror values means we trivially succeed
+    if (num_frames == 0) {
+        LOG_WRN("Num mirror values is 0!");
+        return;
+    }
 
-    LL_TIM_ClearFlag_UPDATE(CAMERA_TRIGGER_TIMER);
-    LL_TIM_EnableIT_UPDATE(CAMERA_TRIGGER_TIMER);
+    // the first frame is taken at the starting position, the polynomials
+    // give the deltas of the following frames
+    phi_table[0] = 0;
+    theta_table[0] = 0;
+    // number of frames checked by the caller
+    ret_code_t err_code = ir_camera_sweep_mirror_table(
+        &mirror_sweep_polynomial, &phi_table[1], &theta_table[1],
+        MAX_NUMBER_OF_FOCUS_VALUES);
+    if (err_code != RET_SUCCESS) {
+        ASSERT_SOFT(err_code);
+        return;
+    }
+    sweep_table_num_frames[IR_CAMERA_SWEEP_MIRROR_PHI] = num_frames + 1;
+    sweep_table_num_frames[IR_CAMERA_SWEEP_MIRROR_THETA] = num_frames + 1;
 
-    LOG_DBG("Starting mirror sweep!");
+    set_mirror_sweep_in_progress();
+    err_code = start_sweep(BIT(IR_CAMERA_SWEEP_MIRROR_PHI) |
+                           BIT(IR_CAMERA_SWEEP_MIRROR_THETA));
+    if (err_code != RET_SUCCESS) {
+        ASSERT_SOFT(err_code);
+        clear_mirror_sweep_in_progress();
+    }
+}
 
-    ir_camera_system_enable_ir_eye_camera_force();
+ret_code_t
+ir_camera_system_perform_sweep_hw(uint32_t actuators)
+{
+    set_sweep_in_progress();
+    const ret_code_t err_code = start_sweep(actuators);
+    if (err_code != RET_SUCCESS) {
+        clear_sweep_in_progress();
+    }
+
+    return err_code;
 }
 
 void
-ir_camera_system_perform_mirror_sweep_hw(void)
+ir_camera_system_stop_sweep_hw(void)
 {
-    LOG_DBG("Initializing mirror sweep.");
-    LOG_DBG("Taking %zu mirror sweep frames",
-            mirror_sweep_polynomial.number_of_frames);
-    // No mirror values means we trivially succeed
-    if (mirror_sweep_polynomial.number_of_frames > 0) {
-        set_mirror_sweep_in_progress();
-        initialize_mirror_sweep();
-    } else {
-        LOG_WRN("Num mirror values is 0!");
+    if (ir_camera_sweep_in_progress()) {
+        LOG_WRN("Sweep aborted");
+        sweep_end();
     }
 }
 
@@ -623,6 +923,9 @@ ir_camera_system_timeout_disable(struct k_timer *timer)
     LOG_WRN("Turning off IR camera system after " STRINGIFY(
         IR_LED_AUTO_OFF_TIMEOUT_S) " secs of inactivity");
 
+    // the cameras can't be disabled during a sweep
+    ir_camera_system_stop_sweep_hw();
+
     int ret = ir_camera_system_enable_leds(
         orb_mcu_main_InfraredLEDs_Wavelength_WAVELENGTH_NONE);
     ASSERT_SOFT(ret);
@@ -773,6 +1076,12 @@ setup_camera_triggers(void)
                 camera_exposure_completes_isr, NULL, 0);
     irq_enable(CAMERA_TRIGGER_TIMER_UPDATE_IRQn);
 
+#if CAMERA_EXPOSURE_IT_ALWAYS_ON
+    // every exposure is followed, not only during sweeps
+    LL_TIM_ClearFlag_UPDATE(CAMERA_TRIGGER_TIMER);
+    LL_TIM_EnableIT_UPDATE(CAMERA_TRIGGER_TIMER);
+#endif
+
     LL_TIM_EnableCounter(CAMERA_TRIGGER_TIMER);
 
     return 0;
@@ -781,6 +1090,9 @@ setup_camera_triggers(void)
 static void
 ir_leds_enable_pulse(void)
 {
+    uint32_t leds_850nm = 0;
+    uint32_t leds_940nm = 0;
+
     // disable all UPDATE interrupts, later enable only active channel
     // the `UPDATE` event triggers the `ir_leds_pulse_finished_isr` (Pearl)
     LL_TIM_DisableIT_UPDATE(LED_850NM_TIMER);
@@ -788,6 +1100,7 @@ ir_leds_enable_pulse(void)
 
     // quit early in case LEDs must stay off
     if (global_timer_settings.on_time_in_us == 0) {
+        ir_leds_disable_all();
 #if defined(CONFIG_BOARD_PEARL_MAIN)
         ir_leds_pulse_finished_isr(NULL);
 #endif
@@ -797,37 +1110,29 @@ ir_leds_enable_pulse(void)
 #if defined(CONFIG_BOARD_PEARL_MAIN)
     switch (ir_camera_system_get_enabled_leds()) {
     case orb_mcu_main_InfraredLEDs_Wavelength_WAVELENGTH_850NM:
-        LL_TIM_CC_EnableChannel(LED_850NM_TIMER,
-                                ch2ll[LED_850NM_TIMER_LEFT_CHANNEL - 1]);
-        LL_TIM_CC_EnableChannel(LED_850NM_TIMER,
-                                ch2ll[LED_850NM_TIMER_RIGHT_CHANNEL - 1]);
+        leds_850nm |= ch2ll[LED_850NM_TIMER_LEFT_CHANNEL - 1];
+        leds_850nm |= ch2ll[LED_850NM_TIMER_RIGHT_CHANNEL - 1];
         LL_TIM_EnableIT_UPDATE(LED_850NM_TIMER);
         break;
     case orb_mcu_main_InfraredLEDs_Wavelength_WAVELENGTH_850NM_LEFT:
-        LL_TIM_CC_EnableChannel(LED_850NM_TIMER,
-                                ch2ll[LED_850NM_TIMER_LEFT_CHANNEL - 1]);
+        leds_850nm |= ch2ll[LED_850NM_TIMER_LEFT_CHANNEL - 1];
         LL_TIM_EnableIT_UPDATE(LED_850NM_TIMER);
         break;
     case orb_mcu_main_InfraredLEDs_Wavelength_WAVELENGTH_850NM_RIGHT:
-        LL_TIM_CC_EnableChannel(LED_850NM_TIMER,
-                                ch2ll[LED_850NM_TIMER_RIGHT_CHANNEL - 1]);
+        leds_850nm |= ch2ll[LED_850NM_TIMER_RIGHT_CHANNEL - 1];
         LL_TIM_EnableIT_UPDATE(LED_850NM_TIMER);
         break;
     case orb_mcu_main_InfraredLEDs_Wavelength_WAVELENGTH_940NM:
-        LL_TIM_CC_EnableChannel(LED_940NM_TIMER,
-                                ch2ll[LED_940NM_TIMER_LEFT_CHANNEL - 1]);
-        LL_TIM_CC_EnableChannel(LED_940NM_TIMER,
-                                ch2ll[LED_940NM_TIMER_RIGHT_CHANNEL - 1]);
+        leds_940nm |= ch2ll[LED_940NM_TIMER_LEFT_CHANNEL - 1];
+        leds_940nm |= ch2ll[LED_940NM_TIMER_RIGHT_CHANNEL - 1];
         LL_TIM_EnableIT_UPDATE(LED_940NM_TIMER);
         break;
     case orb_mcu_main_InfraredLEDs_Wavelength_WAVELENGTH_940NM_LEFT:
-        LL_TIM_CC_EnableChannel(LED_940NM_TIMER,
-                                ch2ll[LED_940NM_TIMER_LEFT_CHANNEL - 1]);
+        leds_940nm |= ch2ll[LED_940NM_TIMER_LEFT_CHANNEL - 1];
         LL_TIM_EnableIT_UPDATE(LED_940NM_TIMER);
         break;
     case orb_mcu_main_InfraredLEDs_Wavelength_WAVELENGTH_940NM_RIGHT:
-        LL_TIM_CC_EnableChannel(LED_940NM_TIMER,
-                                ch2ll[LED_940NM_TIMER_RIGHT_CHANNEL - 1]);
+        leds_940nm |= ch2ll[LED_940NM_TIMER_RIGHT_CHANNEL - 1];
         LL_TIM_EnableIT_UPDATE(LED_940NM_TIMER);
         break;
     case orb_mcu_main_InfraredLEDs_Wavelength_WAVELENGTH_740NM:
@@ -844,38 +1149,28 @@ ir_leds_enable_pulse(void)
 #elif defined(CONFIG_BOARD_DIAMOND_MAIN)
     switch (ir_camera_system_get_enabled_leds()) {
     case orb_mcu_main_InfraredLEDs_Wavelength_WAVELENGTH_850NM:
-        LL_TIM_CC_EnableChannel(LED_850NM_TIMER,
-                                ch2ll[LED_850NM_TIMER_CENTER_CHANNEL - 1]);
-        LL_TIM_CC_EnableChannel(LED_850NM_TIMER,
-                                ch2ll[LED_850NM_TIMER_SIDE_CHANNEL - 1]);
+        leds_850nm |= ch2ll[LED_850NM_TIMER_CENTER_CHANNEL - 1];
+        leds_850nm |= ch2ll[LED_850NM_TIMER_SIDE_CHANNEL - 1];
         break;
     case orb_mcu_main_InfraredLEDs_Wavelength_WAVELENGTH_850NM_CENTER:
-        LL_TIM_CC_EnableChannel(LED_850NM_TIMER,
-                                ch2ll[LED_850NM_TIMER_CENTER_CHANNEL - 1]);
+        leds_850nm |= ch2ll[LED_850NM_TIMER_CENTER_CHANNEL - 1];
         break;
     case orb_mcu_main_InfraredLEDs_Wavelength_WAVELENGTH_850NM_SIDE:
-        LL_TIM_CC_EnableChannel(LED_850NM_TIMER,
-                                ch2ll[LED_850NM_TIMER_SIDE_CHANNEL - 1]);
+        leds_850nm |= ch2ll[LED_850NM_TIMER_SIDE_CHANNEL - 1];
         break;
     case orb_mcu_main_InfraredLEDs_Wavelength_WAVELENGTH_940NM:
-        LL_TIM_CC_EnableChannel(LED_940NM_TIMER,
-                                ch2ll[LED_940NM_TIMER_LEFT_CHANNEL - 1]);
-        LL_TIM_CC_EnableChannel(LED_940NM_TIMER,
-                                ch2ll[LED_940NM_TIMER_RIGHT_CHANNEL - 1]);
-        LL_TIM_CC_EnableChannel(LED_940NM_TIMER,
-                                ch2ll[LED_940NM_TIMER_SINGLE_CHANNEL - 1]);
+        leds_940nm |= ch2ll[LED_940NM_TIMER_LEFT_CHANNEL - 1];
+        leds_940nm |= ch2ll[LED_940NM_TIMER_RIGHT_CHANNEL - 1];
+        leds_940nm |= ch2ll[LED_940NM_TIMER_SINGLE_CHANNEL - 1];
         break;
     case orb_mcu_main_InfraredLEDs_Wavelength_WAVELENGTH_940NM_LEFT:
-        LL_TIM_CC_EnableChannel(LED_940NM_TIMER,
-                                ch2ll[LED_940NM_TIMER_LEFT_CHANNEL - 1]);
+        leds_940nm |= ch2ll[LED_940NM_TIMER_LEFT_CHANNEL - 1];
         break;
     case orb_mcu_main_InfraredLEDs_Wavelength_WAVELENGTH_940NM_RIGHT:
-        LL_TIM_CC_EnableChannel(LED_940NM_TIMER,
-                                ch2ll[LED_940NM_TIMER_RIGHT_CHANNEL - 1]);
+        leds_940nm |= ch2ll[LED_940NM_TIMER_RIGHT_CHANNEL - 1];
         break;
     case orb_mcu_main_InfraredLEDs_Wavelength_WAVELENGTH_940NM_SINGLE:
-        LL_TIM_CC_EnableChannel(LED_940NM_TIMER,
-                                ch2ll[LED_940NM_TIMER_SINGLE_CHANNEL - 1]);
+        leds_940nm |= ch2ll[LED_940NM_TIMER_SINGLE_CHANNEL - 1];
         break;
     case orb_mcu_main_InfraredLEDs_Wavelength_WAVELENGTH_740NM:
     case orb_mcu_main_InfraredLEDs_Wavelength_WAVELENGTH_850NM_LEFT:
@@ -886,6 +1181,10 @@ ir_leds_enable_pulse(void)
         break;
     }
 #endif
+
+    // channels of the previous wavelength are disabled, the ones of the
+    // current wavelength kept enabled
+    ir_leds_set_channels(leds_850nm, leds_940nm);
 }
 
 static void
@@ -897,22 +1196,11 @@ ir_leds_set_pulse_length(void)
         global_timer_settings.on_time_in_us = 0;
     }
 
-    // reset states
-    // so that we can selectively enable the active channels
-    // from scratch
-    ir_leds_disable_all();
+    // channels are set by ir_leds_enable_pulse, without disabling the ones
+    // that stay enabled
 
-    if (global_timer_settings.on_time_in_us != 0) {
-        // set the ARR value for all IR LED timers
-        LL_TIM_SetAutoReload(LED_850NM_TIMER,
-                             global_timer_settings.on_time_in_us +
-                                 MAX(CAMERA_TRIGGER_TIMER_START_DELAY_US,
-                                     IR_LED_TIMER_START_DELAY_US));
-        LL_TIM_SetAutoReload(LED_940NM_TIMER,
-                             global_timer_settings.on_time_in_us +
-                                 MAX(CAMERA_TRIGGER_TIMER_START_DELAY_US,
-                                     IR_LED_TIMER_START_DELAY_US));
-    }
+    ir_camera_timers_leds_set_pulse(LED_850NM_TIMER, LED_940NM_TIMER,
+                                    &global_timer_settings);
 
     if (global_timer_settings.on_time_in_us > 0 &&
         global_timer_settings.fps > 0) {
@@ -922,14 +1210,96 @@ ir_leds_set_pulse_length(void)
     }
 }
 
+/// trigger windows in use, NULL if none scheduled
+static const struct ir_camera_schedule *
+trigger_schedule_get(void)
+{
+    return trigger_schedule_active ? &trigger_schedule : NULL;
+}
+
+/**
+ * The CAMERA_TRIGGER_TIMER period ends with the IR LED pulse, or with the
+ * latest scheduled window.
+ */
+static uint32_t
+camera_trigger_auto_reload(void)
+{
+    return ir_camera_timers_trigger_auto_reload(&global_timer_settings,
+                                                trigger_schedule_get());
+}
+
+/// keep the programmed IR eye camera window, for the frame records
+static void
+ir_eye_window_update(void)
+{
+    ir_camera_timers_trigger_window(
+        &global_timer_settings, trigger_schedule_get(),
+        IR_CAMERA_SCHEDULE_IR_EYE, &ir_eye_window_start_us,
+        &ir_eye_window_end_us);
+}
+
+/**
+ * Program the window of each camera trigger channel: the scheduled one, or
+ * the IR LED pulse from the default start delay.
+ * Compare values are preloaded and applied from the next trigger.
+ */
+static void
+camera_trigger_set_phases(void)
+{
+    ir_camera_timers_trigger_set_phases(CAMERA_TRIGGER_TIMER,
+                                        schedule_channels,
+                                        &global_timer_settings,
+                                        trigger_schedule_get());
+    ir_eye_window_update();
+}
+
+/**
+ * Check a schedule against the current frame period and IR LED pulse
+ */
+static ret_code_t
+schedule_check(const struct ir_camera_schedule *schedule,
+               ir_camera_schedule_camera_t *conflict)
+{
+    if (global_timer_settings.fps == 0) {
+        return RET_ERROR_INVALID_STATE;
+    }
+
+    for (size_t i = 0; i < IR_CAMERA_SCHEDULE_CAMERA_COUNT; ++i) {
+        if (!schedule->slots[i].used) {
+            continue;
+        }
+        // a compare value of 0 keeps the output active during the whole
+        // period, and the cameras lit by the IR LEDs can't start before them
+        if (schedule_channels[i] == 0 ||
+            schedule->slots[i].phase_us < CAMERA_TRIGGER_TIMER_START_DELAY_US) {
+            *conflict = i;
+            return RET_ERROR_INVALID_PARAM;
+        }
+    }
+
+    const uint32_t led_start_us = IR_LED_TIMER_START_DELAY_US;
+    uint32_t led_end_us = led_start_us;
+    if (global_timer_settings.on_time_in_us != 0) {
+        led_end_us =
+            ir_camera_timers_pulse_auto_reload(&global_timer_settings) + 1;
+    }
+
+    ret_code_t ret = ir_camera_schedule_check(
+        schedule, 1000000 / global_timer_settings.fps, led_start_us,
+        led_end_us, conflict);
+    if (ret == RET_SUCCESS) {
+        ret = ir_camera_timers_trigger_check(
+            schedule_channels, &global_timer_settings, schedule, conflict);
+    }
+
+    return ret;
+}
+
 static void
 camera_enable_trigger(bool enabled, int channel)
 {
     // set the ARR value for the camera trigger timer
-    LL_TIM_SetAutoReload(CAMERA_TRIGGER_TIMER,
-                         global_timer_settings.on_time_in_us +
-                             MAX(CAMERA_TRIGGER_TIMER_START_DELAY_US,
-                                 IR_LED_TIMER_START_DELAY_US));
+    LL_TIM_SetAutoReload(CAMERA_TRIGGER_TIMER, camera_trigger_auto_reload());
 
     // enable only the active channel
     if (enabled && global_timer_settings.fps > 0) {
@@ -939,45 +1309,60 @@ camera_enable_trigger(bool enabled, int channel)
     }
 }
 
+/// cameras to trigger, BIT(ir_camera_schedule_camera_t)
+static uint32_t
+cameras_enabled(void)
+{
+    uint32_t enabled = 0;
+
+    if (ir_camera_system_ir_eye_camera_is_enabled()) {
+        enabled |= BIT(IR_CAMERA_SCHEDULE_IR_EYE);
+    }
+    if (ir_camera_system_ir_face_camera_is_enabled()) {
+        enabled |= BIT(IR_CAMERA_SCHEDULE_IR_FACE);
+    }
+    if (ir_camera_system_2d_tof_camera_is_enabled()) {
+        enabled |= BIT(IR_CAMERA_SCHEDULE_TOF_2D);
+    }
+
+    return enabled;
+}
+
 static void
 apply_new_timer_settings()
 {
     static struct ir_camera_timer_settings old_timer_settings = {0};
     bool ir_camera_triggered = false;
+    uint32_t cameras = BIT_MASK(IR_CAMERA_SCHEDULE_CAMERA_COUNT);
 
     CRITICAL_SECTION_ENTER(k);
 
-    // If the FPS is zero, we disable the timers. If it is greater than zero, we
-    // enable them.
-    if (global_timer_settings.fps == 0 &&
-        LL_TIM_IsEnabledCounter(MASTER_TIMER)) {
-        LL_TIM_DisableCounter(MASTER_TIMER);
-        LOG_DBG("Disabling camera trigger timer");
-    } else if (global_timer_settings.fps > 0 &&
-               !LL_TIM_IsEnabledCounter(MASTER_TIMER)) {
-        LL_TIM_EnableCounter(MASTER_TIMER);
-        LOG_DBG("Enabling camera trigger timer");
+    if (trigger_schedule_active) {
+        ir_camera_schedule_camera_t conflict;
+        if (schedule_check(&trigger_schedule, &conflict) != RET_SUCCESS) {
+            LOG_WRN("Camera schedule (%s) doesn't fit the new settings, "
+                    "cleared",
+                    schedule_camera_names[conflict]);
+            trigger_schedule_active = false;
+        }
     }
 
-    LL_TIM_SetPrescaler(MASTER_TIMER, global_timer_settings.master_psc);
-    LL_TIM_SetAutoReload(MASTER_TIMER, global_timer_settings.master_arr);
-
 #ifdef CONFIG_BOARD_DIAMOND_MAIN
     // explicitly disable the ir eye camera trigger when applying new settings
     // in case face camera is enabled, since it's gonna synchronize with
     // the strobe signal
-    if (!ir_camera_system_ir_face_camera_is_enabled()) {
-        camera_enable_trigger(ir_camera_system_ir_eye_camera_is_enabled(),
-                              IR_EYE_CAMERA_TRIGGER_TIMER_CHANNEL);
+    if (ir_camera_system_ir_face_camera_is_enabled()) {
+        cameras &= ~BIT(IR_CAMERA_SCHEDULE_IR_EYE);
     }
-#else
-    camera_enable_trigger(ir_camera_system_ir_eye_camera_is_enabled(),
-                          IR_EYE_CAMERA_TRIGGER_TIMER_CHANNEL);
-    camera_enable_trigger(ir_camera_system_ir_face_camera_is_enabled(),
-                          IR_FACE_CAMERA_TRIGGER_TIMER_CHANNEL);
 #endif
-    camera_enable_trigger(ir_camera_system_2d_tof_camera_is_enabled(),
-                          TOF_2D_CAMERA_TRIGGER_TIMER_CHANNEL);
+
+    // If the FPS is zero, the timers are disabled. Windows ending with the IR
+    // LED pulse follow the on-time.
+    ir_camera_timers_apply(MASTER_TIMER, CAMERA_TRIGGER_TIMER,
+                           schedule_channels, cameras, cameras_enabled(),
+                           &global_timer_settings, &old_timer_settings,
+                           trigger_schedule_get());
+    ir_eye_window_update();
 
     ir_leds_set_pulse_length();
 #ifdef CONFIG_BOARD_DIAMOND_MAIN
@@ -985,6 +1370,8 @@ apply_new_timer_settings()
     if (!ir_camera_system_ir_face_camera_is_enabled()) {
         ir_leds_enable_pulse();
         ir_camera_triggered = true;
+    } else {
+        ir_leds_disable_all();
     }
 #else
     ir_leds_enable_pulse();
@@ -1067,6 +1454,12 @@ setup_850nm_led_timer(void)
                  "here if MASTER_TIMER is not longer timer 4");
     LL_TIM_SetTriggerInput(LED_850NM_TIMER, LL_TIM_TS_ITR3); // timer 4
 
+#if defined(CONFIG_IR_LED_RAIL)
+    // ADC1 injected trigger: high during the strobe
+    LL_TIM_SetTriggerOutput(LED_850NM_TIMER,
+                            ch2trgo[LED_850NM_TIMER_LEFT_CHANNEL - 1]);
+#endif
+
     LL_TIM_EnableARRPreload(LED_850NM_TIMER);
 
     LL_TIM_OC_EnablePreload(LED_850NM_TIMER,
@@ -1151,6 +1544,12 @@ setup_940nm_led_timer(void)
     LL_TIM_SetTriggerInput(LED_940NM_TIMER,
                            LL_TIM_TS_ITR3); // timer 4
 
+#if defined(CONFIG_IR_LED_RAIL)
+    // ADC1 injected trigger: high during the strobe
+    LL_TIM_SetTriggerOutput(LED_940NM_TIMER,
+                            ch2trgo[LED_940NM_TIMER_LEFT_CHANNEL - 1]);
+#endif
+
     LL_TIM_EnableARRPreload(LED_940NM_TIMER);
 
     LL_TIM_OC_EnablePreload(LED_940NM_TIMER,
@@ -1179,6 +1578,7 @@ ir_camera_system_disable_ir_eye_camera_hw(void)
     camera_enable_trigger(false, IR_EYE_CAMERA_TRIGGER_TIMER_CHANNEL);
     debug_print();
     configure_timeout();
+    frames_flush();
 }
 
 #ifdef CONFIG_BOARD_DIAMOND_MAIN
@@ -1248,6 +1648,7 @@ ir_camera_system_disable_ir_face_camera_hw(void)
 
     debug_print();
     configure_timeout();
+    frames_flush();
 }
 
 void
@@ -1264,6 +1665,7 @@ ir_camera_system_disable_2d_tof_camera_hw(void)
     camera_enable_trigger(false, TOF_2D_CAMERA_TRIGGER_TIMER_CHANNEL);
     debug_print();
     configure_timeout();
+    frames_flush();
 }
 
 __maybe_unused uint32_t
@@ -1277,16 +1679,59 @@ ir_camera_system_get_time_until_update_us_internal(void)
     return time_until_update_us;
 }
 
+ret_code_t
+ir_camera_system_set_schedule_hw(const struct ir_camera_schedule *schedule)
+{
+    ret_code_t ret = RET_SUCCESS;
+    ir_camera_schedule_camera_t conflict = IR_CAMERA_SCHEDULE_IR_EYE;
+
+    CRITICAL_SECTION_ENTER(k);
+
+    if (schedule == NULL) {
+        trigger_schedule_active = false;
+    } else {
+        ret = schedule_check(schedule, &conflict);
+        if (ret == RET_SUCCESS) {
+            trigger_schedule = *schedule;
+            trigger_schedule_active = true;
+        }
+    }
+
+    if (ret == RET_SUCCESS) {
+        camera_trigger_set_phases();
+    }
+
+    CRITICAL_SECTION_EXIT(k);
+
+    if (ret == RET_ERROR_INVALID_STATE) {
+        LOG_ERR("Camera schedule needs a frame period, set the FPS first");
+    } else if (ret != RET_SUCCESS) {
+        LOG_ERR("Camera schedule rejected: %s",
+                schedule_camera_names[conflict]);
+    }
+
+    return ret;
+}
+
 ret_code_t
 ir_camera_system_set_fps_hw(uint16_t fps)
 {
     ret_code_t ret;
+
+    // no more frames to end the sweep in progress
+    if (fps == 0) {
+        ir_camera_system_stop_sweep_hw();
+    }
+
     ret = timer_settings_from_fps(fps, &global_timer_settings,
                                   &global_timer_settings);
     if (ret != RET_SUCCESS) {
         LOG_ERR("Error setting new FPS");
     } else {
         apply_new_timer_settings();
+        if (fps == 0) {
+            frames_flush();
+        }
     }
 
     debug_print();
@@ -1382,6 +1827,37 @@ ir_camera_system_get_fps_hw(void)
 // - Enable IR LEDs (if safe) for RGB-IR camera illumination
 // - Generate MASTER_TIMER UPDATE event to start LED pulse
 
+#if defined(CONFIG_IR_CAMERA_FRAMES)
+// start of the RGB-IR exposure in progress, valid if `rgb_ir_exposure_started`
+static uint32_t rgb_ir_exposure_start_us;
+static bool rgb_ir_exposure_started = false;
+
+/**
+ * Record the RGB-IR exposure that just ended, on the falling edge of the
+ * strobe, the start being taken on the rising edge
+ */
+static void
+rgb_ir_frame_record(void)
+{
+    // falling edge without the rising one, e.g. strobe interrupt enabled
+    // during an exposure
+    if (!rgb_ir_exposure_started) {
+        return;
+    }
+
+    const uint32_t now_us = ir_camera_frames_timestamp_us(0);
+    const struct ir_camera_frame frame = {
+        .timestamp_us = rgb_ir_exposure_start_us,
+        .exposure_us = MIN(now_us - rgb_ir_exposure_start_us, UINT16_MAX),
+        .wavelength = frame_wavelength(),
+        .sweep_frame = IR_CAMERA_FRAMES_NO_SWEEP,
+    };
+    rgb_ir_exposure_started = false;
+
+    ir_camera_frames_record(IR_CAMERA_FRAMES_RGB_STROBE, &frame);
+}
+#endif
+
 static void
 rgb_ir_strobe_isr(const struct device *port, struct gpio_callback *cb,
                   uint32_t pins)
@@ -1389,25 +1865,19 @@ rgb_ir_strobe_isr(const struct device *port, struct gpio_callback *cb,
     ARG_UNUSED(port);
     ARG_UNUSED(cb);
     ARG_UNUSED(pins);
+    const uint32_t isr_start = cpu_usage_isr_enter();
 
     int strobe_level = gpio_pin_get_dt(&rgb_ir_face_strobe);
     if (strobe_level == 0) {
+#if defined(CONFIG_IR_CAMERA_FRAMES)
+        rgb_ir_frame_record();
+#endif
+
         // use critical section to ensure settings aren't changed
         // during execution of this ISR
         CRITICAL_SECTION_ENTER(k);
 
-        if (global_timer_settings.fps > 0) {
-            // Set master counter settings based on most recent timer settings
-            LL_TIM_SetPrescaler(MASTER_TIMER, global_timer_settings.master_psc);
-            LL_TIM_SetAutoReload(MASTER_TIMER,
-                                 global_timer_settings.master_arr);
-            // The timer will count from the new counter value to
-            // ARR to generate an UPDATE event
-            LL_TIM_SetCounter(MASTER_TIMER,
-                              global_timer_settings.master_initial_counter);
-        } else {
-            LL_TIM_DisableCounter(MASTER_TIMER);
-        }
+        ir_camera_timers_strobe_ended(MASTER_TIMER, &global_timer_settings);
 
         // set most recent IR LED pulse length
         ir_leds_set_pulse_length();
@@ -1428,64 +1898,19 @@ rgb_ir_strobe_isr(const struct device *port, struct gpio_callback *cb,
         // Rising edge: Turn on IR LEDs for RGB-IR camera illumination
         // if it occurs before the scheduled ir led pulse.
         // otherwise, pulse is already ongoing, so do nothing.
+#if defined(CONFIG_IR_CAMERA_FRAMES)
+        rgb_ir_exposure_start_us = ir_camera_frames_timestamp_us(0);
+        rgb_ir_exposure_started = true;
+#endif
 
-        // Calculate remaining time until MASTER_TIMER reaches ARR
-        const uint32_t current_counter = LL_TIM_GetCounter(MASTER_TIMER);
-        // detect wrap around, meaning the MASTER_TIMER triggered already
-        // ie, the isr occurs during a pulse, so do nothing and return
-        if (current_counter < global_timer_settings.master_initial_counter) {
-            return;
-        }
-
-        // the remaining ticks before scheduled ir led pulse is:
-        const uint32_t remaining_ticks =
-            global_timer_settings.master_arr - current_counter;
-
-        // Convert remaining ticks to microseconds
-        // time_us = remaining_ticks * (prescaler + 1) / TIMER_CLOCK_FREQ_MHZ
-        // Use uint64_t intermediate to prevent overflow
-        const uint32_t remaining_us = ((uint64_t)remaining_ticks *
-                                       (global_timer_settings.master_psc + 1)) /
-                                      TIMER_CLOCK_FREQ_MHZ;
-
-        if (remaining_us + global_timer_settings.on_time_in_us >
-            IR_CAMERA_SYSTEM_MAX_IR_LED_ON_TIME_US) {
-            // More than max IR duration time left: reconfigure MASTER_TIMER to
-            // trigger before expected time and set IR LEDs pulse to last max
-            // duration time
-
-            // Set master timer counter so UPDATE occurs
-            // `master_max_ir_leds_tick` before the end of the strobe
-            LL_TIM_SetCounter(
-                MASTER_TIMER,
-                global_timer_settings.master_arr -
-                    (remaining_ticks -
-                     global_timer_settings.master_max_ir_leds_tick));
-
-            LL_TIM_SetAutoReload(LED_850NM_TIMER,
-                                 IR_CAMERA_SYSTEM_MAX_IR_LED_ON_TIME_US);
-            LL_TIM_SetAutoReload(LED_940NM_TIMER,
-                                 IR_CAMERA_SYSTEM_MAX_IR_LED_ON_TIME_US);
-        } else {
-            // Less than IR_CAMERA_SYSTEM_MAX_IR_LED_ON_TIME_US left: set IR
-            // LEDs to last until end of period + on_time_in_us
-
-            // Total duration = remaining time to ARR + configured on_time
-            // /!\ we assume:
-            // remaining_us + global_timer_settings.on_time_in_us
-            //          < IR_CAMERA_SYSTEM_MAX_IR_LED_ON_TIME_US
-            // as checked above
-            uint32_t total_duration_us =
-                remaining_us + global_timer_settings.on_time_in_us;
-
-            LL_TIM_SetAutoReload(LED_850NM_TIMER, total_duration_us);
-            LL_TIM_SetAutoReload(LED_940NM_TIMER, total_duration_us);
-
-            LL_TIM_GenerateEvent_UPDATE(MASTER_TIMER);
-        }
+        ir_camera_timers_strobe_started(MASTER_TIMER, LED_850NM_TIMER,
+                                        LED_940NM_TIMER,
+                                        &global_timer_settings);
     } else {
         ASSERT_SOFT(strobe_level);
     }
+
+    cpu_usage_isr_exit(CPU_USAGE_ISR_RGB_IR_STROBE, isr_start);
 }
 #endif
 
@@ -1575,6 +2000,8 @@ ir_camera_system_hw_init(void)
     irq_enable(LED_850NM_TIMER_GLOBAL_IRQn);
 #endif
 
+    sweep_register_actuators();
+
 #if defined(CONFIG_BOARD_DIAMOND_MAIN)
     const struct gpio_dt_spec en_5v_switched =
         GPIO_DT_SPEC_GET(DT_PATH(zephyr_user), front_unit_en_5v_switched_gpios);
@@ -37,6 +37,8 @@ ret_code_t
 ir_camera_system_set_fps_hw(uint16_t fps);
 ret_code_t
 ir_camera_system_set_on_time_us_hw(uint16_t on_time_us);
+ret_code_t
+ir_camera_system_set_schedule_hw(const struct ir_camera_schedule *schedule);
 
 #if defined(ZTEST)
 // mock the function to avoid including the ir_camera_system_hw module
@@ -68,5 +70,14 @@ ir_camera_system_set_polynomial_coefficients_for_mirror_sweep_hw(
 void
 ir_camera_system_perform_mirror_sweep_hw(void);
 
+/* Generic sweep */
+void
+ir_camera_system_set_sweep_table_hw(ir_camera_sweep_actuator_t actuator,
+                                    const int16_t *values, size_t num_frames);
+ret_code_t
+ir_camera_system_perform_sweep_hw(uint32_t actuators);
+void
+ir_camera_system_stop_sweep_hw(void);
+
 uint16_t
 ir_camera_system_get_fps_hw(void);
@@ -20,6 +20,13 @@ set_mirror_sweep_in_progress(void);
 void
 clear_mirror_sweep_in_progress(void);
 
+bool
+get_sweep_in_progress(void);
+void
+set_sweep_in_progress(void);
+void
+clear_sweep_in_progress(void);
+
 void
 ir_camera_system_enable_ir_eye_camera_force(void);
 void
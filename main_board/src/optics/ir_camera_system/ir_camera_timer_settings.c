@@ -162,6 +162,29 @@ timer_settings_from_fps(uint16_t fps,
     return ret;
 }
 
+uint32_t
+timer_settings_master_commit_delay_ticks(
+    uint16_t counter, const struct ir_camera_timer_settings *active)
+{
+    if (active->fps == 0 || active->master_arr == 0) {
+        // counter stopped: no update event to wait for
+        return 0;
+    }
+
+    const uint32_t margin_ticks =
+        DIV_ROUND_UP(IR_CAMERA_SYSTEM_MASTER_COMMIT_MARGIN_US *
+                         TIMER_CLOCK_FREQ_MHZ,
+                     active->master_psc + 1);
+
+    if (counter > active->master_arr ||
+        (uint32_t)counter + margin_ticks <= active->master_arr) {
+        return 0;
+    }
+
+    // wait for the update event, the counter restarting from 0
+    return active->master_arr - counter + 1;
+}
+
 void
 timer_settings_print(const struct ir_camera_timer_settings *settings)
 {
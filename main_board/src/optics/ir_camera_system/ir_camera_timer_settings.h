@@ -69,6 +69,10 @@ BUILD_ASSERT(CAMERA_TRIGGER_TIMER_START_DELAY_US > 0 &&
              "output is low in idle state");
 #endif
 
+// longest time to write both master timer prescaler and auto-reload
+// registers, interrupts locked, see timer_settings_master_commit_delay_ticks
+#define IR_CAMERA_SYSTEM_MASTER_COMMIT_MARGIN_US 2
+
 struct ir_camera_timer_settings {
     uint16_t fps;
     uint16_t master_psc;
@@ -99,3 +103,20 @@ ret_code_t
 timer_settings_from_fps(uint16_t fps,
                         const struct ir_camera_timer_settings *current_settings,
                         struct ir_camera_timer_settings *new_settings);
+
+/**
+ * The master timer prescaler and auto-reload registers are preloaded: both
+ * are transferred to their shadow registers at the next update event, so
+ * that the period in progress completes with the previous settings. If that
+ * event occurs between both writes, the following period uses the new
+ * prescaler with the old auto-reload value, and a frame is triggered at the
+ * wrong time.
+ *
+ * @param counter Current counter value of the master timer
+ * @param active Settings the master timer is running with
+ * @return number of master timer ticks to wait before writing both registers,
+ *  0 if they can be written right away
+ */
+uint32_t
+timer_settings_master_commit_delay_ticks(
+    uint16_t counter, const struct ir_camera_timer_settings *active);
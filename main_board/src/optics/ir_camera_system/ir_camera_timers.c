@@ -0,0 +1,355 @@
+#include "ir_camera_timers.h"
+#include "ir_camera_sweep.h"
+#include <stddef.h>
+#ifdef CONFIG_ZTEST
+#include <zephyr/logging/log.h>
+#else
+#include "orb_logs.h"
+#endif
+#include <zephyr/sys/util.h>
+
+LOG_MODULE_DECLARE(ir_camera_system);
+
+uint32_t
+ir_camera_timers_pulse_auto_reload(
+    const struct ir_camera_timer_settings *settings)
+{
+    return settings->on_time_in_us + MAX(CAMERA_TRIGGER_TIMER_START_DELAY_US,
+                                         IR_LED_TIMER_START_DELAY_US);
+}
+
+static void
+set_compare(TIM_TypeDef *timer, int channel, uint32_t compare)
+{
+    switch (channel) {
+    case 1:
+        LL_TIM_OC_SetCompareCH1(timer, compare);
+        break;
+    case 2:
+        LL_TIM_OC_SetCompareCH2(timer, compare);
+        break;
+    case 3:
+        LL_TIM_OC_SetCompareCH3(timer, compare);
+        break;
+    case 4:
+        LL_TIM_OC_SetCompareCH4(timer, compare);
+        break;
+    default:
+        break;
+    }
+}
+
+static uint32_t
+ll_channel(int channel)
+{
+    static const uint32_t ll_channels[] = {
+        LL_TIM_CHANNEL_CH1, LL_TIM_CHANNEL_CH2, LL_TIM_CHANNEL_CH3,
+        LL_TIM_CHANNEL_CH4};
+
+    return ll_channels[channel - 1];
+}
+
+/// other channel of the pair of `channel`, for the combined PWM mode
+static int
+pair_channel(int channel)
+{
+    return ((channel - 1) ^ 1) + 1;
+}
+
+void
+ir_camera_timers_trigger_window(const struct ir_camera_timer_settings *settings,
+                                const struct ir_camera_schedule *schedule,
+                                ir_camera_schedule_camera_t camera,
+                                uint32_t *start_us, uint32_t *end_us)
+{
+    if (schedule != NULL && schedule->slots[camera].used) {
+        *start_us = schedule->slots[camera].phase_us;
+        *end_us = *start_us + schedule->slots[camera].window_us;
+    } else {
+        *start_us = CAMERA_TRIGGER_TIMER_START_DELAY_US;
+        *end_us = ir_camera_timers_pulse_auto_reload(settings) + 1;
+    }
+}
+
+uint32_t
+ir_camera_timers_trigger_auto_reload(
+    const struct ir_camera_timer_settings *settings,
+    const struct ir_camera_schedule *schedule)
+{
+    uint32_t end_us = ir_camera_timers_pulse_auto_reload(settings) + 1;
+
+    if (schedule != NULL) {
+        end_us = MAX(end_us, ir_camera_schedule_end_us(schedule));
+    }
+
+    return end_us - 1;
+}
+
+ret_code_t
+ir_camera_timers_trigger_check(
+    const int channels[IR_CAMERA_SCHEDULE_CAMERA_COUNT],
+    const struct ir_camera_timer_settings *settings,
+    const struct ir_camera_schedule *schedule,
+    ir_camera_schedule_camera_t *conflict)
+{
+    const uint32_t arr =
+        ir_camera_timers_trigger_auto_reload(settings, schedule);
+
+    for (size_t i = 0; i < IR_CAMERA_SCHEDULE_CAMERA_COUNT; ++i) {
+        if (channels[i] == 0) {
+            continue;
+        }
+        *conflict = i;
+
+        uint32_t start_us, end_us;
+        ir_camera_timers_trigger_window(settings, schedule, i, &start_us,
+                                        &end_us);
+        if (end_us - 1 > BIT_MASK(TIMER_COUNTER_WIDTH_BITS)) {
+            return RET_ERROR_INVALID_PARAM;
+        }
+        if (end_us > arr) {
+            continue;
+        }
+        for (size_t j = 0; j < IR_CAMERA_SCHEDULE_CAMERA_COUNT; ++j) {
+            if (channels[j] == pair_channel(channels[i])) {
+                return RET_ERROR_INVALID_PARAM;
+            }
+        }
+    }
+
+    return RET_SUCCESS;
+}
+
+void
+ir_camera_timers_trigger_set_phases(
+    TIM_TypeDef *trigger, const int channels[IR_CAMERA_SCHEDULE_CAMERA_COUNT],
+    const struct ir_camera_timer_settings *settings,
+    const struct ir_camera_schedule *schedule)
+{
+    const uint32_t arr =
+        ir_camera_timers_trigger_auto_reload(settings, schedule);
+
+    for (size_t i = 0; i < IR_CAMERA_SCHEDULE_CAMERA_COUNT; ++i) {
+        const int channel = channels[i];
+        if (channel == 0) {
+            continue;
+        }
+
+        uint32_t start_us, end_us;
+        ir_camera_timers_trigger_window(settings, schedule, i, &start_us,
+                                        &end_us);
+        set_compare(trigger, channel, start_us);
+        if (end_us > arr) {
+            // until the end of the period
+            LL_TIM_OC_SetMode(trigger, ll_channel(channel),
+                              LL_TIM_OCMODE_PWM2);
+        } else {
+            // active from the compare value of the trigger channel, and
+            // while the counter is below the one of the other channel
+            const int pair = pair_channel(channel);
+            set_compare(trigger, pair, end_us);
+            LL_TIM_OC_EnablePreload(trigger, ll_channel(pair));
+            LL_TIM_OC_SetMode(trigger, ll_channel(pair), LL_TIM_OCMODE_PWM1);
+            LL_TIM_OC_SetMode(trigger, ll_channel(channel),
+                              LL_TIM_OCMODE_COMBINED_PWM2);
+        }
+    }
+
+    LL_TIM_SetAutoReload(trigger, arr);
+}
+
+void
+ir_camera_timers_apply(TIM_TypeDef *master, TIM_TypeDef *trigger,
+                       const int channels[IR_CAMERA_SCHEDULE_CAMERA_COUNT],
+                       uint32_t cameras, uint32_t enabled,
+                       const struct ir_camera_timer_settings *next,
+                       const struct ir_camera_timer_settings *active,
+                       const struct ir_camera_schedule *schedule)
+{
+    if (next->fps == 0 && LL_TIM_IsEnabledCounter(master)) {
+        LL_TIM_DisableCounter(master);
+        LOG_DBG("Disabling camera trigger timer");
+    } else if (next->fps > 0 && !LL_TIM_IsEnabledCounter(master)) {
+        LL_TIM_EnableCounter(master);
+        LOG_DBG("Enabling camera trigger timer");
+    }
+
+    ir_camera_timers_master_commit(master, next, active);
+    ir_camera_timers_trigger_set_phases(trigger, channels, next, schedule);
+
+    for (size_t i = 0; i < IR_CAMERA_SCHEDULE_CAMERA_COUNT; ++i) {
+        if (channels[i] == 0 || (cameras & BIT(i)) == 0) {
+            continue;
+        }
+        if ((enabled & BIT(i)) != 0 && next->fps > 0) {
+            LL_TIM_CC_EnableChannel(trigger, ll_channel(channels[i]));
+        } else {
+            LL_TIM_CC_DisableChannel(trigger, ll_channel(channels[i]));
+        }
+    }
+}
+
+void
+ir_camera_timers_leds_set_pulse(TIM_TypeDef *led_850nm, TIM_TypeDef *led_940nm,
+                                const struct ir_camera_timer_settings *settings)
+{
+    if (settings->on_time_in_us != 0) {
+        const uint32_t arr = ir_camera_timers_pulse_auto_reload(settings);
+        LL_TIM_SetAutoReload(led_850nm, arr);
+        LL_TIM_SetAutoReload(led_940nm, arr);
+    }
+}
+
+void
+ir_camera_timers_leds_set_channels(TIM_TypeDef *led, uint32_t channels,
+                                   uint32_t enabled)
+{
+    // LL_TIM_CHANNEL_CHx are the CCxE bits of CCER
+    MODIFY_REG(led->CCER, channels, enabled);
+}
+
+void
+ir_camera_timers_master_commit(TIM_TypeDef *master,
+                               const struct ir_camera_timer_settings *next,
+                               const struct ir_camera_timer_settings *active)
+{
+    if (LL_TIM_IsEnabledCounter(master)) {
+        // update event imminent: let it go, at most
+        // IR_CAMERA_SYSTEM_MASTER_COMMIT_MARGIN_US
+        while (timer_settings_master_commit_delay_ticks(
+                   LL_TIM_GetCounter(master), active) != 0) {
+        }
+    }
+
+    LL_TIM_SetPrescaler(master, next->master_psc);
+    LL_TIM_SetAutoReload(master, next->master_arr);
+}
+
+#ifdef CONFIG_BOARD_DIAMOND_MAIN
+void
+ir_camera_timers_strobe_ended(TIM_TypeDef *master,
+                              const struct ir_camera_timer_settings *settings)
+{
+    if (settings->fps > 0) {
+        // Set master counter settings based on most recent timer settings
+        LL_TIM_SetPrescaler(master, settings->master_psc);
+        LL_TIM_SetAutoReload(master, settings->master_arr);
+        // The timer will count from the new counter value to
+        // ARR to generate an UPDATE event
+        LL_TIM_SetCounter(master, settings->master_initial_counter);
+    } else {
+        LL_TIM_DisableCounter(master);
+    }
+}
+
+void
+ir_camera_timers_strobe_started(TIM_TypeDef *master, TIM_TypeDef *led_850nm,
+                                TIM_TypeDef *led_940nm,
+                                const struct ir_camera_timer_settings *settings)
+{
+    // Calculate remaining time until MASTER_TIMER reaches ARR
+    const uint32_t current_counter = LL_TIM_GetCounter(master);
+    // detect wrap around, meaning the MASTER_TIMER triggered already
+    // ie, the isr occurs during a pulse, so do nothing and return
+    if (current_counter < settings->master_initial_counter) {
+        return;
+    }
+
+    // the remaining ticks before scheduled ir led pulse is:
+    const uint32_t remaining_ticks = settings->master_arr - current_counter;
+
+    // Convert remaining ticks to microseconds
+    // time_us = remaining_ticks * (prescaler + 1) / TIMER_CLOCK_FREQ_MHZ
+    // Use uint64_t intermediate to prevent overflow
+    const uint32_t remaining_us =
+        ((uint64_t)remaining_ticks * (settings->master_psc + 1)) /
+        TIMER_CLOCK_FREQ_MHZ;
+
+    if (remaining_us + settings->on_time_in_us >
+        IR_CAMERA_SYSTEM_MAX_IR_LED_ON_TIME_US) {
+        // More than max IR duration time left: reconfigure MASTER_TIMER to
+        // trigger before expected time and set IR LEDs pulse to last max
+        // duration time
+
+        // Set master timer counter so UPDATE occurs
+        // `master_max_ir_leds_tick` before the end of the strobe
+        LL_TIM_SetCounter(master,
+                          settings->master_arr -
+                              (remaining_ticks -
+                               settings->master_max_ir_leds_tick));
+
+        LL_TIM_SetAutoReload(led_850nm, IR_CAMERA_SYSTEM_MAX_IR_LED_ON_TIME_US);
+        LL_TIM_SetAutoReload(led_940nm, IR_CAMERA_SYSTEM_MAX_IR_LED_ON_TIME_US);
+    } else {
+        // Less than IR_CAMERA_SYSTEM_MAX_IR_LED_ON_TIME_US left: set IR
+        // LEDs to last until end of period + on_time_in_us
+
+        // Total duration = remaining time to ARR + configured on_time
+        // /!\ we assume:
+        // remaining_us + settings->on_time_in_us
+        //          < IR_CAMERA_SYSTEM_MAX_IR_LED_ON_TIME_US
+        // as checked above
+        const uint32_t total_duration_us =
+            remaining_us + settings->on_time_in_us;
+
+        LL_TIM_SetAutoReload(led_850nm, total_duration_us);
+        LL_TIM_SetAutoReload(led_940nm, total_duration_us);
+
+        LL_TIM_GenerateEvent_UPDATE(master);
+    }
+}
+#endif
+
+void
+ir_camera_timers_sweep_stop(TIM_TypeDef *trigger, bool it_always_on)
+{
+    ir_camera_sweep_stop();
+
+    if (!it_always_on) {
+        LL_TIM_DisableIT_UPDATE(trigger);
+    }
+}
+
+static bool
+exposure_ended(TIM_TypeDef *trigger)
+{
+    LL_TIM_ClearFlag_UPDATE(trigger);
+
+    // the counter is stopped at the end of the one-pulse period, not when
+    // the slave reset starts a trigger
+    return !LL_TIM_IsEnabledCounter(trigger);
+}
+
+void
+ir_camera_timers_exposure_isr(TIM_TypeDef *master, TIM_TypeDef *trigger,
+                              bool it_always_on,
+                              const struct ir_camera_timers_exposure_ops *ops)
+{
+    // only catch the end of a pulse
+    if (!exposure_ended(trigger)) {
+        return;
+    }
+
+    // the trigger timer is started by the master update event, the master
+    // keeps counting from 0 since then
+    const uint32_t since_master_update_us = LL_TIM_GetCounter(master) *
+                                            (LL_TIM_GetPrescaler(master) + 1) /
+                                            TIMER_CLOCK_FREQ_MHZ;
+    ops->ended(since_master_update_us);
+
+    bool deferred_pending = false;
+    if (!ir_camera_sweep_in_progress()) {
+        // the interrupt stays enabled outside sweeps to stream frames
+        if (!it_always_on) {
+            LOG_ERR("Nothing is in progress, this should not be possible!");
+        }
+    } else if (ir_camera_sweep_next_frame(&deferred_pending)) {
+        if (deferred_pending) {
+            ops->deferred();
+        }
+    } else {
+        LOG_DBG("Sweep complete!");
+        ir_camera_timers_sweep_stop(trigger, it_always_on);
+        ops->sweep_end();
+    }
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include "ir_camera_schedule.h"
+#include "ir_camera_timer_settings.h"
+#include <errors.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32_ll_tim.h>
+
+/**
+ * Programming of the IR camera system timers, from the settings.
+ *
+ * The master timer update event starts, once per frame, the one-pulse camera
+ * trigger and IR LED timers (slave mode combined reset + trigger). Their
+ * outputs are in PWM mode 2, active from the compare value to the end of the
+ * period, and all their registers are preloaded: values written during a
+ * frame are applied from the next one.
+ *
+ * The timer side of the camera exposure and RGB-IR strobe ISRs lives here
+ * too. Only LL timer calls are used, on the timers passed by the caller, so
+ * that this code runs against the simulated timers of the unit tests.
+ *
+ * Camera trigger windows: each output is active from its compare value (the
+ * phase) to the end of the camera trigger period, which is the end of the
+ * latest window. A window ending earlier is cut by the other channel of its
+ * pair (1-2, 3-4) in combined PWM mode: the trigger channel goes active at
+ * its own compare value and inactive at the compare value of the other
+ * channel, whose output must not be used by a camera.
+ */
+
+/**
+ * @param settings Timer settings
+ * @return auto-reload value of the IR LED timers, at 1 µs per tick: end of
+ *  the IR LED pulse
+ */
+uint32_t
+ir_camera_timers_pulse_auto_reload(
+    const struct ir_camera_timer_settings *settings);
+
+/**
+ * Trigger window of a camera, from the start of the camera trigger period
+ *
+ * @param settings Timer settings
+ * @param schedule Trigger windows, checked, NULL if none
+ * @param camera Camera
+ * @param start_us set to the scheduled phase, or to the default start delay
+ *  shared with the IR LEDs
+ * @param end_us set to the end of the scheduled window, or to the end of the
+ *  IR LED pulse
+ */
+void
+ir_camera_timers_trigger_window(const struct ir_camera_timer_settings *settings,
+                                const struct ir_camera_schedule *schedule,
+                                ir_camera_schedule_camera_t camera,
+                                uint32_t *start_us, uint32_t *end_us);
+
+/**
+ * @param settings Timer settings
+ * @param schedule Trigger windows, checked, NULL if none
+ * @return auto-reload value of the camera trigger timer, at the end of the
+ *  latest window
+ */
+uint32_t
+ir_camera_timers_trigger_auto_reload(
+    const struct ir_camera_timer_settings *settings,
+    const struct ir_camera_schedule *schedule);
+
+/**
+ * Check that the trigger windows can be programmed on the camera trigger
+ * timer
+ *
+ * @param channels Timer channel of each camera, 1 to 4, 0 if the camera
+ *  isn't triggered by the MCU
+ * @param settings Timer settings
+ * @param schedule Trigger windows, checked against the frame period
+ * @param conflict set to the camera at fault on error
+ * @retval RET_SUCCESS windows can be programmed
+ * @retval RET_ERROR_INVALID_PARAM a window ends after the largest period of
+ *  the 16-bit timer, or ends before the others while the other channel of
+ *  its pair triggers a camera
+ */
+ret_code_t
+ir_camera_timers_trigger_check(
+    const int channels[IR_CAMERA_SCHEDULE_CAMERA_COUNT],
+    const struct ir_camera_timer_settings *settings,
+    const struct ir_camera_schedule *schedule,
+    ir_camera_schedule_camera_t *conflict);
+
+/**
+ * Program the window of each camera trigger channel, its output mode and
+ * compare values, and the period of the camera trigger timer.
+ * Compare values and period are preloaded, output modes aren't: the trigger
+ * in progress may be cut at its previous end.
+ *
+ * @param trigger Camera trigger timer
+ * @param channels Timer channel of each camera, 1 to 4, 0 if the camera
+ *  isn't triggered by the MCU
+ * @param settings Timer settings
+ * @param schedule Trigger windows, checked, NULL if none
+ */
+void
+ir_camera_timers_trigger_set_phases(
+    TIM_TypeDef *trigger, const int channels[IR_CAMERA_SCHEDULE_CAMERA_COUNT],
+    const struct ir_camera_timer_settings *settings,
+    const struct ir_camera_schedule *schedule);
+
+/**
+ * Apply new settings: run the master timer while frames are taken and commit
+ * its period, program the trigger windows, then enable the trigger channel
+ * of each camera of `cameras` that is in `enabled`.
+ * Interrupts must be locked, see ir_camera_timers_master_commit.
+ *
+ * @param master Master timer
+ * @param trigger Camera trigger timer
+ * @param channels Timer channel of each camera, 1 to 4, 0 if the camera
+ *  isn't triggered by the MCU
+ * @param cameras Cameras whose trigger channel is updated,
+ *  BIT(ir_camera_schedule_camera_t)
+ * @param enabled Cameras to trigger, BIT(ir_camera_schedule_camera_t)
+ * @param next Settings to apply
+ * @param active Settings the master timer is running with
+ * @param schedule Trigger windows, checked against `next`, NULL if none
+ */
+void
+ir_camera_timers_apply(TIM_TypeDef *master, TIM_TypeDef *trigger,
+                       const int channels[IR_CAMERA_SCHEDULE_CAMERA_COUNT],
+                       uint32_t cameras, uint32_t enabled,
+                       const struct ir_camera_timer_settings *next,
+                       const struct ir_camera_timer_settings *active,
+                       const struct ir_camera_schedule *schedule);
+
+/**
+ * Set the IR LED pulse length, unless the IR LEDs are off
+ *
+ * @param led_850nm 850nm IR LED timer
+ * @param led_940nm 940nm IR LED timer
+ * @param settings Timer settings
+ */
+void
+ir_camera_timers_leds_set_pulse(
+    TIM_TypeDef *led_850nm, TIM_TypeDef *led_940nm,
+    const struct ir_camera_timer_settings *settings);
+
+/**
+ * Enable exactly `enabled` among the `channels` of an LED timer, with a
+ * single register write: a channel that stays enabled isn't toggled so that
+ * a pulse in progress isn't cut when settings are applied.
+ *
+ * @param led IR LED timer
+ * @param channels All the IR LED channels of the timer, LL_TIM_CHANNEL_CHx
+ * @param enabled Channels to enable, LL_TIM_CHANNEL_CHx
+ */
+void
+ir_camera_timers_leds_set_channels(TIM_TypeDef *led, uint32_t channels,
+                                   uint32_t enabled);
+
+/**
+ * Write the new master timer prescaler and auto-reload values, applied
+ * together at the next update event: the period in progress and the frame
+ * it triggers aren't altered.
+ * Interrupts must be locked so that the writes aren't delayed.
+ *
+ * @param master Master timer
+ * @param next Settings to apply
+ * @param active Settings the master timer is running with
+ */
+void
+ir_camera_timers_master_commit(TIM_TypeDef *master,
+                               const struct ir_camera_timer_settings *next,
+                               const struct ir_camera_timer_settings *active);
+
+#ifdef CONFIG_BOARD_DIAMOND_MAIN
+/**
+ * End of the RGB-IR camera strobe: the master timer, stopped or sped up at
+ * the start of the strobe, restarts the frame period from
+ * `master_initial_counter`, or stops if no frames are taken.
+ *
+ * @param master Master timer
+ * @param settings Timer settings
+ */
+void
+ir_camera_timers_strobe_ended(TIM_TypeDef *master,
+                              const struct ir_camera_timer_settings *settings);
+
+/**
+ * Start of the RGB-IR camera strobe: the IR LEDs must light the exposure,
+ * for at most IR_CAMERA_SYSTEM_MAX_IR_LED_ON_TIME_US.
+ * If the scheduled IR LED pulse comes later than that, the master update
+ * event is brought forward by `master_max_ir_leds_tick` and the pulse lasts
+ * the maximum on-time, otherwise the update event is generated right away
+ * and the pulse lasts until the end of the scheduled one.
+ * Nothing is done during the IR LED pulse.
+ *
+ * @param master Master timer
+ * @param led_850nm 850nm IR LED timer
+ * @param led_940nm 940nm IR LED timer
+ * @param settings Timer settings
+ */
+void
+ir_camera_timers_strobe_started(
+    TIM_TypeDef *master, TIM_TypeDef *led_850nm, TIM_TypeDef *led_940nm,
+    const struct ir_camera_timer_settings *settings);
+#endif
+
+/**
+ * Stop the sweep in progress, and the camera exposure interrupt if it is only
+ * enabled during sweeps
+ *
+ * @param trigger Camera trigger timer
+ * @param it_always_on Exposure interrupt enabled outside sweeps
+ */
+void
+ir_camera_timers_sweep_stop(TIM_TypeDef *trigger, bool it_always_on);
+
+/// actions of the camera exposure ISR, called from ISR context
+struct ir_camera_timers_exposure_ops {
+    /**
+     * End of an exposure, before the sweep moves to the next frame
+     *
+     * @param since_master_update_us Time since the master update event
+     *  which started the trigger
+     */
+    void (*ended)(uint32_t since_master_update_us);
+    /// setpoints of the next frame left to thread context, see
+    /// ir_camera_sweep_next_frame
+    void (*deferred)(void);
+    /// last frame of the sweep taken, sweep stopped
+    void (*sweep_end)(void);
+};
+
+/**
+ * Camera exposure ISR: the update interrupt of the camera trigger timer is
+ * raised both when a trigger starts (slave reset) and when it ends (end of
+ * the one-pulse period). At the end of an exposure, the sweep in progress
+ * moves to the next frame.
+ *
+ * @param master Master timer
+ * @param trigger Camera trigger timer
+ * @param it_always_on Interrupt enabled outside sweeps
+ * @param ops Actions on the exposures and the sweep
+ */
+void
+ir_camera_timers_exposure_isr(TIM_TypeDef *master, TIM_TypeDef *trigger,
+                              bool it_always_on,
+                              const struct ir_camera_timers_exposure_ops *ops);
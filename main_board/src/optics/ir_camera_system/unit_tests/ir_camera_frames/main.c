@@ -0,0 +1,149 @@
+#include <ir_camera_frames.h>
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/ztest.h>
+
+// CONFIG_IR_CAMERA_FRAMES_RING_SIZE in CMakeLists.txt
+#define RING_SIZE 8
+
+static void
+record(ir_camera_frames_source_t source, uint32_t timestamp_us,
+       uint16_t exposure_us, uint8_t wavelength, uint16_t sweep_frame,
+       int16_t setpoint)
+{
+    const struct ir_camera_frame frame = {
+        .frame = 0xDEADBEEF, // overwritten
+        .timestamp_us = timestamp_us,
+        .exposure_us = exposure_us,
+        .wavelength = wavelength,
+        .sweep_frame = sweep_frame,
+        .setpoint = setpoint,
+    };
+    ir_camera_frames_record(source, &frame);
+}
+
+// frame counters keep counting across tests: first frame of each source in
+// the current test
+static uint32_t first_frame[IR_CAMERA_FRAMES_SOURCE_COUNT];
+
+static void
+before_each_test(void *fixture)
+{
+    ARG_UNUSED(fixture);
+    char buf[64];
+
+    for (size_t i = 0; i < IR_CAMERA_FRAMES_SOURCE_COUNT; ++i) {
+        // empty the ring, then read the counter from a probe entry
+        while (ir_camera_frames_encode(i, buf, sizeof(buf)) > 0) {
+        }
+        record(i, 0, 0, 0, IR_CAMERA_FRAMES_NO_SWEEP, 0);
+        zassert_equal(1, ir_camera_frames_encode(i, buf, sizeof(buf)));
+
+        unsigned int probe;
+        zassert_equal(1, sscanf(strchr(buf, '#'), "#%u", &probe));
+        first_frame[i] = probe + 1;
+    }
+}
+
+ZTEST_SUITE(ir_camera_frames, NULL, NULL, before_each_test, NULL, NULL);
+
+ZTEST(ir_camera_frames, test_batch_with_changed_fields_only)
+{
+    char buf[128];
+    char expected[128];
+
+    record(IR_CAMERA_FRAMES_IR_TRIGGER, 1000000, 2500, 3,
+           IR_CAMERA_FRAMES_NO_SWEEP, 0);
+    record(IR_CAMERA_FRAMES_IR_TRIGGER, 1033333, 2500, 3,
+           IR_CAMERA_FRAMES_NO_SWEEP, 0);
+    record(IR_CAMERA_FRAMES_IR_TRIGGER, 1066667, 3000, 3, 0, -120);
+    record(IR_CAMERA_FRAMES_IR_TRIGGER, 1100000, 3000, 1, 1, -100);
+    zassert_equal(4, ir_camera_frames_pending(IR_CAMERA_FRAMES_IR_TRIGGER));
+
+    zassert_equal(4, ir_camera_frames_encode(IR_CAMERA_FRAMES_IR_TRIGGER, buf,
+                                             sizeof(buf)));
+    snprintf(expected, sizeof(expected),
+             "frames ir #%u 1000000 0e2500w3 33333 33334e3000s0:-120 "
+             "33333w1s1:-100",
+             first_frame[IR_CAMERA_FRAMES_IR_TRIGGER]);
+    zassert_str_equal(expected, buf);
+    zassert_equal(0, ir_camera_frames_pending(IR_CAMERA_FRAMES_IR_TRIGGER));
+    zassert_equal(0, ir_camera_frames_encode(IR_CAMERA_FRAMES_IR_TRIGGER, buf,
+                                             sizeof(buf)));
+}
+
+ZTEST(ir_camera_frames, test_sources_are_independent)
+{
+    char buf[128];
+    char expected[128];
+
+    record(IR_CAMERA_FRAMES_IR_TRIGGER, 10, 100, 0, IR_CAMERA_FRAMES_NO_SWEEP,
+           0);
+    record(IR_CAMERA_FRAMES_RGB_STROBE, 20, 200, 0, IR_CAMERA_FRAMES_NO_SWEEP,
+           0);
+    record(IR_CAMERA_FRAMES_RGB_STROBE, 50, 200, 0, IR_CAMERA_FRAMES_NO_SWEEP,
+           0);
+
+    zassert_equal(2, ir_camera_frames_encode(IR_CAMERA_FRAMES_RGB_STROBE, buf,
+                                             sizeof(buf)));
+    snprintf(expected, sizeof(expected), "frames rgb #%u 20 0e200w0 30",
+             first_frame[IR_CAMERA_FRAMES_RGB_STROBE]);
+    zassert_str_equal(expected, buf);
+    zassert_equal(1, ir_camera_frames_pending(IR_CAMERA_FRAMES_IR_TRIGGER));
+}
+
+ZTEST(ir_camera_frames, test_full_ring_drops_and_reports_gap)
+{
+    char buf[256];
+    char expected[64];
+
+    for (uint32_t i = 0; i < RING_SIZE + 2; ++i) {
+        record(IR_CAMERA_FRAMES_IR_TRIGGER, i * 10, 100, 0,
+               IR_CAMERA_FRAMES_NO_SWEEP, 0);
+    }
+    zassert_equal(RING_SIZE,
+                  ir_camera_frames_pending(IR_CAMERA_FRAMES_IR_TRIGGER));
+
+    const size_t count =
+        ir_camera_frames_encode(IR_CAMERA_FRAMES_IR_TRIGGER, buf, sizeof(buf));
+    zassert_equal(RING_SIZE, count);
+
+    // the last 2 frames recorded into the full ring were dropped
+    record(IR_CAMERA_FRAMES_IR_TRIGGER, 100, 100, 0, IR_CAMERA_FRAMES_NO_SWEEP,
+           0);
+    record(IR_CAMERA_FRAMES_IR_TRIGGER, 110, 100, 0, IR_CAMERA_FRAMES_NO_SWEEP,
+           0);
+    zassert_equal(2, ir_camera_frames_encode(IR_CAMERA_FRAMES_IR_TRIGGER, buf,
+                                             sizeof(buf)));
+    snprintf(expected, sizeof(expected), "frames ir #%u 100 0e100w0 10",
+             first_frame[IR_CAMERA_FRAMES_IR_TRIGGER] + RING_SIZE + 2);
+    zassert_str_equal(expected, buf);
+}
+
+ZTEST(ir_camera_frames, test_batch_split_when_buffer_full)
+{
+    char buf[40];
+    size_t total = 0;
+    size_t count;
+
+    for (uint32_t i = 0; i < RING_SIZE; ++i) {
+        record(IR_CAMERA_FRAMES_IR_TRIGGER, 1000000 + i * 33333, 2500, 3, i,
+               (int16_t)(i * 10));
+    }
+
+    // entries that don't fit stay in the ring for the next batch
+    while ((count = ir_camera_frames_encode(IR_CAMERA_FRAMES_IR_TRIGGER, buf,
+                                            sizeof(buf))) > 0) {
+        zassert_true(count < RING_SIZE);
+        zassert_true(strlen(buf) < sizeof(buf));
+        zassert_equal(0, strncmp(buf, "frames ir #", strlen("frames ir #")));
+        total += count;
+    }
+    zassert_equal(RING_SIZE, total);
+
+    // buffer too small for a single entry: nothing removed
+    record(IR_CAMERA_FRAMES_IR_TRIGGER, 0, 0, 0, IR_CAMERA_FRAMES_NO_SWEEP, 0);
+    zassert_equal(
+        0, ir_camera_frames_encode(IR_CAMERA_FRAMES_IR_TRIGGER, buf, 12));
+    zassert_equal(1, ir_camera_frames_pending(IR_CAMERA_FRAMES_IR_TRIGGER));
+}
@@ -0,0 +1,145 @@
+#include <ir_camera_schedule.h>
+#include <zephyr/ztest.h>
+
+// 30 fps, IR LED pulse from 1 µs to 2'051 µs
+#define PERIOD_US    33333
+#define LED_START_US 1
+#define LED_END_US   2051
+
+ZTEST_SUITE(ir_camera_schedule, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(ir_camera_schedule, test_empty_schedule_is_valid)
+{
+    const struct ir_camera_schedule schedule = {0};
+
+    zassert_equal(RET_SUCCESS,
+                  ir_camera_schedule_check(&schedule, PERIOD_US, LED_START_US,
+                                           LED_END_US, NULL));
+    zassert_equal(0, ir_camera_schedule_end_us(&schedule));
+}
+
+ZTEST(ir_camera_schedule, test_tof_interleaved_after_ir_pulse)
+{
+    const struct ir_camera_schedule schedule = {
+        .slots = {
+            [IR_CAMERA_SCHEDULE_IR_EYE] = {.used = true,
+                                           .phase_us = 51,
+                                           .window_us = 2000},
+            [IR_CAMERA_SCHEDULE_TOF_2D] = {.used = true,
+                                           .phase_us = LED_END_US,
+                                           .window_us = 10000},
+        }};
+
+    zassert_equal(RET_SUCCESS,
+                  ir_camera_schedule_check(&schedule, PERIOD_US, LED_START_US,
+                                           LED_END_US, NULL));
+    zassert_equal(LED_END_US + 10000, ir_camera_schedule_end_us(&schedule));
+}
+
+ZTEST(ir_camera_schedule, test_tof_overlapping_ir_pulse_is_rejected)
+{
+    ir_camera_schedule_camera_t conflict = IR_CAMERA_SCHEDULE_IR_EYE;
+    const struct ir_camera_schedule schedule = {
+        .slots = {[IR_CAMERA_SCHEDULE_TOF_2D] = {.used = true,
+                                                 .phase_us = LED_END_US - 1,
+                                                 .window_us = 1000}}};
+
+    zassert_equal(RET_ERROR_INVALID_PARAM,
+                  ir_camera_schedule_check(&schedule, PERIOD_US, LED_START_US,
+                                           LED_END_US, &conflict));
+    zassert_equal(IR_CAMERA_SCHEDULE_TOF_2D, conflict);
+
+    // the IR LEDs are off: nothing to overlap with
+    zassert_equal(RET_SUCCESS,
+                  ir_camera_schedule_check(&schedule, PERIOD_US, LED_START_US,
+                                           LED_START_US, NULL));
+}
+
+ZTEST(ir_camera_schedule, test_tof_overlapping_ir_camera_is_rejected)
+{
+    ir_camera_schedule_camera_t conflict = IR_CAMERA_SCHEDULE_TOF_2D;
+    // the IR face camera exposes after the IR LED pulse, with ambient light,
+    // while the ToF emitter is on
+    const struct ir_camera_schedule schedule = {
+        .slots = {
+            [IR_CAMERA_SCHEDULE_IR_FACE] = {.used = true,
+                                            .phase_us = 5000,
+                                            .window_us = 1000},
+            [IR_CAMERA_SCHEDULE_TOF_2D] = {.used = true,
+                                           .phase_us = 5999,
+                                           .window_us = 1000},
+        }};
+
+    zassert_equal(RET_ERROR_INVALID_PARAM,
+                  ir_camera_schedule_check(&schedule, PERIOD_US, LED_START_US,
+                                           LED_END_US, &conflict));
+    zassert_equal(IR_CAMERA_SCHEDULE_IR_FACE, conflict);
+}
+
+ZTEST(ir_camera_schedule, test_ir_cameras_share_the_ir_pulse)
+{
+    const struct ir_camera_schedule schedule = {
+        .slots = {
+            [IR_CAMERA_SCHEDULE_IR_EYE] = {.used = true,
+                                           .phase_us = 51,
+                                           .window_us = 2000},
+            [IR_CAMERA_SCHEDULE_IR_FACE] = {.used = true,
+                                            .phase_us = 1000,
+                                            .window_us = 2000},
+        }};
+
+    zassert_equal(RET_SUCCESS,
+                  ir_camera_schedule_check(&schedule, PERIOD_US, LED_START_US,
+                                           LED_END_US, NULL));
+    zassert_equal(3000, ir_camera_schedule_end_us(&schedule));
+}
+
+ZTEST(ir_camera_schedule, test_window_must_fit_in_the_period)
+{
+    ir_camera_schedule_camera_t conflict = IR_CAMERA_SCHEDULE_TOF_2D;
+    struct ir_camera_schedule schedule = {
+        .slots = {[IR_CAMERA_SCHEDULE_IR_EYE] = {.used = true,
+                                                 .phase_us = PERIOD_US - 100,
+                                                 .window_us = 100}}};
+
+    zassert_equal(RET_SUCCESS,
+                  ir_camera_schedule_check(&schedule, PERIOD_US, LED_START_US,
+                                           LED_END_US, NULL));
+
+    schedule.slots[IR_CAMERA_SCHEDULE_IR_EYE].window_us = 101;
+    zassert_equal(RET_ERROR_INVALID_PARAM,
+                  ir_camera_schedule_check(&schedule, PERIOD_US, LED_START_US,
+                                           LED_END_US, &conflict));
+    zassert_equal(IR_CAMERA_SCHEDULE_IR_EYE, conflict);
+
+    // no wrap around
+    schedule.slots[IR_CAMERA_SCHEDULE_IR_EYE].phase_us = UINT32_MAX;
+    zassert_equal(RET_ERROR_INVALID_PARAM,
+                  ir_camera_schedule_check(&schedule, PERIOD_US, LED_START_US,
+                                           LED_END_US, NULL));
+
+    // empty window
+    schedule.slots[IR_CAMERA_SCHEDULE_IR_EYE].phase_us = 51;
+    schedule.slots[IR_CAMERA_SCHEDULE_IR_EYE].window_us = 0;
+    zassert_equal(RET_ERROR_INVALID_PARAM,
+                  ir_camera_schedule_check(&schedule, PERIOD_US, LED_START_US,
+                                           LED_END_US, NULL));
+}
+
+ZTEST(ir_camera_schedule, test_unused_slots_are_ignored)
+{
+    const struct ir_camera_schedule schedule = {
+        .slots = {
+            [IR_CAMERA_SCHEDULE_IR_EYE] = {.used = true,
+                                           .phase_us = 51,
+                                           .window_us = 2000},
+            [IR_CAMERA_SCHEDULE_TOF_2D] = {.used = false,
+                                           .phase_us = 0,
+                                           .window_us = PERIOD_US * 2},
+        }};
+
+    zassert_equal(RET_SUCCESS,
+                  ir_camera_schedule_check(&schedule, PERIOD_US, LED_START_US,
+                                           LED_END_US, NULL));
+    zassert_equal(2051, ir_camera_schedule_end_us(&schedule));
+}
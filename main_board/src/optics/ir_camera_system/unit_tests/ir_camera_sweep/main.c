@@ -0,0 +1,226 @@
+#include <ir_camera_sweep.h>
+#include <string.h>
+#include <zephyr/ztest.h>
+
+#define MAX_CALLS 16
+
+struct fake_actuator {
+    int32_t setpoints[MAX_CALLS];
+    size_t call_count;
+    int32_t position;
+};
+
+static struct fake_actuator fakes[IR_CAMERA_SWEEP_ACTUATOR_COUNT];
+
+static void
+record(ir_camera_sweep_actuator_t actuator, int32_t setpoint)
+{
+    struct fake_actuator *fake = &fakes[actuator];
+    if (fake->call_count < MAX_CALLS) {
+        fake->setpoints[fake->call_count] = setpoint;
+    }
+    fake->call_count++;
+}
+
+static void
+set_lens(int32_t setpoint)
+{
+    record(IR_CAMERA_SWEEP_LIQUID_LENS, setpoint);
+}
+
+static void
+set_phi(int32_t setpoint)
+{
+    record(IR_CAMERA_SWEEP_MIRROR_PHI, setpoint);
+}
+
+static int32_t
+get_phi(void)
+{
+    return fakes[IR_CAMERA_SWEEP_MIRROR_PHI].position;
+}
+
+static void
+set_polarizer(int32_t setpoint)
+{
+    record(IR_CAMERA_SWEEP_POLARIZER, setpoint);
+}
+
+static const struct ir_camera_sweep_actuator_ops lens_ops = {.set = set_lens};
+static const struct ir_camera_sweep_actuator_ops phi_ops = {.set = set_phi,
+                                                            .get = get_phi};
+static const struct ir_camera_sweep_actuator_ops polarizer_ops = {
+    .set = set_polarizer, .deferred = true};
+
+static void
+before_each_test(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    ir_camera_sweep_stop();
+    memset(fakes, 0, sizeof(fakes));
+    for (size_t i = 0; i < IR_CAMERA_SWEEP_ACTUATOR_COUNT; ++i) {
+        ir_camera_sweep_register(i, NULL);
+        ir_camera_sweep_load(i, NULL, 0);
+    }
+    ir_camera_sweep_register(IR_CAMERA_SWEEP_LIQUID_LENS, &lens_ops);
+    ir_camera_sweep_register(IR_CAMERA_SWEEP_MIRROR_PHI, &phi_ops);
+    ir_camera_sweep_register(IR_CAMERA_SWEEP_POLARIZER, &polarizer_ops);
+}
+
+ZTEST_SUITE(ir_camera_sweep, NULL, NULL, before_each_test, NULL, NULL);
+
+ZTEST(ir_camera_sweep, test_single_actuator_one_setpoint_per_frame)
+{
+    const int16_t table[] = {-120, -100, -80};
+    bool deferred;
+    size_t frame;
+    int16_t setpoint;
+
+    zassert_equal(RET_SUCCESS,
+                  ir_camera_sweep_load(IR_CAMERA_SWEEP_LIQUID_LENS, table,
+                                       ARRAY_SIZE(table)));
+    zassert_equal(RET_SUCCESS,
+                  ir_camera_sweep_start(BIT(IR_CAMERA_SWEEP_LIQUID_LENS)));
+    zassert_true(ir_camera_sweep_in_progress());
+    zassert_equal(ARRAY_SIZE(table), ir_camera_sweep_num_frames());
+
+    // first setpoint applied before the first exposure
+    zassert_equal(1, fakes[IR_CAMERA_SWEEP_LIQUID_LENS].call_count);
+
+    // end of exposures 1 and 2
+    zassert_true(ir_camera_sweep_current_frame(&frame, &setpoint));
+    zassert_equal(0, frame);
+    zassert_equal(-120, setpoint);
+    zassert_true(ir_camera_sweep_next_frame(&deferred));
+    zassert_false(deferred);
+    zassert_true(ir_camera_sweep_current_frame(&frame, &setpoint));
+    zassert_equal(1, frame);
+    zassert_equal(-100, setpoint);
+    zassert_true(ir_camera_sweep_next_frame(&deferred));
+
+    // end of exposure 3: done, one frame per setpoint
+    zassert_false(ir_camera_sweep_next_frame(&deferred));
+    zassert_false(ir_camera_sweep_in_progress());
+    zassert_false(ir_camera_sweep_current_frame(&frame, &setpoint));
+
+    zassert_equal(3, fakes[IR_CAMERA_SWEEP_LIQUID_LENS].call_count);
+    for (size_t i = 0; i < ARRAY_SIZE(table); ++i) {
+        zassert_equal(table[i],
+                      fakes[IR_CAMERA_SWEEP_LIQUID_LENS].setpoints[i]);
+    }
+}
+
+ZTEST(ir_camera_sweep, test_lockstep_with_relative_table)
+{
+    const int16_t lens[] = {10, 20, 30};
+    const int16_t phi[] = {0, 500, -500};
+    bool deferred;
+
+    fakes[IR_CAMERA_SWEEP_MIRROR_PHI].position = 45000;
+
+    ir_camera_sweep_load(IR_CAMERA_SWEEP_LIQUID_LENS, lens, ARRAY_SIZE(lens));
+    ir_camera_sweep_load(IR_CAMERA_SWEEP_MIRROR_PHI, phi, ARRAY_SIZE(phi));
+    zassert_equal(RET_SUCCESS,
+                  ir_camera_sweep_start(BIT(IR_CAMERA_SWEEP_LIQUID_LENS) |
+                                        BIT(IR_CAMERA_SWEEP_MIRROR_PHI)));
+
+    // the origin is read once, when the sweep starts
+    fakes[IR_CAMERA_SWEEP_MIRROR_PHI].position = 0;
+
+    while (ir_camera_sweep_next_frame(&deferred)) {
+        zassert_equal(fakes[IR_CAMERA_SWEEP_LIQUID_LENS].call_count,
+                      fakes[IR_CAMERA_SWEEP_MIRROR_PHI].call_count);
+    }
+
+    zassert_equal(3, fakes[IR_CAMERA_SWEEP_MIRROR_PHI].call_count);
+    zassert_equal(45000, fakes[IR_CAMERA_SWEEP_MIRROR_PHI].setpoints[0]);
+    zassert_equal(45500, fakes[IR_CAMERA_SWEEP_MIRROR_PHI].setpoints[1]);
+    zassert_equal(44500, fakes[IR_CAMERA_SWEEP_MIRROR_PHI].setpoints[2]);
+    zassert_equal(30, fakes[IR_CAMERA_SWEEP_LIQUID_LENS].setpoints[2]);
+}
+
+ZTEST(ir_camera_sweep, test_deferred_actuator_applied_from_thread)
+{
+    const int16_t lens[] = {1, 2, 3, 4};
+    const int16_t polarizer[] = {0, 900, 1800, 2700};
+    bool deferred;
+
+    ir_camera_sweep_load(IR_CAMERA_SWEEP_LIQUID_LENS, lens, ARRAY_SIZE(lens));
+    ir_camera_sweep_load(IR_CAMERA_SWEEP_POLARIZER, polarizer,
+                         ARRAY_SIZE(polarizer));
+    zassert_equal(RET_SUCCESS,
+                  ir_camera_sweep_start(BIT(IR_CAMERA_SWEEP_LIQUID_LENS) |
+                                        BIT(IR_CAMERA_SWEEP_POLARIZER)));
+    // first setpoint applied at start, from thread context
+    zassert_equal(1, fakes[IR_CAMERA_SWEEP_POLARIZER].call_count);
+    zassert_equal(0, fakes[IR_CAMERA_SWEEP_POLARIZER].setpoints[0]);
+
+    // the ISR doesn't call the deferred actuator
+    zassert_true(ir_camera_sweep_next_frame(&deferred));
+    zassert_true(deferred);
+    zassert_equal(1, fakes[IR_CAMERA_SWEEP_POLARIZER].call_count);
+    ir_camera_sweep_apply_deferred();
+    zassert_equal(2, fakes[IR_CAMERA_SWEEP_POLARIZER].call_count);
+    zassert_equal(900, fakes[IR_CAMERA_SWEEP_POLARIZER].setpoints[1]);
+
+    // nothing pending
+    ir_camera_sweep_apply_deferred();
+    zassert_equal(2, fakes[IR_CAMERA_SWEEP_POLARIZER].call_count);
+
+    // thread late by one frame: only the latest setpoint is applied
+    zassert_true(ir_camera_sweep_next_frame(&deferred));
+    zassert_true(ir_camera_sweep_next_frame(&deferred));
+    ir_camera_sweep_apply_deferred();
+    zassert_equal(3, fakes[IR_CAMERA_SWEEP_POLARIZER].call_count);
+    zassert_equal(2700, fakes[IR_CAMERA_SWEEP_POLARIZER].setpoints[2]);
+
+    // the other actuators didn't wait
+    zassert_equal(4, fakes[IR_CAMERA_SWEEP_LIQUID_LENS].call_count);
+    zassert_false(ir_camera_sweep_next_frame(&deferred));
+}
+
+ZTEST(ir_camera_sweep, test_start_fails_with_invalid_tables)
+{
+    const int16_t three[] = {1, 2, 3};
+    const int16_t two[] = {1, 2};
+
+    // nothing to move
+    zassert_equal(RET_ERROR_INVALID_PARAM, ir_camera_sweep_start(0));
+    // no table
+    zassert_equal(RET_ERROR_INVALID_PARAM,
+                  ir_camera_sweep_start(BIT(IR_CAMERA_SWEEP_LIQUID_LENS)));
+    // not registered
+    ir_camera_sweep_load(IR_CAMERA_SWEEP_IR_LED_ON_TIME, three,
+                         ARRAY_SIZE(three));
+    zassert_equal(RET_ERROR_INVALID_PARAM,
+                  ir_camera_sweep_start(BIT(IR_CAMERA_SWEEP_IR_LED_ON_TIME)));
+    // tables of different lengths
+    ir_camera_sweep_load(IR_CAMERA_SWEEP_LIQUID_LENS, three, ARRAY_SIZE(three));
+    ir_camera_sweep_load(IR_CAMERA_SWEEP_MIRROR_PHI, two, ARRAY_SIZE(two));
+    zassert_equal(RET_ERROR_INVALID_PARAM,
+                  ir_camera_sweep_start(BIT(IR_CAMERA_SWEEP_LIQUID_LENS) |
+                                        BIT(IR_CAMERA_SWEEP_MIRROR_PHI)));
+    zassert_false(ir_camera_sweep_in_progress());
+    zassert_equal(0, fakes[IR_CAMERA_SWEEP_LIQUID_LENS].call_count);
+}
+
+ZTEST(ir_camera_sweep, test_busy_during_sweep)
+{
+    const int16_t table[] = {1, 2};
+    bool deferred;
+
+    ir_camera_sweep_load(IR_CAMERA_SWEEP_LIQUID_LENS, table, ARRAY_SIZE(table));
+    zassert_equal(RET_SUCCESS,
+                  ir_camera_sweep_start(BIT(IR_CAMERA_SWEEP_LIQUID_LENS)));
+
+    zassert_equal(RET_ERROR_BUSY,
+                  ir_camera_sweep_load(IR_CAMERA_SWEEP_LIQUID_LENS, table, 1));
+    zassert_equal(RET_ERROR_BUSY,
+                  ir_camera_sweep_start(BIT(IR_CAMERA_SWEEP_LIQUID_LENS)));
+
+    ir_camera_sweep_stop();
+    zassert_false(ir_camera_sweep_in_progress());
+    zassert_false(ir_camera_sweep_next_frame(&deferred));
+    zassert_equal(1, fakes[IR_CAMERA_SWEEP_LIQUID_LENS].call_count);
+}
@@ -0,0 +1,187 @@
+#include <ir_camera_sweep_tables.h>
+#include <math.h>
+#include <stdlib.h>
+#include <zephyr/ztest.h>
+
+ZTEST_SUITE(sweep_tables_focus, NULL, NULL, NULL, NULL, NULL);
+ZTEST_SUITE(sweep_tables_mirror, NULL, NULL, NULL, NULL, NULL);
+
+#define TABLE_SIZE 200
+
+// coefficients used by the sweeps sent by the Jetson
+static const orb_mcu_main_IREyeCameraFocusSweepValuesPolynomial focus_poly = {
+    .coef_a = -120.0f,
+    .coef_b = 4.5f,
+    .coef_c = 0.045f,
+    .coef_d = 0.00015f,
+    .coef_e = 0.0f,
+    .coef_f = 0.0f,
+    .number_of_frames = 100,
+};
+
+static const orb_mcu_main_IREyeCameraMirrorSweepValuesPolynomial mirror_poly =
+    {
+        .radius_coef_a = 1.0f,
+        .radius_coef_b = 0.09f,
+        .radius_coef_c = 0.0003f,
+        .angle_coef_a = 10.0f,
+        .angle_coef_b = 0.18849556f,
+        .angle_coef_c = 0.0f,
+        .number_of_frames = 100,
+};
+
+/// focus polynomial evaluated in double precision
+static double
+focus_reference(const orb_mcu_main_IREyeCameraFocusSweepValuesPolynomial *poly,
+                uint32_t frame_no)
+{
+    const double n = frame_no;
+    return poly->coef_a + poly->coef_b * n + poly->coef_c * n * n +
+           poly->coef_d * n * n * n + poly->coef_e * n * n * n * n +
+           poly->coef_f * n * n * n * n * n;
+}
+
+/// mirror polynomials evaluated in double precision, before truncation
+static void
+mirror_reference(
+    const orb_mcu_main_IREyeCameraMirrorSweepValuesPolynomial *poly,
+    uint32_t frame_no, double *phi_millidegrees, double *theta_millidegrees)
+{
+    const double n = frame_no;
+    const double radius = poly->radius_coef_a + poly->radius_coef_b * n +
+                          poly->radius_coef_c * n * n;
+    const double angle = poly->angle_coef_a + poly->angle_coef_b * n +
+                         poly->angle_coef_c * n * n;
+
+    *phi_millidegrees = radius * sin(angle) * 1000.0 / -2.0;
+    *theta_millidegrees = radius * cos(angle) * 1000.0 / 2.0;
+}
+
+ZTEST(sweep_tables_focus, test_focus_table_matches_polynomial)
+{
+    int16_t table[TABLE_SIZE] = {0};
+
+    ret_code_t ret =
+        ir_camera_sweep_focus_table(&focus_poly, table, ARRAY_SIZE(table));
+    zassert_equal(RET_SUCCESS, ret);
+
+    for (uint32_t i = 0; i < focus_poly.number_of_frames; ++i) {
+        const double expected = focus_reference(&focus_poly, i);
+        // rounded to the closest mA, float evaluation error included
+        zassert_true(fabs(table[i] - expected) <= 0.5 + 1e-3,
+                     "frame %u: %d mA, expected %f mA", i, table[i],
+                     expected);
+    }
+    zassert_equal(-120, table[0]);
+    // untouched after the last frame
+    zassert_equal(0, table[focus_poly.number_of_frames]);
+}
+
+ZTEST(sweep_tables_focus, test_focus_table_all_coefficients)
+{
+    int16_t table[TABLE_SIZE] = {0};
+    orb_mcu_main_IREyeCameraFocusSweepValuesPolynomial poly = {
+        .coef_a = 100.0f,
+        .coef_b = -2.0f,
+        .coef_c = 0.01f,
+        .coef_d = 0.0001f,
+        .coef_e = -0.000001f,
+        .coef_f = 0.000000005f,
+        .number_of_frames = TABLE_SIZE,
+    };
+
+    ret_code_t ret =
+        ir_camera_sweep_focus_table(&poly, table, ARRAY_SIZE(table));
+    zassert_equal(RET_SUCCESS, ret);
+
+    for (uint32_t i = 0; i < poly.number_of_frames; ++i) {
+        const double expected = focus_reference(&poly, i);
+        zassert_true(fabs(table[i] - expected) <= 0.5 + 1e-2,
+                     "frame %u: %d mA, expected %f mA", i, table[i],
+                     expected);
+    }
+}
+
+ZTEST(sweep_tables_focus, test_focus_table_saturates)
+{
+    int16_t table[2] = {0};
+    orb_mcu_main_IREyeCameraFocusSweepValuesPolynomial poly = {
+        .coef_a = 40000.0f,
+        .coef_b = -80000.0f,
+        .number_of_frames = 2,
+    };
+
+    ret_code_t ret =
+        ir_camera_sweep_focus_table(&poly, table, ARRAY_SIZE(table));
+    zassert_equal(RET_SUCCESS, ret);
+    zassert_equal(INT16_MAX, table[0]);
+    zassert_equal(INT16_MIN, table[1]);
+}
+
+ZTEST(sweep_tables_focus, test_focus_table_too_many_frames)
+{
+    int16_t table[TABLE_SIZE] = {0};
+    orb_mcu_main_IREyeCameraFocusSweepValuesPolynomial poly = focus_poly;
+    poly.number_of_frames = TABLE_SIZE + 1;
+
+    ret_code_t ret =
+        ir_camera_sweep_focus_table(&poly, table, ARRAY_SIZE(table));
+    zassert_equal(RET_ERROR_INVALID_PARAM, ret);
+}
+
+ZTEST(sweep_tables_focus, test_focus_table_no_frames)
+{
+    int16_t table[1] = {0x5A5A};
+    orb_mcu_main_IREyeCameraFocusSweepValuesPolynomial poly = focus_poly;
+    poly.number_of_frames = 0;
+
+    ret_code_t ret =
+        ir_camera_sweep_focus_table(&poly, table, ARRAY_SIZE(table));
+    zassert_equal(RET_SUCCESS, ret);
+    zassert_equal(0x5A5A, table[0]);
+}
+
+ZTEST(sweep_tables_mirror, test_mirror_table_matches_polynomials)
+{
+    int16_t phi_table[TABLE_SIZE] = {0};
+    int16_t theta_table[TABLE_SIZE] = {0};
+
+    ret_code_t ret = ir_camera_sweep_mirror_table(&mirror_poly, phi_table,
+                                                  theta_table, TABLE_SIZE);
+    zassert_equal(RET_SUCCESS, ret);
+
+    for (uint32_t i = 0; i < mirror_poly.number_of_frames; ++i) {
+        double phi, theta;
+        mirror_reference(&mirror_poly, i, &phi, &theta);
+
+        const int32_t delta_phi = phi_table[i];
+        const int32_t delta_theta = theta_table[i];
+
+        // angles are truncated to whole degrees before being halved
+        zassert_equal(0, delta_phi % 500, "frame %u: %d", i, delta_phi);
+        zassert_equal(0, delta_theta % 500, "frame %u: %d", i, delta_theta);
+        // truncation towards 0: at most half a degree closer to 0
+        zassert_true(abs(delta_phi) <= fabs(phi) + 1.0 &&
+                         fabs(phi) - abs(delta_phi) < 500.0 + 1.0,
+                     "frame %u: %d, expected %f", i, delta_phi, phi);
+        zassert_true(abs(delta_theta) <= fabs(theta) + 1.0 &&
+                         fabs(theta) - abs(delta_theta) < 500.0 + 1.0,
+                     "frame %u: %d, expected %f", i, delta_theta, theta);
+    }
+
+    // radius of 1 degree at frame 0, |sin| and |cos| < 1: truncated to 0
+    zassert_equal(0, phi_table[0]);
+    zassert_equal(0, theta_table[0]);
+}
+
+ZTEST(sweep_tables_mirror, test_mirror_table_too_many_frames)
+{
+    int16_t phi_table[TABLE_SIZE] = {0};
+    int16_t theta_table[TABLE_SIZE] = {0};
+    orb_mcu_main_IREyeCameraMirrorSweepValuesPolynomial poly = mirror_poly;
+    poly.number_of_frames = TABLE_SIZE + 1;
+
+    ret_code_t ret = ir_camera_sweep_mirror_table(&poly, phi_table,
+                                                  theta_table, TABLE_SIZE);
+    zassert_equal(RET_ERROR_INVALID_PARAM, ret);
+}
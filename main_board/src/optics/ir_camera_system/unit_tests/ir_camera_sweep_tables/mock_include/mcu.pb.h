@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+    float coef_a;
+    float coef_b;
+    float coef_c;
+    float coef_d;
+    float coef_e;
+    float coef_f;
+    uint32_t number_of_frames;
+} orb_mcu_main_IREyeCameraFocusSweepValuesPolynomial;
+
+typedef struct {
+    float radius_coef_a;
+    float radius_coef_b;
+    float radius_coef_c;
+    float angle_coef_a;
+    float angle_coef_b;
+    float angle_coef_c;
+    uint32_t number_of_frames;
+} orb_mcu_main_IREyeCameraMirrorSweepValuesPolynomial;
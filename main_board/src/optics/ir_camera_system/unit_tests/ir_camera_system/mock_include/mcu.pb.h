@@ -7,9 +7,11 @@ typedef struct {
 } orb_mcu_main_IREyeCameraFocusSweepLensValues;
 
 typedef struct {
+    uint32_t number_of_frames;
 } orb_mcu_main_IREyeCameraFocusSweepValuesPolynomial;
 
 typedef struct {
+    uint32_t number_of_frames;
 } orb_mcu_main_IREyeCameraMirrorSweepValuesPolynomial;
 
 typedef enum {
@@ -21,6 +21,8 @@ FAKE_VALUE_FUNC(ret_code_t, ir_camera_system_disable_2d_tof_camera_hw);
 FAKE_VOID_FUNC(ir_camera_system_enable_leds_hw);
 FAKE_VALUE_FUNC(ret_code_t, ir_camera_system_set_fps_hw, uint16_t);
 FAKE_VALUE_FUNC(ret_code_t, ir_camera_system_set_on_time_us_hw, uint16_t);
+FAKE_VALUE_FUNC(ret_code_t, ir_camera_system_set_schedule_hw,
+                const struct ir_camera_schedule *);
 
 FAKE_VALUE_FUNC(uint32_t, ir_camera_system_get_time_until_update_us_internal);
 
@@ -32,10 +34,14 @@ FAKE_VOID_FUNC(ir_camera_system_perform_focus_sweep_hw);
 FAKE_VOID_FUNC(ir_camera_system_set_polynomial_coefficients_for_mirror_sweep_hw,
                orb_mcu_main_IREyeCameraMirrorSweepValuesPolynomial);
 FAKE_VOID_FUNC(ir_camera_system_perform_mirror_sweep_hw);
+FAKE_VOID_FUNC(ir_camera_system_set_sweep_table_hw, ir_camera_sweep_actuator_t,
+               const int16_t *, size_t);
+FAKE_VALUE_FUNC(ret_code_t, ir_camera_system_perform_sweep_hw, uint32_t);
 FAKE_VALUE_FUNC(uint16_t, ir_camera_system_get_fps_hw);
 
 extern bool ir_camera_system_initialized;
 extern atomic_t focus_sweep_in_progress;
+extern atomic_t sweep_in_progress;
 extern bool enabled_ir_eye_camera;
 extern bool enabled_ir_face_camera;
 extern bool enabled_2d_tof_camera;
@@ -49,6 +55,7 @@ before_each_test(void *fixture)
     // Reset module state
     ir_camera_system_initialized = false;
     atomic_set(&focus_sweep_in_progress, 0);
+    atomic_set(&sweep_in_progress, 0);
     enabled_ir_eye_camera = false;
     enabled_ir_face_camera = false;
     enabled_2d_tof_camera = false;
@@ -70,10 +77,13 @@ before_each_test(void *fixture)
     RESET_FAKE(ir_camera_system_enable_leds_hw);
     RESET_FAKE(ir_camera_system_set_fps_hw);
     RESET_FAKE(ir_camera_system_set_on_time_us_hw);
+    RESET_FAKE(ir_camera_system_set_schedule_hw);
     RESET_FAKE(ir_camera_system_get_time_until_update_us_internal);
     RESET_FAKE(ir_camera_system_set_polynomial_coefficients_for_focus_sweep_hw);
     RESET_FAKE(ir_camera_system_set_focus_values_for_focus_sweep_hw);
     RESET_FAKE(ir_camera_system_perform_focus_sweep_hw);
+    RESET_FAKE(ir_camera_system_set_sweep_table_hw);
+    RESET_FAKE(ir_camera_system_perform_sweep_hw);
     RESET_FAKE(ir_camera_system_get_fps_hw);
 }
 
@@ -567,7 +577,7 @@ ZTEST(ir_camera_system_api, test_set_on_time_fail_because_hw_call_failed)
 ZTEST(ir_camera_system_api, test_set_focus_sweep_polynomial_coefficients_success)
 {
     ret_code_t ret;
-    orb_mcu_main_IREyeCameraFocusSweepValuesPolynomial poly;
+    orb_mcu_main_IREyeCameraFocusSweepValuesPolynomial poly = {0};
 
     ir_camera_system_hw_init_fake.return_val = RET_SUCCESS;
     ir_camera_system_init();
@@ -579,7 +589,7 @@ ZTEST(ir_camera_system_api, test_set_focus_sweep_polynomial_coefficients_success
 ZTEST(ir_camera_system_api, test_set_focus_sweep_polynomial_coefficients_fail_because_focus_sweep_in_progress)
 {
     ret_code_t ret;
-    orb_mcu_main_IREyeCameraFocusSweepValuesPolynomial poly;
+    orb_mcu_main_IREyeCameraFocusSweepValuesPolynomial poly = {0};
 
     ir_camera_system_hw_init_fake.return_val = RET_SUCCESS;
     ir_camera_system_init();
@@ -593,6 +603,20 @@ ZTEST(ir_camera_system_api, test_set_focus_sweep_polynomial_coefficients_fail_be
     zassert_equal(ret, RET_ERROR_BUSY);
 }
 
+ZTEST(ir_camera_system_api, test_set_focus_sweep_polynomial_coefficients_fail_because_too_many_frames)
+{
+    ret_code_t ret;
+    orb_mcu_main_IREyeCameraFocusSweepValuesPolynomial poly = {
+        .number_of_frames = MAX_NUMBER_OF_FOCUS_VALUES + 1};
+
+    ir_camera_system_hw_init_fake.return_val = RET_SUCCESS;
+    ir_camera_system_init();
+
+    ret = ir_camera_system_set_polynomial_coefficients_for_focus_sweep(poly);
+    zassert_equal(ret, RET_ERROR_INVALID_PARAM);
+    zassert_equal(ir_camera_system_set_polynomial_coefficients_for_focus_sweep_hw_fake.call_count, 0);
+}
+
 ZTEST(ir_camera_system_api, test_set_focus_sweep_focus_values_success)
 {
     ret_code_t ret;
@@ -703,3 +727,158 @@ ZTEST(ir_camera_system_api, test_perform_focus_sweep_fail_because_ir_eye_camera_
     ret = ir_camera_system_perform_focus_sweep();
     zassert_equal(ret, RET_ERROR_INVALID_STATE);
 }
+
+ZTEST(ir_camera_system_api, test_set_sweep_table_success)
+{
+    ret_code_t ret;
+    const int16_t values[] = {0, 900, 1800};
+
+    ir_camera_system_hw_init_fake.return_val = RET_SUCCESS;
+    ir_camera_system_init();
+
+    ret = ir_camera_system_set_sweep_table(IR_CAMERA_SWEEP_POLARIZER, values,
+                                           ARRAY_SIZE(values));
+    zassert_equal(ret, RET_SUCCESS);
+    zassert_equal(ir_camera_system_set_sweep_table_hw_fake.call_count, 1);
+    zassert_equal(ir_camera_system_set_sweep_table_hw_fake.arg2_val,
+                  ARRAY_SIZE(values));
+}
+
+ZTEST(ir_camera_system_api, test_set_sweep_table_fail_because_invalid_param)
+{
+    ret_code_t ret;
+    const int16_t values[] = {0};
+
+    ir_camera_system_hw_init_fake.return_val = RET_SUCCESS;
+    ir_camera_system_init();
+
+    ret = ir_camera_system_set_sweep_table(IR_CAMERA_SWEEP_ACTUATOR_COUNT,
+                                           values, ARRAY_SIZE(values));
+    zassert_equal(ret, RET_ERROR_INVALID_PARAM);
+
+    ret = ir_camera_system_set_sweep_table(IR_CAMERA_SWEEP_LIQUID_LENS, values,
+                                           MAX_NUMBER_OF_FOCUS_VALUES + 1);
+    zassert_equal(ret, RET_ERROR_INVALID_PARAM);
+
+    ret = ir_camera_system_set_sweep_table(IR_CAMERA_SWEEP_LIQUID_LENS, NULL,
+                                           1);
+    zassert_equal(ret, RET_ERROR_INVALID_PARAM);
+    zassert_equal(ir_camera_system_set_sweep_table_hw_fake.call_count, 0);
+}
+
+ZTEST(ir_camera_system_api, test_set_sweep_table_fail_because_sweep_in_progress)
+{
+    ret_code_t ret;
+    const int16_t values[] = {0};
+
+    ir_camera_system_hw_init_fake.return_val = RET_SUCCESS;
+    ir_camera_system_init();
+
+    set_sweep_in_progress();
+    ret = ir_camera_system_set_sweep_table(IR_CAMERA_SWEEP_LIQUID_LENS, values,
+                                           ARRAY_SIZE(values));
+    zassert_equal(ret, RET_ERROR_BUSY);
+    clear_sweep_in_progress();
+
+    set_focus_sweep_in_progress();
+    ret = ir_camera_system_set_sweep_table(IR_CAMERA_SWEEP_LIQUID_LENS, values,
+                                           ARRAY_SIZE(values));
+    zassert_equal(ret, RET_ERROR_BUSY);
+    clear_focus_sweep_in_progress();
+}
+
+ZTEST(ir_camera_system_api, test_perform_sweep_success)
+{
+    ret_code_t ret;
+    const uint32_t actuators =
+        BIT(IR_CAMERA_SWEEP_LIQUID_LENS) | BIT(IR_CAMERA_SWEEP_POLARIZER);
+
+    ir_camera_system_hw_init_fake.return_val = RET_SUCCESS;
+    ir_camera_system_init();
+
+    ir_camera_system_get_fps_hw_fake.return_val = 1;
+    ir_camera_system_perform_sweep_hw_fake.return_val = RET_SUCCESS;
+
+    ret = ir_camera_system_perform_sweep(actuators);
+    zassert_equal(ret, RET_SUCCESS);
+    zassert_equal(ir_camera_system_perform_sweep_hw_fake.arg0_val, actuators);
+}
+
+ZTEST(ir_camera_system_api, test_perform_sweep_fail_because_invalid_tables)
+{
+    ret_code_t ret;
+
+    ir_camera_system_hw_init_fake.return_val = RET_SUCCESS;
+    ir_camera_system_init();
+
+    ir_camera_system_get_fps_hw_fake.return_val = 1;
+    ir_camera_system_perform_sweep_hw_fake.return_val = RET_ERROR_INVALID_PARAM;
+
+    ret = ir_camera_system_perform_sweep(BIT(IR_CAMERA_SWEEP_LIQUID_LENS));
+    zassert_equal(ret, RET_ERROR_INVALID_PARAM);
+}
+
+ZTEST(ir_camera_system_api, test_perform_sweep_fail_because_sweep_in_progress)
+{
+    ret_code_t ret;
+
+    ir_camera_system_hw_init_fake.return_val = RET_SUCCESS;
+    ir_camera_system_init();
+
+    ir_camera_system_get_fps_hw_fake.return_val = 1;
+
+    set_sweep_in_progress();
+    ret = ir_camera_system_perform_sweep(BIT(IR_CAMERA_SWEEP_LIQUID_LENS));
+    zassert_equal(ret, RET_ERROR_BUSY);
+    zassert_equal(ir_camera_system_perform_sweep_hw_fake.call_count, 0);
+
+    // cameras can't be switched during the sweep
+    ret = ir_camera_system_enable_ir_eye_camera();
+    zassert_equal(ret, RET_ERROR_BUSY);
+    clear_sweep_in_progress();
+}
+
+ZTEST(ir_camera_system_api, test_set_schedule_success)
+{
+    ret_code_t ret;
+    const struct ir_camera_schedule schedule = {
+        .slots = {[IR_CAMERA_SCHEDULE_TOF_2D] = {.used = true,
+                                                 .phase_us = 5000,
+                                                 .window_us = 1000}}};
+
+    ir_camera_system_hw_init_fake.return_val = RET_SUCCESS;
+    ir_camera_system_init();
+
+    ir_camera_system_set_schedule_hw_fake.return_val = RET_SUCCESS;
+    ret = ir_camera_system_set_schedule(&schedule);
+    zassert_equal(ret, RET_SUCCESS);
+    zassert_equal(ir_camera_system_set_schedule_hw_fake.arg0_val, &schedule);
+
+    // rejected by the hardware checks
+    ir_camera_system_set_schedule_hw_fake.return_val = RET_ERROR_INVALID_PARAM;
+    ret = ir_camera_system_set_schedule(&schedule);
+    zassert_equal(ret, RET_ERROR_INVALID_PARAM);
+
+    // back to the default
+    ir_camera_system_set_schedule_hw_fake.return_val = RET_SUCCESS;
+    ret = ir_camera_system_set_schedule(NULL);
+    zassert_equal(ret, RET_SUCCESS);
+    zassert_is_null(ir_camera_system_set_schedule_hw_fake.arg0_val);
+}
+
+ZTEST(ir_camera_system_api, test_set_schedule_fail_because_sweep_in_progress)
+{
+    ret_code_t ret;
+
+    ret = ir_camera_system_set_schedule(NULL);
+    zassert_equal(ret, RET_ERROR_NOT_INITIALIZED);
+
+    ir_camera_system_hw_init_fake.return_val = RET_SUCCESS;
+    ir_camera_system_init();
+
+    set_sweep_in_progress();
+    ret = ir_camera_system_set_schedule(NULL);
+    zassert_equal(ret, RET_ERROR_BUSY);
+    zassert_equal(ir_camera_system_set_schedule_hw_fake.call_count, 0);
+    clear_sweep_in_progress();
+}
@@ -1,8 +1,10 @@
 #include <ir_camera_timer_settings.h>
+#include <math.h>
 #include <zephyr/ztest.h>
 
 ZTEST_SUITE(timer_settings_on_time, NULL, NULL, NULL, NULL, NULL);
 ZTEST_SUITE(timer_settings_fps, NULL, NULL, NULL, NULL, NULL);
+ZTEST_SUITE(timer_settings_master_commit, NULL, NULL, NULL, NULL, NULL);
 
 ZTEST(timer_settings_on_time, test_on_time_set_0us_with_0_fps)
 {
@@ -535,3 +537,150 @@ ZTEST(timer_settings_fps, test_fps_set_valid_then_invalid_on_time)
                   "must not have changed. Was %u, now %u", settings.master_arr,
                   ts.master_arr);
 }
+
+/// master timer period in timer clock cycles
+static uint64_t
+master_period_cycles(uint16_t psc, uint16_t arr)
+{
+    return (uint64_t)(psc + 1) * (arr + 1);
+}
+
+ZTEST(timer_settings_fps, test_every_fps_and_on_time_combination)
+{
+    for (uint16_t fps = 1; fps <= IR_CAMERA_SYSTEM_MAX_FPS; ++fps) {
+        const double period_us = 1e6 / fps;
+
+        for (uint16_t on_time_us = 0;
+             on_time_us <= IR_CAMERA_SYSTEM_MAX_IR_LED_ON_TIME_US;
+             ++on_time_us) {
+            struct ir_camera_timer_settings settings = {0};
+            struct ir_camera_timer_settings ts = {0};
+
+            ret_code_t ret = timer_settings_from_fps(fps, &settings, &ts);
+            zassert_equal(RET_SUCCESS, ret, "fps %u", fps);
+            settings = ts;
+            ret = timer_settings_from_on_time_us(on_time_us, &settings, &ts);
+
+            const double max_on_time_us =
+                period_us * IR_CAMERA_SYSTEM_MAX_IR_LED_DUTY_CYCLE;
+            const bool allowed = on_time_us <= max_on_time_us;
+            if (!allowed) {
+                zassert_equal(RET_ERROR_INVALID_PARAM, ret,
+                              "fps %u, on-time %uus", fps, on_time_us);
+                zassert_mem_equal(&settings, &ts, sizeof(ts));
+                continue;
+            }
+            zassert_equal(RET_SUCCESS, ret, "fps %u, on-time %uus", fps,
+                          on_time_us);
+
+            // the master timer period matches the frame rate
+            const double actual_us =
+                (double)master_period_cycles(ts.master_psc, ts.master_arr) /
+                TIMER_CLOCK_FREQ_MHZ;
+            zassert_true(fabs(period_us - actual_us) < period_us * 1e-3,
+                         "fps %u: period %f us", fps, actual_us);
+
+            // the LED pulse and the camera trigger fit in the period
+            zassert_true(on_time_us + CAMERA_TRIGGER_TIMER_START_DELAY_US <
+                             actual_us,
+                         "fps %u, on-time %uus", fps, on_time_us);
+
+            // changing the frame rate keeps the on-time if still allowed,
+            // settings are left untouched otherwise
+            for (uint16_t new_fps = 1; new_fps <= IR_CAMERA_SYSTEM_MAX_FPS;
+                 new_fps += 7) {
+                struct ir_camera_timer_settings changed = ts;
+                ret = timer_settings_from_fps(new_fps, &ts, &changed);
+                if (ret == RET_SUCCESS) {
+                    zassert_equal(on_time_us, changed.on_time_in_us);
+                    zassert_equal(new_fps, changed.fps);
+                } else {
+                    const double new_max_on_time_us =
+                        1e6 / new_fps * IR_CAMERA_SYSTEM_MAX_IR_LED_DUTY_CYCLE;
+                    zassert_true(on_time_us > new_max_on_time_us);
+                    zassert_mem_equal(&changed, &ts, sizeof(ts));
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Model of the preloaded master timer: the update event, at the end of each
+ * period, transfers both preload registers to the shadow registers used for
+ * the next period. The prescaler and then the auto-reload registers are
+ * written `write_cycles` apart, after waiting for
+ * `timer_settings_master_commit_delay_ticks`.
+ *
+ * @return true if the update event falls between both writes, the next
+ *  period then using the new prescaler with the old auto-reload value
+ */
+static bool
+master_commit_splits(const struct ir_camera_timer_settings *active,
+                     uint16_t counter, uint32_t write_cycles)
+{
+    const uint32_t delay_ticks =
+        timer_settings_master_commit_delay_ticks(counter, active);
+    if (delay_ticks != 0) {
+        // update event during the wait: the counter restarts from 0
+        zassert_equal(active->master_arr + 1, (uint32_t)counter + delay_ticks);
+        counter = 0;
+    }
+
+    // worst case: the prescaler is about to roll over, the update event
+    // occurs on the next cycle when the counter is at the auto-reload value
+    const uint64_t cycles_to_update =
+        (uint64_t)(active->master_arr - counter) * (active->master_psc + 1) +
+        1;
+
+    return cycles_to_update <= write_cycles;
+}
+
+ZTEST(timer_settings_master_commit, test_commit_never_splits_psc_and_arr)
+{
+    // both writes with interrupts locked take a few tens of cycles, the
+    // margin covers ten times more
+    const uint32_t write_cycles =
+        IR_CAMERA_SYSTEM_MASTER_COMMIT_MARGIN_US * TIMER_CLOCK_FREQ_MHZ / 10;
+
+    for (uint16_t fps = 1; fps <= IR_CAMERA_SYSTEM_MAX_FPS; ++fps) {
+        struct ir_camera_timer_settings none = {0};
+        struct ir_camera_timer_settings active = {0};
+        zassert_equal(RET_SUCCESS,
+                      timer_settings_from_fps(fps, &none, &active));
+
+        // every counter value close to the update event, a sample of the
+        // others
+        for (uint32_t counter = 0; counter <= active.master_arr;
+             counter += (counter + 1000 < active.master_arr) ? 97 : 1) {
+            zassert_false(master_commit_splits(&active, counter, write_cycles),
+                          "fps %u, counter %u", fps, counter);
+        }
+    }
+}
+
+ZTEST(timer_settings_master_commit, test_commit_delay_bounded_by_margin)
+{
+    for (uint16_t fps = 1; fps <= IR_CAMERA_SYSTEM_MAX_FPS; ++fps) {
+        struct ir_camera_timer_settings none = {0};
+        struct ir_camera_timer_settings active = {0};
+        zassert_equal(RET_SUCCESS,
+                      timer_settings_from_fps(fps, &none, &active));
+
+        // waiting with interrupts locked: never longer than the margin plus
+        // one tick
+        const uint32_t max_wait_cycles =
+            IR_CAMERA_SYSTEM_MASTER_COMMIT_MARGIN_US * TIMER_CLOCK_FREQ_MHZ +
+            2 * (active.master_psc + 1);
+        for (uint32_t counter = 0; counter <= active.master_arr; ++counter) {
+            const uint32_t delay =
+                timer_settings_master_commit_delay_ticks(counter, &active);
+            zassert_true(delay * (active.master_psc + 1) <= max_wait_cycles,
+                         "fps %u, counter %u: %u ticks", fps, counter, delay);
+        }
+    }
+
+    // timer stopped: nothing to wait for
+    struct ir_camera_timer_settings stopped = {0};
+    zassert_equal(0, timer_settings_master_commit_delay_ticks(0, &stopped));
+}
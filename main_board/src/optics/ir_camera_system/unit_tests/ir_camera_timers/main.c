@@ -0,0 +1,704 @@
+#include "tim_sim.h"
+#include <ir_camera_sweep.h>
+#include <ir_camera_timers.h>
+#include <string.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+/*
+ * The IR camera system timers, run by the timer model frame after frame:
+ * master timer, camera trigger timer (IR eye camera on channel 3, 2D ToF
+ * camera on channel 1, no IR face camera) and the IR LED timers (850nm LED
+ * on channel 1, channel 2 and 940nm LEDs disabled), wired as in
+ * ir_camera_system_hw.c on Diamond, and driven by its ISRs and settings
+ * code in ir_camera_timers.c
+ */
+
+#define EYE_CHANNEL 3
+#define TOF_CHANNEL 1
+#define LED_CHANNEL 1
+// IR face camera trigger on Pearl
+#define FACE_CHANNEL 4
+
+#define MAX_FRAMES 16
+
+// LL calls on the timers by the exposure ISR: acknowledge the interrupt,
+// check the trigger counter, read the master counter and prescaler, and
+// disable the interrupt at the end of a sweep. Each access is a peripheral
+// bus transaction of a few cycles on the MCU, where the cycle count of the
+// whole ISR is given by `orb isr_trace`.
+#define EXPOSURE_ISR_MAX_ACCESSES 5
+
+static TIM_TypeDef master;
+static TIM_TypeDef trigger;
+static TIM_TypeDef led_850nm;
+static TIM_TypeDef led_940nm;
+
+static const int channels[IR_CAMERA_SCHEDULE_CAMERA_COUNT] = {
+    [IR_CAMERA_SCHEDULE_IR_EYE] = EYE_CHANNEL,
+    [IR_CAMERA_SCHEDULE_IR_FACE] = 0,
+    [IR_CAMERA_SCHEDULE_TOF_2D] = TOF_CHANNEL,
+};
+
+#define ALL_CAMERAS BIT_MASK(IR_CAMERA_SCHEDULE_CAMERA_COUNT)
+#define EYE_AND_TOF                                                            \
+    (BIT(IR_CAMERA_SCHEDULE_IR_EYE) | BIT(IR_CAMERA_SCHEDULE_TOF_2D))
+
+static struct ir_camera_timer_settings settings;
+// exposure interrupt enabled outside sweeps, to stream frames
+static bool it_always_on;
+// time of the first master update event, see start
+static uint64_t started_at;
+
+static struct {
+    size_t calls;
+    size_t exposures;
+    uint64_t ended_at[MAX_FRAMES];
+    uint32_t since_update_us[MAX_FRAMES];
+    size_t deferred;
+    size_t sweep_ends;
+    uint32_t max_accesses;
+} isr_log;
+
+static struct {
+    size_t count;
+    int32_t setpoints[MAX_FRAMES];
+    uint64_t at[MAX_FRAMES];
+} lens_log;
+
+static uint64_t
+us_to_cycles(uint64_t us)
+{
+    return us * TIM_SIM_CLOCK_MHZ;
+}
+
+static uint64_t
+frame_period_cycles(const struct ir_camera_timer_settings *ts)
+{
+    return ((uint64_t)ts->master_arr + 1) * (ts->master_psc + 1);
+}
+
+static uint64_t
+master_tick_cycles(void)
+{
+    return settings.master_psc + 1;
+}
+
+static void
+exposure_ended(uint32_t since_master_update_us)
+{
+    if (isr_log.exposures < MAX_FRAMES) {
+        isr_log.ended_at[isr_log.exposures] = tim_sim_now();
+        isr_log.since_update_us[isr_log.exposures] = since_master_update_us;
+    }
+    isr_log.exposures++;
+}
+
+static void
+sweep_deferred(void)
+{
+    isr_log.deferred++;
+}
+
+static void
+sweep_end(void)
+{
+    isr_log.sweep_ends++;
+}
+
+static const struct ir_camera_timers_exposure_ops exposure_ops = {
+    .ended = exposure_ended,
+    .deferred = sweep_deferred,
+    .sweep_end = sweep_end,
+};
+
+static uint32_t
+all_accesses(void)
+{
+    return tim_sim_accesses(&master) + tim_sim_accesses(&trigger) +
+           tim_sim_accesses(&led_850nm) + tim_sim_accesses(&led_940nm);
+}
+
+static void
+exposure_isr(void)
+{
+    // LL calls of the interrupted code
+    const uint32_t interrupted[] = {
+        tim_sim_accesses(&master), tim_sim_accesses(&trigger),
+        tim_sim_accesses(&led_850nm), tim_sim_accesses(&led_940nm)};
+
+    isr_log.calls++;
+    ir_camera_timers_exposure_isr(&master, &trigger, it_always_on,
+                                  &exposure_ops);
+    const uint32_t accesses = all_accesses();
+    isr_log.max_accesses = MAX(isr_log.max_accesses, accesses);
+
+    master.sim.accesses = interrupted[0];
+    trigger.sim.accesses = interrupted[1];
+    led_850nm.sim.accesses = interrupted[2];
+    led_940nm.sim.accesses = interrupted[3];
+}
+
+static void
+set_lens(int32_t setpoint)
+{
+    if (lens_log.count < MAX_FRAMES) {
+        lens_log.setpoints[lens_log.count] = setpoint;
+        lens_log.at[lens_log.count] = tim_sim_now();
+    }
+    lens_log.count++;
+}
+
+static const struct ir_camera_sweep_actuator_ops lens_ops = {.set = set_lens};
+
+/**
+ * Program the timers from `next`, as apply_new_timer_settings does
+ */
+static void
+apply_settings(const struct ir_camera_timer_settings *next, uint32_t cameras,
+               uint32_t enabled, const struct ir_camera_schedule *schedule)
+{
+    const struct ir_camera_timer_settings active = settings;
+
+    settings = *next;
+    tim_sim_irq_lock(true);
+    ir_camera_timers_apply(&master, &trigger, channels, cameras, enabled,
+                           &settings, &active, schedule);
+    ir_camera_timers_leds_set_pulse(&led_850nm, &led_940nm, &settings);
+    tim_sim_irq_lock(false);
+}
+
+static void
+led_timer_init(TIM_TypeDef *led, uint32_t enabled)
+{
+    LL_TIM_SetPrescaler(led, IR_CAMERA_SYSTEM_IR_LED_PSC);
+    LL_TIM_EnableARRPreload(led);
+    LL_TIM_SetOnePulseMode(led, LL_TIM_ONEPULSEMODE_SINGLE);
+    LL_TIM_OC_SetCompareCH1(led, IR_LED_TIMER_START_DELAY_US);
+    LL_TIM_OC_SetCompareCH2(led, IR_LED_TIMER_START_DELAY_US);
+    LL_TIM_OC_SetMode(led, LL_TIM_CHANNEL_CH1, LL_TIM_OCMODE_PWM2);
+    LL_TIM_OC_SetMode(led, LL_TIM_CHANNEL_CH2, LL_TIM_OCMODE_PWM2);
+    ir_camera_timers_leds_set_channels(
+        led, LL_TIM_CHANNEL_CH1 | LL_TIM_CHANNEL_CH2, enabled);
+}
+
+/**
+ * Start taking frames, the first one when the master counter wraps around
+ */
+static void
+start(uint16_t fps, uint16_t on_time_us)
+{
+    struct ir_camera_timer_settings ts = {0};
+
+    zassert_ok(timer_settings_from_fps(fps, &ts, &ts));
+    zassert_ok(timer_settings_from_on_time_us(on_time_us, &ts, &ts));
+
+    LL_TIM_SetPrescaler(&trigger, IR_CAMERA_SYSTEM_IR_LED_PSC);
+    LL_TIM_EnableARRPreload(&trigger);
+    LL_TIM_SetOnePulseMode(&trigger, LL_TIM_ONEPULSEMODE_SINGLE);
+    led_timer_init(&led_850nm, LL_TIM_CHANNEL_CH1);
+    led_timer_init(&led_940nm, 0);
+    LL_TIM_EnableARRPreload(&master);
+    apply_settings(&ts, ALL_CAMERAS, EYE_AND_TOF, NULL);
+
+    LL_TIM_GenerateEvent_UPDATE(&master);
+    LL_TIM_GenerateEvent_UPDATE(&trigger);
+    LL_TIM_GenerateEvent_UPDATE(&led_850nm);
+    LL_TIM_GenerateEvent_UPDATE(&led_940nm);
+    LL_TIM_ClearFlag_UPDATE(&trigger);
+    LL_TIM_EnableIT_UPDATE(&trigger);
+    started_at = tim_sim_now();
+
+    // wired once the registers are loaded, no frame before the first update
+    // event of the master counter
+    tim_sim_set_slave(&trigger, &master);
+    tim_sim_set_slave(&led_850nm, &master);
+    tim_sim_set_slave(&led_940nm, &master);
+
+    (void)all_accesses();
+}
+
+/**
+ * Copy the edges of an output
+ * @return number of edges
+ */
+static size_t
+output_edges(const TIM_TypeDef *timer, int channel, struct tim_sim_edge *out,
+             size_t max)
+{
+    const struct tim_sim_edge *edges;
+    const size_t count = tim_sim_edges(&edges);
+    size_t n = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (edges[i].timer == timer && edges[i].channel == channel) {
+            if (n < max) {
+                out[n] = edges[i];
+            }
+            n++;
+        }
+    }
+
+    return n;
+}
+
+/**
+ * Check that the output pulses once per frame, from `phase_us` to `end_us`
+ * after the start of each frame
+ * @return start of the first frame
+ */
+static uint64_t
+assert_pulses(const TIM_TypeDef *timer, int channel, size_t frames,
+              uint32_t phase_us, uint32_t end_us)
+{
+    struct tim_sim_edge edges[2 * MAX_FRAMES];
+    const size_t n = output_edges(timer, channel, edges, ARRAY_SIZE(edges));
+
+    zassert_equal(2 * frames, n, "%s ch%d: %zu edges", timer->sim.name,
+                  channel, n);
+
+    const uint64_t frame_start = edges[0].cycle - us_to_cycles(phase_us);
+    for (size_t i = 0; i < frames; ++i) {
+        const uint64_t start =
+            frame_start + i * frame_period_cycles(&settings);
+        zassert_true(edges[2 * i].level);
+        zassert_equal(start + us_to_cycles(phase_us), edges[2 * i].cycle,
+                      "%s ch%d frame %zu", timer->sim.name, channel, i);
+        zassert_false(edges[2 * i + 1].level);
+        zassert_equal(start + us_to_cycles(end_us), edges[2 * i + 1].cycle,
+                      "%s ch%d frame %zu", timer->sim.name, channel, i);
+    }
+
+    return frame_start;
+}
+
+/**
+ * Let `frames` frames be taken, the first one starting when the master
+ * counter wraps around, and stop in the middle of the next period
+ */
+static void
+run_frames(size_t frames)
+{
+    tim_sim_run(frame_period_cycles(&settings) * frames +
+                frame_period_cycles(&settings) / 2);
+}
+
+/**
+ * @return time of the first rising edge of an output, 0 if none
+ */
+static uint64_t
+next_rising_edge(const TIM_TypeDef *timer, int channel)
+{
+    struct tim_sim_edge edges[2];
+
+    if (output_edges(timer, channel, edges, ARRAY_SIZE(edges)) == 0) {
+        return 0;
+    }
+    zassert_true(edges[0].level);
+
+    return edges[0].cycle;
+}
+
+/**
+ * @return length of the first pulse of an output, in timer clock cycles
+ */
+static uint64_t
+first_pulse_cycles(const TIM_TypeDef *timer, int channel)
+{
+    struct tim_sim_edge edges[2];
+
+    zassert_true(output_edges(timer, channel, edges, ARRAY_SIZE(edges)) >= 2);
+    zassert_true(edges[0].level);
+    zassert_false(edges[1].level);
+
+    return edges[1].cycle - edges[0].cycle;
+}
+
+static void
+before_each_test(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    tim_sim_reset();
+    tim_sim_add(&master, "master");
+    tim_sim_add(&trigger, "trigger");
+    tim_sim_add(&led_850nm, "led 850nm");
+    tim_sim_add(&led_940nm, "led 940nm");
+    tim_sim_set_isr(&trigger, exposure_isr);
+
+    memset(&settings, 0, sizeof(settings));
+    memset(&isr_log, 0, sizeof(isr_log));
+    memset(&lens_log, 0, sizeof(lens_log));
+    it_always_on = true;
+
+    ir_camera_sweep_stop();
+    ir_camera_sweep_register(IR_CAMERA_SWEEP_LIQUID_LENS, &lens_ops);
+}
+
+ZTEST_SUITE(ir_camera_timers, NULL, NULL, before_each_test, NULL, NULL);
+
+ZTEST(ir_camera_timers, test_trigger_and_strobe_each_frame)
+{
+    start(30, 2000);
+    run_frames(3);
+
+    // the IR LED and the IR eye camera are synchronized, the exposure ends
+    // with the auto-reload of the one-pulse timers
+    const uint32_t end_us = ir_camera_timers_pulse_auto_reload(&settings) + 1;
+    const uint64_t frame_start =
+        assert_pulses(&led_850nm, LED_CHANNEL, 3, IR_LED_TIMER_START_DELAY_US,
+                      end_us);
+    zassert_equal(frame_start,
+                  assert_pulses(&trigger, EYE_CHANNEL, 3,
+                                CAMERA_TRIGGER_TIMER_START_DELAY_US, end_us));
+    zassert_equal(started_at + frame_period_cycles(&settings), frame_start);
+
+    // disabled channel
+    struct tim_sim_edge edge;
+    zassert_equal(0, output_edges(&led_850nm, 2, &edge, 1));
+}
+
+ZTEST(ir_camera_timers, test_exposure_ends_once_per_frame)
+{
+    start(30, 2000);
+    run_frames(3);
+
+    // the interrupt is raised at the start and at the end of each trigger
+    zassert_equal(3, isr_log.exposures);
+    zassert_equal(6, isr_log.calls);
+
+    struct tim_sim_edge edges[6];
+    zassert_equal(6, output_edges(&trigger, EYE_CHANNEL, edges, 6));
+    // once the master counter is read
+    for (size_t i = 0; i < 3; ++i) {
+        zassert_within(edges[2 * i + 1].cycle, isr_log.ended_at[i],
+                       TIM_SIM_POLL_CYCLES);
+    }
+}
+
+ZTEST(ir_camera_timers, test_sweep_setpoints_follow_exposures)
+{
+    static const int16_t table[] = {100, 110, 120, 130};
+
+    start(30, 2000);
+    zassert_ok(ir_camera_sweep_load(IR_CAMERA_SWEEP_LIQUID_LENS, table,
+                                    ARRAY_SIZE(table)));
+    zassert_ok(ir_camera_sweep_start(BIT(IR_CAMERA_SWEEP_LIQUID_LENS)));
+    run_frames(5);
+
+    // first setpoint at the start, then one at the end of each exposure but
+    // the last one
+    zassert_equal(ARRAY_SIZE(table), lens_log.count);
+    zassert_false(ir_camera_sweep_in_progress());
+    zassert_equal(5, isr_log.exposures);
+    zassert_equal(started_at, lens_log.at[0]);
+    for (size_t i = 0; i < ARRAY_SIZE(table); ++i) {
+        zassert_equal(table[i], lens_log.setpoints[i]);
+        if (i > 0) {
+            zassert_equal(isr_log.ended_at[i - 1], lens_log.at[i]);
+        }
+    }
+}
+
+ZTEST(ir_camera_timers, test_on_time_change_applies_from_next_frame)
+{
+    start(30, 2000);
+    tim_sim_run(frame_period_cycles(&settings) +
+                us_to_cycles(IR_LED_TIMER_START_DELAY_US + 1000));
+
+    // in the middle of the first strobe
+    struct ir_camera_timer_settings next;
+    zassert_ok(timer_settings_from_on_time_us(500, &settings, &next));
+    const uint32_t old_end_us =
+        ir_camera_timers_pulse_auto_reload(&settings) + 1;
+    apply_settings(&next, ALL_CAMERAS, EYE_AND_TOF, NULL);
+    tim_sim_run(frame_period_cycles(&settings));
+
+    struct tim_sim_edge edges[4];
+    zassert_equal(4, output_edges(&led_850nm, LED_CHANNEL, edges, 4));
+    zassert_equal(us_to_cycles(old_end_us - IR_LED_TIMER_START_DELAY_US),
+                  edges[1].cycle - edges[0].cycle);
+    const uint32_t new_end_us =
+        ir_camera_timers_pulse_auto_reload(&settings) + 1;
+    zassert_equal(us_to_cycles(new_end_us - IR_LED_TIMER_START_DELAY_US),
+                  edges[3].cycle - edges[2].cycle);
+}
+
+ZTEST(ir_camera_timers, test_fps_change_without_short_frame)
+{
+    start(30, 2000);
+    const uint64_t old_period = frame_period_cycles(&settings);
+    tim_sim_run(old_period);
+
+    struct ir_camera_timer_settings next;
+    zassert_ok(timer_settings_from_fps(60, &settings, &next));
+
+    // right before the update event: the commit waits for it
+    zassert_true(tim_sim_run_until_counter(&master, settings.master_arr,
+                                           old_period));
+    apply_settings(&next, ALL_CAMERAS, EYE_AND_TOF, NULL);
+    const uint64_t new_period = frame_period_cycles(&settings);
+    tim_sim_run(old_period * 3);
+
+    struct tim_sim_edge edges[2 * MAX_FRAMES];
+    const size_t n =
+        output_edges(&trigger, EYE_CHANNEL, edges, ARRAY_SIZE(edges));
+    zassert_true(n >= 8);
+    // the frame in progress and the one started by the imminent update event
+    // keep the old period
+    for (size_t i = 2; i < n; i += 2) {
+        const uint64_t period = edges[i].cycle - edges[i - 2].cycle;
+        zassert_equal(i <= 4 ? old_period : new_period, period,
+                      "frame %zu: %llu cycles", i / 2,
+                      (unsigned long long)period);
+    }
+}
+
+ZTEST(ir_camera_timers, test_tof_scheduled_after_strobe)
+{
+    start(30, 2000);
+    const uint32_t strobe_end_us =
+        ir_camera_timers_pulse_auto_reload(&settings) + 1;
+    const struct ir_camera_schedule schedule = {
+        .slots = {
+            [IR_CAMERA_SCHEDULE_TOF_2D] = {.used = true,
+                                           .phase_us = strobe_end_us,
+                                           .window_us = 10000},
+        }};
+    zassert_ok(ir_camera_schedule_check(&schedule, 1000000 / settings.fps,
+                                        IR_LED_TIMER_START_DELAY_US,
+                                        strobe_end_us, NULL));
+    apply_settings(&settings, ALL_CAMERAS, EYE_AND_TOF, &schedule);
+    run_frames(2);
+
+    // the trigger period is extended for the ToF camera window, the IR eye
+    // camera is still exposed during the strobe only
+    const uint64_t frame_start =
+        assert_pulses(&led_850nm, LED_CHANNEL, 2, IR_LED_TIMER_START_DELAY_US,
+                      strobe_end_us);
+    zassert_equal(frame_start,
+                  assert_pulses(&trigger, TOF_CHANNEL, 2, strobe_end_us,
+                                strobe_end_us + 10000));
+    zassert_equal(frame_start,
+                  assert_pulses(&trigger, EYE_CHANNEL, 2,
+                                CAMERA_TRIGGER_TIMER_START_DELAY_US,
+                                strobe_end_us));
+    zassert_equal(strobe_end_us + 10000 - 1, trigger.ARR);
+}
+
+ZTEST(ir_camera_timers, test_trigger_check_counter_width)
+{
+    struct ir_camera_schedule schedule = {
+        .slots = {
+            [IR_CAMERA_SCHEDULE_TOF_2D] = {.used = true,
+                                           .phase_us = 60000,
+                                           .window_us = 5536},
+        }};
+    ir_camera_schedule_camera_t conflict = IR_CAMERA_SCHEDULE_IR_EYE;
+
+    zassert_ok(timer_settings_from_fps(10, &settings, &settings));
+    zassert_ok(timer_settings_from_on_time_us(2000, &settings, &settings));
+
+    // the window ends with the last count of the 16-bit trigger timer
+    zassert_ok(ir_camera_timers_trigger_check(channels, &settings, &schedule,
+                                              &conflict));
+
+    schedule.slots[IR_CAMERA_SCHEDULE_TOF_2D].window_us++;
+    zassert_equal(RET_ERROR_INVALID_PARAM,
+                  ir_camera_timers_trigger_check(channels, &settings,
+                                                 &schedule, &conflict));
+    zassert_equal(IR_CAMERA_SCHEDULE_TOF_2D, conflict);
+}
+
+ZTEST(ir_camera_timers, test_trigger_check_channel_pair)
+{
+    static const int pearl_channels[IR_CAMERA_SCHEDULE_CAMERA_COUNT] = {
+        [IR_CAMERA_SCHEDULE_IR_EYE] = EYE_CHANNEL,
+        [IR_CAMERA_SCHEDULE_IR_FACE] = FACE_CHANNEL,
+        [IR_CAMERA_SCHEDULE_TOF_2D] = TOF_CHANNEL,
+    };
+    const struct ir_camera_schedule schedule = {
+        .slots = {
+            [IR_CAMERA_SCHEDULE_TOF_2D] = {.used = true,
+                                           .phase_us = 5000,
+                                           .window_us = 10000},
+        }};
+    ir_camera_schedule_camera_t conflict = IR_CAMERA_SCHEDULE_TOF_2D;
+
+    zassert_ok(timer_settings_from_fps(30, &settings, &settings));
+    zassert_ok(timer_settings_from_on_time_us(2000, &settings, &settings));
+
+    // all the windows end with the trigger period
+    zassert_ok(ir_camera_timers_trigger_check(pearl_channels, &settings, NULL,
+                                              &conflict));
+
+    // the IR eye camera window ends before the period, with the compare
+    // value of channel 4, which triggers the IR face camera
+    zassert_equal(RET_ERROR_INVALID_PARAM,
+                  ir_camera_timers_trigger_check(pearl_channels, &settings,
+                                                 &schedule, &conflict));
+    zassert_equal(IR_CAMERA_SCHEDULE_IR_EYE, conflict);
+
+    // channel 4 is free on Diamond
+    zassert_ok(ir_camera_timers_trigger_check(channels, &settings, &schedule,
+                                              &conflict));
+}
+
+ZTEST(ir_camera_timers, test_sweep_end_disables_interrupt)
+{
+    static const int16_t table[] = {100, 110, 120};
+
+    it_always_on = false;
+    start(30, 2000);
+    zassert_ok(ir_camera_sweep_load(IR_CAMERA_SWEEP_LIQUID_LENS, table,
+                                    ARRAY_SIZE(table)));
+    zassert_ok(ir_camera_sweep_start(BIT(IR_CAMERA_SWEEP_LIQUID_LENS)));
+    run_frames(5);
+
+    // the interrupt isn't raised after the last frame of the sweep
+    zassert_equal(ARRAY_SIZE(table), isr_log.exposures);
+    zassert_equal(2 * ARRAY_SIZE(table), isr_log.calls);
+    zassert_equal(1, isr_log.sweep_ends);
+    zassert_equal(0, isr_log.deferred);
+    zassert_false(ir_camera_sweep_in_progress());
+    zassert_equal(0, trigger.DIER & TIM_DIER_UIE);
+}
+
+ZTEST(ir_camera_timers, test_exposure_time_since_master_update)
+{
+    start(30, 2000);
+    run_frames(3);
+
+    // the IR eye camera window ends with the strobe, the master counter
+    // is read with its resolution
+    const uint32_t end_us = ir_camera_timers_pulse_auto_reload(&settings) + 1;
+    const uint32_t resolution_us =
+        DIV_ROUND_UP(master_tick_cycles(), TIM_SIM_CLOCK_MHZ);
+    zassert_equal(3, isr_log.exposures);
+    for (size_t i = 0; i < 3; ++i) {
+        zassert_within(end_us, isr_log.since_update_us[i], resolution_us,
+                       "frame %zu: %u us", i, isr_log.since_update_us[i]);
+    }
+}
+
+ZTEST(ir_camera_timers, test_apply_updates_selected_triggers)
+{
+    start(30, 2000);
+    run_frames(1);
+
+    // the IR eye camera trigger is left as is, e.g. on Diamond while the IR
+    // face camera is streaming
+    struct ir_camera_timer_settings next = settings;
+    apply_settings(&next, BIT(IR_CAMERA_SCHEDULE_TOF_2D), 0, NULL);
+    zassert_true(LL_TIM_IsEnabledCounter(&master));
+    zassert_true((trigger.CCER & LL_TIM_CHANNEL_CH3) != 0);
+    zassert_equal(0, trigger.CCER & LL_TIM_CHANNEL_CH1);
+
+    // no frames: the master timer stops, all the triggers are disabled
+    next.fps = 0;
+    apply_settings(&next, ALL_CAMERAS, EYE_AND_TOF, NULL);
+    zassert_false(LL_TIM_IsEnabledCounter(&master));
+    zassert_equal(0, trigger.CCER & (LL_TIM_CHANNEL_CH1 | LL_TIM_CHANNEL_CH3));
+}
+
+ZTEST(ir_camera_timers, test_strobe_during_ir_led_pulse_ignored)
+{
+    start(30, 2000);
+    zassert_true(tim_sim_run_until_counter(&master, 1,
+                                           frame_period_cycles(&settings) * 2));
+    (void)all_accesses();
+
+    ir_camera_timers_strobe_started(&master, &led_850nm, &led_940nm,
+                                    &settings);
+
+    // counter read only
+    zassert_equal(1, all_accesses());
+}
+
+ZTEST(ir_camera_timers, test_strobe_brings_ir_led_pulse_forward)
+{
+    start(30, 2000);
+    tim_sim_run(frame_period_cycles(&settings) +
+                frame_period_cycles(&settings) / 2);
+    tim_sim_clear_edges();
+
+    // RGB-IR camera exposure starting long before the IR LED pulse
+    const uint64_t strobe_start = tim_sim_now();
+    const uint32_t remaining_ticks = settings.master_arr - master.CNT + 1;
+    ir_camera_timers_strobe_started(&master, &led_850nm, &led_940nm,
+                                    &settings);
+    tim_sim_run(frame_period_cycles(&settings));
+
+    // the update event is brought forward by `master_max_ir_leds_tick`, the
+    // pulse lasts the longest on-time
+    const uint64_t update =
+        strobe_start +
+        (remaining_ticks - settings.master_max_ir_leds_tick) *
+            master_tick_cycles();
+    zassert_within(update + us_to_cycles(IR_LED_TIMER_START_DELAY_US),
+                   next_rising_edge(&led_850nm, LED_CHANNEL),
+                   2 * master_tick_cycles());
+    zassert_equal(us_to_cycles(IR_CAMERA_SYSTEM_MAX_IR_LED_ON_TIME_US),
+                  first_pulse_cycles(&led_850nm, LED_CHANNEL));
+
+    // end of the strobe: the next frame is scheduled from the initial
+    // counter value
+    tim_sim_clear_edges();
+    const uint64_t strobe_end = tim_sim_now();
+    ir_camera_timers_strobe_ended(&master, &settings);
+    zassert_equal(settings.master_initial_counter, master.CNT);
+    tim_sim_run(frame_period_cycles(&settings));
+
+    const uint64_t next_update =
+        strobe_end +
+        ((uint64_t)settings.master_arr - settings.master_initial_counter + 1) *
+            master_tick_cycles();
+    zassert_within(next_update + us_to_cycles(IR_LED_TIMER_START_DELAY_US),
+                   next_rising_edge(&led_850nm, LED_CHANNEL),
+                   master_tick_cycles());
+}
+
+ZTEST(ir_camera_timers, test_strobe_starts_ir_led_pulse_early)
+{
+    start(30, 2000);
+    const uint32_t remaining_us = 3000;
+    const uint32_t remaining_ticks =
+        us_to_cycles(remaining_us) / master_tick_cycles();
+    zassert_true(tim_sim_run_until_counter(&master,
+                                           settings.master_arr -
+                                               remaining_ticks,
+                                           frame_period_cycles(&settings) * 2));
+    tim_sim_clear_edges();
+
+    // RGB-IR camera exposure starting shortly before the IR LED pulse: the
+    // pulse starts right away and ends with the scheduled one
+    const uint64_t strobe_start = tim_sim_now();
+    ir_camera_timers_strobe_started(&master, &led_850nm, &led_940nm,
+                                    &settings);
+    tim_sim_run(frame_period_cycles(&settings));
+
+    zassert_within(strobe_start + us_to_cycles(IR_LED_TIMER_START_DELAY_US),
+                   next_rising_edge(&led_850nm, LED_CHANNEL),
+                   TIM_SIM_POLL_CYCLES + TIM_SIM_CLOCK_MHZ);
+    zassert_within(us_to_cycles(remaining_us + settings.on_time_in_us),
+                   first_pulse_cycles(&led_850nm, LED_CHANNEL),
+                   us_to_cycles(1) + master_tick_cycles());
+}
+
+ZTEST(ir_camera_timers, test_exposure_isr_accesses)
+{
+    static const int16_t table[] = {100, 110, 120};
+
+    it_always_on = false;
+    start(30, 2000);
+    zassert_ok(ir_camera_sweep_load(IR_CAMERA_SWEEP_LIQUID_LENS, table,
+                                    ARRAY_SIZE(table)));
+    zassert_ok(ir_camera_sweep_start(BIT(IR_CAMERA_SWEEP_LIQUID_LENS)));
+    run_frames(4);
+
+    // up to the end of the sweep
+    zassert_equal(6, isr_log.calls);
+    zassert_equal(1, isr_log.sweep_ends);
+    zassert_true(isr_log.max_accesses <= EXPOSURE_ISR_MAX_ACCESSES,
+                 "%u accesses", isr_log.max_accesses);
+}
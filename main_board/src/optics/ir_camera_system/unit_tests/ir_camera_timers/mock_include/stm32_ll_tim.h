@@ -0,0 +1,248 @@
+#pragma once
+
+/**
+ * Simulated STM32 timers, behind the LL functions used by the IR camera
+ * system, see tim_sim.h
+ *
+ * Registers keep their names, the preloaded ones (PSC, ARR, CCRx) hold the
+ * value written by the firmware and `sim` the active ones.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TIM_CR1_CEN  (1U << 0)
+#define TIM_CR1_OPM  (1U << 3)
+#define TIM_CR1_ARPE (1U << 7)
+#define TIM_DIER_UIE (1U << 0)
+#define TIM_SR_UIF   (1U << 0)
+
+#define LL_TIM_CHANNEL_CH1 (1U << 0)
+#define LL_TIM_CHANNEL_CH2 (1U << 4)
+#define LL_TIM_CHANNEL_CH3 (1U << 8)
+#define LL_TIM_CHANNEL_CH4 (1U << 12)
+
+// output compare modes, OCxM bits of CCMRx
+#define TIM_CCMR1_OC1M_0 (1U << 4)
+#define TIM_CCMR1_OC1M_1 (1U << 5)
+#define TIM_CCMR1_OC1M_2 (1U << 6)
+#define TIM_CCMR1_OC1M_3 (1U << 16)
+
+#define LL_TIM_OCMODE_FROZEN 0U
+#define LL_TIM_OCMODE_PWM1   (TIM_CCMR1_OC1M_2 | TIM_CCMR1_OC1M_1)
+#define LL_TIM_OCMODE_PWM2                                                     \
+    (TIM_CCMR1_OC1M_2 | TIM_CCMR1_OC1M_1 | TIM_CCMR1_OC1M_0)
+#define LL_TIM_OCMODE_COMBINED_PWM2                                            \
+    (TIM_CCMR1_OC1M_3 | TIM_CCMR1_OC1M_2 | TIM_CCMR1_OC1M_0)
+
+#define TIM_SIM_CHANNELS 4
+
+typedef struct tim_sim_timer {
+    volatile uint32_t CR1;
+    volatile uint32_t DIER;
+    volatile uint32_t SR;
+    volatile uint32_t CCER;
+    volatile uint32_t CNT;
+    volatile uint32_t PSC;
+    volatile uint32_t ARR;
+    volatile uint32_t CCR[TIM_SIM_CHANNELS];
+    // OCxM of each channel, not preloaded
+    volatile uint32_t OCM[TIM_SIM_CHANNELS];
+
+    struct {
+        const char *name;
+        uint32_t psc;
+        uint32_t arr;
+        uint32_t ccr[TIM_SIM_CHANNELS];
+        uint32_t prescaler_count;
+        // started and reset by the update events of `master`, see
+        // tim_sim_set_slave
+        struct tim_sim_timer *master;
+        bool update;
+        bool outputs[TIM_SIM_CHANNELS];
+        void (*isr)(void);
+        // LL calls, see tim_sim_accesses
+        uint32_t accesses;
+    } sim;
+} TIM_TypeDef;
+
+#ifndef MODIFY_REG
+#define MODIFY_REG(REG, CLEARMASK, SETMASK)                                    \
+    ((REG) = (((REG) & (~(CLEARMASK))) | (SETMASK)))
+#endif
+
+/// polling the counter lets the simulated time run, see tim_sim.h
+void
+tim_sim_counter_polled(TIM_TypeDef *timer);
+
+static inline void
+LL_TIM_EnableCounter(TIM_TypeDef *timer)
+{
+    timer->sim.accesses++;
+    timer->CR1 |= TIM_CR1_CEN;
+}
+
+static inline void
+LL_TIM_DisableCounter(TIM_TypeDef *timer)
+{
+    timer->sim.accesses++;
+    timer->CR1 &= ~TIM_CR1_CEN;
+}
+
+static inline uint32_t
+LL_TIM_IsEnabledCounter(const TIM_TypeDef *timer)
+{
+    ((TIM_TypeDef *)timer)->sim.accesses++;
+    return (timer->CR1 & TIM_CR1_CEN) != 0;
+}
+
+static inline void
+LL_TIM_EnableARRPreload(TIM_TypeDef *timer)
+{
+    timer->sim.accesses++;
+    timer->CR1 |= TIM_CR1_ARPE;
+}
+
+static inline void
+LL_TIM_SetOnePulseMode(TIM_TypeDef *timer, uint32_t one_pulse_mode)
+{
+    timer->sim.accesses++;
+    MODIFY_REG(timer->CR1, TIM_CR1_OPM, one_pulse_mode);
+}
+
+#define LL_TIM_ONEPULSEMODE_SINGLE     TIM_CR1_OPM
+#define LL_TIM_ONEPULSEMODE_REPETITIVE 0U
+
+static inline uint32_t
+LL_TIM_GetCounter(const TIM_TypeDef *timer)
+{
+    tim_sim_counter_polled((TIM_TypeDef *)timer);
+    return timer->CNT;
+}
+
+static inline void
+LL_TIM_SetCounter(TIM_TypeDef *timer, uint32_t counter)
+{
+    timer->sim.accesses++;
+    timer->CNT = counter;
+}
+
+static inline uint32_t
+LL_TIM_GetPrescaler(const TIM_TypeDef *timer)
+{
+    ((TIM_TypeDef *)timer)->sim.accesses++;
+    return timer->PSC;
+}
+
+static inline void
+LL_TIM_SetPrescaler(TIM_TypeDef *timer, uint32_t prescaler)
+{
+    timer->sim.accesses++;
+    timer->PSC = prescaler;
+}
+
+static inline void
+LL_TIM_SetAutoReload(TIM_TypeDef *timer, uint32_t auto_reload)
+{
+    timer->sim.accesses++;
+    timer->ARR = auto_reload;
+    if ((timer->CR1 & TIM_CR1_ARPE) == 0) {
+        timer->sim.arr = auto_reload;
+    }
+}
+
+static inline uint32_t
+LL_TIM_GetAutoReload(const TIM_TypeDef *timer)
+{
+    ((TIM_TypeDef *)timer)->sim.accesses++;
+    return timer->ARR;
+}
+
+static inline void
+LL_TIM_OC_SetCompareCH1(TIM_TypeDef *timer, uint32_t compare)
+{
+    timer->sim.accesses++;
+    timer->CCR[0] = compare;
+}
+
+static inline void
+LL_TIM_OC_SetCompareCH2(TIM_TypeDef *timer, uint32_t compare)
+{
+    timer->sim.accesses++;
+    timer->CCR[1] = compare;
+}
+
+static inline void
+LL_TIM_OC_SetCompareCH3(TIM_TypeDef *timer, uint32_t compare)
+{
+    timer->sim.accesses++;
+    timer->CCR[2] = compare;
+}
+
+static inline void
+LL_TIM_OC_SetCompareCH4(TIM_TypeDef *timer, uint32_t compare)
+{
+    timer->sim.accesses++;
+    timer->CCR[3] = compare;
+}
+
+/// index of the channel in the registers arrays
+static inline int
+tim_sim_channel_index(uint32_t channel)
+{
+    return __builtin_ctz(channel) / 4;
+}
+
+static inline void
+LL_TIM_OC_SetMode(TIM_TypeDef *timer, uint32_t channel, uint32_t mode)
+{
+    timer->sim.accesses++;
+    timer->OCM[tim_sim_channel_index(channel)] = mode;
+}
+
+/// compare values are always preloaded by the model
+static inline void
+LL_TIM_OC_EnablePreload(TIM_TypeDef *timer, uint32_t channel)
+{
+    (void)channel;
+    timer->sim.accesses++;
+}
+
+static inline void
+LL_TIM_CC_EnableChannel(TIM_TypeDef *timer, uint32_t channels)
+{
+    timer->sim.accesses++;
+    timer->CCER |= channels;
+}
+
+static inline void
+LL_TIM_CC_DisableChannel(TIM_TypeDef *timer, uint32_t channels)
+{
+    timer->sim.accesses++;
+    timer->CCER &= ~channels;
+}
+
+static inline void
+LL_TIM_ClearFlag_UPDATE(TIM_TypeDef *timer)
+{
+    timer->sim.accesses++;
+    timer->SR &= ~TIM_SR_UIF;
+}
+
+static inline void
+LL_TIM_EnableIT_UPDATE(TIM_TypeDef *timer)
+{
+    timer->sim.accesses++;
+    timer->DIER |= TIM_DIER_UIE;
+}
+
+static inline void
+LL_TIM_DisableIT_UPDATE(TIM_TypeDef *timer)
+{
+    timer->sim.accesses++;
+    timer->DIER &= ~TIM_DIER_UIE;
+}
+
+/// the update event transfers the preloaded registers
+void
+LL_TIM_GenerateEvent_UPDATE(TIM_TypeDef *timer);
@@ -0,0 +1,6 @@
+#define LOG_MODULE_REGISTER(...)
+#define LOG_MODULE_DECLARE(...)
+#define LOG_ERR(...)
+#define LOG_WRN(...)
+#define LOG_INF(...)
+#define LOG_DBG(...)
@@ -0,0 +1,259 @@
+#include "tim_sim.h"
+#include <string.h>
+
+static TIM_TypeDef *timers[TIM_SIM_MAX_TIMERS];
+static size_t timer_count;
+static uint64_t now;
+static bool irq_locked;
+static bool in_isr;
+static struct tim_sim_edge edges[TIM_SIM_MAX_EDGES];
+static size_t edge_count;
+
+void
+tim_sim_reset(void)
+{
+    memset(timers, 0, sizeof(timers));
+    timer_count = 0;
+    now = 0;
+    irq_locked = false;
+    in_isr = false;
+    edge_count = 0;
+}
+
+void
+tim_sim_add(TIM_TypeDef *timer, const char *name)
+{
+    memset(timer, 0, sizeof(*timer));
+    timer->sim.name = name;
+    if (timer_count < TIM_SIM_MAX_TIMERS) {
+        timers[timer_count++] = timer;
+    }
+}
+
+void
+tim_sim_set_slave(TIM_TypeDef *slave, TIM_TypeDef *master)
+{
+    slave->sim.master = master;
+}
+
+void
+tim_sim_set_isr(TIM_TypeDef *timer, void (*isr)(void))
+{
+    timer->sim.isr = isr;
+}
+
+void
+tim_sim_irq_lock(bool locked)
+{
+    irq_locked = locked;
+}
+
+uint64_t
+tim_sim_now(void)
+{
+    return now;
+}
+
+size_t
+tim_sim_edges(const struct tim_sim_edge **out)
+{
+    *out = edges;
+    return edge_count;
+}
+
+void
+tim_sim_clear_edges(void)
+{
+    edge_count = 0;
+}
+
+uint32_t
+tim_sim_accesses(TIM_TypeDef *timer)
+{
+    const uint32_t accesses = timer->sim.accesses;
+    timer->sim.accesses = 0;
+    return accesses;
+}
+
+/// OCxREF of a channel in PWM mode
+static bool
+output_ref(const TIM_TypeDef *timer, int i)
+{
+    switch (timer->OCM[i]) {
+    case LL_TIM_OCMODE_PWM1:
+        return timer->CNT < timer->sim.ccr[i];
+    case LL_TIM_OCMODE_PWM2:
+    case LL_TIM_OCMODE_COMBINED_PWM2:
+        return timer->CNT >= timer->sim.ccr[i];
+    default:
+        return false;
+    }
+}
+
+static void
+update_outputs(TIM_TypeDef *timer)
+{
+    for (int i = 0; i < TIM_SIM_CHANNELS; ++i) {
+        bool level = (timer->CCER & (1U << (4 * i))) != 0 &&
+                     output_ref(timer, i);
+        if (timer->OCM[i] == LL_TIM_OCMODE_COMBINED_PWM2) {
+            level = level && output_ref(timer, i ^ 1);
+        }
+        if (level != timer->sim.outputs[i]) {
+            timer->sim.outputs[i] = level;
+            if (edge_count < TIM_SIM_MAX_EDGES) {
+                edges[edge_count++] = (struct tim_sim_edge){
+                    .timer = timer, .channel = i + 1, .level = level,
+                    .cycle = now};
+            }
+        }
+    }
+}
+
+static void
+update_event(TIM_TypeDef *timer)
+{
+    timer->sim.psc = timer->PSC;
+    timer->sim.arr = timer->ARR;
+    memcpy(timer->sim.ccr, (const uint32_t *)timer->CCR,
+           sizeof(timer->sim.ccr));
+    timer->SR |= TIM_SR_UIF;
+    timer->sim.update = true;
+}
+
+static void
+counter_tick(TIM_TypeDef *timer)
+{
+    if (timer->CNT >= timer->sim.arr) {
+        timer->CNT = 0;
+        update_event(timer);
+        if ((timer->CR1 & TIM_CR1_OPM) != 0) {
+            timer->CR1 &= ~TIM_CR1_CEN;
+        }
+    } else {
+        timer->CNT++;
+    }
+    update_outputs(timer);
+}
+
+static void
+slave_trigger(TIM_TypeDef *timer)
+{
+    // combined reset + trigger mode, URS regular: the update event of the
+    // counter reset raises the interrupt too
+    timer->CNT = 0;
+    timer->sim.prescaler_count = 0;
+    update_event(timer);
+    timer->CR1 |= TIM_CR1_CEN;
+    update_outputs(timer);
+}
+
+void
+LL_TIM_GenerateEvent_UPDATE(TIM_TypeDef *timer)
+{
+    timer->sim.accesses++;
+    timer->CNT = 0;
+    timer->sim.prescaler_count = 0;
+    update_event(timer);
+    update_outputs(timer);
+
+    // TRGO on the update event, software generated or not
+    for (size_t i = 0; i < timer_count; ++i) {
+        if (timers[i]->sim.master == timer) {
+            slave_trigger(timers[i]);
+        }
+    }
+}
+
+static void
+call_pending_isrs(void)
+{
+    if (irq_locked || in_isr) {
+        return;
+    }
+
+    in_isr = true;
+    for (size_t i = 0; i < timer_count; ++i) {
+        TIM_TypeDef *timer = timers[i];
+        if ((timer->DIER & TIM_DIER_UIE) != 0 &&
+            (timer->SR & TIM_SR_UIF) != 0 && timer->sim.isr != NULL) {
+            timer->sim.isr();
+        }
+    }
+    in_isr = false;
+}
+
+/**
+ * Run at most `cycles` timer clock cycles, up to the next counter tick
+ * @return elapsed cycles
+ */
+static uint64_t
+step(uint64_t cycles)
+{
+    uint64_t elapsed = cycles;
+    for (size_t i = 0; i < timer_count; ++i) {
+        const TIM_TypeDef *timer = timers[i];
+        if ((timer->CR1 & TIM_CR1_CEN) != 0) {
+            const uint64_t remaining =
+                timer->sim.psc + 1 - timer->sim.prescaler_count;
+            if (remaining < elapsed) {
+                elapsed = remaining;
+            }
+        }
+    }
+
+    now += elapsed;
+    for (size_t i = 0; i < timer_count; ++i) {
+        TIM_TypeDef *timer = timers[i];
+        timer->sim.update = false;
+        if ((timer->CR1 & TIM_CR1_CEN) == 0) {
+            continue;
+        }
+        timer->sim.prescaler_count += elapsed;
+        if (timer->sim.prescaler_count > timer->sim.psc) {
+            timer->sim.prescaler_count = 0;
+            counter_tick(timer);
+        }
+    }
+
+    // masters are added first
+    for (size_t i = 0; i < timer_count; ++i) {
+        TIM_TypeDef *timer = timers[i];
+        if (timer->sim.master != NULL && timer->sim.master->sim.update) {
+            slave_trigger(timer);
+        }
+    }
+
+    call_pending_isrs();
+
+    return elapsed;
+}
+
+void
+tim_sim_run(uint64_t cycles)
+{
+    while (cycles != 0) {
+        cycles -= step(cycles);
+    }
+}
+
+bool
+tim_sim_run_until_counter(const TIM_TypeDef *timer, uint32_t counter,
+                          uint64_t max_cycles)
+{
+    while (timer->CNT != counter) {
+        if (max_cycles == 0) {
+            return false;
+        }
+        max_cycles -= step(max_cycles);
+    }
+
+    return true;
+}
+
+void
+tim_sim_counter_polled(TIM_TypeDef *timer)
+{
+    timer->sim.accesses++;
+    tim_sim_run(TIM_SIM_POLL_CYCLES);
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+/**
+ * Model of the STM32 timers driving the IR camera system, precise to the
+ * timer clock cycle:
+ * - counting up to the active auto-reload value, with prescaler
+ * - preloaded PSC, ARR (when ARPE is set) and CCRx, transferred at the update
+ *   event
+ * - one-pulse mode: the counter stops at the update event
+ * - slave mode "combined reset + trigger" on the update event (TRGO) of a
+ *   master timer, generated by software or not, which also generates an
+ *   update event on the slave
+ * - outputs of the enabled channels, whether the counter runs or not:
+ *   - PWM mode 1: active while the counter is lower than the compare value
+ *   - PWM mode 2: active while the counter is greater than or equal to the
+ *     compare value
+ *   - combined PWM mode 2: PWM mode 2, and the reference of the other
+ *     channel of the pair (1 and 2, 3 and 4)
+ *   - inactive in any other mode
+ * - update interrupt, raised after the timer clock cycle of the event unless
+ *   interrupts are locked
+ *
+ * Output edges are recorded with their time, and LL calls are counted per
+ * timer as a measure of the cost of the code accessing them.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stm32_ll_tim.h>
+
+#define TIM_SIM_CLOCK_MHZ 170
+#define TIM_SIM_MAX_TIMERS 4
+#define TIM_SIM_MAX_EDGES  512
+
+/// timer clock cycles elapsed between two reads of the counter, busy-waiting
+#define TIM_SIM_POLL_CYCLES 12
+
+struct tim_sim_edge {
+    const TIM_TypeDef *timer;
+    // 1 to 4
+    int channel;
+    bool level;
+    uint64_t cycle;
+};
+
+/**
+ * Forget all the timers and recorded edges, time back to 0
+ */
+void
+tim_sim_reset(void);
+
+/**
+ * Clear the registers of a timer and simulate it
+ *
+ * @param timer Timer
+ * @param name Name, for debugging
+ */
+void
+tim_sim_add(TIM_TypeDef *timer, const char *name);
+
+/**
+ * @param slave Timer started and reset by each update event of `master`,
+ *  added after `master`
+ * @param master Master timer
+ */
+void
+tim_sim_set_slave(TIM_TypeDef *slave, TIM_TypeDef *master);
+
+/**
+ * @param timer Timer
+ * @param isr Called when the update interrupt is enabled and pending
+ */
+void
+tim_sim_set_isr(TIM_TypeDef *timer, void (*isr)(void));
+
+/**
+ * Interrupts stay pending while locked
+ */
+void
+tim_sim_irq_lock(bool locked);
+
+/**
+ * Let the time run
+ *
+ * @param cycles Timer clock cycles
+ */
+void
+tim_sim_run(uint64_t cycles);
+
+/**
+ * Let the time run until the counter of `timer` reaches `counter`
+ *
+ * @retval false `max_cycles` elapsed before
+ */
+bool
+tim_sim_run_until_counter(const TIM_TypeDef *timer, uint32_t counter,
+                          uint64_t max_cycles);
+
+/**
+ * @return timer clock cycles since the reset
+ */
+uint64_t
+tim_sim_now(void);
+
+/**
+ * @param edges set to the output edges recorded since the last call to
+ *  `tim_sim_clear_edges`, in chronological order
+ * @return number of edges
+ */
+size_t
+tim_sim_edges(const struct tim_sim_edge **edges);
+
+void
+tim_sim_clear_edges(void);
+
+/**
+ * @return number of LL calls on `timer`, reset to 0
+ */
+uint32_t
+tim_sim_accesses(TIM_TypeDef *timer);
@@ -2,6 +2,7 @@
 #include "errors.h"
 #include "orb_logs.h"
 #include "orb_state.h"
+#include "system/cpu_usage.h"
 #include "system/version/version.h"
 #include "voltage_measurement/voltage_measurement.h"
 #include <app_assert.h>
@@ -169,6 +170,7 @@ adc_callback(const struct device *dev, const struct adc_sequence *sequence,
     ARG_UNUSED(dev);
     ARG_UNUSED(sequence);
     ARG_UNUSED(sampling_index);
+    const uint32_t isr_start = cpu_usage_isr_enter();
 
     if (liquid_lens_is_enabled()) {
         const uint16_t stm32_vref_mv = voltage_measurement_get_vref_mv_from_raw(
@@ -229,6 +231,7 @@ adc_callback(const struct device *dev, const struct adc_sequence *sequence,
         liquid_lens_set_pwm(pwm_output_per_mille);
     }
 
+    cpu_usage_isr_exit(CPU_USAGE_ISR_LIQUID_LENS_ADC, isr_start);
     return ADC_ACTION_REPEAT;
 }
 
@@ -33,10 +33,18 @@ mirror_auto_homing_overreach_end_thread(void *p1, void *p2, void *p3)
     int32_t timeout = AUTOHOMING_TIMEOUT_LOOP_COUNT;
     enum mirror_homing_state auto_homing_state = AH_UNINIT;
     while (auto_homing_state != AH_SUCCESS && timeout > 0) {
-        uint32_t status_phi = motor_controller_spi_read(
-            TMC5041_REGISTERS[REG_IDX_DRV_STATUS][MOTOR_PHI_ANGLE]);
-        uint32_t status_theta = motor_controller_spi_read(
-            TMC5041_REGISTERS[REG_IDX_DRV_STATUS][MOTOR_THETA_ANGLE]);
+        uint32_t status_phi = 0;
+        uint32_t status_theta = 0;
+        struct motor_spi_batch batch;
+        motor_spi_batch_clear(&batch);
+        (void)motor_spi_batch_read(
+            &batch, TMC5041_REGISTERS[REG_IDX_DRV_STATUS][MOTOR_PHI_ANGLE],
+            &status_phi);
+        (void)motor_spi_batch_read(
+            &batch, TMC5041_REGISTERS[REG_IDX_DRV_STATUS][MOTOR_THETA_ANGLE],
+            &status_theta);
+        ret_code_t err_code = motor_spi_batch_transfer(&batch);
+        ASSERT_SOFT(err_code);
         bool are_standstill = (status_phi & MOTOR_DRV_STATUS_STANDSTILL) &&
                               (status_theta & MOTOR_DRV_STATUS_STANDSTILL);
 
@@ -7,8 +7,8 @@
 
 #include <app_assert.h>
 #include <app_config.h>
-#include <math.h>
 #include <stdlib.h>
+#include <string.h>
 #include <utils.h>
 #include <zephyr/drivers/spi.h>
 #include <zephyr/kernel.h>
@@ -35,7 +35,7 @@ static struct async_mirror_command {
 #define TMC5041_REG_GCONF 0x00
 #define REG_INPUT         0x04
 
-const double motors_arm_length_mm[MOTORS_COUNT] = {
+const float motors_arm_length_mm[MOTORS_COUNT] = {
     [MOTOR_THETA_ANGLE] = MOTOR_THETA_ARM_LENGTH_MM,
     [MOTOR_PHI_ANGLE] = MOTOR_PHI_ARM_LENGTH_MM};
 
@@ -62,11 +62,36 @@ static motors_refs_t motors_refs[MOTORS_COUNT] = {
         .full_stroke_steps = MOTOR_PHI_FULL_RANGE_STEPS,
     }};
 
+#if defined(CONFIG_MIRROR_TRAJECTORY)
+static const struct mirror_trajectory_ramp trajectory_ramp = {
+    .a1 = MOTOR_FS_A1, .v1 = MOTOR_FS_V1, .vmax = MOTOR_FS_VMAX};
+
+// shared by the callers, the trajectory timer and the camera exposure ISR
+static struct k_spinlock trajectory_lock;
+static struct mirror_trajectory trajectory;
+static bool trajectory_is_running;
+static mirror_trajectory_timebase_t trajectory_timebase;
+static int64_t trajectory_start_ms;
+static uint32_t trajectory_frames;
+// 0 until the first frame: the first moves are done at full speed
+static uint32_t trajectory_frame_period_us;
+// XTARGET last written by the trajectory, where the next moves start from
+static int32_t trajectory_positions[MOTORS_COUNT];
+
+static void
+trajectory_timer_handler(struct k_timer *timer);
+
+static K_TIMER_DEFINE(trajectory_timer, trajectory_timer_handler, NULL);
+#endif
+
 static void
 mirror_set_stepper_position(int32_t position_steps, motor_t mirror)
 {
-    motor_controller_spi_write(TMC5041_REGISTERS[REG_IDX_XTARGET][mirror],
-                               position_steps);
+    // the targets of both motors are written together, without waiting for
+    // the bus
+    ret_code_t err_code = motor_controller_spi_write_async(
+        TMC5041_REGISTERS[REG_IDX_XTARGET][mirror], position_steps);
+    ASSERT_SOFT(err_code);
 }
 
 /**
@@ -87,6 +112,10 @@ mirror_set_angle_from_center(int32_t angle_from_center_millidegrees,
         return motors_refs[motor].motor_state;
     }
 
+    if (mirror_trajectory_running()) {
+        mirror_trajectory_stop();
+    }
+
     if (motor == MOTOR_PHI_ANGLE) {
         angle_from_center_millidegrees = -angle_from_center_millidegrees;
     }
@@ -328,6 +357,8 @@ mirror_get_theta_angle_millidegrees(void)
 ret_code_t
 mirror_autohoming(const motor_t *motor)
 {
+    mirror_trajectory_stop();
+
 #if defined(CONFIG_BOARD_PEARL_MAIN)
     if (motor == NULL || *motor >= MOTORS_COUNT) {
         return RET_ERROR_INVALID_PARAM;
@@ -360,12 +391,262 @@ mirror_go_home(void)
     return ret;
 }
 
+#if defined(CONFIG_MIRROR_TRAJECTORY)
+/**
+ * @return XTARGET of `angle_millidegrees`
+ */
+static int32_t
+stepper_position_from_angle(uint32_t angle_millidegrees, motor_t motor)
+{
+    int32_t angle_from_center_millidegrees =
+        (int32_t)angle_millidegrees - mirror_center_angles[motor];
+    if (motor == MOTOR_PHI_ANGLE) {
+        angle_from_center_millidegrees = -angle_from_center_millidegrees;
+    }
+
+    return motors_refs[motor].steps_at_center_position +
+           calculate_microsteps_from_center_position(
+               angle_from_center_millidegrees, motors_arm_length_mm[motor]);
+}
+
+static void
+trajectory_move_locked(const struct mirror_waypoint *waypoint,
+                       uint32_t duration_us)
+{
+    const uint32_t angles[MOTORS_COUNT] = {
+        [MOTOR_THETA_ANGLE] = waypoint->theta_millidegrees,
+        [MOTOR_PHI_ANGLE] = waypoint->phi_millidegrees};
+
+    for (motor_t motor = 0; motor < MOTORS_COUNT; ++motor) {
+        const int32_t position =
+            stepper_position_from_angle(angles[motor], motor);
+        const uint32_t vmax = mirror_trajectory_vmax(
+            (uint32_t)abs(position - trajectory_positions[motor]), duration_us,
+            &trajectory_ramp);
+
+        // velocity and target change together, in the same batch
+        ret_code_t err_code = motor_controller_spi_write_async(
+            TMC5041_REGISTERS[REG_IDX_VMAX][motor], (int32_t)vmax);
+        ASSERT_SOFT(err_code);
+        err_code = motor_controller_spi_write_async(
+            TMC5041_REGISTERS[REG_IDX_XTARGET][motor], position);
+        ASSERT_SOFT(err_code);
+
+        trajectory_positions[motor] = position;
+        motors_refs[motor].angle_millidegrees = angles[motor];
+    }
+}
+
+/**
+ * @param unit_us Set to the duration of a time unit of the trajectory, 0 if
+ *  unknown yet
+ * @return time since the start of the trajectory
+ */
+static uint32_t
+trajectory_now_locked(uint32_t *unit_us)
+{
+    if (trajectory_timebase == MIRROR_TRAJECTORY_TIMEBASE_FRAMES) {
+        *unit_us = trajectory_frame_period_us;
+        return trajectory_frames;
+    }
+
+    *unit_us = USEC_PER_MSEC;
+    return (uint32_t)(k_uptime_get() - trajectory_start_ms);
+}
+
+/**
+ * Start the move to the next waypoint if due, then wake up when the
+ * following one is
+ */
+static void
+trajectory_step_locked(void)
+{
+    uint32_t unit_us;
+    const uint32_t now = trajectory_now_locked(&unit_us);
+
+    struct mirror_waypoint target;
+    uint32_t remaining;
+    if (mirror_trajectory_next(&trajectory, now, &target, &remaining)) {
+        const uint32_t duration_us =
+            unit_us != 0 ? MIN(remaining, UINT32_MAX / unit_us) * unit_us : 0;
+        trajectory_move_locked(&target, duration_us);
+    }
+
+    uint32_t start;
+    if (trajectory_timebase == MIRROR_TRAJECTORY_TIMEBASE_MS &&
+        mirror_trajectory_next_start(&trajectory, &start)) {
+        k_timer_start(&trajectory_timer,
+                      K_TIMEOUT_ABS_MS(trajectory_start_ms + start), K_NO_WAIT);
+    }
+}
+
+static void
+trajectory_timer_handler(struct k_timer *timer)
+{
+    UNUSED_PARAMETER(timer);
+
+    k_spinlock_key_t key = k_spin_lock(&trajectory_lock);
+    if (trajectory_is_running &&
+        trajectory_timebase == MIRROR_TRAJECTORY_TIMEBASE_MS) {
+        trajectory_step_locked();
+    }
+    k_spin_unlock(&trajectory_lock, key);
+}
+
+void
+mirror_trajectory_on_frame(uint32_t frame_period_us)
+{
+    k_spinlock_key_t key = k_spin_lock(&trajectory_lock);
+    if (trajectory_is_running &&
+        trajectory_timebase == MIRROR_TRAJECTORY_TIMEBASE_FRAMES) {
+        trajectory_frame_period_us = frame_period_us;
+        trajectory_frames++;
+        trajectory_step_locked();
+    }
+    k_spin_unlock(&trajectory_lock, key);
+}
+
+ret_code_t
+mirror_trajectory_start(mirror_trajectory_timebase_t timebase)
+{
+    if (timebase != MIRROR_TRAJECTORY_TIMEBASE_MS &&
+        timebase != MIRROR_TRAJECTORY_TIMEBASE_FRAMES) {
+        return RET_ERROR_INVALID_PARAM;
+    }
+
+    if (mirror_auto_homing_in_progress() || !mirror_homed_successfully()) {
+        return RET_ERROR_INVALID_STATE;
+    }
+
+    // the first moves start from the current targets: the batch transfers
+    // the pending posted writes before reading them back, targets posted by
+    // a move or a previous trajectory aren't missed
+    uint32_t positions[MOTORS_COUNT];
+    struct motor_spi_batch batch;
+    motor_spi_batch_clear(&batch);
+    for (motor_t motor = 0; motor < MOTORS_COUNT; ++motor) {
+        (void)motor_spi_batch_read(
+            &batch, TMC5041_REGISTERS[REG_IDX_XTARGET][motor],
+            &positions[motor]);
+    }
+    ret_code_t err_code = motor_spi_batch_transfer(&batch);
+    if (err_code != RET_SUCCESS) {
+        ASSERT_SOFT(err_code);
+        return RET_ERROR_INTERNAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&trajectory_lock);
+    mirror_trajectory_reset(&trajectory);
+    memcpy(trajectory_positions, positions, sizeof(trajectory_positions));
+    trajectory_timebase = timebase;
+    trajectory_start_ms = k_uptime_get();
+    trajectory_frames = 0;
+    trajectory_frame_period_us = 0;
+    trajectory_is_running = true;
+    k_spin_unlock(&trajectory_lock, key);
+
+    LOG_INF("Mirror trajectory started (%s)",
+            timebase == MIRROR_TRAJECTORY_TIMEBASE_MS ? "ms" : "frames");
+
+    return RET_SUCCESS;
+}
+
+ret_code_t
+mirror_trajectory_add_waypoints(const struct mirror_waypoint *waypoints,
+                                size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (mirror_check_angle(waypoints[i].theta_millidegrees,
+                               MOTOR_THETA_ANGLE) != RET_SUCCESS ||
+            mirror_check_angle(waypoints[i].phi_millidegrees,
+                               MOTOR_PHI_ANGLE) != RET_SUCCESS) {
+            return RET_ERROR_INVALID_PARAM;
+        }
+    }
+
+    ret_code_t err_code = RET_ERROR_INVALID_STATE;
+    k_spinlock_key_t key = k_spin_lock(&trajectory_lock);
+    if (trajectory_is_running) {
+        err_code = mirror_trajectory_append(&trajectory, waypoints, count);
+        if (err_code == RET_SUCCESS) {
+            trajectory_step_locked();
+        }
+    }
+    k_spin_unlock(&trajectory_lock, key);
+
+    return err_code;
+}
+
+void
+mirror_trajectory_stop(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&trajectory_lock);
+    const bool was_running = trajectory_is_running;
+    trajectory_is_running = false;
+    mirror_trajectory_reset(&trajectory);
+    k_spin_unlock(&trajectory_lock, key);
+
+    k_timer_stop(&trajectory_timer);
+
+    if (was_running) {
+        // back to full speed for the other commands
+        for (motor_t motor = 0; motor < MOTORS_COUNT; ++motor) {
+            ret_code_t err_code = motor_controller_spi_write_async(
+                TMC5041_REGISTERS[REG_IDX_VMAX][motor], MOTOR_FS_VMAX);
+            ASSERT_SOFT(err_code);
+        }
+        LOG_INF("Mirror trajectory stopped");
+    }
+}
+
+bool
+mirror_trajectory_running(void)
+{
+    return trajectory_is_running;
+}
+#else
+ret_code_t
+mirror_trajectory_start(mirror_trajectory_timebase_t timebase)
+{
+    UNUSED_PARAMETER(timebase);
+
+    return RET_ERROR_NOT_SUPPORTED;
+}
+
+ret_code_t
+mirror_trajectory_add_waypoints(const struct mirror_waypoint *waypoints,
+                                size_t count)
+{
+    UNUSED_PARAMETER(waypoints);
+    UNUSED_PARAMETER(count);
+
+    return RET_ERROR_INVALID_STATE;
+}
+
+void
+mirror_trajectory_stop(void)
+{
+}
+
+bool
+mirror_trajectory_running(void)
+{
+    return false;
+}
+
+void
+mirror_trajectory_on_frame(uint32_t frame_period_us)
+{
+    UNUSED_PARAMETER(frame_period_us);
+}
+#endif
+
 ret_code_t
 mirror_init(void)
 {
     uint32_t read_value;
 
-    if (!motor_spi_ready()) {
+    if (motor_controller_spi_init() != RET_SUCCESS) {
         LOG_ERR("motion controller SPI device not ready");
         return RET_ERROR_INVALID_STATE;
     } else {
@@ -4,6 +4,7 @@
 #include <zephyr/kernel.h>
 
 #include "mirror_private.h"
+#include "mirror_trajectory.h"
 
 /**
  * Set phi angle
@@ -110,6 +111,58 @@ mirror_get_phi_angle_millidegrees(void);
 bool
 mirror_homed_successfully(void);
 
+/**
+ * Start executing a trajectory, see mirror_trajectory.h
+ *
+ * Waypoints are then added with `mirror_trajectory_add_waypoints`, their
+ * times counted from now, in ms or in IR camera exposures ended since. Any
+ * other mirror command stops the trajectory.
+ *
+ * @param timebase Unit of the waypoint times
+ * @retval RET_SUCCESS started, previous trajectory dropped
+ * @retval RET_ERROR_INVALID_STATE mirror not homed
+ * @retval RET_ERROR_INTERNAL current targets couldn't be read
+ * @retval RET_ERROR_NOT_SUPPORTED CONFIG_MIRROR_TRAJECTORY disabled
+ */
+ret_code_t
+mirror_trajectory_start(mirror_trajectory_timebase_t timebase);
+
+/**
+ * Append waypoints to the running trajectory, all or none
+ *
+ * @param waypoints Waypoints with increasing times
+ * @param count Number of waypoints
+ * @retval RET_SUCCESS appended
+ * @retval RET_ERROR_INVALID_PARAM angle out of range or times not increasing
+ * @retval RET_ERROR_NO_MEM not enough room left
+ * @retval RET_ERROR_INVALID_STATE no trajectory running
+ */
+ret_code_t
+mirror_trajectory_add_waypoints(const struct mirror_waypoint *waypoints,
+                                size_t count);
+
+/**
+ * Stop the trajectory, the mirror goes on to the waypoint it is moving to at
+ * full speed
+ */
+void
+mirror_trajectory_stop(void);
+
+/**
+ * @retval true a trajectory is running, even without waypoints left
+ */
+bool
+mirror_trajectory_running(void);
+
+/**
+ * Move to the next waypoints of a trajectory counted in frames, called at the
+ * end of each IR camera exposure
+ *
+ * @param frame_period_us Duration of a frame
+ */
+void
+mirror_trajectory_on_frame(uint32_t frame_period_us);
+
 /**
  * Initialize mirror controlling system
  *
@@ -0,0 +1,37 @@
+#include "mirror_angle.h"
+#include <math.h>
+
+// 1mm / 0.4mm (pitch) * (360° / 18° (per step)) * 256 micro-steps
+#define MICROSTEPS_PER_MM 12800.0f
+
+#define MILLIDEGREES_PER_RADIAN (180000.0f / (float)M_PI)
+
+int32_t
+calculate_millidegrees_from_center_position(
+    int32_t microsteps_from_center_position, const float motors_arm_length_mm)
+{
+    const float stepper_position_from_center_millimeters =
+        (float)microsteps_from_center_position / MICROSTEPS_PER_MM;
+    float ratio =
+        stepper_position_from_center_millimeters / motors_arm_length_mm;
+    // out of the asin domain
+    if (ratio > 1.0f) {
+        ratio = 1.0f;
+    } else if (ratio < -1.0f) {
+        ratio = -1.0f;
+    }
+
+    return (int32_t)(asinf(ratio) * MILLIDEGREES_PER_RADIAN);
+}
+
+int32_t
+calculate_microsteps_from_center_position(
+    int32_t angle_from_center_millidegrees, const float motors_arm_length_mm)
+{
+    const float stepper_position_from_center_millimeters =
+        sinf((float)angle_from_center_millidegrees / MILLIDEGREES_PER_RADIAN) *
+        motors_arm_length_mm;
+
+    return (int32_t)lroundf(stepper_position_from_center_millimeters *
+                            MICROSTEPS_PER_MM);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Conversions between the mirror angle and the position of the stepper
+ * driving it, in single precision: the FPU of the Cortex-M4F only handles
+ * floats, doubles are emulated in software.
+ *
+ * The stepper pushes an arm of length `motors_arm_length_mm` pivoting around
+ * the mirror axis: position_mm = arm_length_mm * sin(angle).
+ *
+ * Compared to the double precision computation, the results are off by at
+ * most MIRROR_ANGLE_MAX_ERROR_MICROSTEPS and
+ * MIRROR_ANGLE_MAX_ERROR_MILLIDEGREES, when the rounding of the result falls
+ * on the other side, see the unit tests.
+ */
+
+#define MIRROR_ANGLE_MAX_ERROR_MICROSTEPS   1
+#define MIRROR_ANGLE_MAX_ERROR_MILLIDEGREES 1
+
+/**
+ * @param microsteps_from_center_position Stepper position from the center
+ * @param motors_arm_length_mm Length of the arm, positions further than that
+ *  from the center are clamped
+ * @return angle from the center, rounded towards 0
+ */
+int32_t
+calculate_millidegrees_from_center_position(
+    int32_t microsteps_from_center_position, const float motors_arm_length_mm);
+
+/**
+ * @param angle_from_center_millidegrees Angle from the center
+ * @param motors_arm_length_mm Length of the arm
+ * @return stepper position from the center, rounded to the nearest microstep
+ */
+int32_t
+calculate_microsteps_from_center_position(
+    int32_t angle_from_center_millidegrees, const float motors_arm_length_mm);
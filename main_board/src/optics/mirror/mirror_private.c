@@ -3,9 +3,11 @@
 #include "errors.h"
 
 #include <app_assert.h>
-#include <math.h>
+#include <app_config.h>
+#include <string.h>
 #include <utils.h>
 #include <zephyr/drivers/spi.h>
+#include <zephyr/kernel.h>
 #include <zephyr/sys/byteorder.h>
 
 #if defined(CONFIG_BOARD_PEARL_MAIN)
@@ -64,9 +66,6 @@ const int32_t mirror_center_angles[MOTORS_COUNT] = {
     [MOTOR_THETA_ANGLE] = MIRROR_ANGLE_THETA_CENTER_MILLIDEGREES,
     [MOTOR_PHI_ANGLE] = MIRROR_ANGLE_PHI_CENTER_MILLIDEGREES};
 
-const double microsteps_per_mm = 12800.0; // 1mm / 0.4mm (pitch) * (360° / 18°
-// (per step)) * 256 micro-steps
-
 // SPI w/ TMC5041
 #define SPI_DEVICE          DT_NODELABEL(motion_controller)
 #define SPI_CONTROLLER_NODE DT_PARENT(SPI_DEVICE)
@@ -74,77 +73,242 @@ const double microsteps_per_mm = 12800.0; // 1mm / 0.4mm (pitch) * (360° / 18°
 #define READ  0
 #define WRITE (1 << 7)
 
-static const struct spi_dt_spec spi_bus_dt = SPI_DT_SPEC_GET(
-    SPI_DEVICE,
-    SPI_WORD_SET(8) | SPI_OP_MODE_MASTER | SPI_MODE_CPOL | SPI_MODE_CPHA, 2);
+// the bus is held during a batch, see spi_release_dt
+static const struct spi_dt_spec spi_bus_dt =
+    SPI_DT_SPEC_GET(SPI_DEVICE,
+                    SPI_WORD_SET(8) | SPI_OP_MODE_MASTER | SPI_MODE_CPOL |
+                        SPI_MODE_CPHA | SPI_LOCK_ON,
+                    2);
+
+// one batch at a time on the bus
+static K_MUTEX_DEFINE(batch_mutex);
+
+K_THREAD_STACK_DEFINE(stack_area_motor_spi_work_queue,
+                      THREAD_STACK_SIZE_MOTOR_SPI);
+static struct k_work_q motor_spi_work_queue;
+static bool motor_spi_work_queue_started = false;
+
+// posted writes, see motor_controller_spi_write_async
+#define POSTED_WRITES_MAX 4
+
+static struct {
+    uint8_t reg;
+    int32_t value;
+} posted_writes[POSTED_WRITES_MAX];
+static size_t posted_writes_count;
+static struct k_spinlock posted_writes_lock;
+
+void
+motor_spi_batch_clear(struct motor_spi_batch *batch)
+{
+    batch->count = 0;
+    batch->overflow = false;
+}
+
+static ret_code_t
+batch_add(struct motor_spi_batch *batch, uint8_t reg, int32_t value,
+          uint32_t *read_value)
+{
+    // a read needs a following datagram to get its value
+    const size_t needed = (read_value != NULL) ? 2 : 1;
+    if (batch->count + needed > MOTOR_SPI_BATCH_MAX_DATAGRAMS) {
+        batch->overflow = true;
+        return RET_ERROR_NO_MEM;
+    }
+
+    uint8_t *tx = batch->tx[batch->count];
+    tx[0] = reg;
+    sys_put_be32((uint32_t)value, &tx[1]);
+    batch->reads[batch->count] = read_value;
+    batch->count++;
+
+    return RET_SUCCESS;
+}
+
+ret_code_t
+motor_spi_batch_write(struct motor_spi_batch *batch, uint8_t reg,
+                      int32_t value)
+{
+    // make sure there is the write flag
+    return batch_add(batch, reg | WRITE, value, NULL);
+}
+
+ret_code_t
+motor_spi_batch_read(struct motor_spi_batch *batch, uint8_t reg,
+                     uint32_t *value)
+{
+    if (value == NULL) {
+        return RET_ERROR_INVALID_PARAM;
+    }
+
+    // make sure there is the read flag (msb is 0)
+    return batch_add(batch, reg & ~WRITE, 0, value);
+}
+
+// transferred before any other batch, guarded by batch_mutex
+static struct motor_spi_batch posted_batch;
+
+// called with batch_mutex held
+static ret_code_t
+batch_transceive(struct motor_spi_batch *batch)
+{
+    if (batch->count == 0) {
+        return RET_SUCCESS;
+    }
+
+    // the value of a trailing read comes with the next datagram: repeat the
+    // read request, room reserved by batch_add
+    if (batch->reads[batch->count - 1] != NULL) {
+        memcpy(batch->tx[batch->count], batch->tx[batch->count - 1],
+               TMC5041_DATAGRAM_SIZE);
+        batch->reads[batch->count] = NULL;
+        batch->count++;
+    }
+
+    for (size_t i = 0; i < batch->count; ++i) {
+        // chip select released after each datagram
+        const struct spi_buf tx = {.buf = batch->tx[i],
+                                   .len = TMC5041_DATAGRAM_SIZE};
+        const struct spi_buf rx = {.buf = batch->rx[i],
+                                   .len = TMC5041_DATAGRAM_SIZE};
+        const struct spi_buf_set tx_bufs = {.buffers = &tx, .count = 1};
+        const struct spi_buf_set rx_bufs = {.buffers = &rx, .count = 1};
+
+        int ret = spi_transceive_dt(&spi_bus_dt, &tx_bufs, &rx_bufs);
+        if (ret != 0) {
+            ASSERT_SOFT(ret);
+            return RET_ERROR_INTERNAL;
+        }
+
+        // reply: status byte, then the value requested by the previous
+        // datagram
+        if (i > 0 && batch->reads[i - 1] != NULL) {
+            *batch->reads[i - 1] = sys_get_be32(&batch->rx[i][1]);
+        }
+    }
+
+    return RET_SUCCESS;
+}
+
+/**
+ * Transfer the pending posted writes, called with batch_mutex held so that
+ * a batch never reads a register with a posted write pending, nor has its
+ * writes overwritten by older posted values
+ */
+static ret_code_t
+posted_writes_flush(void)
+{
+    motor_spi_batch_clear(&posted_batch);
 
-static struct spi_buf rx;
-static struct spi_buf_set rx_bufs = {.buffers = &rx, .count = 1};
+    // writes posted from now on submit the work item again
+    k_spinlock_key_t key = k_spin_lock(&posted_writes_lock);
+    for (size_t i = 0; i < posted_writes_count; ++i) {
+        (void)motor_spi_batch_write(&posted_batch, posted_writes[i].reg,
+                                    posted_writes[i].value);
+    }
+    posted_writes_count = 0;
+    k_spin_unlock(&posted_writes_lock, key);
 
-static struct spi_buf tx;
-static struct spi_buf_set tx_bufs = {.buffers = &tx, .count = 1};
+    return batch_transceive(&posted_batch);
+}
 
-int32_t
-calculate_millidegrees_from_center_position(
-    int32_t microsteps_from_center_position, const double motors_arm_length_mm)
+ret_code_t
+motor_spi_batch_transfer(struct motor_spi_batch *batch)
 {
-    double stepper_position_from_center_millimeters =
-        (double)microsteps_from_center_position / microsteps_per_mm;
-    int32_t angle_from_center_millidegrees =
-        asin(stepper_position_from_center_millimeters / motors_arm_length_mm) *
-        180000.0 / M_PI;
-    return angle_from_center_millidegrees;
+    if (batch->overflow) {
+        return RET_ERROR_NO_MEM;
+    }
+
+    k_mutex_lock(&batch_mutex, K_FOREVER);
+
+    ret_code_t err_code = posted_writes_flush();
+    if (err_code == RET_SUCCESS) {
+        err_code = batch_transceive(batch);
+    }
+
+    spi_release_dt(&spi_bus_dt);
+    k_mutex_unlock(&batch_mutex);
+
+    return err_code;
 }
 
-int32_t
-calculate_microsteps_from_center_position(
-    int32_t angle_from_center_millidegrees, const double motors_arm_length_mm)
+static void
+posted_writes_work_handler(struct k_work *work)
 {
-    double stepper_position_from_center_millimeters =
-        sin((double)angle_from_center_millidegrees * M_PI / 180000.0) *
-        motors_arm_length_mm;
-    int32_t stepper_position_from_center_microsteps = (int32_t)roundl(
-        stepper_position_from_center_millimeters * microsteps_per_mm);
-    return stepper_position_from_center_microsteps;
+    UNUSED_PARAMETER(work);
+
+    // an empty batch: only the posted writes are transferred
+    struct motor_spi_batch batch;
+    motor_spi_batch_clear(&batch);
+
+    ret_code_t err_code = motor_spi_batch_transfer(&batch);
+    ASSERT_SOFT(err_code);
+}
+
+static K_WORK_DEFINE(posted_writes_work, posted_writes_work_handler);
+
+ret_code_t
+motor_controller_spi_write_async(uint8_t reg, int32_t value)
+{
+    if (!motor_spi_work_queue_started) {
+        return RET_ERROR_NOT_INITIALIZED;
+    }
+
+    ret_code_t err_code = RET_SUCCESS;
+
+    k_spinlock_key_t key = k_spin_lock(&posted_writes_lock);
+    size_t i = 0;
+    while (i < posted_writes_count && posted_writes[i].reg != reg) {
+        ++i;
+    }
+    if (i < posted_writes_count) {
+        posted_writes[i].value = value;
+    } else if (posted_writes_count < POSTED_WRITES_MAX) {
+        posted_writes[posted_writes_count].reg = reg;
+        posted_writes[posted_writes_count].value = value;
+        posted_writes_count++;
+    } else {
+        err_code = RET_ERROR_NO_MEM;
+    }
+    k_spin_unlock(&posted_writes_lock, key);
+
+    // no-op if already queued, queued again if running
+    k_work_submit_to_queue(&motor_spi_work_queue, &posted_writes_work);
+
+    return err_code;
 }
 
 void
 motor_controller_spi_send_commands(const uint64_t *cmds, size_t num_cmds)
 {
-    uint64_t cmd;
-    uint8_t tx_buffer[5];
-    tx.buf = tx_buffer;
-    tx.len = sizeof tx_buffer;
-
-    for (size_t i = 0; i < num_cmds; ++i) {
-        cmd = sys_cpu_to_be64(cmds[i] << 24);
-        memcpy(tx_buffer, &cmd, 5);
-        spi_write_dt(&spi_bus_dt, &tx_bufs);
+    struct motor_spi_batch batch;
+
+    while (num_cmds != 0) {
+        motor_spi_batch_clear(&batch);
+        while (num_cmds != 0 &&
+               motor_spi_batch_write(&batch, (uint8_t)(*cmds >> 32),
+                                     (int32_t)(uint32_t)*cmds) ==
+                   RET_SUCCESS) {
+            cmds++;
+            num_cmds--;
+        }
+        // the last write didn't fit and is sent with the next batch
+        batch.overflow = false;
+
+        ret_code_t err_code = motor_spi_batch_transfer(&batch);
+        ASSERT_SOFT(err_code);
     }
 }
 
 int
 motor_controller_spi_write(uint8_t reg, int32_t value)
 {
-    uint8_t tx_buffer[5] = {0};
-    uint8_t rx_buffer[5] = {0};
-
-    // make sure there is the write flag
-    reg |= WRITE;
-    tx_buffer[0] = reg;
+    struct motor_spi_batch batch;
 
-    tx_buffer[1] = (value >> 24) & 0xFF;
-    tx_buffer[2] = (value >> 16) & 0xFF;
-    tx_buffer[3] = (value >> 8) & 0xFF;
-    tx_buffer[4] = (value >> 0) & 0xFF;
-
-    rx.buf = rx_buffer;
-    rx.len = sizeof rx_buffer;
-    tx.buf = tx_buffer;
-    tx.len = sizeof tx_buffer;
-
-    int ret = spi_transceive_dt(&spi_bus_dt, &tx_bufs, &rx_bufs);
-    ASSERT_SOFT(ret);
+    motor_spi_batch_clear(&batch);
+    (void)motor_spi_batch_write(&batch, reg, value);
+    ret_code_t err_code = motor_spi_batch_transfer(&batch);
+    ASSERT_SOFT(err_code);
 
     return RET_SUCCESS;
 }
@@ -152,42 +316,40 @@ motor_controller_spi_write(uint8_t reg, int32_t value)
 uint32_t
 motor_controller_spi_read(uint8_t reg)
 {
-    uint8_t tx_buffer[5] = {0};
-    uint8_t rx_buffer[5] = {0};
-    int ret;
-
-    // make sure there is the read flag (msb is 0)
-    reg &= ~WRITE;
-    tx_buffer[0] = reg;
-
-    rx.buf = rx_buffer;
-    rx.len = sizeof rx_buffer;
-    tx.buf = tx_buffer;
-    tx.len = sizeof tx_buffer;
+    struct motor_spi_batch batch;
+    uint32_t read_value = 0;
 
     // reading happens in two SPI operations:
     //  - first, send the register address, returned data is
     //    the one from previous read operation.
     //  - second, read the actual data
-
-    // first, send reg address
-    ret = spi_transceive_dt(&spi_bus_dt, &tx_bufs, &rx_bufs);
-    ASSERT_SOFT(ret);
-
-    memset(rx_buffer, 0, sizeof(rx_buffer));
-
-    // second, read data
-    ret = spi_transceive_dt(&spi_bus_dt, &tx_bufs, &rx_bufs);
-    ASSERT_SOFT(ret);
-
-    const uint32_t read_value = (rx_buffer[1] << 24 | rx_buffer[2] << 16 |
-                                 rx_buffer[3] << 8 | rx_buffer[4] << 0);
+    motor_spi_batch_clear(&batch);
+    (void)motor_spi_batch_read(&batch, reg, &read_value);
+    ret_code_t err_code = motor_spi_batch_transfer(&batch);
+    ASSERT_SOFT(err_code);
 
     return read_value;
 }
 
-bool
-motor_spi_ready()
+ret_code_t
+motor_controller_spi_init(void)
 {
-    return device_is_ready(spi_bus_dt.bus);
+    if (!device_is_ready(spi_bus_dt.bus)) {
+        return RET_ERROR_INVALID_STATE;
+    }
+
+    if (!motor_spi_work_queue_started) {
+        k_work_queue_init(&motor_spi_work_queue);
+        const struct k_work_queue_config config = {
+            .name = "motor_spi_work_queue",
+            .no_yield = false,
+            .essential = false};
+        k_work_queue_start(
+            &motor_spi_work_queue, stack_area_motor_spi_work_queue,
+            K_THREAD_STACK_SIZEOF(stack_area_motor_spi_work_queue),
+            THREAD_PRIORITY_MOTOR_SPI, &config);
+        motor_spi_work_queue_started = true;
+    }
+
+    return RET_SUCCESS;
 }
@@ -1,4 +1,6 @@
 #pragma once
+#include "mirror_angle.h"
+#include <errors.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -20,8 +22,8 @@
     (MIRROR_ANGLE_PHI_MAX_MILLIDEGREES - MIRROR_ANGLE_PHI_MIN_MILLIDEGREES)
 
 #if defined(CONFIG_BOARD_PEARL_MAIN)
-#define MOTOR_THETA_ARM_LENGTH_MM 12.0
-#define MOTOR_PHI_ARM_LENGTH_MM   18.71
+#define MOTOR_THETA_ARM_LENGTH_MM 12.0f
+#define MOTOR_PHI_ARM_LENGTH_MM   18.71f
 
 // EV2 and later
 #define MOTOR_THETA_CENTER_FROM_END_STEPS 55000
@@ -32,8 +34,8 @@
 #define MIRROR_ANGLE_THETA_MIN_MILLIDEGREES (90000 - 17500)
 #define MIRROR_ANGLE_THETA_MAX_MILLIDEGREES (90000 + 17500)
 #elif defined(CONFIG_BOARD_DIAMOND_MAIN)
-#define MOTOR_THETA_ARM_LENGTH_MM         18.0
-#define MOTOR_PHI_ARM_LENGTH_MM           16.0
+#define MOTOR_THETA_ARM_LENGTH_MM         18.0f
+#define MOTOR_PHI_ARM_LENGTH_MM           16.0f
 
 /*
  * Motor stroke definitions
@@ -105,6 +107,8 @@ typedef enum { MOTOR_PHI_ANGLE = 0, MOTOR_THETA_ANGLE, MOTORS_COUNT } motor_t;
 #define MOTOR_INIT_VMAX             100000
 #define MOTOR_INIT_AMAX             (MOTOR_INIT_VMAX / 20)
 #define MOTOR_FS_VMAX               800000
+#define MOTOR_FS_A1                 0x8000 // see position_mode_full_speed
+#define MOTOR_FS_V1                 (MOTOR_FS_VMAX * 3 / 4)
 #define IHOLDDELAY                  (1 << 16)
 #define MOTOR_DRV_STATUS_STALLGUARD (1 << 24)
 #define MOTOR_DRV_STATUS_STANDSTILL (1 << 31)
@@ -140,13 +144,88 @@ extern const uint8_t TMC5041_REGISTERS[REG_IDX_COUNT][MOTORS_COUNT];
 extern const uint64_t position_mode_full_speed[MOTORS_COUNT][10];
 extern const int32_t mirror_center_angles[MOTORS_COUNT];
 
-int32_t
-calculate_millidegrees_from_center_position(
-    int32_t microsteps_from_center_position, const double motors_arm_length_mm);
+/// TMC5041 SPI datagram: address byte then 32-bit data, MSB first
+#define TMC5041_DATAGRAM_SIZE 5
 
-int32_t
-calculate_microsteps_from_center_position(
-    int32_t angle_from_center_millidegrees, const double motors_arm_length_mm);
+/// datagrams of a batch, including the one flushing a trailing read
+#define MOTOR_SPI_BATCH_MAX_DATAGRAMS 12
+
+/**
+ * Command list for the TMC5041: writes and reads of both motors, transferred
+ * back-to-back while holding the SPI bus.
+ *
+ * The TMC5041 latches one datagram per chip select cycle and returns the
+ * value of a read request with the reply to the next datagram: read values
+ * are taken from the replies of the following datagrams, and a trailing read
+ * is flushed by repeating it. Reading N registers thus takes N + 1 datagrams
+ * instead of 2 * N.
+ */
+struct motor_spi_batch {
+    uint8_t tx[MOTOR_SPI_BATCH_MAX_DATAGRAMS][TMC5041_DATAGRAM_SIZE];
+    uint8_t rx[MOTOR_SPI_BATCH_MAX_DATAGRAMS][TMC5041_DATAGRAM_SIZE];
+    /// destination of the value requested by each datagram, NULL for writes
+    uint32_t *reads[MOTOR_SPI_BATCH_MAX_DATAGRAMS];
+    size_t count;
+    /// a command didn't fit, the batch is rejected
+    bool overflow;
+};
+
+/**
+ * Empty a batch
+ */
+void
+motor_spi_batch_clear(struct motor_spi_batch *batch);
+
+/**
+ * Queue a register write
+ *
+ * @retval RET_SUCCESS queued
+ * @retval RET_ERROR_NO_MEM batch full, the transfer will be rejected
+ */
+ret_code_t
+motor_spi_batch_write(struct motor_spi_batch *batch, uint8_t reg,
+                      int32_t value);
+
+/**
+ * Queue a register read
+ *
+ * @param value Set when the batch has been transferred, must stay valid until
+ *  then
+ * @retval RET_SUCCESS queued
+ * @retval RET_ERROR_NO_MEM batch full, the transfer will be rejected
+ */
+ret_code_t
+motor_spi_batch_read(struct motor_spi_batch *batch, uint8_t reg,
+                     uint32_t *value);
+
+/**
+ * Transfer a batch from the calling thread
+ *
+ * Pending posted writes are transferred first, see
+ * motor_controller_spi_write_async: the batch reads the posted values and its
+ * writes aren't overwritten by them.
+ *
+ * @retval RET_SUCCESS transferred, read values resolved
+ * @retval RET_ERROR_NO_MEM batch overflow, nothing transferred
+ * @retval RET_ERROR_INTERNAL SPI error, the batch is incomplete
+ */
+ret_code_t
+motor_spi_batch_transfer(struct motor_spi_batch *batch);
+
+/**
+ * Post a register write, transferred from the motor SPI work queue: the
+ * caller, possibly an ISR, doesn't wait for the bus.
+ *
+ * Only the last value posted to a register before the transfer is written,
+ * and posted writes to both motors are transferred in the same batch: meant
+ * for targets, such as XTARGET, updated faster than the bus can keep up with.
+ *
+ * @retval RET_SUCCESS posted
+ * @retval RET_ERROR_NO_MEM too many registers posted
+ * @retval RET_ERROR_NOT_INITIALIZED motor_controller_spi_init not called
+ */
+ret_code_t
+motor_controller_spi_write_async(uint8_t reg, int32_t value);
 
 void
 motor_controller_spi_send_commands(const uint64_t *cmds, size_t num_cmds);
@@ -157,5 +236,11 @@ motor_controller_spi_write(uint8_t reg, int32_t value);
 uint32_t
 motor_controller_spi_read(uint8_t reg);
 
-bool
-motor_spi_ready();
+/**
+ * Check the SPI bus and start the motor SPI work queue
+ *
+ * @retval RET_SUCCESS ready
+ * @retval RET_ERROR_INVALID_STATE SPI bus not ready
+ */
+ret_code_t
+motor_controller_spi_init(void);
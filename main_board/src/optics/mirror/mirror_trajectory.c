@@ -0,0 +1,165 @@
+#include "mirror_trajectory.h"
+#include <string.h>
+
+#define CLOCK_HZ MIRROR_TRAJECTORY_TMC5041_CLOCK_HZ
+
+// longer moves are planned as if they lasted that long: the velocity is
+// already much below the ramp accelerations
+#define MAX_DURATION_US 60000000ULL
+
+void
+mirror_trajectory_reset(struct mirror_trajectory *trajectory)
+{
+    memset(trajectory, 0, sizeof(*trajectory));
+}
+
+ret_code_t
+mirror_trajectory_append(struct mirror_trajectory *trajectory,
+                         const struct mirror_waypoint *waypoints, size_t count)
+{
+    if (count > MIRROR_TRAJECTORY_MAX_WAYPOINTS - trajectory->count) {
+        return RET_ERROR_NO_MEM;
+    }
+
+    bool previous = trajectory->appended;
+    uint32_t previous_at = trajectory->tail_at;
+    for (size_t i = 0; i < count; ++i) {
+        if (previous && waypoints[i].at <= previous_at) {
+            return RET_ERROR_INVALID_PARAM;
+        }
+        previous = true;
+        previous_at = waypoints[i].at;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const size_t index = (trajectory->head + trajectory->count) %
+                             MIRROR_TRAJECTORY_MAX_WAYPOINTS;
+        trajectory->waypoints[index] = waypoints[i];
+        trajectory->count++;
+    }
+    if (count != 0) {
+        trajectory->appended = true;
+        trajectory->tail_at = previous_at;
+    }
+
+    return RET_SUCCESS;
+}
+
+size_t
+mirror_trajectory_pending(const struct mirror_trajectory *trajectory)
+{
+    return trajectory->count;
+}
+
+bool
+mirror_trajectory_next_start(const struct mirror_trajectory *trajectory,
+                             uint32_t *start)
+{
+    if (trajectory->count == 0) {
+        return false;
+    }
+
+    *start = trajectory->last_at;
+    return true;
+}
+
+static void
+pop(struct mirror_trajectory *trajectory)
+{
+    trajectory->last_at = trajectory->waypoints[trajectory->head].at;
+    trajectory->head = (trajectory->head + 1) % MIRROR_TRAJECTORY_MAX_WAYPOINTS;
+    trajectory->count--;
+}
+
+bool
+mirror_trajectory_next(struct mirror_trajectory *trajectory, uint32_t now,
+                       struct mirror_waypoint *target, uint32_t *remaining)
+{
+    if (trajectory->count == 0 || trajectory->last_at > now) {
+        return false;
+    }
+
+    // the move to the next waypoint should have started already: skip
+    while (trajectory->count > 1 &&
+           trajectory->waypoints[trajectory->head].at <= now) {
+        pop(trajectory);
+    }
+
+    *target = trajectory->waypoints[trajectory->head];
+    *remaining = target->at > now ? target->at - now : 0;
+    pop(trajectory);
+
+    return true;
+}
+
+/// integer square root, rounded down
+static uint64_t
+isqrt(uint64_t n)
+{
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > n) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (n >= root + bit) {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return root;
+}
+
+uint32_t
+mirror_trajectory_vmax(uint32_t distance_microsteps, uint32_t duration_us,
+                       const struct mirror_trajectory_ramp *ramp)
+{
+    if (distance_microsteps == 0) {
+        // nothing to move, keep a valid velocity
+        return 1;
+    }
+    if (duration_us == 0) {
+        return ramp->vmax;
+    }
+
+    // a[µsteps/s²] = a1 * fCLK² / 2^41
+    const uint64_t acceleration =
+        ((((uint64_t)ramp->a1 * CLOCK_HZ) >> 20) * CLOCK_HZ) >> 21;
+    if (acceleration == 0) {
+        return ramp->vmax;
+    }
+
+    // trapezoid from and to standstill at `acceleration`:
+    // d = v * (T - v / a), the slowest solution being
+    // v = 2 * d / (T + sqrt(T² - 4 * d / a))
+    const uint64_t duration = duration_us < MAX_DURATION_US ? duration_us
+                                                            : MAX_DURATION_US;
+    const uint64_t squared_duration = duration * duration;
+    // 4 * d / a, in µs²
+    const uint64_t min_squared_duration =
+        (4 * (uint64_t)distance_microsteps * 1000000ULL + acceleration - 1) /
+        acceleration * 1000000ULL;
+    if (min_squared_duration > squared_duration) {
+        return ramp->vmax;
+    }
+
+    const uint64_t divisor =
+        duration + isqrt(squared_duration - min_squared_duration);
+    // µsteps/s, in 40.24 fixed point: VMAX = velocity * 2^24 / fCLK
+    const uint64_t dividend = 2 * (uint64_t)distance_microsteps * 1000000ULL;
+    const uint64_t velocity =
+        ((dividend / divisor) << 24) +
+        (((dividend % divisor) << 24) + divisor - 1) / divisor;
+    const uint64_t vmax = (velocity + CLOCK_HZ - 1) / CLOCK_HZ;
+
+    if (vmax > ramp->v1) {
+        return ramp->vmax;
+    }
+
+    return (uint32_t)vmax;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <errors.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Timed mirror waypoints, executed by the MCU.
+ *
+ * Each waypoint gives both mirror angles and the time at which the mirror
+ * must reach them, in ms or in IR camera frames since the start of the
+ * trajectory. The move towards a waypoint starts when the previous one is
+ * due, or right away for the first one, and the velocity of the TMC5041
+ * ramps is lowered so that it ends on time instead of as fast as possible:
+ * consecutive moves blend into a smooth trajectory.
+ *
+ * Waypoints can be appended while the trajectory runs. Waypoints already due
+ * when their move would start are skipped, except the last one, reached at
+ * full speed.
+ */
+
+#if defined(CONFIG_MIRROR_TRAJECTORY_WAYPOINTS)
+#define MIRROR_TRAJECTORY_MAX_WAYPOINTS CONFIG_MIRROR_TRAJECTORY_WAYPOINTS
+#else
+#define MIRROR_TRAJECTORY_MAX_WAYPOINTS 32
+#endif
+
+/// typical frequency of the TMC5041 internal oscillator, clocking the ramp
+/// generator; the actual one varies by a few %, so do move durations
+#define MIRROR_TRAJECTORY_TMC5041_CLOCK_HZ 13200000ULL
+
+typedef enum {
+    /// waypoint times in ms since the start
+    MIRROR_TRAJECTORY_TIMEBASE_MS,
+    /// waypoint times in IR camera exposures ended since the start
+    MIRROR_TRAJECTORY_TIMEBASE_FRAMES,
+} mirror_trajectory_timebase_t;
+
+struct mirror_waypoint {
+    uint32_t theta_millidegrees;
+    uint32_t phi_millidegrees;
+    /// time at which the angles are reached, in the trajectory timebase
+    uint32_t at;
+};
+
+/// waypoints not executed yet, in a ring
+struct mirror_trajectory {
+    struct mirror_waypoint waypoints[MIRROR_TRAJECTORY_MAX_WAYPOINTS];
+    size_t head;
+    size_t count;
+    /// time of the last waypoint taken: start of the move to the next one
+    uint32_t last_at;
+    /// time of the last waypoint appended, later ones must come after it
+    uint32_t tail_at;
+    bool appended;
+};
+
+/// TMC5041 ramp of the position mode, in TMC5041 units
+struct mirror_trajectory_ramp {
+    /// acceleration and deceleration below `v1`
+    uint32_t a1;
+    /// velocity threshold above which the ramp switches to slower
+    /// accelerations: planned moves stay below it
+    uint32_t v1;
+    /// velocity of the moves that can't be planned below `v1`
+    uint32_t vmax;
+};
+
+/**
+ * Drop all the waypoints, time back to 0
+ */
+void
+mirror_trajectory_reset(struct mirror_trajectory *trajectory);
+
+/**
+ * Append waypoints, all or none
+ *
+ * @param waypoints Waypoints with increasing times, after the last appended
+ * @param count Number of waypoints
+ * @retval RET_SUCCESS appended
+ * @retval RET_ERROR_INVALID_PARAM times not increasing
+ * @retval RET_ERROR_NO_MEM not enough room left
+ */
+ret_code_t
+mirror_trajectory_append(struct mirror_trajectory *trajectory,
+                         const struct mirror_waypoint *waypoints, size_t count);
+
+/**
+ * @return number of waypoints not taken yet
+ */
+size_t
+mirror_trajectory_pending(const struct mirror_trajectory *trajectory);
+
+/**
+ * @param start Set to the time at which the move to the next waypoint starts
+ * @retval false no waypoint left
+ */
+bool
+mirror_trajectory_next_start(const struct mirror_trajectory *trajectory,
+                             uint32_t *start);
+
+/**
+ * Take the waypoint to move to, if its move starts at `now` or before
+ *
+ * @param now Time since the start, in the trajectory timebase
+ * @param target Set to the waypoint
+ * @param remaining Set to the time left to reach it, 0 if already late
+ * @retval false no move to start yet
+ */
+bool
+mirror_trajectory_next(struct mirror_trajectory *trajectory, uint32_t now,
+                       struct mirror_waypoint *target, uint32_t *remaining);
+
+/**
+ * Velocity of a move of `distance_microsteps` starting from standstill and
+ * ending after `duration_us`, accelerating and decelerating at `ramp->a1`.
+ * When moves are chained, the ramp generator blends the velocities and each
+ * move ends within a few ms of its waypoint.
+ *
+ * @return VMAX register value, rounded up, `ramp->vmax` if the move
+ *  can't be done in time below `ramp->v1`
+ */
+uint32_t
+mirror_trajectory_vmax(uint32_t distance_microsteps, uint32_t duration_us,
+                       const struct mirror_trajectory_ramp *ramp);
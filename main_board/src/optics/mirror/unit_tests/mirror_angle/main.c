@@ -0,0 +1,94 @@
+#include "mirror_angle.h"
+#include <math.h>
+#include <stdlib.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+// arm lengths of all the boards
+static const double arm_lengths_mm[] = {12.0, 18.71, 16.0, 18.0};
+
+// mechanical range of the mirror is much narrower, see mirror_private.h
+#define MAX_ANGLE_FROM_CENTER_MILLIDEGREES 50000
+
+#define MICROSTEPS_PER_MM 12800.0
+
+/// double precision reference, as previously computed on the MCU
+static int32_t
+millidegrees_reference(int32_t microsteps, double arm_length_mm)
+{
+    const double mm = (double)microsteps / MICROSTEPS_PER_MM;
+    return (int32_t)(asin(mm / arm_length_mm) * 180000.0 / M_PI);
+}
+
+static int32_t
+microsteps_reference(int32_t millidegrees, double arm_length_mm)
+{
+    const double mm = sin((double)millidegrees * M_PI / 180000.0) *
+                      arm_length_mm;
+    return (int32_t)lround(mm * MICROSTEPS_PER_MM);
+}
+
+ZTEST(mirror_angle, test_microsteps_from_angle_error_bounded)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(arm_lengths_mm); ++i) {
+        for (int32_t angle = -MAX_ANGLE_FROM_CENTER_MILLIDEGREES;
+             angle <= MAX_ANGLE_FROM_CENTER_MILLIDEGREES; ++angle) {
+            const int32_t reference =
+                microsteps_reference(angle, arm_lengths_mm[i]);
+            const int32_t steps = calculate_microsteps_from_center_position(
+                angle, (float)arm_lengths_mm[i]);
+            zassert_true(abs(steps - reference) <=
+                             MIRROR_ANGLE_MAX_ERROR_MICROSTEPS,
+                         "arm %f mm, %d mdeg: %d steps, expected %d",
+                         arm_lengths_mm[i], angle, steps, reference);
+        }
+    }
+}
+
+ZTEST(mirror_angle, test_angle_from_microsteps_error_bounded)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(arm_lengths_mm); ++i) {
+        const int32_t max_steps = microsteps_reference(
+            MAX_ANGLE_FROM_CENTER_MILLIDEGREES, arm_lengths_mm[i]);
+        for (int32_t steps = -max_steps; steps <= max_steps; ++steps) {
+            const int32_t reference =
+                millidegrees_reference(steps, arm_lengths_mm[i]);
+            const int32_t angle = calculate_millidegrees_from_center_position(
+                steps, (float)arm_lengths_mm[i]);
+            zassert_true(abs(angle - reference) <=
+                             MIRROR_ANGLE_MAX_ERROR_MILLIDEGREES,
+                         "arm %f mm, %d steps: %d mdeg, expected %d",
+                         arm_lengths_mm[i], steps, angle, reference);
+        }
+    }
+}
+
+ZTEST(mirror_angle, test_round_trip)
+{
+    // one microstep is less than a millidegree on all the boards
+    for (size_t i = 0; i < ARRAY_SIZE(arm_lengths_mm); ++i) {
+        for (int32_t angle = -MAX_ANGLE_FROM_CENTER_MILLIDEGREES;
+             angle <= MAX_ANGLE_FROM_CENTER_MILLIDEGREES; angle += 7) {
+            const float arm_length_mm = (float)arm_lengths_mm[i];
+            const int32_t steps =
+                calculate_microsteps_from_center_position(angle, arm_length_mm);
+            const int32_t back =
+                calculate_millidegrees_from_center_position(steps,
+                                                            arm_length_mm);
+            zassert_true(abs(back - angle) <= 1, "%d mdeg -> %d -> %d mdeg",
+                         angle, steps, back);
+        }
+    }
+}
+
+ZTEST(mirror_angle, test_out_of_range)
+{
+    zassert_equal(calculate_millidegrees_from_center_position(
+                      (int32_t)(12.0 * MICROSTEPS_PER_MM) + 1000, 12.0f),
+                  90000);
+    zassert_equal(calculate_millidegrees_from_center_position(
+                      -(int32_t)(12.0 * MICROSTEPS_PER_MM) - 1000, 12.0f),
+                  -90000);
+}
+
+ZTEST_SUITE(mirror_angle, NULL, NULL, NULL, NULL, NULL);
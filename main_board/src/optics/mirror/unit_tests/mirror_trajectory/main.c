@@ -0,0 +1,191 @@
+#include <math.h>
+#include <mirror_trajectory.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+// position mode ramp of the TMC5041, see mirror_private.h
+static const struct mirror_trajectory_ramp ramp = {
+    .a1 = 0x8000, .v1 = 600000, .vmax = 800000};
+
+static struct mirror_trajectory trajectory;
+
+static void
+before_each_test(void *fixture)
+{
+    ARG_UNUSED(fixture);
+    mirror_trajectory_reset(&trajectory);
+}
+
+ZTEST_SUITE(mirror_trajectory, NULL, NULL, before_each_test, NULL, NULL);
+
+static struct mirror_waypoint
+waypoint(uint32_t at)
+{
+    return (struct mirror_waypoint){
+        .theta_millidegrees = 90000, .phi_millidegrees = 45000 + at, .at = at};
+}
+
+ZTEST(mirror_trajectory, test_times_must_increase)
+{
+    const struct mirror_waypoint decreasing[] = {waypoint(10), waypoint(5)};
+    zassert_equal(RET_ERROR_INVALID_PARAM,
+                  mirror_trajectory_append(&trajectory, decreasing, 2));
+    zassert_equal(0, mirror_trajectory_pending(&trajectory));
+
+    const struct mirror_waypoint first[] = {waypoint(0), waypoint(10)};
+    zassert_ok(mirror_trajectory_append(&trajectory, first, 2));
+
+    // also against the waypoints appended before
+    const struct mirror_waypoint same[] = {waypoint(10)};
+    zassert_equal(RET_ERROR_INVALID_PARAM,
+                  mirror_trajectory_append(&trajectory, same, 1));
+    zassert_equal(2, mirror_trajectory_pending(&trajectory));
+}
+
+ZTEST(mirror_trajectory, test_all_or_none_when_full)
+{
+    const struct mirror_waypoint three[] = {waypoint(10), waypoint(20),
+                                            waypoint(30)};
+    zassert_ok(mirror_trajectory_append(&trajectory, three, 3));
+
+    const struct mirror_waypoint two[] = {waypoint(40), waypoint(50)};
+    zassert_equal(RET_ERROR_NO_MEM,
+                  mirror_trajectory_append(&trajectory, two, 2));
+    zassert_equal(3, mirror_trajectory_pending(&trajectory));
+    zassert_ok(mirror_trajectory_append(&trajectory, two, 1));
+    zassert_equal(4, mirror_trajectory_pending(&trajectory));
+}
+
+ZTEST(mirror_trajectory, test_moves_start_when_previous_waypoint_is_due)
+{
+    const struct mirror_waypoint waypoints[] = {waypoint(10), waypoint(30)};
+    zassert_ok(mirror_trajectory_append(&trajectory, waypoints, 2));
+
+    struct mirror_waypoint target;
+    uint32_t remaining;
+    uint32_t start;
+
+    // the first move starts right away
+    zassert_true(mirror_trajectory_next_start(&trajectory, &start));
+    zassert_equal(0, start);
+    zassert_true(mirror_trajectory_next(&trajectory, 0, &target, &remaining));
+    zassert_equal(10, target.at);
+    zassert_equal(10, remaining);
+
+    // the second one when the first waypoint is reached
+    zassert_true(mirror_trajectory_next_start(&trajectory, &start));
+    zassert_equal(10, start);
+    zassert_false(mirror_trajectory_next(&trajectory, 9, &target, &remaining));
+    zassert_true(mirror_trajectory_next(&trajectory, 11, &target, &remaining));
+    zassert_equal(30, target.at);
+    zassert_equal(45030, target.phi_millidegrees);
+    zassert_equal(19, remaining);
+
+    zassert_false(mirror_trajectory_next_start(&trajectory, &start));
+    zassert_false(
+        mirror_trajectory_next(&trajectory, 100, &target, &remaining));
+}
+
+ZTEST(mirror_trajectory, test_late_waypoints_are_skipped)
+{
+    const struct mirror_waypoint waypoints[] = {waypoint(10), waypoint(20),
+                                                waypoint(30)};
+    zassert_ok(mirror_trajectory_append(&trajectory, waypoints, 3));
+
+    struct mirror_waypoint target;
+    uint32_t remaining;
+
+    // 10 and 20 are past: move to 30
+    zassert_true(mirror_trajectory_next(&trajectory, 25, &target, &remaining));
+    zassert_equal(30, target.at);
+    zassert_equal(5, remaining);
+    zassert_equal(0, mirror_trajectory_pending(&trajectory));
+
+    // the last waypoint is never skipped, reached as fast as possible
+    const struct mirror_waypoint last[] = {waypoint(40)};
+    zassert_ok(mirror_trajectory_append(&trajectory, last, 1));
+    zassert_true(mirror_trajectory_next(&trajectory, 50, &target, &remaining));
+    zassert_equal(40, target.at);
+    zassert_equal(0, remaining);
+}
+
+ZTEST(mirror_trajectory, test_streaming_wraps_around)
+{
+    struct mirror_waypoint target;
+    uint32_t remaining;
+
+    for (uint32_t at = 1; at <= 3 * MIRROR_TRAJECTORY_MAX_WAYPOINTS; ++at) {
+        const struct mirror_waypoint next[] = {waypoint(at)};
+        zassert_ok(mirror_trajectory_append(&trajectory, next, 1));
+        zassert_true(
+            mirror_trajectory_next(&trajectory, at - 1, &target, &remaining));
+        zassert_equal(at, target.at);
+        zassert_equal(1, remaining);
+    }
+}
+
+/**
+ * @return duration of a move at `vmax` from and to standstill, in µs,
+ *  accelerating at `ramp.a1`
+ */
+static double
+move_duration_us(uint32_t distance_microsteps, uint32_t vmax)
+{
+    const double clock_hz = (double)MIRROR_TRAJECTORY_TMC5041_CLOCK_HZ;
+    const double velocity = vmax * clock_hz / (1 << 24);
+    const double acceleration =
+        ramp.a1 * clock_hz * clock_hz / (double)(1ULL << 41);
+
+    // triangle if the velocity isn't reached
+    double duration_s = 2.0 * sqrt(distance_microsteps / acceleration);
+    if (velocity * velocity / acceleration < distance_microsteps) {
+        duration_s =
+            distance_microsteps / velocity + velocity / acceleration;
+    }
+    return duration_s * 1e6;
+}
+
+ZTEST(mirror_trajectory, test_moves_end_on_time)
+{
+    static const uint32_t distances[] = {10, 500, 5000, 20000, 100000};
+    static const uint32_t durations_us[] = {10000, 33333, 100000, 500000,
+                                            2000000};
+
+    for (size_t i = 0; i < ARRAY_SIZE(distances); ++i) {
+        for (size_t j = 0; j < ARRAY_SIZE(durations_us); ++j) {
+            const uint32_t vmax =
+                mirror_trajectory_vmax(distances[i], durations_us[j], &ramp);
+            const double duration_us = move_duration_us(distances[i], vmax);
+
+            if (vmax == ramp.vmax) {
+                // can't be on time: as fast as possible
+                zassert_true(duration_us > durations_us[j] * 0.99,
+                             "%u steps in %u us", distances[i],
+                             durations_us[j]);
+                continue;
+            }
+            // never late, early by less than 1% or by the VMAX resolution
+            zassert_true(duration_us <= durations_us[j] + 1.0,
+                         "%u steps in %u us: %f us", distances[i],
+                         durations_us[j], duration_us);
+            zassert_true(duration_us >= durations_us[j] * 0.99 ||
+                             move_duration_us(distances[i], vmax - 1) >
+                                 durations_us[j],
+                         "%u steps in %u us: %f us", distances[i],
+                         durations_us[j], duration_us);
+        }
+    }
+}
+
+ZTEST(mirror_trajectory, test_vmax_limits)
+{
+    zassert_equal(1, mirror_trajectory_vmax(0, 1000, &ramp));
+    zassert_equal(ramp.vmax, mirror_trajectory_vmax(1000, 0, &ramp));
+    // the whole range in 1 ms
+    zassert_equal(ramp.vmax, mirror_trajectory_vmax(200000, 1000, &ramp));
+    // slower for longer moves, still moving after a minute
+    const uint32_t slow = mirror_trajectory_vmax(1000, 60000000, &ramp);
+    zassert_true(slow > 0 && slow < mirror_trajectory_vmax(1000, 1000000,
+                                                            &ramp));
+    zassert_equal(slow, mirror_trajectory_vmax(1000, UINT32_MAX, &ramp));
+}
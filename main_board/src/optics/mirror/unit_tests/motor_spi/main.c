@@ -0,0 +1,173 @@
+#include "motor_spi_sim.h"
+#include <mirror_private.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#define XTARGET(motor)    TMC5041_REGISTERS[REG_IDX_XTARGET][motor]
+#define XACTUAL(motor)    TMC5041_REGISTERS[REG_IDX_XACTUAL][motor]
+#define DRV_STATUS(motor) TMC5041_REGISTERS[REG_IDX_DRV_STATUS][motor]
+#define VSTART(motor)     TMC5041_REGISTERS[REG_IDX_VSTART][motor]
+#define VMAX(motor)       TMC5041_REGISTERS[REG_IDX_VMAX][motor]
+
+static void *
+suite_setup(void)
+{
+    // posting needs the work queue
+    zassert_equal(RET_ERROR_NOT_INITIALIZED,
+                  motor_controller_spi_write_async(XTARGET(0), 1));
+    zassert_ok(motor_controller_spi_init());
+
+    return NULL;
+}
+
+static void
+before_each_test(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    // drop writes left posted by the previous test
+    motor_spi_sim_run_work();
+    motor_spi_sim_reset();
+}
+
+ZTEST_SUITE(motor_spi, NULL, suite_setup, before_each_test, NULL, NULL);
+
+static void
+assert_datagram(size_t index, uint8_t reg, bool write, uint32_t value)
+{
+    zassert_true(index < motor_spi_sim_datagram_count);
+    const struct motor_spi_sim_datagram *datagram =
+        &motor_spi_sim_datagrams[index];
+    zassert_equal(reg, datagram->reg, "datagram %zu", index);
+    zassert_equal(write, datagram->write, "datagram %zu", index);
+    zassert_equal(value, datagram->value, "datagram %zu", index);
+}
+
+ZTEST(motor_spi, test_reads_resolved_from_next_replies)
+{
+    motor_spi_sim_registers[XACTUAL(0)] = 0x11111111;
+    motor_spi_sim_registers[XACTUAL(1)] = 0x22222222;
+    motor_spi_sim_registers[DRV_STATUS(0)] = 0x80000000;
+
+    uint32_t xactual[MOTORS_COUNT] = {0};
+    uint32_t drv_status = 0;
+    struct motor_spi_batch batch;
+    motor_spi_batch_clear(&batch);
+    zassert_ok(motor_spi_batch_read(&batch, XACTUAL(0), &xactual[0]));
+    zassert_ok(motor_spi_batch_read(&batch, XACTUAL(1), &xactual[1]));
+    zassert_ok(motor_spi_batch_write(&batch, XTARGET(0), -1000));
+    zassert_ok(motor_spi_batch_read(&batch, DRV_STATUS(0), &drv_status));
+    zassert_ok(motor_spi_batch_transfer(&batch));
+
+    zassert_equal(0x11111111, xactual[0]);
+    zassert_equal(0x22222222, xactual[1]);
+    zassert_equal(0x80000000, drv_status);
+    zassert_equal((uint32_t)-1000, motor_spi_sim_registers[XTARGET(0)]);
+
+    // one datagram per command, the trailing read is repeated to get its value
+    zassert_equal(5, motor_spi_sim_datagram_count);
+    assert_datagram(0, XACTUAL(0), false, 0);
+    assert_datagram(1, XACTUAL(1), false, 0);
+    assert_datagram(2, XTARGET(0), true, (uint32_t)-1000);
+    assert_datagram(3, DRV_STATUS(0), false, 0);
+    assert_datagram(4, DRV_STATUS(0), false, 0);
+}
+
+ZTEST(motor_spi, test_single_read_takes_two_datagrams)
+{
+    motor_spi_sim_registers[XACTUAL(1)] = 1234;
+
+    zassert_equal(1234, motor_controller_spi_read(XACTUAL(1)));
+    zassert_equal(2, motor_spi_sim_datagram_count);
+}
+
+ZTEST(motor_spi, test_overflow_rejects_the_batch)
+{
+    uint32_t values[MOTOR_SPI_BATCH_MAX_DATAGRAMS];
+    struct motor_spi_batch batch;
+    motor_spi_batch_clear(&batch);
+
+    // a read needs room for the datagram returning its value
+    size_t reads = 0;
+    while (motor_spi_batch_read(&batch, XACTUAL(0), &values[reads]) ==
+           RET_SUCCESS) {
+        reads++;
+    }
+    zassert_equal(MOTOR_SPI_BATCH_MAX_DATAGRAMS - 1, reads);
+
+    zassert_equal(RET_ERROR_NO_MEM, motor_spi_batch_transfer(&batch));
+    zassert_equal(0, motor_spi_sim_datagram_count);
+}
+
+ZTEST(motor_spi, test_commands_split_into_batches)
+{
+    uint64_t cmds[MOTOR_SPI_BATCH_MAX_DATAGRAMS + 3];
+    for (size_t i = 0; i < ARRAY_SIZE(cmds); ++i) {
+        cmds[i] = ((uint64_t)(0x80 | XTARGET(i % MOTORS_COUNT)) << 32) | i;
+    }
+
+    motor_controller_spi_send_commands(cmds, ARRAY_SIZE(cmds));
+
+    zassert_equal(ARRAY_SIZE(cmds), motor_spi_sim_datagram_count);
+    for (size_t i = 0; i < ARRAY_SIZE(cmds); ++i) {
+        assert_datagram(i, XTARGET(i % MOTORS_COUNT), true, i);
+    }
+}
+
+ZTEST(motor_spi, test_posted_writes_coalesced)
+{
+    for (int32_t i = 1; i <= 3; ++i) {
+        zassert_ok(motor_controller_spi_write_async(XTARGET(0), i));
+        zassert_ok(motor_controller_spi_write_async(XTARGET(1), -i));
+    }
+    zassert_equal(0, motor_spi_sim_datagram_count);
+
+    // the last values, both motors in the same batch
+    zassert_equal(1, motor_spi_sim_run_work());
+    zassert_equal(2, motor_spi_sim_datagram_count);
+    assert_datagram(0, XTARGET(0), true, 3);
+    assert_datagram(1, XTARGET(1), true, (uint32_t)-3);
+
+    // nothing left
+    zassert_equal(0, motor_spi_sim_run_work());
+    zassert_equal(2, motor_spi_sim_datagram_count);
+}
+
+ZTEST(motor_spi, test_posted_writes_limited)
+{
+    const uint8_t regs[] = {XTARGET(0), XTARGET(1), VMAX(0), VMAX(1)};
+    for (size_t i = 0; i < ARRAY_SIZE(regs); ++i) {
+        zassert_ok(motor_controller_spi_write_async(regs[i], 1));
+    }
+    zassert_equal(RET_ERROR_NO_MEM,
+                  motor_controller_spi_write_async(VSTART(0), 1));
+
+    // a register already posted is updated
+    zassert_ok(motor_controller_spi_write_async(XTARGET(1), 2));
+
+    motor_spi_sim_run_work();
+    zassert_equal(ARRAY_SIZE(regs), motor_spi_sim_datagram_count);
+    zassert_equal(2, motor_spi_sim_registers[XTARGET(1)]);
+    zassert_equal(0, motor_spi_sim_registers[VSTART(0)]);
+}
+
+ZTEST(motor_spi, test_posted_writes_flushed_before_sync_transfers)
+{
+    zassert_ok(motor_controller_spi_write_async(XTARGET(0), 42));
+
+    // read back before the work queue had a chance to run
+    zassert_equal(42, motor_controller_spi_read(XTARGET(0)));
+    zassert_equal(3, motor_spi_sim_datagram_count);
+    assert_datagram(0, XTARGET(0), true, 42);
+
+    // a synchronous write isn't overwritten by an older posted value
+    zassert_ok(motor_controller_spi_write_async(XTARGET(1), 10));
+    motor_controller_spi_write(XTARGET(1), 20);
+    zassert_equal(20, motor_spi_sim_registers[XTARGET(1)]);
+
+    // the work finds nothing to transfer
+    size_t count = motor_spi_sim_datagram_count;
+    motor_spi_sim_run_work();
+    zassert_equal(count, motor_spi_sim_datagram_count);
+    zassert_equal(20, motor_spi_sim_registers[XTARGET(1)]);
+}
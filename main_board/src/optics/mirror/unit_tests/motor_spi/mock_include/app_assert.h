@@ -0,0 +1,3 @@
+#pragma once
+
+#define ASSERT_SOFT(err_code) (void)(err_code)
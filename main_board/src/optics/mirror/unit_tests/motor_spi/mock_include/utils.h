@@ -0,0 +1,3 @@
+#include <zephyr/toolchain.h>
+
+#define UNUSED_PARAMETER(x) (void)(x)
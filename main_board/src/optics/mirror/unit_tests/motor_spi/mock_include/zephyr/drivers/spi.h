@@ -0,0 +1,51 @@
+#pragma once
+
+/**
+ * SPI API used by the motor SPI driver, the device on the bus is the
+ * simulated TMC5041 of motor_spi_sim.h
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SPI_WORD_SET(word_size) ((word_size) << 5)
+#define SPI_OP_MODE_MASTER      0U
+#define SPI_MODE_CPOL           (1U << 1)
+#define SPI_MODE_CPHA           (1U << 2)
+#define SPI_LOCK_ON             (1U << 13)
+
+struct device {
+    const char *name;
+};
+
+struct spi_dt_spec {
+    const struct device *bus;
+    uint32_t operation;
+};
+
+extern const struct device motor_spi_sim_bus;
+
+#define SPI_DT_SPEC_GET(node_id, op, delay)                                    \
+    {.bus = &motor_spi_sim_bus, .operation = (op)}
+
+struct spi_buf {
+    void *buf;
+    size_t len;
+};
+
+struct spi_buf_set {
+    const struct spi_buf *buffers;
+    size_t count;
+};
+
+bool
+device_is_ready(const struct device *dev);
+
+int
+spi_transceive_dt(const struct spi_dt_spec *spec,
+                  const struct spi_buf_set *tx_bufs,
+                  const struct spi_buf_set *rx_bufs);
+
+int
+spi_release_dt(const struct spi_dt_spec *spec);
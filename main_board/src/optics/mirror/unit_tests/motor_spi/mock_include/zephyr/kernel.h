@@ -0,0 +1,86 @@
+#pragma once
+
+/**
+ * Kernel objects used by the motor SPI driver, single-threaded: locks are
+ * no-ops and submitted work items run when the test says so, see
+ * motor_spi_sim.h
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define K_FOREVER 0
+
+struct k_mutex {
+    int unused;
+};
+
+#define K_MUTEX_DEFINE(name) struct k_mutex name
+
+static inline int
+k_mutex_lock(struct k_mutex *mutex, int timeout)
+{
+    (void)mutex;
+    (void)timeout;
+    return 0;
+}
+
+static inline int
+k_mutex_unlock(struct k_mutex *mutex)
+{
+    (void)mutex;
+    return 0;
+}
+
+struct k_spinlock {
+    int unused;
+};
+
+typedef int k_spinlock_key_t;
+
+static inline k_spinlock_key_t
+k_spin_lock(struct k_spinlock *lock)
+{
+    (void)lock;
+    return 0;
+}
+
+static inline void
+k_spin_unlock(struct k_spinlock *lock, k_spinlock_key_t key)
+{
+    (void)lock;
+    (void)key;
+}
+
+#define K_THREAD_STACK_DEFINE(name, size) char name[size]
+#define K_THREAD_STACK_SIZEOF(name)       sizeof(name)
+
+struct k_work;
+typedef void (*k_work_handler_t)(struct k_work *work);
+
+struct k_work {
+    k_work_handler_t handler;
+};
+
+#define K_WORK_DEFINE(name, work_handler)                                      \
+    struct k_work name = {.handler = work_handler}
+
+struct k_work_q {
+    int unused;
+};
+
+struct k_work_queue_config {
+    const char *name;
+    bool no_yield;
+    bool essential;
+};
+
+void
+k_work_queue_init(struct k_work_q *queue);
+
+void
+k_work_queue_start(struct k_work_q *queue, char *stack, size_t stack_size,
+                   int prio, const struct k_work_queue_config *cfg);
+
+int
+k_work_submit_to_queue(struct k_work_q *queue, struct k_work *work);
@@ -0,0 +1,133 @@
+#include "motor_spi_sim.h"
+#include <errno.h>
+#include <string.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+
+#define TMC5041_WRITE         (1 << 7)
+#define TMC5041_DATAGRAM_SIZE 5
+
+const struct device motor_spi_sim_bus = {.name = "motor_spi_sim"};
+
+uint32_t motor_spi_sim_registers[MOTOR_SPI_SIM_REGISTERS];
+struct motor_spi_sim_datagram
+    motor_spi_sim_datagrams[MOTOR_SPI_SIM_MAX_DATAGRAMS];
+size_t motor_spi_sim_datagram_count;
+
+// value requested by the last datagram, returned with the next reply
+static uint32_t reply_value;
+
+static struct k_work *submitted[4];
+static size_t submitted_count;
+
+void
+motor_spi_sim_reset(void)
+{
+    memset(motor_spi_sim_registers, 0, sizeof(motor_spi_sim_registers));
+    motor_spi_sim_datagram_count = 0;
+    reply_value = 0;
+}
+
+size_t
+motor_spi_sim_run_work(void)
+{
+    size_t count = 0;
+
+    // work items may submit themselves again
+    while (submitted_count != 0) {
+        struct k_work *work = submitted[0];
+        submitted_count--;
+        memmove(&submitted[0], &submitted[1],
+                submitted_count * sizeof(submitted[0]));
+        work->handler(work);
+        count++;
+    }
+
+    return count;
+}
+
+bool
+device_is_ready(const struct device *dev)
+{
+    return dev == &motor_spi_sim_bus;
+}
+
+int
+spi_transceive_dt(const struct spi_dt_spec *spec,
+                  const struct spi_buf_set *tx_bufs,
+                  const struct spi_buf_set *rx_bufs)
+{
+    if (spec->bus != &motor_spi_sim_bus || tx_bufs->count != 1 ||
+        rx_bufs->count != 1 ||
+        tx_bufs->buffers[0].len != TMC5041_DATAGRAM_SIZE ||
+        rx_bufs->buffers[0].len != TMC5041_DATAGRAM_SIZE ||
+        motor_spi_sim_datagram_count == MOTOR_SPI_SIM_MAX_DATAGRAMS) {
+        return -EINVAL;
+    }
+
+    const uint8_t *tx = tx_bufs->buffers[0].buf;
+    uint8_t *rx = rx_bufs->buffers[0].buf;
+
+    struct motor_spi_sim_datagram *datagram =
+        &motor_spi_sim_datagrams[motor_spi_sim_datagram_count++];
+    datagram->reg = tx[0] & ~TMC5041_WRITE;
+    datagram->write = (tx[0] & TMC5041_WRITE) != 0;
+    datagram->value = sys_get_be32(&tx[1]);
+
+    rx[0] = 0;
+    sys_put_be32(reply_value, &rx[1]);
+
+    if (datagram->write) {
+        motor_spi_sim_registers[datagram->reg] = datagram->value;
+        reply_value = 0;
+    } else {
+        reply_value = motor_spi_sim_registers[datagram->reg];
+    }
+
+    return 0;
+}
+
+int
+spi_release_dt(const struct spi_dt_spec *spec)
+{
+    ARG_UNUSED(spec);
+    return 0;
+}
+
+void
+k_work_queue_init(struct k_work_q *queue)
+{
+    ARG_UNUSED(queue);
+}
+
+void
+k_work_queue_start(struct k_work_q *queue, char *stack, size_t stack_size,
+                   int prio, const struct k_work_queue_config *cfg)
+{
+    ARG_UNUSED(queue);
+    ARG_UNUSED(stack);
+    ARG_UNUSED(stack_size);
+    ARG_UNUSED(prio);
+    ARG_UNUSED(cfg);
+}
+
+int
+k_work_submit_to_queue(struct k_work_q *queue, struct k_work *work)
+{
+    ARG_UNUSED(queue);
+
+    for (size_t i = 0; i < submitted_count; ++i) {
+        if (submitted[i] == work) {
+            // already queued
+            return 0;
+        }
+    }
+    if (submitted_count == ARRAY_SIZE(submitted)) {
+        return -ENOMEM;
+    }
+    submitted[submitted_count++] = work;
+
+    return 1;
+}
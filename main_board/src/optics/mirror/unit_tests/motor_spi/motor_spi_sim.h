@@ -0,0 +1,46 @@
+#pragma once
+
+/**
+ * Model of the TMC5041 on the motor SPI bus, and of the motor SPI work queue:
+ * - one datagram per chip select cycle: address byte, write flag in the MSB,
+ *   then 32-bit data, MSB first
+ * - the reply to a datagram is a status byte then the value of the register
+ *   requested by the previous datagram, if it was a read, 0 otherwise
+ * - work items submitted to the queue run when motor_spi_sim_run_work is
+ *   called, once however many times they have been submitted
+ *
+ * Datagrams are recorded in the order they are received.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MOTOR_SPI_SIM_REGISTERS     0x80
+#define MOTOR_SPI_SIM_MAX_DATAGRAMS 64
+
+struct motor_spi_sim_datagram {
+    // without the write flag
+    uint8_t reg;
+    bool write;
+    uint32_t value;
+};
+
+extern uint32_t motor_spi_sim_registers[MOTOR_SPI_SIM_REGISTERS];
+extern struct motor_spi_sim_datagram
+    motor_spi_sim_datagrams[MOTOR_SPI_SIM_MAX_DATAGRAMS];
+extern size_t motor_spi_sim_datagram_count;
+
+/**
+ * Clear the registers and the recorded datagrams
+ */
+void
+motor_spi_sim_reset(void);
+
+/**
+ * Run the work items submitted since the last call
+ *
+ * @return number of work items run
+ */
+size_t
+motor_spi_sim_run_work(void);
@@ -22,6 +22,8 @@
 #include <stdlib.h>
 #include <stm32g474xx.h>
 #include <stm32g4xx_ll_tim.h>
+#include <system/cpu_usage.h>
+#include <system/isr_trace.h>
 #include <zephyr/drivers/clock_control/stm32_clock_control.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/pinctrl.h>
@@ -88,6 +90,7 @@ typedef struct {
     struct {
         uint8_t notch_count;
         bool success;
+        bool done; /* first homing attempt finished, successful or not */
     } homing;
 
     /* Bump calibration state - measures bump widths in dedicated calibration
@@ -170,6 +173,7 @@ static K_MUTEX_DEFINE(cmd_mutex);
     do {                                                                       \
         ORB_STATE_SET_CURRENT(ret_code, msg);                                  \
         g_polarizer_wheel_instance.homing.success = false;                     \
+        g_polarizer_wheel_instance.homing.done = true;                         \
         g_polarizer_wheel_instance.state = STATE_UNINITIALIZED;                \
         polarizer_halt();                                                      \
         disable_encoder();                                                     \
@@ -761,6 +765,7 @@ static void
 polarizer_wheel_step_isr(const void *arg)
 {
     ARG_UNUSED(arg);
+    const uint32_t isr_start = cpu_usage_isr_enter();
 
     static uint32_t __maybe_unused (*const is_capture_active[])(
         const TIM_TypeDef *) = {
@@ -769,6 +774,10 @@ polarizer_wheel_step_isr(const void *arg)
 
     if (is_capture_active[polarizer_step_pwm_spec->channel - 1](
             polarizer_step_timer)) {
+        ISR_TRACE_LATENCY(CPU_USAGE_ISR_POLARIZER_STEP,
+                          isr_trace_timer_compare_elapsed_cycles(
+                              polarizer_step_timer,
+                              polarizer_step_pwm_spec->channel));
         clear_step_interrupt();
 
         /* Update step counter */
@@ -792,6 +801,8 @@ polarizer_wheel_step_isr(const void *arg)
         /* Signal step event to thread */
         k_sem_give(&step_sem);
     }
+
+    cpu_usage_isr_exit(CPU_USAGE_ISR_POLARIZER_STEP, isr_start);
 }
 
 /*******************************************************************************
@@ -1135,6 +1146,7 @@ execute_homing(void)
 
         g_polarizer_wheel_instance.state = STATE_IDLE;
         g_polarizer_wheel_instance.homing.success = true;
+        g_polarizer_wheel_instance.homing.done = true;
         atomic_clear(&g_polarizer_wheel_instance.step_count.current);
 
         report_reached_state();
@@ -1962,6 +1974,7 @@ exit:
     if (ret_val != RET_SUCCESS) {
         ORB_STATE_SET_CURRENT(RET_ERROR_NOT_INITIALIZED, "init failed");
         g_polarizer_wheel_instance.state = STATE_UNINITIALIZED;
+        g_polarizer_wheel_instance.homing.done = true;
     } else {
         ORB_STATE_SET_CURRENT(RET_SUCCESS, "init success");
     }
@@ -1974,6 +1987,12 @@ polarizer_wheel_homed(void)
     return g_polarizer_wheel_instance.homing.success;
 }
 
+bool
+polarizer_wheel_homing_done(void)
+{
+    return g_polarizer_wheel_instance.homing.done;
+}
+
 ret_code_t
 polarizer_wheel_get_bump_widths(polarizer_wheel_bump_widths_t *widths)
 {
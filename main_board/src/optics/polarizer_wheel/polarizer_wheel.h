@@ -177,6 +177,13 @@ polarizer_wheel_init(const orb_mcu_Hardware *hw_version);
 bool
 polarizer_wheel_homed(void);
 
+/**
+ * return true once the first homing attempt is finished, whether it succeeded
+ * or failed (including initialization failure), false otherwise
+ */
+bool
+polarizer_wheel_homing_done(void);
+
 /**
  * Bump width calibration data measured during calibration.
  * Widths are in microsteps.
@@ -4,6 +4,7 @@
 #include "orb_state.h"
 #include "sysflash/sysflash.h"
 #include "system/backup_regs.h"
+#include "system/boot_timeline.h"
 #include "system/config/config.h"
 #include "system/version/version.h"
 #include "temperature/fan/fan.h"
@@ -383,17 +384,17 @@ power_vbat_5v_3v3_supplies_on(void)
     ret = gpio_pin_set_dt(&supply_vbat_sw_enable_gpio_spec, 1);
     ASSERT_SOFT(ret);
     LOG_DBG("VBAT SW enabled");
-    k_msleep(20);
+    boot_timeline_msleep(20);
 
     ret = gpio_pin_set_dt(&supply_5v_enable_gpio_spec, 1);
     ASSERT_SOFT(ret);
     LOG_DBG("5V power supply enabled");
-    k_msleep(20);
+    boot_timeline_msleep(20);
 
     ret = gpio_pin_set_dt(&supply_3v3_enable_gpio_spec, 1);
     ASSERT_SOFT(ret);
     LOG_DBG("3.3V power supply enabled");
-    k_msleep(20);
+    boot_timeline_msleep(20);
 }
 
 void
@@ -413,11 +414,11 @@ power_vbat_5v_3v3_supplies_off(void)
 
     gpio_pin_set_dt(&supply_vbat_sw_enable_gpio_spec, 0);
     LOG_DBG("VBAT SW disabled");
-    k_msleep(20);
+    boot_timeline_msleep(20);
 
     gpio_pin_set_dt(&supply_5v_enable_gpio_spec, 0);
     LOG_DBG("5V power supply disabled");
-    k_msleep(20);
+    boot_timeline_msleep(20);
 
     gpio_pin_set_dt(&supply_3v3_enable_gpio_spec, 0);
     LOG_DBG("3.3V power supply disabled");
@@ -563,6 +564,8 @@ turn_on_power_supplies(void)
 {
     int ret = 0;
 
+    boot_timeline_begin(__func__);
+
     // might be a duplicate call, but it's preferable to be sure that
     // these supplies are on
     power_vbat_5v_3v3_supplies_on();
@@ -572,32 +575,32 @@ turn_on_power_supplies(void)
     ret = gpio_pin_set_dt(&supply_12v_caps_enable_gpio_spec, 1);
     ASSERT_SOFT(ret);
     LOG_INF("12V_CAPS enabled");
-    k_msleep(20);
+    boot_timeline_msleep(20);
 
     ret = gpio_pin_set_dt(&supply_5v_rgb_enable_gpio_spec, 1);
     ASSERT_SOFT(ret);
     LOG_INF("5V_RGB enabled");
-    k_msleep(20);
+    boot_timeline_msleep(20);
 
     ret = gpio_pin_set_dt(&supply_3v6_enable_gpio_spec, 1);
     ASSERT_SOFT(ret);
     LOG_INF("3V6 enabled");
-    k_msleep(20);
+    boot_timeline_msleep(20);
 
     ret = gpio_pin_set_dt(&supply_3v3_lte_enable_gpio_spec, 1);
     ASSERT_SOFT(ret);
     LOG_INF("3V3_LTE enabled");
-    k_msleep(20);
+    boot_timeline_msleep(20);
 
     ret = gpio_pin_set_dt(&supply_2v8_enable_gpio_spec, 1);
     ASSERT_SOFT(ret);
     LOG_INF("2V8 enabled");
-    k_msleep(20);
+    boot_timeline_msleep(20);
 
     ret = gpio_pin_set_dt(&supply_3v3_ssd_enable_gpio_spec, 1);
     ASSERT_SOFT(ret);
     LOG_INF("3.3V SD card power supply enabled");
-    k_msleep(20);
+    boot_timeline_msleep(20);
 
     ret = gpio_pin_set_dt(&supply_3v3_wifi_enable_gpio_spec, 1);
     ASSERT_SOFT(ret);
@@ -625,21 +628,22 @@ turn_on_power_supplies(void)
         ret = gpio_pin_set_dt(&supply_3v3_ssd_enable_gpio_spec, 1);
         ASSERT_SOFT(ret);
         LOG_INF("3.3V SSD power supply enabled");
-        k_msleep(20);
+        boot_timeline_msleep(20);
 
         ret = gpio_pin_set_dt(&supply_3v3_wifi_enable_gpio_spec, 1);
         ASSERT_SOFT(ret);
         LOG_INF("3.3V WIFI power supply enabled");
     }
 #endif
-    k_msleep(100);
+    boot_timeline_msleep(100);
 
     ret = gpio_pin_set_dt(&supply_1v8_enable_gpio_spec, 1);
     ASSERT_SOFT(ret);
     LOG_INF("1.8V power supply enabled");
 
-    k_msleep(100);
+    boot_timeline_msleep(100);
 
+    boot_timeline_end();
     return 0;
 }
 
@@ -713,7 +717,7 @@ power_until_button_press(void)
 
     gpio_pin_set_dt(&supply_meas_enable_spec, 1);
 
-    k_msleep(1);
+    boot_timeline_msleep(1);
 
     ret = gpio_pin_configure_dt(&pvcc_in_gpio_spec, GPIO_INPUT);
     if (ret) {
@@ -734,7 +738,7 @@ power_until_button_press(void)
             if (optics_self_test() == 0) {
                 self_test_pending = false;
                 gpio_pin_set_dt(&supply_meas_enable_spec, 0);
-                k_msleep(1000);
+                boot_timeline_msleep(1000);
             }
         }
 
@@ -744,7 +748,7 @@ power_until_button_press(void)
                 operator_leds_set_blocking(&white, 0);
                 power_vbat_5v_3v3_supplies_off();
                 // give some time for the wifi module to reset correctly
-                k_msleep(1000);
+                boot_timeline_msleep(1000);
             }
 
             operator_led_mask = 0;
@@ -776,7 +780,8 @@ power_until_button_press(void)
 #endif
         operator_leds_set_blocking(color, operator_led_mask);
 
-        k_msleep(BUTTON_PRESS_TIME_MS / OPERATOR_LEDS_ITERATIONS_COUNT);
+        boot_timeline_msleep(BUTTON_PRESS_TIME_MS /
+                             OPERATOR_LEDS_ITERATIONS_COUNT);
     }
 
     // Disconnect PVCC pin from GPIO so that it can be used by the ADC in other
@@ -801,6 +806,8 @@ app_init_state(void)
 {
     int ret = 0;
 
+    boot_timeline_begin(__func__);
+
     // read image status to know whether we are waiting for user to press
     // the button
     struct boot_swap_state primary_slot = {0};
@@ -811,7 +818,7 @@ app_init_state(void)
 
     // give some time for the wifi module to reset correctly
     // without its power supply
-    k_msleep(2000);
+    boot_timeline_msleep(2000);
 
     post_update = (primary_slot.image_ok == BOOT_FLAG_UNSET &&
                    primary_slot.magic != BOOT_MAGIC_UNSET);
@@ -865,10 +872,12 @@ app_init_state(void)
         ret = dfu_readback_protection();
         ASSERT_SOFT(ret);
 
-        ret = power_until_button_press();
+        BOOT_TIMELINE_RECORD("power_until_button_press",
+                             ret = power_until_button_press());
     }
     LOG_INF_IMM("Booting system...");
 
+    boot_timeline_end();
     return ret;
 }
 
@@ -1090,7 +1099,7 @@ boot_turn_on_jetson(void)
                           "error reading reset pin %d", reset);
             return RET_ERROR_INTERNAL;
         } else if (reset != 0) {
-            k_msleep(1);
+            boot_timeline_msleep(1);
         }
     } while (reset != 0 && --timeout_ms > 0);
 
@@ -1098,7 +1107,7 @@ boot_turn_on_jetson(void)
         ORB_STATE_SET(jetson, RET_ERROR_TIMEOUT, "timeout waiting for reset");
         LOG_ERR(
             "Jetson cannot boot, ensure it's correctly connected & functional");
-        k_msleep(1000);
+        boot_timeline_msleep(1000);
         NVIC_SystemReset();
         CODE_UNREACHABLE;
         // 💀
@@ -1152,7 +1161,7 @@ boot_turn_on_super_cap_charger(void)
     }
     LOG_INF("super cap charger enabled");
 
-    k_msleep(1000);
+    boot_timeline_msleep(1000);
     return RET_SUCCESS;
 }
 
@@ -17,6 +17,7 @@
 #include "storage.h"
 #include "system/backup_regs.h"
 #include "system/config/config.h"
+#include "system/cpu_usage.h"
 #include "system/version/version.h"
 #include "temperature/fan/fan.h"
 #include "temperature/sensors/temperature.h"
@@ -119,6 +120,30 @@ job_ack(orb_mcu_Ack_ErrorCode error, job_t *job)
 }
 
 /// Convert error codes to ack codes
+static orb_mcu_Ack_ErrorCode
+err_code_to_ack_error(int err)
+{
+    switch (err) {
+    case RET_SUCCESS:
+        return orb_mcu_Ack_ErrorCode_SUCCESS;
+
+    case RET_ERROR_INVALID_PARAM:
+    case RET_ERROR_NOT_FOUND:
+        return orb_mcu_Ack_ErrorCode_RANGE;
+
+    case RET_ERROR_BUSY:
+    case RET_ERROR_INVALID_STATE:
+        return orb_mcu_Ack_ErrorCode_IN_PROGRESS;
+
+    case RET_ERROR_FORBIDDEN:
+        return orb_mcu_Ack_ErrorCode_OPERATION_NOT_SUPPORTED;
+
+    default:
+        return orb_mcu_Ack_ErrorCode_FAIL;
+    }
+}
+
+/// Ack jobs processed asynchronously, with error codes converted to ack codes
 static void
 handle_err_code(void *ctx, int err)
 {
@@ -127,30 +152,30 @@ handle_err_code(void *ctx, int err)
 
     if (context->remote == CAN_JETSON_MESSAGING) {
         orb_mcu_Ack ack = {.ack_number = context->ack_number,
-                           .error = orb_mcu_Ack_ErrorCode_FAIL};
-
-        switch (err) {
-        case RET_SUCCESS:
-            ack.error = orb_mcu_Ack_ErrorCode_SUCCESS;
-            break;
+                           .error = err_code_to_ack_error(err)};
 
-        case RET_ERROR_INVALID_PARAM:
-        case RET_ERROR_NOT_FOUND:
-            ack.error = orb_mcu_Ack_ErrorCode_RANGE;
-            break;
+        publish_new(&ack, sizeof(ack), orb_mcu_main_McuToJetson_ack_tag,
+                    context->remote_addr);
+    }
 
-        case RET_ERROR_BUSY:
-        case RET_ERROR_INVALID_STATE:
-            ack.error = orb_mcu_Ack_ErrorCode_IN_PROGRESS;
-            break;
+    if (err == RET_SUCCESS) {
+        ++job_counter;
+    }
+}
 
-        case RET_ERROR_FORBIDDEN:
-            ack.error = orb_mcu_Ack_ErrorCode_OPERATION_NOT_SUPPORTED;
-            break;
+/// Ack firmware image blocks once processed by the DFU library
+static void
+handle_dfu_block_err_code(void *ctx, int err)
+{
+    struct handle_error_context_s *context =
+        (struct handle_error_context_s *)ctx;
 
-        default:
+    if (context->remote == CAN_JETSON_MESSAGING) {
+        orb_mcu_Ack ack = {.ack_number = context->ack_number,
+                           .error = err_code_to_ack_error(err)};
+        if (err == RET_ERROR_INVALID_STATE) {
+            // block couldn't be written, image must be sent from scratch
             ack.error = orb_mcu_Ack_ErrorCode_FAIL;
-            break;
         }
 
         publish_new(&ack, sizeof(ack), orb_mcu_main_McuToJetson_ack_tag,
@@ -912,14 +937,18 @@ handle_fw_img_crc(job_t *job)
     context.remote_addr = job->remote_addr;
     context.ack_number = job->ack_number;
 
+    // image is verified while being written, no need to read it again
     int ret = dfu_secondary_check_async(msg->payload.fw_image_check.crc32,
-                                        (void *)&context, handle_err_code);
+                                        false, (void *)&context,
+                                        handle_err_code);
     if (ret == -EINPROGRESS) {
         return;
     }
 
     if (ret == RET_ERROR_INVALID_STATE) {
         job_ack(orb_mcu_Ack_ErrorCode_INVALID_STATE, job);
+    } else if (ret == RET_ERROR_BUSY) {
+        job_ack(orb_mcu_Ack_ErrorCode_IN_PROGRESS, job);
     } else {
         job_ack(orb_mcu_Ack_ErrorCode_FAIL, job);
     }
@@ -1029,17 +1058,26 @@ handle_dfu_block_message(job_t *job)
     MAKE_ASSERTS(orb_mcu_main_JetsonToMcu_dfu_block_tag);
 
     // must be static to be used by callback
-    static struct handle_error_context_s context = {0};
-    context.remote = job->remote;
-    context.remote_addr = job->remote_addr;
-    context.ack_number = job->ack_number;
+    // one context per block queued in the DFU library, plus one for the
+    // incoming block which might be rejected: contexts of the queued blocks
+    // are never overwritten
+    static struct handle_error_context_s contexts[DFU_WINDOW_SIZE + 1] = {0};
+    static size_t context_idx = 0;
+    struct handle_error_context_s *context = &contexts[context_idx];
+    context->remote = job->remote;
+    context->remote_addr = job->remote_addr;
+    context->ack_number = job->ack_number;
 
     LOG_DBG("Got firmware image block");
     int ret = dfu_load(msg->payload.dfu_block.block_number,
                        msg->payload.dfu_block.block_count,
                        msg->payload.dfu_block.image_block.bytes,
                        msg->payload.dfu_block.image_block.size,
-                       (void *)&context, handle_err_code);
+                       (void *)context, handle_dfu_block_err_code);
+
+    if (ret == -EINPROGRESS) {
+        context_idx = (context_idx + 1) % ARRAY_SIZE(contexts);
+    }
 
     // if the operation is not over,
     // the DFU module will handle acknowledgement
@@ -1048,23 +1086,20 @@ handle_dfu_block_message(job_t *job)
     }
 
     switch (ret) {
-    case RET_SUCCESS:
-        job_ack(orb_mcu_Ack_ErrorCode_SUCCESS, job);
-        break;
-
-    case RET_ERROR_NO_MEM:
-        /* internal dfu buffer not processed? */
-        job_ack(orb_mcu_Ack_ErrorCode_INVALID_STATE, job);
-        break;
-
     case RET_ERROR_INVALID_PARAM:
         job_ack(orb_mcu_Ack_ErrorCode_RANGE, job);
         break;
 
     case RET_ERROR_BUSY:
+        /* window full, block to be sent again */
         job_ack(orb_mcu_Ack_ErrorCode_IN_PROGRESS, job);
         break;
 
+    case RET_ERROR_INVALID_STATE:
+        /* previous block not written, image to be sent from scratch */
+        job_ack(orb_mcu_Ack_ErrorCode_FAIL, job);
+        break;
+
     default:
         LOG_ERR("Unhandled error code %d", ret);
         job_ack(orb_mcu_Ack_ErrorCode_FAIL, job);
@@ -1384,6 +1419,13 @@ handle_mirror_angle_relative_message(job_t *job)
     job_ack(orb_mcu_Ack_ErrorCode_SUCCESS, job);
 }
 
+#if defined(CONFIG_CPU_USAGE_PROFILER)
+/// ValueGet value requesting the CPU usage report, sent as log messages,
+/// chosen far from the values of the protobuf definitions, which don't have
+/// one yet
+#define VALUE_GET_CPU_USAGE 0x100
+#endif
+
 static void
 handle_value_get_message(job_t *job)
 {
@@ -1395,6 +1437,16 @@ handle_value_get_message(job_t *job)
     orb_mcu_ValueGet_Value value = msg->payload.value_get.value;
     LOG_DBG("Got ValueGet request: %u", value);
 
+#if defined(CONFIG_CPU_USAGE_PROFILER)
+    // not part of the protobuf definitions, but enums are open: see
+    // VALUE_GET_CPU_USAGE
+    if ((uint32_t)value == VALUE_GET_CPU_USAGE) {
+        cpu_usage_send(job->remote_addr);
+        job_ack(orb_mcu_Ack_ErrorCode_SUCCESS, job);
+        return;
+    }
+#endif
+
     switch (value) {
     case orb_mcu_ValueGet_Value_FIRMWARE_VERSIONS:
         version_fw_send(job->remote_addr);
@@ -3,6 +3,10 @@
 
 enum backup_regs_offsets {
     REBOOT_FLAG_OFFSET_BYTE = 0,
+    // bytes [4, 24) hold the DFU checkpoint,
+    // see CONFIG_ORB_LIB_DFU_RESUME_BACKUP_REGS_OFFSET
+    // bytes [32, 64) hold the bootloader stages timing,
+    // see BOOT_STAGES_BACKUP_REGS_OFFSET
 };
 
 enum reboot_flags {
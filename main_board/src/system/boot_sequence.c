@@ -0,0 +1,99 @@
+#include "boot_sequence.h"
+#include "boot_timeline.h"
+#include "orb_logs.h"
+#include <app_assert.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+LOG_MODULE_REGISTER(boot_sequence, CONFIG_BOOT_SEQUENCE_LOG_LEVEL);
+
+// period at which readiness conditions are polled
+#define BOOT_SEQUENCE_POLL_PERIOD_MS 50
+
+int
+boot_sequence_run(const boot_step_t *steps, size_t count)
+{
+    if (count > BOOT_SEQUENCE_STEPS_MAX) {
+        return RET_ERROR_INVALID_PARAM;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if ((steps[i].depends_on | steps[i].after) & ~BIT_MASK(count)) {
+            return RET_ERROR_INVALID_PARAM;
+        }
+    }
+
+    uint32_t done = 0;
+    uint32_t failed = 0;
+    // time at which each step could start waiting for its readiness
+    // condition, 0 if not yet
+    uint32_t eligible_ms[BOOT_SEQUENCE_STEPS_MAX] = {0};
+    const uint32_t start_ms = k_uptime_get_32();
+
+    while ((done | failed) != BIT_MASK(count)) {
+        bool progress = false;
+        bool waiting = false;
+
+        for (size_t i = 0; i < count; ++i) {
+            const boot_step_t *step = &steps[i];
+            if ((done | failed) & BIT(i)) {
+                continue;
+            }
+            if (step->depends_on & failed) {
+                LOG_ERR("%s: skipped, dependency failed", step->name);
+                failed |= BIT(i);
+                progress = true;
+                continue;
+            }
+            const uint32_t waits_for = step->depends_on | step->after;
+            if ((waits_for & (done | failed)) != waits_for) {
+                continue;
+            }
+
+            const uint32_t now_ms = k_uptime_get_32();
+            if (eligible_ms[i] == 0) {
+                eligible_ms[i] = MAX(now_ms, 1);
+            }
+
+            if (step->ready != NULL && !step->ready()) {
+                if (now_ms - eligible_ms[i] < step->timeout_ms) {
+                    waiting = true;
+                    continue;
+                }
+                LOG_WRN("%s: not ready after %u ms, running anyway",
+                        step->name, step->timeout_ms);
+            }
+
+            int err_code = RET_SUCCESS;
+            boot_timeline_begin(step->name);
+            boot_timeline_wait_add((uint64_t)(now_ms - eligible_ms[i]) * 1000);
+            if (step->run != NULL) {
+                err_code = step->run();
+            }
+            boot_timeline_end();
+            if (err_code == RET_SUCCESS) {
+                done |= BIT(i);
+            } else {
+                ASSERT_SOFT(err_code);
+                failed |= BIT(i);
+            }
+            LOG_INF("%s: %s at %u ms, waited %u ms", step->name,
+                    err_code == RET_SUCCESS ? "done" : "failed",
+                    k_uptime_get_32() - start_ms, now_ms - eligible_ms[i]);
+            progress = true;
+        }
+
+        if (progress || (done | failed) == BIT_MASK(count)) {
+            // steps depending on the ones done might be runnable right away
+            continue;
+        }
+        if (!waiting) {
+            // remaining steps depend on each other
+            LOG_ERR("Circular dependencies, steps 0x%x not run",
+                    (uint32_t)BIT_MASK(count) & ~(done | failed));
+            return RET_ERROR_INVALID_PARAM;
+        }
+        k_msleep(BOOT_SEQUENCE_POLL_PERIOD_MS);
+    }
+
+    return failed ? RET_ERROR_INTERNAL : RET_SUCCESS;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <errors.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Boot sequencing driven by dependencies and readiness conditions, instead of
+ * fixed delays.
+ *
+ * A step runs once all the steps it depends on are done and its readiness
+ * condition is met. Steps waiting for their condition don't block the
+ * others: independent steps run as soon as they can. The timeout bounds the
+ * wait for the readiness condition, the step then runs anyway, so that a
+ * condition that is never met (sensor failure, missing hardware) only delays
+ * the step as much as a fixed delay would have.
+ */
+
+#define BOOT_SEQUENCE_STEPS_MAX 16
+
+typedef struct {
+    const char *name;
+    // bitmask of the steps (`BIT(index)`) that must be done before this one
+    uint32_t depends_on;
+    // bitmask of the steps that must be finished before this one, whether
+    // they succeeded, failed or have been skipped
+    uint32_t after;
+    // readiness condition, polled once dependencies are done; NULL if none
+    bool (*ready)(void);
+    // maximum wait for `ready`, from the time `depends_on` and `after` are
+    // satisfied
+    uint32_t timeout_ms;
+    // NULL if the step has nothing to do in the current configuration
+    // dependent steps are skipped if it doesn't return RET_SUCCESS
+    int (*run)(void);
+} boot_step_t;
+
+/**
+ * Run the steps until all of them are done or skipped
+ *
+ * @param steps Steps, dependencies reference indexes in this array
+ * @param count Number of steps, at most BOOT_SEQUENCE_STEPS_MAX
+ * @retval RET_SUCCESS all steps ran successfully
+ * @retval RET_ERROR_INVALID_PARAM too many steps, dependency on a step that
+ * doesn't exist or circular dependencies
+ * @retval RET_ERROR_INTERNAL at least one step failed or has been skipped
+ */
+int
+boot_sequence_run(const boot_step_t *steps, size_t count);
@@ -0,0 +1,150 @@
+#include "boot_timeline.h"
+#include "orb_logs.h"
+#include <compilers.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#ifdef CONFIG_SHELL
+#include <zephyr/shell/shell.h>
+#endif
+
+LOG_MODULE_REGISTER(boot_timeline, CONFIG_BOOT_TIMELINE_LOG_LEVEL);
+
+#define BOOT_TIMELINE_DEPTH_MAX 4
+// index of an open step that couldn't be recorded
+#define BOOT_TIMELINE_DROPPED BOOT_TIMELINE_ENTRIES_MAX
+
+typedef struct {
+    const char *name;
+    // 64-bit to not wrap after ~71 minutes
+    uint64_t start_us; // since kernel start
+    uint64_t duration_us;
+    uint64_t wait_us;
+    uint8_t depth;
+} boot_timeline_entry_t;
+
+static boot_timeline_entry_t entries[BOOT_TIMELINE_ENTRIES_MAX];
+static size_t entries_count = 0;
+static size_t dropped_count = 0;
+
+// steps being recorded, innermost last
+static size_t open_steps[BOOT_TIMELINE_DEPTH_MAX];
+static size_t open_count = 0;
+// steps started while already `BOOT_TIMELINE_DEPTH_MAX` deep
+static size_t open_overflow = 0;
+// thread that started the outermost step being recorded
+static k_tid_t owner = NULL;
+
+static uint64_t
+now_us(void)
+{
+    return k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+/// 64-bit integers can't be printed with CONFIG_CBPRINTF_NANO
+static uint32_t
+to_u32(uint64_t value)
+{
+    return (uint32_t)MIN(value, UINT32_MAX);
+}
+
+void
+boot_timeline_begin(const char *name)
+{
+    if (open_count == BOOT_TIMELINE_DEPTH_MAX) {
+        open_overflow++;
+        dropped_count++;
+        return;
+    }
+
+    if (open_count == 0) {
+        owner = k_current_get();
+    }
+
+    if (entries_count == BOOT_TIMELINE_ENTRIES_MAX) {
+        open_steps[open_count++] = BOOT_TIMELINE_DROPPED;
+        dropped_count++;
+        return;
+    }
+
+    entries[entries_count] = (boot_timeline_entry_t){
+        .name = name, .start_us = now_us(), .depth = (uint8_t)open_count};
+    open_steps[open_count++] = entries_count++;
+}
+
+void
+boot_timeline_end(void)
+{
+    if (open_overflow != 0) {
+        open_overflow--;
+        return;
+    }
+    if (open_count == 0) {
+        return;
+    }
+
+    const size_t index = open_steps[--open_count];
+    if (index != BOOT_TIMELINE_DROPPED) {
+        entries[index].duration_us = now_us() - entries[index].start_us;
+    }
+    if (open_count == 0) {
+        owner = NULL;
+    }
+}
+
+void
+boot_timeline_wait_add(uint64_t wait_us)
+{
+    if (open_count == 0 || k_current_get() != owner) {
+        return;
+    }
+
+    const size_t index = open_steps[open_count - 1];
+    if (index != BOOT_TIMELINE_DROPPED) {
+        entries[index].wait_us += wait_us;
+    }
+}
+
+int32_t
+boot_timeline_msleep(int32_t ms)
+{
+    const uint64_t start_us = now_us();
+    const int32_t remaining_ms = k_msleep(ms);
+
+    boot_timeline_wait_add(now_us() - start_us);
+
+    return remaining_ms;
+}
+
+void
+boot_timeline_print(const struct shell *sh)
+{
+#ifdef CONFIG_SHELL
+    if (sh != NULL) {
+        shell_print(sh, "Boot timeline: %zu steps, %zu dropped",
+                    entries_count, dropped_count);
+        shell_print(sh, "  start [ms] duration [ms] wait [ms] step");
+        for (size_t i = 0; i < entries_count; ++i) {
+            const boot_timeline_entry_t *entry = &entries[i];
+            shell_print(sh, "%12u %13u %9u %*s%s",
+                        to_u32(entry->start_us / 1000),
+                        to_u32(entry->duration_us / 1000),
+                        to_u32(entry->wait_us / 1000), entry->depth * 2, "",
+                        entry->name);
+        }
+        return;
+    }
+#else
+    UNUSED_PARAMETER(sh);
+#endif
+
+    LOG_INF("Boot timeline: %zu steps, %zu dropped", entries_count,
+            dropped_count);
+    for (size_t i = 0; i < entries_count; ++i) {
+        const boot_timeline_entry_t *entry = &entries[i];
+        LOG_INF("%*s%s: start %u ms, took %u us, waited %u us",
+                entry->depth * 2, "", entry->name,
+                to_u32(entry->start_us / 1000), to_u32(entry->duration_us),
+                to_u32(entry->wait_us));
+    }
+}
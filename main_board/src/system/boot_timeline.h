@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stdint.h>
+
+struct shell;
+
+/**
+ * Boot timeline: duration of each initialization step, from the SYS_INIT hooks
+ * to the end of `initialize()`, and time spent sleeping in each of them.
+ *
+ * Steps are recorded into a fixed table, in the order they start. Steps can
+ * be nested (e.g. `power_until_button_press` called from `app_init_state`),
+ * in which case the duration of the parent includes the one of its children,
+ * and sleeps are accounted to the innermost step.
+ *
+ * Recording is meant to happen during boot, from a single thread at a time.
+ */
+
+#define BOOT_TIMELINE_ENTRIES_MAX 32
+
+/**
+ * Time `statement` as the boot step `name`
+ */
+#define BOOT_TIMELINE_RECORD(name, statement)                                  \
+    do {                                                                       \
+        boot_timeline_begin(name);                                             \
+        statement;                                                             \
+        boot_timeline_end();                                                   \
+    } while (0)
+
+/**
+ * Start a boot step, to be ended with `boot_timeline_end()`
+ * Once the table is full, new steps are dropped.
+ *
+ * @param name Step name, must be a string with static storage duration
+ */
+void
+boot_timeline_begin(const char *name);
+
+/**
+ * End the last started boot step
+ */
+void
+boot_timeline_end(void);
+
+/**
+ * Account time spent waiting to the current boot step, for waits that
+ * don't go through `boot_timeline_msleep()`
+ *
+ * @param wait_us Waiting time in microseconds
+ */
+void
+boot_timeline_wait_add(uint64_t wait_us);
+
+/**
+ * `k_msleep()`, accounting the time actually spent sleeping to the
+ * current boot step if called from the thread that started it
+ *
+ * @param ms Time to sleep in milliseconds
+ * @return See `k_msleep()`
+ */
+int32_t
+boot_timeline_msleep(int32_t ms);
+
+/**
+ * Print the boot timeline on the shell if `sh` is provided, into the logs
+ * otherwise (sent to the Jetson)
+ *
+ * @param sh Shell instance or NULL
+ */
+void
+boot_timeline_print(const struct shell *sh);
@@ -0,0 +1,377 @@
+#include "cpu_usage.h"
+#include "mcu.pb.h"
+#include "orb_logs.h"
+#include "pubsub/pubsub.h"
+#include <compilers.h>
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+
+#ifdef CONFIG_SHELL
+#include <zephyr/shell/shell.h>
+#endif
+
+LOG_MODULE_REGISTER(cpu_usage, CONFIG_CPU_USAGE_LOG_LEVEL);
+
+#define CPU_USAGE_THREADS_MAX 48
+
+/// each consumer has its own window, reporting doesn't affect the others'
+typedef enum {
+    WINDOW_LOCAL, // shell or logs
+    WINDOW_JETSON,
+    WINDOW_COUNT,
+} window_id_t;
+
+static const char *const isr_names[CPU_USAGE_ISR_COUNT] = {
+    [CPU_USAGE_ISR_CAMERA_EXPOSURE] = "isr_camera_exposure",
+    [CPU_USAGE_ISR_RGB_IR_STROBE] = "isr_rgb_ir_strobe",
+    [CPU_USAGE_ISR_POLARIZER_STEP] = "isr_polarizer_step",
+    [CPU_USAGE_ISR_ADC] = "isr_adc",
+    [CPU_USAGE_ISR_FAN_TACH] = "isr_fan_tach",
+    [CPU_USAGE_ISR_LIQUID_LENS_ADC] = "isr_liquid_lens_adc",
+};
+
+typedef struct {
+    uint32_t count;
+    uint64_t total_cycles;
+} isr_counters_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+} isr_stats_t;
+
+// updated from interrupt context: since boot, and longest run over each
+// window
+static isr_counters_t isr_counters[CPU_USAGE_ISR_COUNT];
+static uint32_t isr_max_cycles[WINDOW_COUNT][CPU_USAGE_ISR_COUNT];
+
+typedef struct {
+    const struct k_thread *thread;
+    uint32_t count;
+    bool seen;
+} switch_counter_t;
+
+// context switches to each thread, counted by the scheduler tracing hook with
+// interrupts locked, see `cpu_usage_thread_switched_in()`
+static switch_counter_t switch_counters[CPU_USAGE_THREADS_MAX];
+
+typedef struct {
+    const struct k_thread *thread;
+    const char *name;
+    // counters at the beginning of each window
+    uint64_t cycles_start[WINDOW_COUNT];
+    uint32_t switches_start[WINDOW_COUNT];
+    // usage over the window being reported
+    uint64_t cycles;
+    uint32_t switches;
+    // longest run since boot
+    uint64_t peak_cycles;
+    bool seen;
+} thread_usage_t;
+
+// threads are matched with their slot by address, slots of threads that
+// don't exist anymore are freed on the next report
+static thread_usage_t threads[CPU_USAGE_THREADS_MAX];
+static size_t threads_dropped = 0;
+
+typedef struct {
+    int64_t start_ticks;
+    // ISR counters at the beginning of the window
+    isr_counters_t isr_start[CPU_USAGE_ISR_COUNT];
+    // window being reported, in cycles
+    uint64_t cycles;
+    isr_stats_t isr[CPU_USAGE_ISR_COUNT];
+} window_t;
+
+static window_t windows[WINDOW_COUNT];
+
+// serializes reports
+static K_MUTEX_DEFINE(report_mutex);
+
+void
+cpu_usage_isr_record(cpu_usage_isr_t isr, uint32_t cycles)
+{
+    // ISRs of different priorities can preempt each other
+    const unsigned int key = irq_lock();
+    isr_counters[isr].count++;
+    isr_counters[isr].total_cycles += cycles;
+    for (size_t w = 0; w < WINDOW_COUNT; ++w) {
+        if (cycles > isr_max_cycles[w][isr]) {
+            isr_max_cycles[w][isr] = cycles;
+        }
+    }
+    irq_unlock(key);
+}
+
+void
+cpu_usage_thread_switched_in(void)
+{
+    const struct k_thread *thread = k_current_get();
+    switch_counter_t *free_counter = NULL;
+
+    for (size_t i = 0; i < ARRAY_SIZE(switch_counters); ++i) {
+        if (switch_counters[i].thread == thread) {
+            switch_counters[i].count++;
+            return;
+        }
+        if (free_counter == NULL && switch_counters[i].thread == NULL) {
+            free_counter = &switch_counters[i];
+        }
+    }
+
+    // first switch to this thread, not counted if no counter is left
+    if (free_counter != NULL) {
+        free_counter->count = 1;
+        free_counter->thread = thread;
+    }
+}
+
+static uint32_t
+switch_count_get(const struct k_thread *thread)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(switch_counters); ++i) {
+        if (switch_counters[i].thread == thread) {
+            switch_counters[i].seen = true;
+            return switch_counters[i].count;
+        }
+    }
+
+    return 0;
+}
+
+static thread_usage_t *
+thread_slot_get(const struct k_thread *thread)
+{
+    thread_usage_t *free_slot = NULL;
+
+    for (size_t i = 0; i < ARRAY_SIZE(threads); ++i) {
+        if (threads[i].thread == thread) {
+            return &threads[i];
+        }
+        if (free_slot == NULL && threads[i].thread == NULL) {
+            free_slot = &threads[i];
+        }
+    }
+
+    if (free_slot != NULL) {
+        // new thread: the windows start at its creation
+        *free_slot = (thread_usage_t){.thread = thread};
+    }
+    return free_slot;
+}
+
+static void
+thread_usage_update(const struct k_thread *thread, void *user_data)
+{
+    const window_id_t window = *(const window_id_t *)user_data;
+
+    thread_usage_t *slot = thread_slot_get(thread);
+    if (slot == NULL) {
+        threads_dropped++;
+        return;
+    }
+
+    k_thread_runtime_stats_t stats;
+    if (k_thread_runtime_stats_get((k_tid_t)thread, &stats) != 0) {
+        return;
+    }
+    const uint32_t switches = switch_count_get(thread);
+
+    slot->name = k_thread_name_get((k_tid_t)thread);
+    slot->cycles = stats.execution_cycles - slot->cycles_start[window];
+    // the counter restarts if it has been freed while the thread was created
+    slot->switches = switches >= slot->switches_start[window]
+                         ? switches - slot->switches_start[window]
+                         : switches;
+    slot->peak_cycles = stats.peak_cycles;
+    slot->cycles_start[window] = stats.execution_cycles;
+    slot->switches_start[window] = switches;
+    slot->seen = true;
+}
+
+/**
+ * Close the current window: compute the usage of each thread and ISR over
+ * the window and start a new one
+ */
+static void
+window_close(window_id_t window)
+{
+    window_t *w = &windows[window];
+
+    for (size_t i = 0; i < ARRAY_SIZE(threads); ++i) {
+        threads[i].seen = false;
+    }
+    for (size_t i = 0; i < ARRAY_SIZE(switch_counters); ++i) {
+        switch_counters[i].seen = false;
+    }
+    threads_dropped = 0;
+
+    const int64_t now_ticks = k_uptime_ticks();
+    k_thread_foreach_unlocked(thread_usage_update, &window);
+
+    const unsigned int key = irq_lock();
+    for (size_t i = 0; i < CPU_USAGE_ISR_COUNT; ++i) {
+        w->isr[i].count = isr_counters[i].count - w->isr_start[i].count;
+        w->isr[i].total_cycles =
+            isr_counters[i].total_cycles - w->isr_start[i].total_cycles;
+        w->isr[i].max_cycles = isr_max_cycles[window][i];
+        w->isr_start[i] = isr_counters[i];
+        isr_max_cycles[window][i] = 0;
+    }
+    irq_unlock(key);
+
+    w->cycles = k_ticks_to_cyc_floor64(now_ticks - w->start_ticks);
+    w->start_ticks = now_ticks;
+
+    for (size_t i = 0; i < ARRAY_SIZE(threads); ++i) {
+        if (!threads[i].seen) {
+            threads[i].thread = NULL;
+        }
+    }
+    // counters are only taken from free ones by the hook: a counter freed
+    // while its thread switches in loses a few switches at most
+    for (size_t i = 0; i < ARRAY_SIZE(switch_counters); ++i) {
+        if (!switch_counters[i].seen) {
+            switch_counters[i].thread = NULL;
+        }
+    }
+}
+
+/// usage over the window in hundredths of percent
+static uint32_t
+window_pct_x100(window_id_t window, uint64_t cycles)
+{
+    if (windows[window].cycles == 0) {
+        return 0;
+    }
+    return (uint32_t)(cycles * 10000 / windows[window].cycles);
+}
+
+static uint32_t
+cycles_to_us(uint64_t cycles)
+{
+    return (uint32_t)k_cyc_to_us_floor64(cycles);
+}
+
+void
+cpu_usage_print(void *sh)
+{
+    const window_t *w = &windows[WINDOW_LOCAL];
+
+    k_mutex_lock(&report_mutex, K_FOREVER);
+    window_close(WINDOW_LOCAL);
+
+#ifdef CONFIG_SHELL
+    if (sh != NULL) {
+        shell_print((const struct shell *)sh,
+                    "Window: %u ms, %zu threads not tracked",
+                    cycles_to_us(w->cycles) / 1000, threads_dropped);
+        shell_print((const struct shell *)sh,
+                    "   cpu [%%]  time [us]     runs longest [us] name");
+        for (size_t i = 0; i < ARRAY_SIZE(threads); ++i) {
+            const thread_usage_t *t = &threads[i];
+            if (t->thread == NULL) {
+                continue;
+            }
+            const uint32_t pct = window_pct_x100(WINDOW_LOCAL, t->cycles);
+            shell_print((const struct shell *)sh,
+                        "%7u.%02u %10u %8u %12u %s", pct / 100, pct % 100,
+                        cycles_to_us(t->cycles), t->switches,
+                        cycles_to_us(t->peak_cycles), t->name);
+        }
+        for (size_t i = 0; i < CPU_USAGE_ISR_COUNT; ++i) {
+            const isr_stats_t *isr = &w->isr[i];
+            const uint32_t pct =
+                window_pct_x100(WINDOW_LOCAL, isr->total_cycles);
+            shell_print((const struct shell *)sh,
+                        "%7u.%02u %10u %8u %12u %s", pct / 100, pct % 100,
+                        cycles_to_us(isr->total_cycles), isr->count,
+                        cycles_to_us(isr->max_cycles), isr_names[i]);
+        }
+        k_mutex_unlock(&report_mutex);
+        return;
+    }
+#else
+    UNUSED_PARAMETER(sh);
+#endif
+
+    LOG_INF("Window: %u ms, %zu threads not tracked",
+            cycles_to_us(w->cycles) / 1000, threads_dropped);
+    for (size_t i = 0; i < ARRAY_SIZE(threads); ++i) {
+        const thread_usage_t *t = &threads[i];
+        if (t->thread == NULL) {
+            continue;
+        }
+        const uint32_t pct = window_pct_x100(WINDOW_LOCAL, t->cycles);
+        LOG_INF("%s: %u.%02u%%, %u switches, longest %u us", t->name,
+                pct / 100, pct % 100, t->switches,
+                cycles_to_us(t->peak_cycles));
+    }
+    for (size_t i = 0; i < CPU_USAGE_ISR_COUNT; ++i) {
+        const isr_stats_t *isr = &w->isr[i];
+        const uint32_t pct = window_pct_x100(WINDOW_LOCAL, isr->total_cycles);
+        LOG_INF("%s: %u.%02u%%, %u calls, longest %u us", isr_names[i],
+                pct / 100, pct % 100, isr->count,
+                cycles_to_us(isr->max_cycles));
+    }
+    k_mutex_unlock(&report_mutex);
+}
+
+static void
+send_line(uint32_t remote, const char *name, uint64_t cycles, uint32_t count,
+          uint64_t peak_cycles)
+{
+    orb_mcu_Log log = {0};
+    const uint32_t pct = window_pct_x100(WINDOW_JETSON, cycles);
+
+    snprintf(log.log, sizeof(log.log),
+             "cpu_usage: %s %u.%02u%% %u us, %u runs, longest %u us", name,
+             pct / 100, pct % 100, cycles_to_us(cycles), count,
+             cycles_to_us(peak_cycles));
+    (void)publish_new(&log, sizeof(log), orb_mcu_main_McuToJetson_log_tag,
+                      remote);
+}
+
+void
+cpu_usage_send(uint32_t remote)
+{
+    const window_t *w = &windows[WINDOW_JETSON];
+
+    k_mutex_lock(&report_mutex, K_FOREVER);
+    window_close(WINDOW_JETSON);
+
+    // only report what ran during the window, to keep the report short
+    for (size_t i = 0; i < ARRAY_SIZE(threads); ++i) {
+        const thread_usage_t *t = &threads[i];
+        if (t->thread != NULL && t->switches != 0) {
+            send_line(remote, t->name, t->cycles, t->switches, t->peak_cycles);
+        }
+    }
+    for (size_t i = 0; i < CPU_USAGE_ISR_COUNT; ++i) {
+        const isr_stats_t *isr = &w->isr[i];
+        if (isr->count != 0) {
+            send_line(remote, isr_names[i], isr->total_cycles, isr->count,
+                      isr->max_cycles);
+        }
+    }
+    k_mutex_unlock(&report_mutex);
+}
+
+int
+cpu_usage_init(void)
+{
+    if (z_arm_dwt_init() != 0) {
+        return RET_ERROR_NOT_INITIALIZED;
+    }
+    z_arm_dwt_cycle_count_start();
+
+    k_mutex_lock(&report_mutex, K_FOREVER);
+    for (window_id_t w = 0; w < WINDOW_COUNT; ++w) {
+        window_close(w);
+    }
+    k_mutex_unlock(&report_mutex);
+
+    return RET_SUCCESS;
+}
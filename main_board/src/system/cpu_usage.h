@@ -0,0 +1,140 @@
+#pragma once
+
+#include <errors.h>
+#include <stdint.h>
+
+#if defined(CONFIG_CPU_USAGE_PROFILER) || defined(CONFIG_ISR_TRACE)
+#include <zephyr/arch/arm/cortex_m/dwt.h>
+#endif
+
+/**
+ * CPU usage profiler: CPU time used by each thread and by our own ISRs over a
+ * window, which starts at the previous report.
+ *
+ * Threads are accounted by the kernel and read through the runtime statistics
+ * API (`k_thread_runtime_stats_get()`), in cycles between two context
+ * switches, so that time spent in ISRs is accounted to the interrupted thread.
+ * Context switches are counted by the scheduler tracing hook
+ * (`CONFIG_TRACING_USER`). ISRs listed in `cpu_usage_isr_t` measure their own
+ * duration with the DWT cycle counter, nested interrupts included.
+ *
+ * The shell (or logs) and the Jetson each have their own window.
+ *
+ * The ISR enter and exit hooks are shared with the ISR tracer (isr_trace.h),
+ * which adds their duration to its histograms: the cycle counter is read
+ * once on entry and once on exit whichever of the two is enabled, and the
+ * hooks compile out when both are disabled.
+ */
+
+typedef enum {
+    CPU_USAGE_ISR_CAMERA_EXPOSURE,
+    CPU_USAGE_ISR_RGB_IR_STROBE,
+    CPU_USAGE_ISR_POLARIZER_STEP,
+    CPU_USAGE_ISR_ADC,
+    CPU_USAGE_ISR_FAN_TACH,
+    CPU_USAGE_ISR_LIQUID_LENS_ADC,
+    CPU_USAGE_ISR_COUNT,
+} cpu_usage_isr_t;
+
+#if defined(CONFIG_CPU_USAGE_PROFILER)
+
+/**
+ * Account the duration of an ISR, see `cpu_usage_isr_exit()`
+ *
+ * @param isr ISR to account the time to
+ * @param cycles Duration
+ */
+void
+cpu_usage_isr_record(cpu_usage_isr_t isr, uint32_t cycles);
+
+/**
+ * To be called by the tracing hook when a thread is switched in, with
+ * interrupts locked
+ */
+void
+cpu_usage_thread_switched_in(void);
+
+/**
+ * Start the cycle counter used to time ISRs and the first windows
+ *
+ * @retval RET_SUCCESS on success
+ * @retval RET_ERROR_NOT_INITIALIZED cycle counter not available
+ */
+int
+cpu_usage_init(void);
+
+/**
+ * Print the usage of each thread and ISR over the window, on the shell if `sh`
+ * is provided, into the logs otherwise. Starts a new window.
+ *
+ * @param sh Shell instance or NULL
+ */
+void
+cpu_usage_print(void *sh);
+
+/**
+ * Send the usage of the threads and ISRs that ran during the Jetson window,
+ * as log messages. Starts a new Jetson window, the one of `cpu_usage_print()`
+ * isn't affected.
+ *
+ * @param remote Remote to send the report to
+ */
+void
+cpu_usage_send(uint32_t remote);
+
+#endif
+
+#if defined(CONFIG_ISR_TRACE)
+// see isr_trace.h
+void
+isr_trace_duration_record(cpu_usage_isr_t isr, uint32_t cycles);
+#endif
+
+#if defined(CONFIG_CPU_USAGE_PROFILER) || defined(CONFIG_ISR_TRACE)
+
+/**
+ * To be called when entering an ISR
+ *
+ * @return Start timestamp to pass to `cpu_usage_isr_exit()`
+ */
+static inline uint32_t
+cpu_usage_isr_enter(void)
+{
+    return z_arm_dwt_get_cycles();
+}
+
+/**
+ * To be called when exiting an ISR, on every exit path
+ *
+ * @param isr ISR to account the time to
+ * @param start Value returned by `cpu_usage_isr_enter()`
+ */
+static inline void
+cpu_usage_isr_exit(cpu_usage_isr_t isr, uint32_t start)
+{
+    const uint32_t cycles = z_arm_dwt_get_cycles() - start;
+
+#if defined(CONFIG_CPU_USAGE_PROFILER)
+    cpu_usage_isr_record(isr, cycles);
+#endif
+#if defined(CONFIG_ISR_TRACE)
+    isr_trace_duration_record(isr, cycles);
+#endif
+}
+
+#else
+
+static inline uint32_t
+cpu_usage_isr_enter(void)
+{
+    return 0;
+}
+
+static inline void
+cpu_usage_isr_exit(cpu_usage_isr_t isr, uint32_t start)
+{
+    (void)isr;
+    (void)start;
+}
+
+#endif
@@ -218,6 +218,17 @@ extern struct dfu_state_t dfu_state;
 extern struct k_sem sem_dfu_free_space;
 extern struct k_sem sem_dfu_full;
 
+/// Wait for all the queued blocks to be processed, 1 second max
+static void
+dfu_test_wait_processed(void)
+{
+    size_t retries = 100;
+    while (k_sem_count_get(&sem_dfu_free_space) != DFU_WINDOW_SIZE &&
+           retries--) {
+        k_msleep(10);
+    }
+}
+
 /**
  * Called before each test of the test suite
  * @return NULL
@@ -227,8 +238,28 @@ dfu_test_reset(void *fixture)
 {
     UNUSED(fixture);
 
+    dfu_test_wait_processed();
+
     memset(&dfu_state, 0, sizeof(dfu_state));
-    k_sem_give(&sem_dfu_free_space);
+    k_sem_reset(&sem_dfu_full);
+    k_sem_reset(&sem_dfu_free_space);
+    for (size_t i = 0; i < DFU_WINDOW_SIZE; ++i) {
+        k_sem_give(&sem_dfu_free_space);
+    }
+}
+
+static atomic_t dfu_test_cb_count;
+static atomic_t dfu_test_cb_errors;
+
+static void
+dfu_test_cb(void *ctx, int err)
+{
+    UNUSED(ctx);
+
+    atomic_inc(&dfu_test_cb_count);
+    if (err != RET_SUCCESS) {
+        atomic_inc(&dfu_test_cb_errors);
+    }
 }
 
 ZTEST(dfu, test_dfu_load_valid)
@@ -242,10 +273,14 @@ ZTEST(dfu, test_dfu_load_valid)
     // Perform a valid dfu_load call
     ret = dfu_load(block_number, block_count, data, size, NULL, NULL);
 
-    zassert_equal(ret, RET_SUCCESS, "Failed to load valid DFU block");
+    zassert_equal(ret, -EINPROGRESS, "Failed to queue valid DFU block");
     zassert_equal(dfu_state.block_count, block_count, "Block count mismatch");
     zassert_equal(dfu_state.block_number, block_number,
                   "Block number mismatch");
+
+    // wait for process_dfu_blocks_thread to stage the block
+    dfu_test_wait_processed();
+
     zassert_mem_equal(dfu_state.bytes, data, size, "Data mismatch");
     zassert_equal(dfu_state.wr_idx, size, "Write index mismatch");
 }
@@ -270,12 +305,12 @@ ZTEST(dfu, test_dfu_load_buffer_overflow)
     uint8_t data[DFU_BLOCK_SIZE_MAX] = {0xAA};
     uint32_t block_count = 10;
     uint32_t block_number = 0;
-    size_t size = sizeof(dfu_state.bytes) + 1; // Too large
+    size_t size = DFU_BLOCK_SIZE_MAX + 1; // Too large
 
     int ret = dfu_load(block_number, block_count, data, size, NULL, NULL);
 
     zassert_equal(ret, RET_ERROR_INVALID_PARAM, "Buffer overflow not handled");
-    zassert_equal(dfu_state.wr_idx, 0, "Write index was unexpectedly modified");
+    zassert_equal(dfu_state.slot_wr_idx, 0, "Block unexpectedly queued");
 }
 
 ZTEST(dfu, test_dfu_load_out_of_sequence)
@@ -285,7 +320,7 @@ ZTEST(dfu, test_dfu_load_out_of_sequence)
 
     // Start with the first block
     int ret = dfu_load(0, block_count, data, DFU_BLOCK_SIZE_MAX, NULL, NULL);
-    zassert_equal(ret, RET_SUCCESS, "Failed to load first block");
+    zassert_equal(ret, -EINPROGRESS, "Failed to load first block");
 
     // Send an out-of-sequence block
     ret = dfu_load(2, block_count, data, DFU_BLOCK_SIZE_MAX, NULL,
@@ -296,36 +331,24 @@ ZTEST(dfu, test_dfu_load_out_of_sequence)
 
 ZTEST(dfu, test_dfu_load_large_block_count)
 {
-    const size_t size = DFU_BLOCK_SIZE_MAX;
     const uint8_t data[DFU_BLOCK_SIZE_MAX] = {0xAA};
     const uint32_t block_count = 0xCAFEBABE;
 
-    // Start with the first block
+    // First block is rejected as the image doesn't fit into the slot
     int ret = dfu_load(0, block_count, data, DFU_BLOCK_SIZE_MAX, NULL, NULL);
-    zassert_equal(ret, RET_SUCCESS, "Failed to load first block");
-    zassert_equal(dfu_state.wr_idx, size, "Write index mismatch");
-
-    // Second block
-    ret = dfu_load(1, block_count, data, DFU_BLOCK_SIZE_MAX, NULL, NULL);
-    zassert_equal(ret, -EINPROGRESS, "Failed to load second block");
-    zassert_equal(dfu_state.wr_idx, size * 2, "Write index mismatch");
-
-    // wait for process_dfu_blocks_thread to process the first chunk
-    k_msleep(100);
-
-    zassert_equal(dfu_state.wr_idx, 0, "Write index mismatch");
+    zassert_equal(ret, RET_ERROR_INVALID_PARAM,
+                  "Image larger than the slot must be rejected");
+    zassert_equal(dfu_state.slot_wr_idx, 0, "Block unexpectedly queued");
 
-    // Resending the second block again should fail as the image must be sent
+    // Sending the second block should fail as the image must be sent
     // from scratch following the large `block_count` value error.
     ret = dfu_load(1, block_count, data, DFU_BLOCK_SIZE_MAX, NULL, NULL);
     zassert_equal(ret, RET_ERROR_INVALID_PARAM,
                   "Block should have failed: image must be sent from scratch");
-    zassert_equal(dfu_state.wr_idx, 0, "Write index mismatch");
 
     // Restart with a first block should work
-    ret = dfu_load(0, block_count, data, DFU_BLOCK_SIZE_MAX, NULL, NULL);
-    zassert_equal(ret, RET_SUCCESS, "Failed to load first block");
-    zassert_equal(dfu_state.wr_idx, size, "Write index mismatch");
+    ret = dfu_load(0, 10, data, DFU_BLOCK_SIZE_MAX, NULL, NULL);
+    zassert_equal(ret, -EINPROGRESS, "Failed to load first block");
 }
 
 ZTEST(dfu, test_dfu_load_semaphore_handling)
@@ -343,3 +366,184 @@ ZTEST(dfu, test_dfu_load_semaphore_handling)
     zassert_equal(ret, RET_ERROR_BUSY, "Producer failed to handle semaphore");
     zassert_equal(dfu_state.block_count, 0, "dfu_state unexpectedly changed");
 }
+
+ZTEST(dfu, test_dfu_load_window)
+{
+    uint8_t data[DFU_BLOCK_SIZE_MAX] = {0x55};
+    // image spanning more than 2 sectors to test erasing ahead
+    uint32_t block_count = (2 * DFU_FLASH_SECTOR_SIZE / DFU_BLOCK_SIZE_MAX) + 2;
+    int ret;
+
+    atomic_set(&dfu_test_cb_count, 0);
+    atomic_set(&dfu_test_cb_errors, 0);
+
+    // prevent the processing thread from running to fill the window
+    k_sched_lock();
+    for (uint32_t i = 0; i < DFU_WINDOW_SIZE; ++i) {
+        ret = dfu_load(i, block_count, data, DFU_BLOCK_SIZE_MAX, NULL,
+                       dfu_test_cb);
+        zassert_equal(ret, -EINPROGRESS, "Block #%u not queued", i);
+    }
+    ret = dfu_load(DFU_WINDOW_SIZE, block_count, data, DFU_BLOCK_SIZE_MAX,
+                   NULL, dfu_test_cb);
+    k_sched_unlock();
+
+    zassert_equal(ret, RET_ERROR_BUSY, "Window must be full");
+
+    dfu_test_wait_processed();
+
+    zassert_equal(atomic_get(&dfu_test_cb_count), DFU_WINDOW_SIZE,
+                  "Each queued block must be acked");
+    zassert_equal(atomic_get(&dfu_test_cb_errors), 0);
+
+    size_t bytes = DFU_WINDOW_SIZE * DFU_BLOCK_SIZE_MAX;
+    zassert_equal(dfu_state.flash_offset,
+                  bytes - (bytes % DFU_BLOCKS_WRITE_SIZE),
+                  "Flash offset mismatch");
+    zassert_equal(dfu_state.wr_idx, bytes % DFU_BLOCKS_WRITE_SIZE,
+                  "Write index mismatch");
+
+    // while waiting for the next block, the next sector has been erased
+    k_msleep(200);
+    zassert_equal(dfu_state.erased_offset, 2 * DFU_FLASH_SECTOR_SIZE,
+                  "Next sector must be erased ahead of the write pointer");
+
+    // window is free again: next block can be queued
+    ret = dfu_load(DFU_WINDOW_SIZE, block_count, data, DFU_BLOCK_SIZE_MAX,
+                   NULL, dfu_test_cb);
+    zassert_equal(ret, -EINPROGRESS, "Block not queued once window is free");
+}
+
+ZTEST(dfu, test_dfu_streamed_crc)
+{
+    uint8_t data[DFU_BLOCK_SIZE_MAX];
+    // last block smaller than the others, to check padding is excluded
+    const size_t last_block_size = DFU_BLOCK_SIZE_MAX / 2 + 1;
+    const uint32_t block_count = 8;
+    uint32_t expected_crc = 0;
+    int ret;
+
+    atomic_set(&dfu_test_cb_count, 0);
+    atomic_set(&dfu_test_cb_errors, 0);
+
+    for (uint32_t i = 0; i < block_count; ++i) {
+        size_t size =
+            (i == block_count - 1) ? last_block_size : DFU_BLOCK_SIZE_MAX;
+        memset(data, (int)i, sizeof(data));
+        if (i == 0) {
+            // the streamed CRC32 is only used if the received bytes match
+            // the image size found in the header
+            struct image_header header = {
+                .ih_magic = IMAGE_MAGIC,
+                .ih_hdr_size = sizeof(struct image_header),
+                .ih_img_size = (block_count - 1) * DFU_BLOCK_SIZE_MAX +
+                               last_block_size - sizeof(struct image_header),
+            };
+            memcpy(data, &header, sizeof(header));
+        }
+        expected_crc = crc32_ieee_update(expected_crc, data, size);
+
+        do {
+            ret = dfu_load(i, block_count, data, size, NULL, dfu_test_cb);
+            if (ret == RET_ERROR_BUSY) {
+                k_msleep(10);
+            }
+        } while (ret == RET_ERROR_BUSY);
+        zassert_equal(ret, -EINPROGRESS, "Block #%u not queued", i);
+    }
+
+    dfu_test_wait_processed();
+    zassert_equal(atomic_get(&dfu_test_cb_count), block_count);
+    zassert_equal(atomic_get(&dfu_test_cb_errors), 0);
+    zassert_true(dfu_state.image_crc32_valid);
+    zassert_equal(dfu_state.image_size,
+                  (block_count - 1) * DFU_BLOCK_SIZE_MAX + last_block_size);
+    zassert_equal(dfu_state.image_crc32, expected_crc,
+                  "CRC32 must be computed over image bytes only");
+
+    // O(1) check, using the CRC32 computed while writing
+    ret = dfu_secondary_check_async(expected_crc, false, NULL, dfu_test_cb);
+    zassert_equal(ret, -EINPROGRESS);
+    dfu_test_wait_processed();
+    zassert_equal(atomic_get(&dfu_test_cb_errors), 0);
+
+    ret = dfu_secondary_check_async(expected_crc ^ 1, false, NULL, dfu_test_cb);
+    zassert_equal(ret, -EINPROGRESS);
+    dfu_test_wait_processed();
+    zassert_equal(atomic_get(&dfu_test_cb_errors), 1,
+                  "Wrong CRC32 must be detected");
+}
+
+static int
+dfu_test_load_block(uint32_t block_number, uint32_t block_count)
+{
+    uint8_t data[DFU_BLOCK_SIZE_MAX];
+    int ret;
+
+    memset(data, (int)(block_number * 7), sizeof(data));
+    do {
+        ret = dfu_load(block_number, block_count, data, sizeof(data), NULL,
+                       dfu_test_cb);
+        if (ret == RET_ERROR_BUSY) {
+            k_msleep(10);
+        }
+    } while (ret == RET_ERROR_BUSY);
+
+    return ret;
+}
+
+ZTEST(dfu, test_dfu_resume)
+{
+    uint8_t data[DFU_BLOCK_SIZE_MAX];
+    const uint32_t block_count = 32;
+    uint32_t expected_crc = 0;
+    uint32_t image_id, resume_block, resume_block_count;
+    int ret;
+
+    for (uint32_t i = 0; i < block_count; ++i) {
+        memset(data, (int)(i * 7), sizeof(data));
+        expected_crc = crc32_ieee_update(expected_crc, data, sizeof(data));
+    }
+
+    atomic_set(&dfu_test_cb_count, 0);
+    atomic_set(&dfu_test_cb_errors, 0);
+
+    ret = dfu_resume_point_get(NULL, NULL, NULL);
+    zassert_equal(ret, RET_ERROR_NOT_FOUND);
+
+    // link lost after half of the image
+    for (uint32_t i = 0; i < block_count / 2; ++i) {
+        zassert_equal(dfu_test_load_block(i, block_count), -EINPROGRESS);
+    }
+    dfu_test_wait_processed();
+    zassert_equal(atomic_get(&dfu_test_cb_errors), 0);
+
+    ret = dfu_resume_point_get(&image_id, &resume_block, &resume_block_count);
+    zassert_equal(ret, RET_SUCCESS);
+    zassert_equal(resume_block_count, block_count);
+    zassert_true(resume_block > 0 && resume_block <= block_count / 2,
+                 "Resume point %u", resume_block);
+    memset(data, 0, sizeof(data));
+    zassert_equal(image_id, crc32_ieee(data, sizeof(data)));
+
+    // blocks can't be skipped
+    zassert_equal(dfu_test_load_block(block_count / 2 + 1, block_count),
+                  RET_ERROR_INVALID_PARAM);
+
+    // block 0 of the same image again, then jump to the resume point
+    zassert_equal(dfu_test_load_block(0, block_count), -EINPROGRESS);
+    for (uint32_t i = resume_block; i < block_count; ++i) {
+        zassert_equal(dfu_test_load_block(i, block_count), -EINPROGRESS,
+                      "Block #%u not queued", i);
+    }
+    dfu_test_wait_processed();
+    zassert_equal(atomic_get(&dfu_test_cb_errors), 0);
+    zassert_true(dfu_state.image_crc32_valid);
+    zassert_equal(dfu_state.image_size, block_count * DFU_BLOCK_SIZE_MAX);
+    zassert_equal(dfu_state.image_crc32, expected_crc,
+                  "Resumed image must match the image sent at once");
+
+    // image complete, nothing to resume
+    ret = dfu_resume_point_get(NULL, NULL, NULL);
+    zassert_equal(ret, RET_ERROR_NOT_FOUND);
+}
@@ -0,0 +1,136 @@
+#include "isr_trace.h"
+#include "orb_logs.h"
+#include <compilers.h>
+#include <errors.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#ifdef CONFIG_SHELL
+#include <zephyr/shell/shell.h>
+#endif
+
+LOG_MODULE_REGISTER(isr_trace, CONFIG_ISR_TRACE_LOG_LEVEL);
+
+static const char *const isr_names[CPU_USAGE_ISR_COUNT] = {
+    [CPU_USAGE_ISR_CAMERA_EXPOSURE] = "camera_exposure",
+    [CPU_USAGE_ISR_RGB_IR_STROBE] = "rgb_ir_strobe",
+    [CPU_USAGE_ISR_POLARIZER_STEP] = "polarizer_step",
+    [CPU_USAGE_ISR_ADC] = "adc",
+    [CPU_USAGE_ISR_FAN_TACH] = "fan_tach",
+    [CPU_USAGE_ISR_LIQUID_LENS_ADC] = "liquid_lens_adc",
+};
+
+typedef struct {
+    uint32_t count;
+    uint32_t max;
+    uint32_t buckets[ISR_TRACE_BUCKETS];
+} histogram_t;
+
+// each entry is only written by its own ISR, which doesn't preempt itself
+static struct {
+    histogram_t latency;
+    histogram_t duration;
+} traces[CPU_USAGE_ISR_COUNT];
+
+static void
+histogram_add(histogram_t *histogram, uint32_t cycles)
+{
+    // index of the most significant bit, single instruction (CLZ)
+    const uint32_t msb = cycles == 0 ? 0 : 31 - __builtin_clz(cycles);
+
+    histogram->buckets[MIN(msb, ISR_TRACE_BUCKETS - 1)]++;
+    histogram->count++;
+    if (cycles > histogram->max) {
+        histogram->max = cycles;
+    }
+}
+
+void
+isr_trace_latency_record(cpu_usage_isr_t isr, uint32_t cycles)
+{
+    histogram_add(&traces[isr].latency, cycles);
+}
+
+void
+isr_trace_duration_record(cpu_usage_isr_t isr, uint32_t cycles)
+{
+    histogram_add(&traces[isr].duration, cycles);
+}
+
+static void
+histogram_print(void *sh, const char *name, const char *kind,
+                const histogram_t *histogram)
+{
+    if (histogram->count == 0) {
+        return;
+    }
+
+#ifdef CONFIG_SHELL
+    if (sh != NULL) {
+        shell_print((const struct shell *)sh, "%s %s: %u samples, max %u cyc",
+                    name, kind, histogram->count, histogram->max);
+        for (size_t i = 0; i < ISR_TRACE_BUCKETS; ++i) {
+            if (histogram->buckets[i] == 0) {
+                continue;
+            }
+            if (i == ISR_TRACE_BUCKETS - 1) {
+                shell_print((const struct shell *)sh, "  >= %6u cyc: %u",
+                            (uint32_t)BIT(i), histogram->buckets[i]);
+            } else {
+                shell_print((const struct shell *)sh, "  < %7u cyc: %u",
+                            (uint32_t)BIT(i + 1), histogram->buckets[i]);
+            }
+        }
+        return;
+    }
+#else
+    UNUSED_PARAMETER(sh);
+#endif
+
+    LOG_INF("%s %s: %u samples, max %u cyc", name, kind, histogram->count,
+            histogram->max);
+    for (size_t i = 0; i < ISR_TRACE_BUCKETS; ++i) {
+        if (histogram->buckets[i] != 0) {
+            LOG_INF("  [%u, %u) cyc: %u", i == 0 ? 0 : (uint32_t)BIT(i),
+                    i == ISR_TRACE_BUCKETS - 1 ? UINT32_MAX
+                                               : (uint32_t)BIT(i + 1),
+                    histogram->buckets[i]);
+        }
+    }
+}
+
+void
+isr_trace_print(void *sh)
+{
+#ifdef CONFIG_SHELL
+    if (sh != NULL) {
+        shell_print((const struct shell *)sh, "CPU clock: %u MHz",
+                    sys_clock_hw_cycles_per_sec() / 1000000);
+    }
+#endif
+
+    for (size_t i = 0; i < CPU_USAGE_ISR_COUNT; ++i) {
+        histogram_print(sh, isr_names[i], "latency", &traces[i].latency);
+        histogram_print(sh, isr_names[i], "duration", &traces[i].duration);
+    }
+}
+
+void
+isr_trace_reset(void)
+{
+    const unsigned int key = irq_lock();
+    memset(traces, 0, sizeof(traces));
+    irq_unlock(key);
+}
+
+int
+isr_trace_init(void)
+{
+    if (z_arm_dwt_init() != 0) {
+        return RET_ERROR_NOT_INITIALIZED;
+    }
+    z_arm_dwt_cycle_count_start();
+
+    return RET_SUCCESS;
+}
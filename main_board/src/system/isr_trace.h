@@ -0,0 +1,109 @@
+#pragma once
+
+#include "cpu_usage.h"
+#include <stdint.h>
+
+/**
+ * ISR tracer: histograms of entry latency and duration of timing-critical
+ * ISRs, measured with the DWT cycle counter.
+ *
+ * The duration covers the ISR body, preemption by higher priority interrupts
+ * included. It's recorded by the `cpu_usage_isr_enter()` and
+ * `cpu_usage_isr_exit()` hooks that the ISR already calls for the CPU usage
+ * profiler, so both tools share the same cycle counter reads.
+ * The entry latency is the time between the hardware event and the ISR
+ * entry; it's only available for ISRs whose peripheral timestamps the event
+ * (timer counter), the call site computes it with the helpers below and
+ * records it with `ISR_TRACE_LATENCY`.
+ *
+ * Histograms use power-of-two buckets in CPU cycles: bucket `i` counts values
+ * in [2^i, 2^(i+1)), the last bucket counts everything above.
+ *
+ * When `CONFIG_ISR_TRACE` is disabled, the macro expands to nothing and its
+ * arguments aren't evaluated.
+ */
+
+#define ISR_TRACE_BUCKETS 16
+
+#if defined(CONFIG_ISR_TRACE)
+
+#include <stm32_ll_tim.h>
+
+/**
+ * Record the entry latency of the ISR `isr`, in CPU cycles
+ */
+#define ISR_TRACE_LATENCY(isr, cycles) isr_trace_latency_record(isr, cycles)
+
+void
+isr_trace_latency_record(cpu_usage_isr_t isr, uint32_t cycles);
+
+/**
+ * Time elapsed since a timer event, from the counter value at the event.
+ * The timer is assumed to run at the CPU clock before prescaling.
+ *
+ * @param timer Timer counting up, not stopped by the event
+ * @param event_count Counter value at the time of the event
+ * @return Elapsed time in CPU cycles
+ */
+static inline uint32_t
+isr_trace_timer_elapsed_cycles(const TIM_TypeDef *timer, uint32_t event_count)
+{
+    const uint32_t count = LL_TIM_GetCounter(timer);
+    uint32_t ticks;
+    if (count >= event_count) {
+        ticks = count - event_count;
+    } else {
+        // the counter wrapped around since the event
+        ticks = count + LL_TIM_GetAutoReload(timer) + 1 - event_count;
+    }
+
+    return ticks * (LL_TIM_GetPrescaler(timer) + 1);
+}
+
+/**
+ * Time elapsed since a compare event on a timer channel
+ *
+ * @param timer Timer counting up
+ * @param channel Channel number, from 1 to 4
+ * @return Elapsed time in CPU cycles
+ */
+static inline uint32_t
+isr_trace_timer_compare_elapsed_cycles(const TIM_TypeDef *timer,
+                                       uint32_t channel)
+{
+    // CCR1 to CCR4 are contiguous
+    const volatile uint32_t *ccr = &timer->CCR1 + (channel - 1);
+    return isr_trace_timer_elapsed_cycles(timer, *ccr);
+}
+
+/**
+ * Print the histograms on the shell if `sh` is provided, into the logs
+ * otherwise
+ *
+ * @param sh Shell instance or NULL
+ */
+void
+isr_trace_print(void *sh);
+
+/**
+ * Clear all the histograms
+ */
+void
+isr_trace_reset(void);
+
+/**
+ * Start the DWT cycle counter
+ *
+ * @retval RET_SUCCESS on success
+ * @retval RET_ERROR_NOT_INITIALIZED cycle counter not available
+ */
+int
+isr_trace_init(void);
+
+#else
+
+#define ISR_TRACE_LATENCY(isr, cycles)                                         \
+    do {                                                                       \
+    } while (0)
+
+#endif
@@ -60,10 +60,6 @@ MEMFAULT_METRICS_DEFINE_THREAD_METRICS(
         .thread_name = "gnss",
         .stack_usage_metric_key = MEMFAULT_METRICS_KEY(memory_gnss_pct_max),
     },
-    {
-        .thread_name = "tof_1d",
-        .stack_usage_metric_key = MEMFAULT_METRICS_KEY(memory_tof_1d_pct_max),
-    },
     {
         .thread_name = "liquid_lens",
         .stack_usage_metric_key =
@@ -107,17 +103,14 @@ MEMFAULT_METRICS_DEFINE_THREAD_METRICS(
         .stack_usage_metric_key = MEMFAULT_METRICS_KEY(memory_runner_pct_max),
     },
     {
-        .thread_name = "fan_tach",
-        .stack_usage_metric_key = MEMFAULT_METRICS_KEY(memory_fan_tach_pct_max),
-    },
-    {
-        .thread_name = "temperature",
+        .thread_name = "sensor_executor",
         .stack_usage_metric_key =
-            MEMFAULT_METRICS_KEY(memory_temperature_pct_max),
+            MEMFAULT_METRICS_KEY(memory_sensor_executor_pct_max),
     },
     {
-        .thread_name = "als",
-        .stack_usage_metric_key = MEMFAULT_METRICS_KEY(memory_als_pct_max),
+        .thread_name = "sensor_executor_bus",
+        .stack_usage_metric_key =
+            MEMFAULT_METRICS_KEY(memory_sensor_executor_bus_pct_max),
     },
     {
         .thread_name = "front_leds",
@@ -148,9 +141,4 @@ MEMFAULT_METRICS_DEFINE_THREAD_METRICS(
         .thread_name = "voltage_measurement_adc5",
         .stack_usage_metric_key =
             MEMFAULT_METRICS_KEY(memory_voltage_measurement_adc5_pct_max),
-    },
-    {
-        .thread_name = "voltage_measurement_publish",
-        .stack_usage_metric_key =
-            MEMFAULT_METRICS_KEY(memory_voltage_measurement_publish_pct_max),
     });
@@ -0,0 +1,189 @@
+#include "sensor_executor.h"
+#include "app_config.h"
+#include "orb_logs.h"
+#include <compilers.h>
+#include <zephyr/sys/slist.h>
+
+#ifdef CONFIG_SHELL
+#include <zephyr/shell/shell.h>
+#endif
+
+LOG_MODULE_REGISTER(sensor_executor, CONFIG_SENSOR_EXECUTOR_LOG_LEVEL);
+
+K_THREAD_STACK_DEFINE(stack_area_sensor_executor,
+                      THREAD_STACK_SIZE_SENSOR_EXECUTOR);
+static struct k_work_q sensor_executor_work_queue;
+K_THREAD_STACK_DEFINE(stack_area_sensor_executor_bus,
+                      THREAD_STACK_SIZE_SENSOR_EXECUTOR_BUS);
+static struct k_work_q sensor_executor_bus_work_queue;
+static bool initialized = false;
+
+// all the started jobs, for statistics
+static sys_slist_t jobs = SYS_SLIST_STATIC_INIT(&jobs);
+
+// protects job periods and deadlines, modified from the executor thread
+// and from the modules changing the job period
+static struct k_spinlock lock;
+
+static struct k_work_q *
+job_queue(const sensor_job_t *job)
+{
+    return job->bus ? &sensor_executor_bus_work_queue
+                    : &sensor_executor_work_queue;
+}
+
+static void
+sensor_executor_handler(struct k_work *work)
+{
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    sensor_job_t *job = CONTAINER_OF(dwork, sensor_job_t, work);
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    const int64_t deadline_ms = job->deadline_ms;
+    k_spin_unlock(&lock, key);
+
+    const int64_t start_ms = k_uptime_get();
+    const uint32_t start_cyc = k_cycle_get_32();
+    job->step();
+    const uint32_t runtime_us =
+        k_cyc_to_us_floor32(k_cycle_get_32() - start_cyc);
+
+    job->stats.runs++;
+    job->stats.runtime_total_us += runtime_us;
+    job->stats.runtime_max_us = MAX(job->stats.runtime_max_us, runtime_us);
+    if (start_ms > deadline_ms) {
+        job->stats.latency_max_ms =
+            MAX(job->stats.latency_max_ms, (uint32_t)(start_ms - deadline_ms));
+    }
+
+    key = k_spin_lock(&lock);
+    if (job->period_ms != 0 && job->deadline_ms == deadline_ms) {
+        // period unchanged during the step: next deadline, unless it's
+        // already missed, in which case the job is rescheduled from now on
+        // rather than run back to back
+        job->deadline_ms += job->period_ms;
+        const int64_t now_ms = k_uptime_get();
+        if (job->deadline_ms <= now_ms) {
+            job->stats.overruns++;
+            job->deadline_ms = now_ms + job->period_ms;
+        }
+        (void)k_work_schedule_for_queue(job_queue(job), &job->work,
+                                        K_TIMEOUT_ABS_MS(job->deadline_ms));
+    }
+    k_spin_unlock(&lock, key);
+}
+
+int
+sensor_executor_init(void)
+{
+    if (initialized) {
+        return RET_ERROR_ALREADY_INITIALIZED;
+    }
+
+    k_work_queue_init(&sensor_executor_work_queue);
+    const struct k_work_queue_config config = {
+        .name = "sensor_executor", .no_yield = false, .essential = false};
+    k_work_queue_start(&sensor_executor_work_queue, stack_area_sensor_executor,
+                       K_THREAD_STACK_SIZEOF(stack_area_sensor_executor),
+                       THREAD_PRIORITY_SENSOR_EXECUTOR, &config);
+
+    k_work_queue_init(&sensor_executor_bus_work_queue);
+    const struct k_work_queue_config bus_config = {
+        .name = "sensor_executor_bus", .no_yield = false, .essential = false};
+    k_work_queue_start(&sensor_executor_bus_work_queue,
+                       stack_area_sensor_executor_bus,
+                       K_THREAD_STACK_SIZEOF(stack_area_sensor_executor_bus),
+                       THREAD_PRIORITY_SENSOR_EXECUTOR_BUS, &bus_config);
+    initialized = true;
+
+    return RET_SUCCESS;
+}
+
+int
+sensor_executor_job_start(sensor_job_t *job, uint32_t period_ms,
+                          uint32_t delay_ms)
+{
+    if (!initialized) {
+        return RET_ERROR_NOT_INITIALIZED;
+    }
+    if (job == NULL || job->step == NULL) {
+        return RET_ERROR_INVALID_PARAM;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    if (sys_slist_find(&jobs, &job->node, NULL)) {
+        k_spin_unlock(&lock, key);
+        return RET_ERROR_ALREADY_INITIALIZED;
+    }
+
+    k_work_init_delayable(&job->work, sensor_executor_handler);
+    sys_slist_append(&jobs, &job->node);
+    job->period_ms = period_ms;
+    job->deadline_ms = k_uptime_get() + delay_ms;
+    (void)k_work_schedule_for_queue(job_queue(job), &job->work,
+                                    K_TIMEOUT_ABS_MS(job->deadline_ms));
+    k_spin_unlock(&lock, key);
+
+    return RET_SUCCESS;
+}
+
+void
+sensor_executor_job_set_period(sensor_job_t *job, uint32_t period_ms)
+{
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    if (!sys_slist_find(&jobs, &job->node, NULL)) {
+        // not started yet, period given when starting the job
+        k_spin_unlock(&lock, key);
+        return;
+    }
+
+    job->period_ms = period_ms;
+    job->deadline_ms = k_uptime_get() + period_ms;
+    if (period_ms == 0) {
+        (void)k_work_cancel_delayable(&job->work);
+    } else {
+        (void)k_work_reschedule_for_queue(job_queue(job), &job->work,
+                                          K_TIMEOUT_ABS_MS(job->deadline_ms));
+    }
+    k_spin_unlock(&lock, key);
+}
+
+static uint32_t
+runtime_avg_us(const sensor_job_t *job)
+{
+    if (job->stats.runs == 0) {
+        return 0;
+    }
+    return (uint32_t)(job->stats.runtime_total_us / job->stats.runs);
+}
+
+void
+sensor_executor_print(const struct shell *sh)
+{
+    sensor_job_t *job;
+
+#ifdef CONFIG_SHELL
+    if (sh != NULL) {
+        shell_print(sh, "period [ms] runs overruns avg [us] max [us] "
+                        "max latency [ms] job");
+        SYS_SLIST_FOR_EACH_CONTAINER(&jobs, job, node) {
+            shell_print(sh, "%11u %4u %8u %8u %8u %16u %s%s",
+                        job->period_ms, job->stats.runs, job->stats.overruns,
+                        runtime_avg_us(job), job->stats.runtime_max_us,
+                        job->stats.latency_max_ms, job->name,
+                        job->bus ? " (bus)" : "");
+        }
+        return;
+    }
+#else
+    UNUSED_PARAMETER(sh);
+#endif
+
+    SYS_SLIST_FOR_EACH_CONTAINER(&jobs, job, node) {
+        LOG_INF("%s: period %u ms, runs %u, overruns %u, avg %u us, max %u "
+                "us, max latency %u ms",
+                job->name, job->period_ms, job->stats.runs,
+                job->stats.overruns, runtime_avg_us(job),
+                job->stats.runtime_max_us, job->stats.latency_max_ms);
+    }
+}
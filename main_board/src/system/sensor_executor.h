@@ -0,0 +1,96 @@
+#pragma once
+
+#include <errors.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+struct shell;
+
+/**
+ * Sensor executor: periodic jobs (sensor polling, publishing of measurements)
+ * sharing two threads, instead of a thread and a stack per module.
+ *
+ * Each job is released at its deadline and runs on a work queue, so jobs of
+ * a queue run in deadline order. Deadlines are absolute (`previous + period`)
+ * so that the period doesn't drift with the job runtime. A job step must not
+ * block for long: it delays all the other jobs of its queue.
+ *
+ * Jobs accessing a shared sensor bus (I2C) wait for the bus with bounded
+ * timeouts and run on their own queue, so that a stuck bus doesn't delay the
+ * other jobs (fan tachometer, cone button, voltages publishing).
+ *
+ * Runtime and release latency of each job are recorded.
+ */
+
+typedef struct {
+    const char *name;
+    void (*step)(void);
+    bool bus; // step accesses a shared sensor bus
+
+    // private, use the functions below
+    struct k_work_delayable work;
+    uint32_t period_ms; // 0 if suspended
+    int64_t deadline_ms;
+    struct {
+        uint32_t runs;
+        uint32_t overruns; // deadlines missed by more than one period
+        uint32_t runtime_max_us;
+        uint64_t runtime_total_us;
+        uint32_t latency_max_ms;
+    } stats;
+    sys_snode_t node;
+} sensor_job_t;
+
+#define SENSOR_JOB_INITIALIZER(_name, _step)                                   \
+    {                                                                          \
+        .name = _name, .step = _step                                           \
+    }
+
+/// Job whose step accesses a shared sensor bus
+#define SENSOR_JOB_BUS_INITIALIZER(_name, _step)                               \
+    {                                                                          \
+        .name = _name, .step = _step, .bus = true                              \
+    }
+
+/**
+ * Start the executor threads, before any job is started
+ *
+ * @retval RET_SUCCESS on success
+ * @retval RET_ERROR_ALREADY_INITIALIZED if already started
+ */
+int
+sensor_executor_init(void);
+
+/**
+ * Start running a job periodically
+ *
+ * @param job Job to run
+ * @param period_ms Period between two runs, 0 to run the job once and then
+ *  keep it suspended until a period is set
+ * @param delay_ms Delay before the first run
+ * @retval RET_SUCCESS on success
+ * @retval RET_ERROR_NOT_INITIALIZED executor not started
+ * @retval RET_ERROR_ALREADY_INITIALIZED job already started
+ */
+int
+sensor_executor_job_start(sensor_job_t *job, uint32_t period_ms,
+                          uint32_t delay_ms);
+
+/**
+ * Change the period of a started job, the next run happens one new period
+ * from now. No effect on jobs not started yet.
+ *
+ * @param job Started job
+ * @param period_ms New period, 0 to suspend the job
+ */
+void
+sensor_executor_job_set_period(sensor_job_t *job, uint32_t period_ms);
+
+/**
+ * Print runtime statistics of each job on the shell if `sh` is provided,
+ * into the logs otherwise
+ *
+ * @param sh Shell instance or NULL
+ */
+void
+sensor_executor_print(const struct shell *sh);
@@ -1,6 +1,10 @@
 #include <compilers.h>
 #include <zephyr/tracing/tracing.h>
 
+#if defined(CONFIG_CPU_USAGE_PROFILER)
+#include "cpu_usage.h"
+#endif
+
 #ifndef CONFIG_TRACING_USER
 #warning                                                                       \
     "CONFIG_TRACING_USER is not set, tracing will not be available, the source file can be removed from the build"
@@ -25,3 +29,14 @@ sys_trace_sys_init_exit_user(const struct init_entry *entry, int level,
         HALT_IF_DEBUGGING();
     }
 }
+
+#if defined(CONFIG_CPU_USAGE_PROFILER)
+/**
+ * Count context switches, see cpu_usage.h
+ */
+void
+sys_trace_thread_switched_in_user(void)
+{
+    cpu_usage_thread_switched_in();
+}
+#endif
@@ -2,8 +2,11 @@
 #include "orb_logs.h"
 #include "pubsub/pubsub.h"
 #include <app_assert.h>
+#include <boot_stages.h>
 #include <can_messaging.h>
 #include <dfu.h>
+#include <stdio.h>
+#include <storage.h>
 #include <zephyr/drivers/adc.h>
 #include <zephyr/drivers/gpio.h>
 
@@ -113,6 +116,77 @@ static orb_mcu_Hardware board_versions = {
     .reset_board =
         orb_mcu_Hardware_ResetBoardVersion_RESET_BOARD_VERSION_UNKNOWN};
 
+/// Bootloader stages timing of the current boot, see boot_stages.h
+static struct boot_stages_t boot_stages;
+
+static const char *const boot_stages_str[BOOT_STAGE_COUNT] = {
+    [BOOT_STAGE_MAIN] = "main",
+    [BOOT_STAGE_BOOT_GO] = "boot_go",
+    [BOOT_STAGE_SECONDARY_CHECK] = "secondary_check",
+    [BOOT_STAGE_UPDATE] = "update",
+    [BOOT_STAGE_PRIMARY_CHECK] = "primary_check",
+    [BOOT_STAGE_BOOT_GO_DONE] = "boot_go_done",
+    [BOOT_STAGE_JUMP] = "jump",
+};
+
+static void
+version_boot_stages_load(void)
+{
+    int ret = backup_regs_read(BOOT_STAGES_BACKUP_REGS_OFFSET, &boot_stages,
+                               sizeof(boot_stages));
+    if (ret != 0 || boot_stages.magic != BOOT_STAGES_MAGIC) {
+        // power cycle or bootloader not reporting its stages
+        memset(&boot_stages, 0, sizeof(boot_stages));
+        return;
+    }
+
+    // invalidate so that a reset through an older bootloader doesn't report
+    // these stages again
+    const uint32_t magic = 0;
+    ret = backup_regs_write(BOOT_STAGES_BACKUP_REGS_OFFSET, &magic,
+                            sizeof(magic));
+    if (ret != 0) {
+        LOG_WRN("Unable to clear boot stages: %d", ret);
+    }
+}
+
+/// Print the bootloader stages timestamps, in microseconds since the
+/// bootloader started, on the shell if `sh` is provided, into the logs
+/// otherwise (sent to the Jetson)
+static void
+version_boot_stages_print(void *sh)
+{
+    char str[160];
+    int len = 0;
+
+    // no stage recorded: nothing printed after the header
+    str[0] = '\0';
+    if (boot_stages.magic != BOOT_STAGES_MAGIC) {
+        (void)snprintf(str, sizeof(str), " unknown");
+    } else {
+        for (size_t i = 0; i < BOOT_STAGE_COUNT; ++i) {
+            // skip stages that didn't happen
+            if (boot_stages.timestamp_us[i] != 0 && len >= 0 &&
+                (size_t)len < sizeof(str)) {
+                len += snprintf(&str[len], sizeof(str) - len, " %s=%u",
+                                boot_stages_str[i],
+                                boot_stages.timestamp_us[i]);
+            }
+        }
+    }
+
+#ifdef CONFIG_SHELL
+    if (sh != NULL) {
+        shell_print((const struct shell *)sh, "Bootloader stages [us]:%s",
+                    str);
+        return;
+    }
+#else
+    UNUSED_PARAMETER(sh);
+#endif
+    LOG_INF("Bootloader stages [us]:%s", str);
+}
+
 int
 version_fw_send(uint32_t remote)
 {
@@ -137,6 +211,9 @@ version_fw_send(uint32_t remote)
         versions.secondary_app.commit_hash = version.iv_build_num;
     }
 
+    // not part of the versions message, reported through the logs
+    version_boot_stages_print(NULL);
+
     return publish_new(&versions, sizeof(versions),
                        orb_mcu_main_McuToJetson_versions_tag, remote);
 }
@@ -511,6 +588,8 @@ version_hw_send(uint32_t remote)
 int
 version_init(void)
 {
+    version_boot_stages_load();
+
     return version_fetch_hardware_rev(&board_versions);
 }
 
@@ -582,7 +661,7 @@ version_print(void *sh)
         shell_print(sh, "Firmware version: %u.%u.%u, commit: 0x%x",
                     version.iv_major, version.iv_minor, version.iv_revision,
                     version.iv_build_num);
-
+        version_boot_stages_print(sh);
     } else
 #else
     UNUSED_PARAMETER(sh);
@@ -595,6 +674,7 @@ version_print(void *sh)
                 hw.power_board, hw.front_unit, hw.reset_board);
         LOG_INF("Firmware version: %u.%u.%u, commit: 0x%x", version.iv_major,
                 version.iv_minor, version.iv_revision, version.iv_build_num);
+        version_boot_stages_print(NULL);
     }
 }
 
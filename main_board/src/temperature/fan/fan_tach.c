@@ -4,6 +4,9 @@
 #include <stm32_ll_rcc.h>
 #include <stm32g474xx.h>
 #include <stm32g4xx_ll_tim.h>
+#include <system/cpu_usage.h>
+#include <system/isr_trace.h>
+#include <system/sensor_executor.h>
 #include <system/stm32_timer_utils/stm32_timer_utils.h>
 #include <temperature/fan/fan.h>
 #include <zephyr/device.h>
@@ -15,9 +18,6 @@
 #include "orb_logs.h"
 LOG_MODULE_REGISTER(fan_tach, CONFIG_FAN_TACH_LOG_LEVEL);
 
-static K_THREAD_STACK_DEFINE(stack_area, THREAD_STACK_SIZE_FAN_TACH);
-static struct k_thread thread_data;
-
 enum isr_state {
     AWAITING_FIRST_SAMPLE,
     AWAITING_SECOND_SAMPLE,
@@ -159,6 +159,7 @@ static void
 fan_tachometer_isr(void *arg)
 {
     struct timer_info *timer_info = (struct timer_info *)arg;
+    const uint32_t isr_start = cpu_usage_isr_enter();
 
     if (is_active_timer_cc_overrun[timer_info->channel - 1](
             timer_info->timer)) {
@@ -169,6 +170,9 @@ fan_tachometer_isr(void *arg)
             timer_info->timer);
         LL_TIM_ClearFlag_UPDATE(timer_info->timer);
     } else if (LL_TIM_IsActiveFlag_UPDATE(timer_info->timer)) {
+        ISR_TRACE_LATENCY(
+            CPU_USAGE_ISR_FAN_TACH,
+            isr_trace_timer_elapsed_cycles(timer_info->timer, 0));
         if (timer_info->state != AWAITING_TIMER_EXPIRATION) {
             atomic_set(&timer_info->rpm, 0);
         } else {
@@ -196,16 +200,26 @@ fan_tachometer_isr(void *arg)
         if (timer_info->state == AWAITING_FIRST_SAMPLE) {
             timer_info->first_cc_value =
                 get_timer_cc_value[timer_info->channel - 1](timer_info->timer);
+            ISR_TRACE_LATENCY(
+                CPU_USAGE_ISR_FAN_TACH,
+                isr_trace_timer_elapsed_cycles(timer_info->timer,
+                                               timer_info->first_cc_value));
             timer_info->state = AWAITING_SECOND_SAMPLE;
         } else if (timer_info->state == AWAITING_SECOND_SAMPLE) {
             timer_info->second_cc_value =
                 get_timer_cc_value[timer_info->channel - 1](timer_info->timer);
+            ISR_TRACE_LATENCY(
+                CPU_USAGE_ISR_FAN_TACH,
+                isr_trace_timer_elapsed_cycles(timer_info->timer,
+                                               timer_info->second_cc_value));
             timer_info->state = AWAITING_TIMER_EXPIRATION;
             LL_TIM_CC_DisableChannel(timer_info->timer,
                                      ch2ll[timer_info->channel - 1]);
         }
         clear_timer_cc_flag[timer_info->channel - 1](timer_info->timer);
     }
+
+    cpu_usage_isr_exit(CPU_USAGE_ISR_FAN_TACH, isr_start);
 }
 
 uint32_t
@@ -267,63 +281,63 @@ config_timer(struct timer_info *timer_info)
     return RET_SUCCESS;
 }
 
+#define FAN_TACH_PERIOD_MS 1000
+
 static void
-fan_tach_thread()
+fan_tach_step(void)
 {
     orb_mcu_main_FanStatus fs;
 
-    while (1) {
-        k_msleep(1000);
-
-        uint32_t main_speed = fan_tach_get_main_speed();
-        uint32_t aux_speed = fan_tach_get_aux_speed();
+    uint32_t main_speed = fan_tach_get_main_speed();
+    uint32_t aux_speed = fan_tach_get_aux_speed();
 
-        if (main_speed == UINT32_MAX) {
-            LOG_ERR("Internal error getting main fan speed!");
-        }
-        if (aux_speed == UINT32_MAX) {
-            LOG_ERR("Internal error getting aux fan speed!");
-        }
+    if (main_speed == UINT32_MAX) {
+        LOG_ERR("Internal error getting main fan speed!");
+    }
+    if (aux_speed == UINT32_MAX) {
+        LOG_ERR("Internal error getting aux fan speed!");
+    }
 
-        LOG_DBG("main fan speed = %" PRIu32 "RPM", main_speed);
-        LOG_DBG("aux fan speed = %" PRIu32 "RPM", aux_speed);
+    LOG_DBG("main fan speed = %" PRIu32 "RPM", main_speed);
+    LOG_DBG("aux fan speed = %" PRIu32 "RPM", aux_speed);
 
-        bool speed_sent = false;
+    bool speed_sent = false;
 
-        // Only if all fans report a speed of 0 do we send 0
+    // Only if all fans report a speed of 0 do we send 0
 
-        if (main_speed != 0 && main_speed != UINT32_MAX) {
-            fs.measured_speed_rpm = main_speed;
-            fs.fan_id = orb_mcu_main_FanStatus_FanID_MAIN;
-            publish_new(&fs, sizeof fs, orb_mcu_main_McuToJetson_fan_status_tag,
-                        CONFIG_CAN_ADDRESS_MCU_TO_JETSON_TX);
-            speed_sent = true;
-        }
-        if (aux_speed != 0 && aux_speed != UINT32_MAX) {
-            fs.measured_speed_rpm = aux_speed;
-            fs.fan_id = orb_mcu_main_FanStatus_FanID_AUX;
-            publish_new(&fs, sizeof fs, orb_mcu_main_McuToJetson_fan_status_tag,
-                        CONFIG_CAN_ADDRESS_MCU_TO_JETSON_TX);
-            speed_sent = true;
-        }
+    if (main_speed != 0 && main_speed != UINT32_MAX) {
+        fs.measured_speed_rpm = main_speed;
+        fs.fan_id = orb_mcu_main_FanStatus_FanID_MAIN;
+        publish_new(&fs, sizeof fs, orb_mcu_main_McuToJetson_fan_status_tag,
+                    CONFIG_CAN_ADDRESS_MCU_TO_JETSON_TX);
+        speed_sent = true;
+    }
+    if (aux_speed != 0 && aux_speed != UINT32_MAX) {
+        fs.measured_speed_rpm = aux_speed;
+        fs.fan_id = orb_mcu_main_FanStatus_FanID_AUX;
+        publish_new(&fs, sizeof fs, orb_mcu_main_McuToJetson_fan_status_tag,
+                    CONFIG_CAN_ADDRESS_MCU_TO_JETSON_TX);
+        speed_sent = true;
+    }
 
-        if (!speed_sent) {
-            fs.measured_speed_rpm = 0;
-            fs.fan_id = orb_mcu_main_FanStatus_FanID_MAIN;
-            publish_new(&fs, sizeof fs, orb_mcu_main_McuToJetson_fan_status_tag,
-                        CONFIG_CAN_ADDRESS_MCU_TO_JETSON_TX);
-            fs.fan_id = orb_mcu_main_FanStatus_FanID_AUX;
-            publish_new(&fs, sizeof fs, orb_mcu_main_McuToJetson_fan_status_tag,
-                        CONFIG_CAN_ADDRESS_MCU_TO_JETSON_TX);
-        }
+    if (!speed_sent) {
+        fs.measured_speed_rpm = 0;
+        fs.fan_id = orb_mcu_main_FanStatus_FanID_MAIN;
+        publish_new(&fs, sizeof fs, orb_mcu_main_McuToJetson_fan_status_tag,
+                    CONFIG_CAN_ADDRESS_MCU_TO_JETSON_TX);
+        fs.fan_id = orb_mcu_main_FanStatus_FanID_AUX;
+        publish_new(&fs, sizeof fs, orb_mcu_main_McuToJetson_fan_status_tag,
+                    CONFIG_CAN_ADDRESS_MCU_TO_JETSON_TX);
     }
 }
 
+static sensor_job_t fan_tach_job =
+    SENSOR_JOB_INITIALIZER("fan_tach", fan_tach_step);
+
 ret_code_t
 fan_tach_init(void)
 {
     ret_code_t ret;
-    k_tid_t thread_id;
     ret = enable_clocks_and_configure_pins(all_pclken, ARRAY_SIZE(all_pclken),
                                            pin_controls,
                                            ARRAY_SIZE(pin_controls));
@@ -348,11 +362,6 @@ fan_tach_init(void)
     }
 #endif
 
-    thread_id = k_thread_create(&thread_data, stack_area,
-                                K_THREAD_STACK_SIZEOF(stack_area),
-                                (k_thread_entry_t)fan_tach_thread, NULL, NULL,
-                                NULL, THREAD_PRIORITY_FAN_TACH, 0, K_NO_WAIT);
-    k_thread_name_set(thread_id, "fan_tach");
-
-    return RET_SUCCESS;
+    return sensor_executor_job_start(&fan_tach_job, FAN_TACH_PERIOD_MS,
+                                     FAN_TACH_PERIOD_MS);
 }
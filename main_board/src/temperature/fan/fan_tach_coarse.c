@@ -6,6 +6,8 @@
 #include <app_config.h>
 #include <main.pb.h>
 #include <pubsub/pubsub.h>
+#include <system/cpu_usage.h>
+#include <system/sensor_executor.h>
 #include <utils.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/pwm.h>
@@ -17,9 +19,6 @@ LOG_MODULE_REGISTER(fan_tach, CONFIG_FAN_TACH_LOG_LEVEL);
 
 ORB_STATE_MODULE_DECLARE(fan_tach);
 
-static K_THREAD_STACK_DEFINE(stack_area, THREAD_STACK_SIZE_FAN_TACH);
-static struct k_thread thread_data;
-
 static const struct gpio_dt_spec pwm_tach_gpio =
     GPIO_DT_SPEC_GET(DT_PATH(zephyr_user), fan_main_tach_gpios);
 static struct gpio_callback pwm_gpio_callback;
@@ -34,51 +33,53 @@ fan_tach_get_main_speed(void)
     return fan_speed_rpm;
 }
 
+#define FAN_TACH_PERIOD_MS 1000
+
 static void
-fan_tach_thread()
+fan_tach_step(void)
 {
     orb_mcu_main_FanStatus fs;
 
-    while (true) {
-        k_msleep(1000);
-
-        if (capture_ms != 0 && rising_edge_counter != 0) {
-            // per bub0812hn datasheet:
-            // fan running for 4 poles <=> 4 edges per revolution <=> 2 rising
-            // edges
-            CRITICAL_SECTION_ENTER(k);
-            const double period =
-                (double)capture_ms / (double)rising_edge_counter * 2.0
-                /* 2 rising edges per revolution */;
-            capture_ms = 0;
-            rising_edge_counter = 0;
-            fan_speed_rpm = (uint32_t)(1000.0 * 60.0 / period);
-            CRITICAL_SECTION_EXIT(k);
-        } else {
-            fan_speed_rpm = 0;
-        }
+    if (capture_ms != 0 && rising_edge_counter != 0) {
+        // per bub0812hn datasheet:
+        // fan running for 4 poles <=> 4 edges per revolution <=> 2 rising
+        // edges
+        CRITICAL_SECTION_ENTER(k);
+        const double period =
+            (double)capture_ms / (double)rising_edge_counter * 2.0
+            /* 2 rising edges per revolution */;
+        capture_ms = 0;
+        rising_edge_counter = 0;
+        fan_speed_rpm = (uint32_t)(1000.0 * 60.0 / period);
+        CRITICAL_SECTION_EXIT(k);
+    } else {
+        fan_speed_rpm = 0;
+    }
 
-        LOG_INF("%llu rpm", fan_speed_rpm);
+    LOG_INF("%llu rpm", fan_speed_rpm);
 
-        fs.measured_speed_rpm = fan_speed_rpm;
-        fs.fan_id = orb_mcu_main_FanStatus_FanID_MAIN;
-        (void)publish_new(&fs, sizeof fs,
-                          orb_mcu_main_McuToJetson_fan_status_tag,
-                          CONFIG_CAN_ADDRESS_MCU_TO_JETSON_TX);
-    }
+    fs.measured_speed_rpm = fan_speed_rpm;
+    fs.fan_id = orb_mcu_main_FanStatus_FanID_MAIN;
+    (void)publish_new(&fs, sizeof fs, orb_mcu_main_McuToJetson_fan_status_tag,
+                      CONFIG_CAN_ADDRESS_MCU_TO_JETSON_TX);
 }
 
+static sensor_job_t fan_tach_job =
+    SENSOR_JOB_INITIALIZER("fan_tach", fan_tach_step);
+
 static void
 fan_tach_event_handler(const struct device *dev, struct gpio_callback *cb,
                        uint32_t pins)
 {
     UNUSED(dev);
     UNUSED(cb);
+    const uint32_t isr_start = cpu_usage_isr_enter();
 
     static uint64_t last_capture = 0;
     if (pins & BIT(pwm_tach_gpio.pin)) {
         if (last_capture == 0) {
             last_capture = k_uptime_ticks();
+            cpu_usage_isr_exit(CPU_USAGE_ISR_FAN_TACH, isr_start);
             return; // first capture, ignore
         }
 
@@ -87,16 +88,19 @@ fan_tach_event_handler(const struct device *dev, struct gpio_callback *cb,
         rising_edge_counter++;
         last_capture = tick;
     }
+
+    cpu_usage_isr_exit(CPU_USAGE_ISR_FAN_TACH, isr_start);
 }
 
 ret_code_t
 fan_tach_init(void)
 {
     int err_code;
-    k_thread_create(&thread_data, stack_area, K_THREAD_STACK_SIZEOF(stack_area),
-                    (k_thread_entry_t)fan_tach_thread, NULL, NULL, NULL,
-                    THREAD_PRIORITY_FAN_TACH, 0, K_NO_WAIT);
-    k_thread_name_set(&thread_data, "fan_tach");
+    err_code = sensor_executor_job_start(&fan_tach_job, FAN_TACH_PERIOD_MS,
+                                         FAN_TACH_PERIOD_MS);
+    if (err_code) {
+        goto exit;
+    }
 
     // set up GPIO interrupt
     if (!gpio_is_ready_dt(&pwm_tach_gpio)) {
@@ -3,6 +3,7 @@
 #include "orb_state.h"
 #include "pubsub/pubsub.h"
 #include "system/diag.h"
+#include "system/sensor_executor.h"
 #include "temperature/fan/fan.h"
 #include "voltage_measurement/voltage_measurement.h"
 #include <app_assert.h>
@@ -464,12 +465,13 @@ static struct sensor_and_channel sensors_and_channels[] = {
 BUILD_ASSERT(TEMPERATURE_SENSOR_COUNT == ARRAY_SIZE(sensors_and_channels),
              "Count must match sensors_and_channels size");
 
-static K_THREAD_STACK_DEFINE(stack_area, THREAD_STACK_SIZE_TEMPERATURE);
-static struct k_thread temperature_thread_data;
-static k_tid_t thread_id = NULL;
-
 static volatile k_timeout_t global_sample_period;
 
+static void
+temperature_step(void);
+static sensor_job_t temperature_job =
+    SENSOR_JOB_BUS_INITIALIZER("temperature", temperature_step);
+
 static void
 init_sensor_and_channel(struct sensor_and_channel *x)
 {
@@ -518,7 +520,9 @@ temperature_set_sampling_period_ms(uint32_t sample_period)
 
     global_sample_period =
         K_MSEC(sample_period / TEMPERATURE_AVERAGE_SAMPLE_COUNT);
-    k_wakeup(thread_id);
+    sensor_executor_job_set_period(&temperature_job,
+                                   sample_period /
+                                       TEMPERATURE_AVERAGE_SAMPLE_COUNT);
 
     return RET_SUCCESS;
 }
@@ -674,53 +678,46 @@ sample_and_report_temperature(struct sensor_and_channel *sensor_and_channel)
     }
 }
 
-_Noreturn static void
-temperature_thread()
+static void
+temperature_step(void)
 {
-    int64_t elapsed = 0;
-    for (;;) {
-        k_timeout_t sleep_duration = {.ticks =
-                                          global_sample_period.ticks - elapsed};
-        k_sleep(sleep_duration);
-
-        int64_t start = k_uptime_ticks();
-        for (size_t i = 0; i < ARRAY_SIZE(sensors_and_channels); ++i) {
-            sample_and_report_temperature(&sensors_and_channels[i]);
-        }
+    for (size_t i = 0; i < ARRAY_SIZE(sensors_and_channels); ++i) {
+        sample_and_report_temperature(&sensors_and_channels[i]);
+    }
 
 #if defined(CONFIG_BOARD_DIAMOND_MAIN)
-        // on diamond, there are many temperature sensors on the front unit
-        // so average all the temperature sensors before reporting
-        // and checking for overtemperature conditions
-        int32_t front_unit_avg = 0;
-        int32_t front_unit_count = 0;
-        for (size_t i = 0; i < ARRAY_SIZE(sensors_and_channels); ++i) {
-            if (sensors_and_channels[i].temperature_source >=
-                    orb_mcu_Temperature_TemperatureSource_FRONT_UNIT_850_730_LEFT_TOP &&
-                sensors_and_channels[i].temperature_source <=
-                    orb_mcu_Temperature_TemperatureSource_FRONT_UNIT_WHITE_RGB_LEFT_BOT &&
-                sensors_and_channels[i].average != TEMPERATURE_SENTINEL_VALUE) {
-                front_unit_avg += sensors_and_channels[i].average;
-                front_unit_count++;
-            }
+    // on diamond, there are many temperature sensors on the front unit
+    // so average all the temperature sensors before reporting
+    // and checking for overtemperature conditions
+    int32_t front_unit_avg = 0;
+    int32_t front_unit_count = 0;
+    const orb_mcu_Temperature_TemperatureSource front_unit_first =
+        orb_mcu_Temperature_TemperatureSource_FRONT_UNIT_850_730_LEFT_TOP;
+    const orb_mcu_Temperature_TemperatureSource front_unit_last =
+        orb_mcu_Temperature_TemperatureSource_FRONT_UNIT_WHITE_RGB_LEFT_BOT;
+    for (size_t i = 0; i < ARRAY_SIZE(sensors_and_channels); ++i) {
+        const orb_mcu_Temperature_TemperatureSource source =
+            sensors_and_channels[i].temperature_source;
+        if (source >= front_unit_first && source <= front_unit_last &&
+            sensors_and_channels[i].average != TEMPERATURE_SENTINEL_VALUE) {
+            front_unit_avg += sensors_and_channels[i].average;
+            front_unit_count++;
         }
-        if (front_unit_count > 0) {
-            fu_avg_sensors.history[fu_avg_sensors.wr_idx] =
-                front_unit_avg / front_unit_count;
-            fu_avg_sensors.wr_idx =
-                (fu_avg_sensors.wr_idx + 1) % TEMPERATURE_AVERAGE_SAMPLE_COUNT;
-            if (fu_avg_sensors.wr_idx == 0) {
-                fu_avg_sensors.average = average(fu_avg_sensors.history);
-                LOG_DBG("%s: %d: %iC", fu_avg_sensors.sensor->name,
-                        fu_avg_sensors.temperature_source,
-                        fu_avg_sensors.average);
-                temperature_report_internal(&fu_avg_sensors);
-            }
+    }
+    if (front_unit_count > 0) {
+        fu_avg_sensors.history[fu_avg_sensors.wr_idx] =
+            front_unit_avg / front_unit_count;
+        fu_avg_sensors.wr_idx =
+            (fu_avg_sensors.wr_idx + 1) % TEMPERATURE_AVERAGE_SAMPLE_COUNT;
+        if (fu_avg_sensors.wr_idx == 0) {
+            fu_avg_sensors.average = average(fu_avg_sensors.history);
+            LOG_DBG("%s: %d: %iC", fu_avg_sensors.sensor->name,
+                    fu_avg_sensors.temperature_source,
+                    fu_avg_sensors.average);
+            temperature_report_internal(&fu_avg_sensors);
         }
-#endif
-
-        elapsed = (k_uptime_ticks() - start);
     }
+#endif
 }
 
 static int
@@ -819,15 +816,13 @@ temperature_init(const orb_mcu_Hardware *hw_version,
         init_sensor_and_channel(&sensors_and_channels[i]);
     }
 
-    if (thread_id == NULL) {
-        thread_id =
-            k_thread_create(&temperature_thread_data, stack_area,
-                            K_THREAD_STACK_SIZEOF(stack_area),
-                            (k_thread_entry_t)temperature_thread, NULL, NULL,
-                            NULL, THREAD_PRIORITY_TEMPERATURE, 0, K_NO_WAIT);
-        k_thread_name_set(thread_id, "temperature");
-    } else {
+    const uint32_t sample_period_ms = 1000 / TEMPERATURE_AVERAGE_SAMPLE_COUNT;
+    ret = sensor_executor_job_start(&temperature_job, sample_period_ms,
+                                    sample_period_ms);
+    if (ret == RET_ERROR_ALREADY_INITIALIZED) {
         LOG_ERR("Sampling already started");
+    } else {
+        ASSERT_SOFT(ret);
     }
 }
 
@@ -3,6 +3,7 @@
 #include "mcu.pb.h"
 #include "power/boot/boot.h"
 #include "pubsub/pubsub.h"
+#include "system/sensor_executor.h"
 #include <app_assert.h>
 #include <zephyr/device.h>
 #include <zephyr/drivers/gpio.h>
@@ -62,9 +63,6 @@ button_long_pressed(struct k_work *item)
 
 #if defined(CONFIG_BOARD_DIAMOND_MAIN) &&                                      \
     defined(CONFIG_DT_HAS_DIAMOND_CONE_ENABLED)
-K_THREAD_STACK_DEFINE(cone_button_thread_stack, THREAD_STACK_SIZE_CONE_BUTTON);
-static struct k_thread cone_button_thread_data = {0};
-
 static const struct gpio_dt_spec cone_button_gpio_spec =
     GPIO_DT_SPEC_GET(DT_PATH(zephyr_user), cone_button_gpios);
 
@@ -148,22 +146,22 @@ button_uninit(void)
 
 #if defined(CONFIG_BOARD_DIAMOND_MAIN) &&                                      \
     defined(CONFIG_DT_HAS_DIAMOND_CONE_ENABLED)
-_Noreturn static void
-cone_button_thread()
+static void
+cone_button_step(void)
 {
-    bool button_pressed_old_state = false;
-    while (1) {
-        bool button_pressed_new_state = gpio_pin_get_dt(&cone_button_gpio_spec);
-        if (!button_pressed_old_state && button_pressed_new_state) {
-            k_work_submit(&button_pressed_work);
-        } else if (button_pressed_old_state && !button_pressed_new_state) {
-            k_work_submit(&button_released_work);
-        }
-        button_pressed_old_state = button_pressed_new_state;
+    static bool button_pressed_old_state = false;
 
-        k_msleep(CONE_BUTTON_POLL_PERIOD_MS);
+    bool button_pressed_new_state = gpio_pin_get_dt(&cone_button_gpio_spec);
+    if (!button_pressed_old_state && button_pressed_new_state) {
+        k_work_submit(&button_pressed_work);
+    } else if (button_pressed_old_state && !button_pressed_new_state) {
+        k_work_submit(&button_released_work);
     }
+    button_pressed_old_state = button_pressed_new_state;
 }
+
+static sensor_job_t cone_button_job =
+    SENSOR_JOB_INITIALIZER("cone_button", cone_button_step);
 #endif
 
 int
@@ -216,11 +214,12 @@ button_init(void)
         if (err_code) {
             LOG_WRN("cone button configuration error");
         } else {
-            k_thread_create(&cone_button_thread_data, cone_button_thread_stack,
-                            K_THREAD_STACK_SIZEOF(cone_button_thread_stack),
-                            (k_thread_entry_t)cone_button_thread, NULL, NULL,
-                            NULL, THREAD_PRIORITY_CONE_BUTTON, 0, K_NO_WAIT);
-            k_thread_name_set(&cone_button_thread_data, "cone_button");
+            err_code = sensor_executor_job_start(&cone_button_job,
+                                                 CONE_BUTTON_POLL_PERIOD_MS, 0);
+            // already polled if the button is initialized again
+            if (err_code != RET_ERROR_ALREADY_INITIALIZED) {
+                ASSERT_SOFT(err_code);
+            }
         }
     }
 #endif
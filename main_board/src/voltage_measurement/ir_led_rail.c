@@ -0,0 +1,244 @@
+#include "ir_led_rail.h"
+#include "mcu.pb.h"
+#include "orb_logs.h"
+#include "pubsub/pubsub.h"
+#include "utils.h"
+#include "voltage_measurement.h"
+#include <app_config.h>
+#include <stdio.h>
+#include <stm32_ll_adc.h>
+#include <string.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
+
+LOG_MODULE_REGISTER(ir_led_rail, CONFIG_IR_LED_RAIL_LOG_LEVEL);
+
+#define VOLTAGE_MEASUREMENT_NODE DT_PATH(voltage_measurement)
+
+BUILD_ASSERT(DT_SAME_NODE(DT_IO_CHANNELS_CTLR_BY_NAME(VOLTAGE_MEASUREMENT_NODE,
+                                                      pvcc),
+                          DT_NODELABEL(adc1)),
+             "The injected triggers below are the ones of ADC1");
+
+#define RAIL_ADC ((ADC_TypeDef *)DT_REG_ADDR(DT_NODELABEL(adc1)))
+#define RAIL_ADC_CHANNEL                                                       \
+    __LL_ADC_DECIMAL_NB_TO_CHANNEL(                                            \
+        DT_IO_CHANNELS_INPUT_BY_NAME(VOLTAGE_MEASUREMENT_NODE, pvcc))
+
+// conversion: 47.5 + 12.5 cycles @ ADC_CLK = 42.5 MHz, ~1.4 µs
+#define CONVERSION_TIMEOUT_US 5
+
+// LED timers, see ir_camera_system_hw.c: their TRGO is the output compare
+// reference of the LED channels, high during the strobe
+static const uint32_t triggers[IR_LED_RAIL_COUNT] = {
+    [IR_LED_RAIL_850NM] = LL_ADC_INJ_TRIG_EXT_TIM15_TRGO,
+    [IR_LED_RAIL_940NM] = LL_ADC_INJ_TRIG_EXT_TIM3_TRGO,
+};
+
+static const char *const source_names[IR_LED_RAIL_COUNT] = {
+    [IR_LED_RAIL_850NM] = "850nm",
+    [IR_LED_RAIL_940NM] = "940nm",
+};
+
+static ir_led_rail_source_t rail_source = IR_LED_RAIL_NONE;
+static struct ir_led_rail_stats rail_stats[IR_LED_RAIL_COUNT];
+
+/**
+ * Restart the injected conversions on the LED timer of `source`, from rank 1:
+ * rank 1 is converted on the rising edge of the strobe, rank 2 on the falling
+ * edge.
+ * Interrupts must be locked.
+ */
+static void
+rail_adc_arm(ir_led_rail_source_t source)
+{
+    // the ADC is enabled by the driver when the voltage measurements start
+    if (!LL_ADC_IsEnabled(RAIL_ADC)) {
+        return;
+    }
+
+    if (LL_ADC_INJ_IsConversionOngoing(RAIL_ADC)) {
+        LL_ADC_INJ_StopConversion(RAIL_ADC);
+        while (LL_ADC_INJ_IsStopConversionOngoing(RAIL_ADC)) {
+        }
+    }
+
+    if (source >= IR_LED_RAIL_COUNT) {
+        return;
+    }
+
+    LL_ADC_INJ_ConfigQueueContext(
+        RAIL_ADC, triggers[source], LL_ADC_INJ_TRIG_EXT_RISINGFALLING,
+        LL_ADC_INJ_SEQ_SCAN_ENABLE_2RANKS, RAIL_ADC_CHANNEL, RAIL_ADC_CHANNEL,
+        RAIL_ADC_CHANNEL, RAIL_ADC_CHANNEL);
+    LL_ADC_ClearFlag_JEOC(RAIL_ADC);
+    LL_ADC_ClearFlag_JEOS(RAIL_ADC);
+    LL_ADC_INJ_StartConversion(RAIL_ADC);
+}
+
+void
+ir_led_rail_set_source(ir_led_rail_source_t source)
+{
+    if (source == rail_source) {
+        return;
+    }
+
+    rail_source = source;
+    rail_adc_arm(source);
+}
+
+static void
+stats_add(struct ir_led_rail_stats *stats, uint16_t start, uint16_t end)
+{
+    if (stats->strobes == 0) {
+        stats->start_min = start;
+        stats->start_max = start;
+        stats->end_min = end;
+        stats->end_max = end;
+    } else {
+        stats->start_min = MIN(stats->start_min, start);
+        stats->start_max = MAX(stats->start_max, start);
+        stats->end_min = MIN(stats->end_min, end);
+        stats->end_max = MAX(stats->end_max, end);
+    }
+
+    stats->start_sum += start;
+    stats->end_sum += end;
+    if (start > end) {
+        stats->droop_max = MAX(stats->droop_max, start - end);
+    }
+    stats->strobes++;
+}
+
+void
+ir_led_rail_strobe_end(void)
+{
+    if (rail_source >= IR_LED_RAIL_COUNT) {
+        return;
+    }
+    if (!LL_ADC_INJ_IsConversionOngoing(RAIL_ADC)) {
+        // ADC enabled since the source was set
+        rail_adc_arm(rail_source);
+        return;
+    }
+
+    // the end of the strobe triggered the second conversion together with
+    // this interrupt
+    const uint32_t timeout_cycles = k_us_to_cyc_ceil32(CONVERSION_TIMEOUT_US);
+    const uint32_t start_cycles = k_cycle_get_32();
+    while (!LL_ADC_IsActiveFlag_JEOS(RAIL_ADC) &&
+           (k_cycle_get_32() - start_cycles) < timeout_cycles) {
+    }
+
+    struct ir_led_rail_stats *stats = &rail_stats[rail_source];
+    if (!LL_ADC_IsActiveFlag_JEOS(RAIL_ADC)) {
+        // an edge was missed: restart the sequence to stay in step with the
+        // strobes
+        stats->missed++;
+        rail_adc_arm(rail_source);
+        return;
+    }
+
+    LL_ADC_ClearFlag_JEOC(RAIL_ADC);
+    LL_ADC_ClearFlag_JEOS(RAIL_ADC);
+    stats_add(stats,
+              LL_ADC_INJ_ReadConversionData12(RAIL_ADC, LL_ADC_INJ_RANK_1),
+              LL_ADC_INJ_ReadConversionData12(RAIL_ADC, LL_ADC_INJ_RANK_2));
+}
+
+ret_code_t
+ir_led_rail_get_stats(ir_led_rail_source_t source,
+                      struct ir_led_rail_stats *stats)
+{
+    if (source >= IR_LED_RAIL_COUNT || stats == NULL) {
+        return RET_ERROR_INVALID_PARAM;
+    }
+
+    CRITICAL_SECTION_ENTER(k);
+    *stats = rail_stats[source];
+    CRITICAL_SECTION_EXIT(k);
+
+    return RET_SUCCESS;
+}
+
+static int32_t
+raw_to_mv(uint32_t raw)
+{
+    int32_t mv = 0;
+    (void)voltage_measurement_raw_to_mv(CHANNEL_PVCC, (uint16_t)raw, &mv);
+    return mv;
+}
+
+static void
+report(ir_led_rail_source_t source, const struct ir_led_rail_stats *stats)
+{
+    orb_mcu_Log log = {0};
+    uint32_t start_mean = 0;
+    uint32_t end_mean = 0;
+
+    if (stats->strobes != 0) {
+        start_mean = stats->start_sum / stats->strobes;
+        end_mean = stats->end_sum / stats->strobes;
+    }
+
+    // mean/min/max in mV
+    snprintf(log.log, sizeof(log.log),
+             "ir led rail %s: n=%u missed=%u start=%d/%d/%d end=%d/%d/%d "
+             "droop=%d",
+             source_names[source], stats->strobes, stats->missed,
+             raw_to_mv(start_mean), raw_to_mv(stats->start_min),
+             raw_to_mv(stats->start_max), raw_to_mv(end_mean),
+             raw_to_mv(stats->end_min), raw_to_mv(stats->end_max),
+             raw_to_mv(stats->droop_max));
+    LOG_INF("%s", log.log);
+
+    (void)publish_new(&log, sizeof(log), orb_mcu_main_McuToJetson_log_tag,
+                      CONFIG_CAN_ADDRESS_MCU_TO_JETSON_TX);
+}
+
+static void
+report_work_handler(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(report_work, report_work_handler);
+
+static void
+report_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    struct ir_led_rail_stats snapshot[IR_LED_RAIL_COUNT];
+
+    CRITICAL_SECTION_ENTER(k);
+    memcpy(snapshot, rail_stats, sizeof(snapshot));
+    memset(rail_stats, 0, sizeof(rail_stats));
+    CRITICAL_SECTION_EXIT(k);
+
+    for (size_t i = 0; i < IR_LED_RAIL_COUNT; ++i) {
+        if (snapshot[i].strobes != 0 || snapshot[i].missed != 0) {
+            report(i, &snapshot[i]);
+        }
+    }
+
+    k_work_reschedule(&report_work,
+                      K_SECONDS(CONFIG_IR_LED_RAIL_REPORT_PERIOD_S));
+}
+
+void
+ir_led_rail_init(void)
+{
+    CRITICAL_SECTION_ENTER(k);
+
+    // CFGR can only be written between two sequences of regular conversions,
+    // which last a few hundred µs
+    while (LL_ADC_REG_IsConversionOngoing(RAIL_ADC)) {
+    }
+    // one rank converted per trigger edge
+    LL_ADC_INJ_SetSequencerDiscont(RAIL_ADC, LL_ADC_INJ_SEQ_DISCONT_1RANK);
+
+    rail_adc_arm(rail_source);
+
+    CRITICAL_SECTION_EXIT(k);
+
+    k_work_reschedule(&report_work,
+                      K_SECONDS(CONFIG_IR_LED_RAIL_REPORT_PERIOD_S));
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <errors.h>
+#include <stdint.h>
+
+/**
+ * Sampling of the IR LED supply (PVCC) synchronized with the strobes.
+ *
+ * The asynchronous voltage measurements run every millisecond and miss most
+ * of the IR LED pulses, which last a few milliseconds at most. Here, ADC1
+ * injected conversions are triggered by the output compare reference of the
+ * LED timer that drives the enabled LEDs: one conversion when the strobe
+ * starts and one when it ends, preempting the regular conversions of the
+ * voltage measurement module.
+ *
+ * Statistics are accumulated per wavelength from the camera exposure interrupt
+ * and reported periodically to the Jetson, see
+ * `CONFIG_IR_LED_RAIL_REPORT_PERIOD_S`.
+ */
+
+typedef enum {
+    IR_LED_RAIL_850NM,
+    IR_LED_RAIL_940NM,
+    IR_LED_RAIL_COUNT,
+} ir_led_rail_source_t;
+
+/// no IR LED enabled, strobes aren't sampled
+#define IR_LED_RAIL_NONE IR_LED_RAIL_COUNT
+
+/// statistics of the samples of one wavelength, raw ADC values
+struct ir_led_rail_stats {
+    uint32_t strobes;
+    /// strobes without both samples
+    uint32_t missed;
+    uint16_t start_min;
+    uint16_t start_max;
+    uint64_t start_sum;
+    uint16_t end_min;
+    uint16_t end_max;
+    uint64_t end_sum;
+    /// largest drop of the rail during a strobe
+    uint16_t droop_max;
+};
+
+/**
+ * Select the LED timer triggering the conversions, from the LED channels
+ * enabled by the IR camera system
+ *
+ * Interrupts must be locked.
+ *
+ * @param source Wavelength of the enabled LEDs or IR_LED_RAIL_NONE
+ */
+void
+ir_led_rail_set_source(ir_led_rail_source_t source);
+
+/**
+ * Collect the samples of the strobe that just ended, from the camera exposure
+ * interrupt
+ */
+void
+ir_led_rail_strobe_end(void);
+
+/**
+ * Copy the statistics of a wavelength since the last report
+ *
+ * @param source Wavelength
+ * @param stats Destination
+ * @retval RET_SUCCESS copied
+ * @retval RET_ERROR_INVALID_PARAM unknown wavelength or `stats` is NULL
+ */
+ret_code_t
+ir_led_rail_get_stats(ir_led_rail_source_t source,
+                      struct ir_led_rail_stats *stats);
+
+/**
+ * Start the periodic reports
+ */
+void
+ir_led_rail_init(void);
@@ -1,8 +1,11 @@
 #include "voltage_measurement.h"
 #include "app_config.h"
+#include "ir_led_rail.h"
 #include "orb_logs.h"
 #include "orb_state.h"
 #include "pubsub/pubsub.h"
+#include "system/cpu_usage.h"
+#include "system/sensor_executor.h"
 #include "utils.h"
 #include <app_assert.h>
 #include <zephyr/device.h>
@@ -27,10 +30,6 @@ K_THREAD_STACK_DEFINE(voltage_measurement_adc5_thread_stack,
                       THREAD_STACK_SIZE_VOLTAGE_MEASUREMENT_ADC5);
 static struct k_thread voltage_measurement_adc5_thread_data = {0};
 
-K_THREAD_STACK_DEFINE(voltage_measurement_publish_thread_stack,
-                      THREAD_STACK_SIZE_VOLTAGE_MEASUREMENT_PUBLISH);
-static struct k_thread voltage_measurement_publish_thread_data = {0};
-
 K_THREAD_STACK_DEFINE(voltage_measurement_self_test_thread_stack,
                       THREAD_STACK_SIZE_VOLTAGE_MEASUREMENT_SELFTEST);
 static struct k_thread voltage_self_test_data = {0};
@@ -171,7 +170,6 @@ static adc_samples_buffers_t adc_samples_buffers = {0};
 static orb_mcu_Hardware_OrbVersion hardware_version =
     orb_mcu_Hardware_OrbVersion_HW_VERSION_UNKNOWN;
 
-k_tid_t tid_publish = NULL;
 
 static atomic_t voltages_publish_period_ms = ATOMIC_INIT(0);
 
@@ -302,8 +300,8 @@ voltage_measurement_get_stats(adc_samples_buffers_t *samples_buffers,
 }
 
 ret_code_t
-voltage_measurement_get(const voltage_measurement_channel_t channel,
-                        int32_t *voltage_mv)
+voltage_measurement_raw_to_mv(voltage_measurement_channel_t channel,
+                              uint16_t adc_raw_value, int32_t *voltage_mv)
 {
     if (channel >= ARRAY_SIZE(adc_samples_buffers.raw) || voltage_mv == NULL) {
         return RET_ERROR_INVALID_PARAM;
@@ -313,12 +311,11 @@ voltage_measurement_get(const voltage_measurement_channel_t channel,
         return RET_ERROR_NOT_INITIALIZED;
     }
 
-    int32_t raw_value;
+    int32_t raw_value = adc_raw_value;
     uint16_t vrefint_raw;
 
     CRITICAL_SECTION_ENTER(k);
 
-    raw_value = adc_samples_buffers.raw[channel];
     vrefint_raw = adc_samples_buffers.raw[CHANNEL_VREFINT];
 
     CRITICAL_SECTION_EXIT(k);
@@ -344,6 +341,25 @@ voltage_measurement_get(const voltage_measurement_channel_t channel,
     return RET_SUCCESS;
 }
 
+ret_code_t
+voltage_measurement_get(const voltage_measurement_channel_t channel,
+                        int32_t *voltage_mv)
+{
+    if (channel >= ARRAY_SIZE(adc_samples_buffers.raw) || voltage_mv == NULL) {
+        return RET_ERROR_INVALID_PARAM;
+    }
+
+    uint16_t raw_value;
+
+    CRITICAL_SECTION_ENTER(k);
+
+    raw_value = adc_samples_buffers.raw[channel];
+
+    CRITICAL_SECTION_EXIT(k);
+
+    return voltage_measurement_raw_to_mv(channel, raw_value, voltage_mv);
+}
+
 ret_code_t
 voltage_measurement_get_raw(voltage_measurement_channel_t channel,
                             uint16_t *adc_raw_value)
@@ -377,6 +393,7 @@ adc1_callback(const struct device *dev, const struct adc_sequence *sequence,
     ARG_UNUSED(dev);
     ARG_UNUSED(sequence);
     ARG_UNUSED(sampling_index);
+    const uint32_t isr_start = cpu_usage_isr_enter();
 
     memcpy((void *)adc_samples_buffers.raw_adc1, (void *)adc1_samples_buffer,
            sizeof(adc_samples_buffers.raw_adc1));
@@ -395,6 +412,7 @@ adc1_callback(const struct device *dev, const struct adc_sequence *sequence,
         }
     }
 
+    cpu_usage_isr_exit(CPU_USAGE_ISR_ADC, isr_start);
     return ADC_ACTION_REPEAT;
 }
 
@@ -407,6 +425,7 @@ adc4_callback(const struct device *dev, const struct adc_sequence *sequence,
     ARG_UNUSED(dev);
     ARG_UNUSED(sequence);
     ARG_UNUSED(sampling_index);
+    const uint32_t isr_start = cpu_usage_isr_enter();
 
     memcpy((void *)adc_samples_buffers.raw_adc4, (void *)adc4_samples_buffer,
            sizeof(adc_samples_buffers.raw_adc4));
@@ -425,6 +444,7 @@ adc4_callback(const struct device *dev, const struct adc_sequence *sequence,
         }
     }
 
+    cpu_usage_isr_exit(CPU_USAGE_ISR_ADC, isr_start);
     return ADC_ACTION_REPEAT;
 }
 #endif
@@ -437,6 +457,7 @@ adc5_callback(const struct device *dev, const struct adc_sequence *sequence,
     ARG_UNUSED(dev);
     ARG_UNUSED(sequence);
     ARG_UNUSED(sampling_index);
+    const uint32_t isr_start = cpu_usage_isr_enter();
 
     memcpy((void *)&adc_samples_buffers.raw_adc5, (void *)adc5_samples_buffer,
            sizeof(adc_samples_buffers.raw_adc5));
@@ -455,6 +476,7 @@ adc5_callback(const struct device *dev, const struct adc_sequence *sequence,
         }
     }
 
+    cpu_usage_isr_exit(CPU_USAGE_ISR_ADC, isr_start);
     return ADC_ACTION_REPEAT;
 }
 
@@ -1009,26 +1031,26 @@ check_caps_voltages(bool with_logs)
 }
 #endif
 
-_Noreturn static void
-voltage_measurement_publish_thread()
+static void
+voltage_measurement_publish_step(void)
 {
-    // clear statistics to remove min/max values that occurred during booting
-    // the power supplies
-    reset_statistics();
-
-    while (1) {
-        atomic_val_t sleep_period_ms = atomic_get(&voltages_publish_period_ms);
-        if (sleep_period_ms == 0) {
-            k_sleep(K_FOREVER);
-        } else {
-            k_msleep(sleep_period_ms);
-        }
+    static bool statistics_reset = false;
 
-        (void)check_caps_voltages(false);
-        publish_all_voltages();
+    if (!statistics_reset) {
+        // clear statistics to remove min/max values that occurred during
+        // booting the power supplies, publish from the next period
+        reset_statistics();
+        statistics_reset = true;
+        return;
     }
+
+    (void)check_caps_voltages(false);
+    publish_all_voltages();
 }
 
+static sensor_job_t voltage_measurement_publish_job = SENSOR_JOB_INITIALIZER(
+    "voltage_measurement_publish", voltage_measurement_publish_step);
+
 void
 voltage_measurement_set_publish_period(uint32_t publish_period_ms)
 {
@@ -1038,7 +1060,8 @@ voltage_measurement_set_publish_period(uint32_t publish_period_ms)
     LOG_DBG("setting publish period to %d ms", capped_publish_period_ms);
 
     atomic_set(&voltages_publish_period_ms, capped_publish_period_ms);
-    k_wakeup(tid_publish);
+    sensor_executor_job_set_period(&voltage_measurement_publish_job,
+                                   capped_publish_period_ms);
 }
 
 static void
@@ -1233,24 +1256,23 @@ voltage_measurement_init(const orb_mcu_Hardware *hw_version,
     // module is initialized
     k_sleep(K_USEC(2 * ADC_SAMPLING_PERIOD_US));
 
-    // Start publish thread with a delay of 10 seconds because we don't want to
+#if defined(CONFIG_IR_LED_RAIL)
+    // ADC1 is now enabled, injected conversions can be armed
+    ir_led_rail_init();
+#endif
+
+    // Start publishing with a delay of 10 seconds because we don't want to
     // publish voltages before all power supplies are turned on. Otherwise, it
     // is hard to filter for outliers because you see outliers in the data at
     // each boot of an Orb.
 #ifdef CONFIG_ZTEST
     // don't delay execution when ZTESTs are enabled otherwise no voltage
     // messages are published when the test starts.
-    const k_timeout_t delay = K_SECONDS(0);
+    const uint32_t delay_ms = 0;
 #else
-    const k_timeout_t delay = K_SECONDS(10);
+    const uint32_t delay_ms = 10000;
 #endif
-    tid_publish = k_thread_create(
-        &voltage_measurement_publish_thread_data,
-        voltage_measurement_publish_thread_stack,
-        K_THREAD_STACK_SIZEOF(voltage_measurement_publish_thread_stack),
-        (k_thread_entry_t)voltage_measurement_publish_thread, NULL, NULL, NULL,
-        THREAD_PRIORITY_VOLTAGE_MEASUREMENT_PUBLISH, 0, delay);
-    k_thread_name_set(tid_publish, "voltage_measurement_publish");
-
-    return RET_SUCCESS;
+    return sensor_executor_job_start(&voltage_measurement_publish_job,
+                                     atomic_get(&voltages_publish_period_ms),
+                                     delay_ms);
 }
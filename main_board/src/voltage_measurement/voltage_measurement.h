@@ -98,6 +98,23 @@ ret_code_t
 voltage_measurement_get(voltage_measurement_channel_t channel,
                         int32_t *voltage_mv);
 
+/**
+ * @brief Converts a raw value of a specific channel into a voltage, for
+ *      samples of the channel taken outside of this module.
+ *
+ * @param channel Voltage measurement channel
+ * @param adc_raw_value 12 bit ADC raw value
+ * @param *voltage_mv Voltage in millivolts.
+ *
+ * @retval RET_SUCCESS on success
+ * @retval RET_ERROR_INVALID_PARAM if channel values is not valid.
+ * @retval RET_ERROR_NOT_INITIALIZED if voltage_measurement_init() was not
+ *      called successfully before using this function.
+ */
+ret_code_t
+voltage_measurement_raw_to_mv(voltage_measurement_channel_t channel,
+                              uint16_t adc_raw_value, int32_t *voltage_mv);
+
 /**
  * @brief Gets the adc raw value of a specific channel.
  *
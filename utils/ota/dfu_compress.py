@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+
+# Pack a firmware image (signed MCUboot binary) into the compressed container
+# decompressed on the fly by the main MCU, see lib/dfu/include/dfu_lz.h
+#
+# The CRC32 to be used to check the image once written (FirmwareUpdateCheck)
+# is computed over the decompressed image and is printed by this script.
+#
+# ⚠️ Encrypted images don't compress: the gain is only significant for images
+# that are not encrypted.
+
+import argparse
+import struct
+import sys
+import zlib
+
+MAGIC = 0x5A4C4644  # "DFLZ"
+VERSION = 1
+HEADER_FORMAT = "<IBBHI"
+MIN_MATCH = 4
+MAX_CHAIN = 256
+
+
+def encode_length(out, length):
+    # lengths >= 15 are continued with bytes, until one is lower than 255
+    length -= 15
+    while length >= 255:
+        out.append(255)
+        length -= 255
+    out.append(length)
+
+
+def emit_sequence(out, literals, match_length, offset):
+    lit_nibble = min(len(literals), 15)
+    match_nibble = 0
+    if match_length:
+        match_nibble = min(match_length - MIN_MATCH, 15)
+    out.append((lit_nibble << 4) | match_nibble)
+    if lit_nibble == 15:
+        encode_length(out, len(literals))
+    out += literals
+    if match_length:
+        out += struct.pack("<H", offset)
+        if match_nibble == 15:
+            encode_length(out, match_length - MIN_MATCH)
+
+
+def compress(data, window_log2):
+    window = 1 << window_log2
+    out = bytearray(struct.pack(HEADER_FORMAT, MAGIC, VERSION, window_log2, 0,
+                                len(data)))
+    if not data:
+        return bytes(out)
+
+    # hash chains over 4-byte prefixes
+    head = {}
+    prev = [-1] * len(data)
+
+    def insert(pos):
+        if pos + MIN_MATCH <= len(data):
+            key = data[pos:pos + MIN_MATCH]
+            prev[pos] = head.get(key, -1)
+            head[key] = pos
+
+    def longest_match(pos):
+        best_length, best_offset = 0, 0
+        if pos + MIN_MATCH > len(data):
+            return best_length, best_offset
+        candidate = head.get(data[pos:pos + MIN_MATCH], -1)
+        chain = 0
+        while candidate >= 0 and pos - candidate <= window and chain < MAX_CHAIN:
+            length = 0
+            while pos + length < len(data) and data[candidate + length] == data[pos + length]:
+                length += 1
+            if length > best_length:
+                best_length, best_offset = length, pos - candidate
+            candidate = prev[candidate]
+            chain += 1
+        return best_length, best_offset
+
+    pos = 0
+    literal_start = 0
+    while pos < len(data):
+        length, offset = longest_match(pos)
+        if length < MIN_MATCH:
+            insert(pos)
+            pos += 1
+            continue
+
+        emit_sequence(out, data[literal_start:pos], length, offset)
+        for i in range(pos, pos + length):
+            insert(i)
+        pos += length
+        literal_start = pos
+
+    # the last sequence only contains literals, possibly none
+    emit_sequence(out, data[literal_start:], 0, 0)
+    return bytes(out)
+
+
+def decompress(packed):
+    magic, version, window_log2, _, raw_size = struct.unpack_from(HEADER_FORMAT, packed)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("not a compressed image")
+    pos = struct.calcsize(HEADER_FORMAT)
+    out = bytearray()
+
+    def read_length(nibble):
+        nonlocal pos
+        length = nibble
+        if nibble == 15:
+            while True:
+                byte = packed[pos]
+                pos += 1
+                length += byte
+                if byte != 255:
+                    break
+        return length
+
+    # the last sequence only contains literals, possibly none
+    while raw_size:
+        token = packed[pos]
+        pos += 1
+        literals = read_length(token >> 4)
+        out += packed[pos:pos + literals]
+        pos += literals
+        if len(out) == raw_size:
+            break
+        offset = struct.unpack_from("<H", packed, pos)[0]
+        pos += 2
+        if offset == 0 or offset > (1 << window_log2) or offset > len(out):
+            raise ValueError("invalid match offset {} @{}".format(offset, pos))
+        length = read_length(token & 0x0F) + MIN_MATCH
+        for _ in range(length):
+            out.append(out[-offset])
+
+    if pos != len(packed) or len(out) != raw_size:
+        raise ValueError("invalid compressed image size")
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Compress a firmware image to be sent to the main MCU")
+    parser.add_argument("input", help="firmware image, binary format")
+    parser.add_argument("output", help="compressed image")
+    parser.add_argument("-w", "--window-log2", type=int, default=10,
+                        help="log2 of the window size, must not exceed "
+                             "CONFIG_ORB_LIB_DFU_LZ_WINDOW_LOG2 (default: 10)")
+    args = parser.parse_args()
+
+    if not 8 <= args.window_log2 <= 15:
+        parser.error("window-log2 must be in [8, 15]")
+
+    with open(args.input, "rb") as f:
+        data = f.read()
+
+    packed = compress(data, args.window_log2)
+    if decompress(packed) != data:
+        print("Round-trip check failed", file=sys.stderr)
+        return 1
+
+    with open(args.output, "wb") as f:
+        f.write(packed)
+
+    print("{}: {} -> {} bytes ({:.1f}%)".format(
+        args.output, len(data), len(packed), 100.0 * len(packed) / max(len(data), 1)))
+    print("CRC32 of decompressed image: 0x{:08x}".format(zlib.crc32(data)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
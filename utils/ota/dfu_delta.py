@@ -0,0 +1,229 @@
+#!/usr/bin/env python3
+
+# Generate a patch from the firmware image running on the main MCU (old image,
+# in the primary slot) to a new image, see lib/dfu/include/dfu_delta.h
+#
+# The old image must be byte-for-byte what is in the primary slot: the patch
+# header contains its CRC32 and the MCU refuses to apply a patch to another
+# image. MCUboot decrypts images when installing them, so the old image must
+# be the decrypted one.
+#
+# The CRC32 to be used to check the image once written (FirmwareUpdateCheck)
+# is computed over the new image and is printed by this script.
+
+import argparse
+import struct
+import sys
+import zlib
+
+import dfu_compress
+
+MAGIC = 0x50444644  # "DFDP"
+VERSION = 1
+HEADER_FORMAT = "<IB3xIII"
+OP_COPY = 0
+OP_ADD = 1
+OP_INSERT = 2
+
+# bytes hashed to find match candidates into the old image
+KEY_SIZE = 8
+MAX_CANDIDATES = 8
+# stop extending an approximate match after that many bytes without gain
+EXTEND_LOOKAHEAD = 64
+
+
+def varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return out
+
+
+def zigzag(value):
+    return value << 1 if value >= 0 else ((-value - 1) << 1) | 1
+
+
+def exact_length(old, new, old_pos, new_pos):
+    length = 0
+    # compare by slices first, then byte per byte
+    while new[new_pos + length:new_pos + length + 64] == old[old_pos + length:old_pos + length + 64] \
+            and new_pos + length + 64 <= len(new) and old_pos + length + 64 <= len(old):
+        length += 64
+    while new_pos + length < len(new) and old_pos + length < len(old) \
+            and new[new_pos + length] == old[old_pos + length]:
+        length += 1
+    return length
+
+
+def approximate_length(old, new, old_pos, new_pos, exact):
+    """bsdiff-style extension: keep extending as long as at least half of the
+    bytes match. Returns the length and the number of matching bytes."""
+    matches = exact
+    best_length, best_matches = exact, exact
+    length = exact
+    while new_pos + length < len(new) and old_pos + length < len(old) \
+            and length - best_length < EXTEND_LOOKAHEAD:
+        if new[new_pos + length] == old[old_pos + length]:
+            matches += 1
+        length += 1
+        if 2 * matches - length > 2 * best_matches - best_length:
+            best_length, best_matches = length, matches
+    return best_length, best_matches
+
+
+def diff(old, new):
+    index = {}
+    for i in range(len(old) - KEY_SIZE + 1):
+        positions = index.setdefault(old[i:i + KEY_SIZE], [])
+        if len(positions) < MAX_CANDIDATES:
+            positions.append(i)
+
+    ops = bytearray()
+    source = 0  # source offset, as tracked by the MCU
+    pos = 0
+    literal_start = 0
+    continuation = None  # old offset aligned with the last match
+
+    def emit_insert(data):
+        if data:
+            ops.append(OP_INSERT)
+            ops.extend(varint(len(data)))
+            ops.extend(data)
+
+    while pos < len(new):
+        candidates = list(index.get(new[pos:pos + KEY_SIZE], []))
+        if continuation is not None and 0 <= continuation < len(old):
+            candidates.append(continuation)
+
+        best = None
+        for candidate in candidates:
+            exact = exact_length(old, new, candidate, pos)
+            length, matches = approximate_length(old, new, candidate, pos, exact)
+            if matches >= KEY_SIZE and (best is None or matches > best[2]):
+                best = (candidate, length, matches)
+
+        if best is None:
+            pos += 1
+            if continuation is not None:
+                continuation += 1
+            continue
+
+        candidate, length, _ = best
+        emit_insert(new[literal_start:pos])
+        added = bytes((new[pos + i] - old[candidate + i]) & 0xFF for i in range(length))
+        op = OP_COPY if not any(added) else OP_ADD
+        ops.append(op)
+        ops.extend(varint(length))
+        ops.extend(varint(zigzag(candidate - source)))
+        if op == OP_ADD:
+            ops.extend(added)
+
+        source = candidate + length
+        pos += length
+        literal_start = pos
+        continuation = source
+
+    emit_insert(new[literal_start:])
+
+    header = struct.pack(HEADER_FORMAT, MAGIC, VERSION, len(old), zlib.crc32(old), len(new))
+    return header + bytes(ops)
+
+
+def patch(old, delta):
+    magic, version, source_size, source_crc32, target_size = struct.unpack_from(HEADER_FORMAT, delta)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("not a patch")
+    if source_size != len(old) or source_crc32 != zlib.crc32(old):
+        raise ValueError("patch doesn't apply to the old image")
+    pos = struct.calcsize(HEADER_FORMAT)
+    out = bytearray()
+    source = 0
+
+    def read_varint():
+        nonlocal pos
+        value, shift = 0, 0
+        while True:
+            byte = delta[pos]
+            pos += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                return value
+
+    while len(out) < target_size:
+        op = delta[pos]
+        pos += 1
+        length = read_varint()
+        if op == OP_INSERT:
+            out += delta[pos:pos + length]
+            pos += length
+            continue
+        seek = read_varint()
+        source += -(seek >> 1) - 1 if seek & 1 else seek >> 1
+        if source < 0 or source + length > len(old):
+            raise ValueError("source out of range @{}".format(pos))
+        if op == OP_COPY:
+            out += old[source:source + length]
+        elif op == OP_ADD:
+            out += bytes((old[source + i] + delta[pos + i]) & 0xFF for i in range(length))
+            pos += length
+        else:
+            raise ValueError("unknown operation {} @{}".format(op, pos))
+        source += length
+
+    if pos != len(delta) or len(out) != target_size:
+        raise ValueError("invalid patch size")
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Generate a patch to update the main MCU from the image "
+                    "in its primary slot")
+    parser.add_argument("old", help="image in the primary slot, binary format")
+    parser.add_argument("new", help="new firmware image, binary format")
+    parser.add_argument("output", help="patch")
+    parser.add_argument("--no-compress", action="store_true",
+                        help="don't pack the patch with dfu_compress.py")
+    parser.add_argument("-w", "--window-log2", type=int, default=10,
+                        help="log2 of the compression window size, must not "
+                             "exceed CONFIG_ORB_LIB_DFU_LZ_WINDOW_LOG2 "
+                             "(default: 10)")
+    args = parser.parse_args()
+
+    if not 8 <= args.window_log2 <= 15:
+        parser.error("window-log2 must be in [8, 15]")
+
+    with open(args.old, "rb") as f:
+        old = f.read()
+    with open(args.new, "rb") as f:
+        new = f.read()
+
+    delta = diff(old, new)
+    if patch(old, delta) != new:
+        print("Round-trip check failed", file=sys.stderr)
+        return 1
+
+    output = delta
+    if not args.no_compress:
+        output = dfu_compress.compress(delta, args.window_log2)
+        if dfu_compress.decompress(output) != delta:
+            print("Compression round-trip check failed", file=sys.stderr)
+            return 1
+
+    with open(args.output, "wb") as f:
+        f.write(output)
+
+    print("{}: {} bytes, {:.1f}% of the new image ({} bytes)".format(
+        args.output, len(output), 100.0 * len(output) / max(len(new), 1), len(new)))
+    print("CRC32 of new image: 0x{:08x}".format(zlib.crc32(new)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())